@@ -0,0 +1,20 @@
+find_path(TURBOJPEG_INCLUDE 
+  NAMES turbojpeg.h
+  HINTS ${CMAKE_INSTALL_FULL_INCLUDEDIR}
+)
+mark_as_advanced(TURBOJPEG_INCLUDE)
+
+# Look for the library (sorted from most current/relevant entry to least).
+set(TURBOJPEG_LIBRARY_NAME turbojpeg)
+find_library(TURBOJPEG_LIBRARY NAMES turbojpeg HINTS ${CMAKE_INSTALL_FULL_LIBDIR})
+set(TURBOJPEG_LIBRARY ${TURBOJPEG_LIBRARY})
+mark_as_advanced(TURBOJPEG_LIBRARY)
+
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(TURBOJPEG
+                                  REQUIRED_VARS TURBOJPEG_LIBRARY TURBOJPEG_INCLUDE)
+
+if(TURBOJPEG_FOUND)
+  set(TURBOJPEG_LIBRARIES ${TURBOJPEG_LIBRARY})
+  set(TURBOJPEG_INCLUDE_DIR ${TURBOJPEG_INCLUDE})
+endif()
@@ -1,12 +1,13 @@
 #include "http_util.h"
 
+#include <cpprest/containerstream.h>
+#include <cpprest/rawptrstream.h>
+
 uint64_t HttpRequestLimiter::max_request_;
 std::atomic_size_t HttpRequestLimiter::request_count_;
 std::mutex HttpRequestLimiter::request_mutex_;
 
-void SafeReply(const web::http::http_request &request,
-               web::http::status_code status) {
-  auto resp = web::http::http_response(status);
+static void AddSecurityHeaders(web::http::http_response &resp) {
   resp.headers().add(U("Referrer-Policy"),
                      U("strict-origin-when-cross-origin"));
   resp.headers().add(
@@ -15,6 +16,12 @@ void SafeReply(const web::http::http_request &request,
         "objectsrc 'none'; "
         "frame-ancestors 'none'"));
   resp.headers().add(U("X-Frame-Options"), U("DENY"));
+}
+
+void SafeReply(const web::http::http_request &request,
+               web::http::status_code status) {
+  auto resp = web::http::http_response(status);
+  AddSecurityHeaders(resp);
   request.reply(resp).then([](pplx::task<void> t) { HandleError(t); });
 }
 
@@ -22,14 +29,7 @@ void SafeReply(const web::http::http_request &request,
                web::http::status_code status, const utf8string &body_data) {
   auto resp = web::http::http_response(status);
   resp.set_body(body_data);
-  resp.headers().add(U("Referrer-Policy"),
-                     U("strict-origin-when-cross-origin"));
-  resp.headers().add(
-      U("Content-Security-Policy"),
-      U("default-src 'self'  data: 'unsafe-inline' 'unsafe-eval'; "
-        "objectsrc 'none'; "
-        "frame-ancestors 'none'"));
-  resp.headers().add(U("X-Frame-Options"), U("DENY"));
+  AddSecurityHeaders(resp);
   request.reply(resp).then([](pplx::task<void> t) { HandleError(t); });
 }
 
@@ -39,17 +39,61 @@ void SafeReply(const web::http::http_request &request,
                const utility::string_t &content_type) {
   auto resp = web::http::http_response(status);
   resp.set_body(body_data, content_type);
-  resp.headers().add(U("Referrer-Policy"),
-                     U("strict-origin-when-cross-origin"));
-  resp.headers().add(
-      U("Content-Security-Policy"),
-      U("default-src 'self'  data: 'unsafe-inline' 'unsafe-eval'; "
-        "objectsrc 'none'; "
-        "frame-ancestors 'none'"));
-  resp.headers().add(U("X-Frame-Options"), U("DENY"));
+  AddSecurityHeaders(resp);
   request.reply(resp).then([](pplx::task<void> t) { HandleError(t); });
 }
 
+void SafeReply(const web::http::http_request &request,
+               web::http::status_code status, const void *body_data,
+               size_t body_size, std::shared_ptr<void> holder,
+               const utility::string_t &content_type) {
+  if (body_data == nullptr || body_size == 0) {
+    SafeReply(request, status,
+              concurrency::streams::bytestream::open_istream<std::string>(""),
+              content_type);
+    return;
+  }
+
+  // content length is known, connection is kept alive after reply
+  concurrency::streams::rawptr_buffer<uint8_t> body_buffer(
+      (const uint8_t *)body_data, body_size);
+  auto resp = web::http::http_response(status);
+  resp.set_body(body_buffer.create_istream(), body_size, content_type);
+  AddSecurityHeaders(resp);
+  request.reply(resp).then([holder](pplx::task<void> t) { HandleError(t); });
+}
+
+pplx::task<std::shared_ptr<std::string>> ReadRequestBody(
+    const web::http::http_request &request) {
+  auto body_buffer =
+      std::make_shared<concurrency::streams::container_buffer<std::string>>();
+  return request.body().read_to_end(*body_buffer).then(
+      [body_buffer](pplx::task<size_t> t) {
+        t.get();
+        return std::make_shared<std::string>(
+            std::move(body_buffer->collection()));
+      });
+}
+
+modelbox::Status AdoptRequestBody(
+    const std::shared_ptr<modelbox::BufferList> &buffer_list,
+    const std::shared_ptr<std::string> &body) {
+  if (body == nullptr || body->empty()) {
+    // device memory can not adopt empty data
+    auto buffer = std::make_shared<modelbox::Buffer>(buffer_list->GetDevice());
+    auto ret = buffer->Build(0);
+    if (!ret) {
+      return ret;
+    }
+
+    buffer_list->PushBack(buffer);
+    return modelbox::STATUS_OK;
+  }
+
+  std::shared_ptr<void> body_data(body, (void *)body->data());
+  return buffer_list->EmplaceBack(body_data, body->size());
+}
+
 utility::string_t GetSupportedMethods() {
   utility::string_t allowed;
   std::vector<web::http::method> methods = {
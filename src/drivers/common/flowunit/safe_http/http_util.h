@@ -17,7 +17,17 @@
 
 #ifndef MODELBOX_FLOWUNIT_HTTP_UTIL_H_
 #define MODELBOX_FLOWUNIT_HTTP_UTIL_H_
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <vector>
+
 #include "modelbox/base/log.h"
+#include "modelbox/buffer_list.h"
 #include "cpprest/http_listener.h"
 
 void SafeReply(const web::http::http_request &request,
@@ -29,6 +39,30 @@ void SafeReply(const web::http::http_request &request,
                const concurrency::streams::istream &body_data,
                const utility::string_t &content_type);
 
+/**
+ * @brief Reply body read from memory in place, memory is kept by holder until
+ * the reply is sent
+ */
+void SafeReply(const web::http::http_request &request,
+               web::http::status_code status, const void *body_data,
+               size_t body_size, std::shared_ptr<void> holder,
+               const utility::string_t &content_type);
+
+/**
+ * @brief Read whole request body without conversion
+ * @return body string, moved out of the stream buffer
+ */
+pplx::task<std::shared_ptr<std::string>> ReadRequestBody(
+    const web::http::http_request &request);
+
+/**
+ * @brief Append request body to buffer list, body memory is adopted by the
+ * buffer without copy
+ */
+modelbox::Status AdoptRequestBody(
+    const std::shared_ptr<modelbox::BufferList> &buffer_list,
+    const std::shared_ptr<std::string> &body);
+
 void HandleError(pplx::task<void> &t);
 
 utility::string_t GetSupportedMethods();
@@ -63,4 +97,128 @@ class HttpRequestLimiter {
    static std::mutex request_mutex_;
 };
 
+/**
+ * @brief Coalesce concurrent requests into batches, a batch is flushed when
+ * it reaches max batch size or its first request has waited for the window
+ */
+template <typename T>
+class HttpRequestBatcher {
+ public:
+  using FlushFunc = std::function<void(std::vector<T> &batch)>;
+
+  HttpRequestBatcher(size_t max_batch_size, uint64_t window_ms,
+                     const FlushFunc &flush_func)
+      : max_batch_size_(max_batch_size > 0 ? max_batch_size : 1),
+        window_(window_ms),
+        flush_func_(flush_func) {}
+
+  virtual ~HttpRequestBatcher() { Stop(); }
+
+  void Start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+      return;
+    }
+
+    running_ = true;
+    flush_thread_ = std::thread(&HttpRequestBatcher::FlushWork, this);
+  }
+
+  /**
+   * @brief Stop batcher, pending requests are flushed before return
+   */
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!running_) {
+        return;
+      }
+
+      running_ = false;
+    }
+
+    cv_.notify_all();
+    flush_thread_.join();
+  }
+
+  void Push(T &&request) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.empty()) {
+      first_time_ = std::chrono::steady_clock::now();
+    }
+
+    pending_.push_back(std::move(request));
+    if (pending_.size() == 1 || pending_.size() >= max_batch_size_) {
+      cv_.notify_one();
+    }
+  }
+
+  /**
+   * @brief Number of batches flushed
+   */
+  uint64_t GetBatchCount() const { return batch_count_; }
+
+  /**
+   * @brief Number of requests flushed
+   */
+  uint64_t GetRequestCount() const { return request_count_; }
+
+  /**
+   * @brief Largest batch flushed so far
+   */
+  uint64_t GetMaxBatchSize() const { return max_batch_size_seen_; }
+
+ private:
+  void FlushWork() {
+    while (true) {
+      std::vector<T> batch;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !pending_.empty() || !running_; });
+        if (pending_.empty()) {
+          return;
+        }
+
+        cv_.wait_until(lock, first_time_ + window_, [this]() {
+          return pending_.size() >= max_batch_size_ || !running_;
+        });
+
+        auto count = std::min(pending_.size(), max_batch_size_);
+        batch.reserve(count);
+        std::move(pending_.begin(), pending_.begin() + count,
+                  std::back_inserter(batch));
+        pending_.erase(pending_.begin(), pending_.begin() + count);
+        // rest of pending requests start a new window
+        first_time_ = std::chrono::steady_clock::now();
+      }
+
+      UpdateStatistics(batch.size());
+      flush_func_(batch);
+    }
+  }
+
+  void UpdateStatistics(uint64_t size) {
+    batch_count_++;
+    request_count_ += size;
+    auto max = max_batch_size_seen_.load();
+    while (size > max &&
+           !max_batch_size_seen_.compare_exchange_weak(max, size)) {
+    }
+  }
+
+  size_t max_batch_size_;
+  std::chrono::milliseconds window_;
+  FlushFunc flush_func_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool running_{false};
+  std::vector<T> pending_;
+  std::chrono::steady_clock::time_point first_time_;
+  std::thread flush_thread_;
+  std::atomic<uint64_t> batch_count_{0};
+  std::atomic<uint64_t> request_count_{0};
+  std::atomic<uint64_t> max_batch_size_seen_{0};
+};
+
 #endif  // MODELBOX_FLOWUNIT_HTTP_UTIL_H_
\ No newline at end of file
@@ -0,0 +1,623 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "color_space_convert.h"
+
+#include <modelbox/base/log.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#define COLOR_CVT_SSSE3
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define COLOR_CVT_NEON
+#endif
+
+namespace videodecode {
+
+/*
+ * Fixed point BT.601 limited range coefficients.
+ * yuv -> rgb, 6 bits fraction:
+ *   yt = ((y * 0x0101 * 18997) >> 16) - 1160  (1.164 * (y - 16), +0.5 folded)
+ *   r = (yt + 102 * v) >> 6
+ *   g = (yt - 25 * u - 52 * v) >> 6
+ *   b = (yt + 129 * u) >> 6
+ * rgb -> yuv, 8 bits fraction:
+ *   y = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16
+ *   u = (112 * b - 74 * g - 38 * r + 0x8080) >> 8
+ *   v = (112 * r - 94 * g - 18 * b + 0x8080) >> 8
+ * The simd implementations follow the same integer steps, so the results are
+ * bit exact with the scalar ones.
+ */
+constexpr int32_t kYMul = 18997;
+constexpr int32_t kYSub = 1160;
+constexpr int32_t kVToR = 102;
+constexpr int32_t kUToG = 25;
+constexpr int32_t kVToG = 52;
+constexpr int32_t kUToB = 129;
+
+static inline uint8_t Clamp255(int32_t val) {
+  if (val < 0) {
+    return 0;
+  }
+
+  if (val > 255) {
+    return 255;
+  }
+
+  return (uint8_t)val;
+}
+
+static inline void YUVToRGBPixel(uint8_t y, int32_t u, int32_t v,
+                                 uint8_t *rgb, bool bgr) {
+  int32_t yt = (int32_t)(((uint32_t)y * 0x0101 * kYMul) >> 16) - kYSub;
+  u -= 128;
+  v -= 128;
+  auto r = Clamp255((yt + kVToR * v) >> 6);
+  auto g = Clamp255((yt - kUToG * u - kVToG * v) >> 6);
+  auto b = Clamp255((yt + kUToB * u) >> 6);
+  rgb[0] = bgr ? b : r;
+  rgb[1] = g;
+  rgb[2] = bgr ? r : b;
+}
+
+static inline uint8_t RGBToY(int32_t r, int32_t g, int32_t b) {
+  return (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+/* r, g, b are average value of 2x2 pixels */
+static inline uint8_t RGBToU(int32_t r, int32_t g, int32_t b) {
+  return (uint8_t)((112 * b - 74 * g - 38 * r + 0x8080) >> 8);
+}
+
+static inline uint8_t RGBToV(int32_t r, int32_t g, int32_t b) {
+  return (uint8_t)((112 * r - 94 * g - 18 * b + 0x8080) >> 8);
+}
+
+/* convert pixels in [start, width) of one row, chroma of pixel x is at
+ * u[(x / 2) * uv_step] */
+static void YUVToRGBRowC(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                         int32_t uv_step, uint8_t *dst, int32_t start,
+                         int32_t width, bool bgr) {
+  for (int32_t x = start; x < width; ++x) {
+    auto uv_index = (x / 2) * uv_step;
+    YUVToRGBPixel(y[x], u[uv_index], v[uv_index], dst + x * 3, bgr);
+  }
+}
+
+/* convert pixels in [start, width) of two rows, row1 may be the same as
+ * row0 for the last line of odd height image */
+static void RGBToYUVRowC(const uint8_t *row0, const uint8_t *row1,
+                         uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v,
+                         int32_t uv_step, int32_t start, int32_t width,
+                         bool bgr) {
+  const int32_t r_idx = bgr ? 2 : 0;
+  const int32_t b_idx = bgr ? 0 : 2;
+  for (int32_t x = start; x < width; x += 2) {
+    auto x1 = (x + 1 < width) ? x + 1 : x;
+    const uint8_t *p[4] = {row0 + x * 3, row0 + x1 * 3, row1 + x * 3,
+                           row1 + x1 * 3};
+    y0[x] = RGBToY(p[0][r_idx], p[0][1], p[0][b_idx]);
+    y0[x1] = RGBToY(p[1][r_idx], p[1][1], p[1][b_idx]);
+    if (y1 != nullptr) {
+      y1[x] = RGBToY(p[2][r_idx], p[2][1], p[2][b_idx]);
+      y1[x1] = RGBToY(p[3][r_idx], p[3][1], p[3][b_idx]);
+    }
+
+    int32_t r = (p[0][r_idx] + p[1][r_idx] + p[2][r_idx] + p[3][r_idx] + 2) >> 2;
+    int32_t g = (p[0][1] + p[1][1] + p[2][1] + p[3][1] + 2) >> 2;
+    int32_t b = (p[0][b_idx] + p[1][b_idx] + p[2][b_idx] + p[3][b_idx] + 2) >> 2;
+    auto uv_index = (x / 2) * uv_step;
+    u[uv_index] = RGBToU(r, g, b);
+    v[uv_index] = RGBToV(r, g, b);
+  }
+}
+
+#ifdef COLOR_CVT_SSSE3
+
+static bool IsSSSE3Supported() {
+  static bool supported = __builtin_cpu_supports("ssse3");
+  return supported;
+}
+
+/* yuv of 8 pixels in 16 bits lanes -> rgb in 16 bits lanes */
+__attribute__((target("ssse3"))) static inline void YUVToRGB8SSSE3(
+    __m128i y, __m128i u, __m128i v, __m128i *r, __m128i *g, __m128i *b) {
+  auto yt = _mm_sub_epi16(_mm_mulhi_epu16(y, _mm_set1_epi16(kYMul)),
+                          _mm_set1_epi16(kYSub));
+  u = _mm_sub_epi16(u, _mm_set1_epi16(128));
+  v = _mm_sub_epi16(v, _mm_set1_epi16(128));
+  /* only b may exceed int16 max, saturation result still clamps to 255 */
+  *r = _mm_srai_epi16(
+      _mm_adds_epi16(yt, _mm_mullo_epi16(v, _mm_set1_epi16(kVToR))), 6);
+  *g = _mm_srai_epi16(
+      _mm_sub_epi16(yt,
+                    _mm_add_epi16(_mm_mullo_epi16(u, _mm_set1_epi16(kUToG)),
+                                  _mm_mullo_epi16(v, _mm_set1_epi16(kVToG)))),
+      6);
+  *b = _mm_srai_epi16(
+      _mm_adds_epi16(yt, _mm_mullo_epi16(u, _mm_set1_epi16(kUToB))), 6);
+}
+
+/* interleave 16 pixels of three planes into 48 bytes */
+__attribute__((target("ssse3"))) static inline void StorePacked3SSSE3(
+    __m128i c0, __m128i c1, __m128i c2, uint8_t *dst) {
+  const auto m00 = _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1,
+                                 4, -1, -1, 5);
+  const auto m01 = _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1,
+                                 -1, 4, -1, -1);
+  const auto m02 = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3,
+                                 -1, -1, 4, -1);
+  const auto m10 = _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9,
+                                 -1, -1, 10, -1);
+  const auto m11 = _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1,
+                                 9, -1, -1, 10);
+  const auto m12 = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1,
+                                 -1, 9, -1, -1);
+  const auto m20 = _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14,
+                                 -1, -1, 15, -1, -1);
+  const auto m21 = _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1,
+                                 14, -1, -1, 15, -1);
+  const auto m22 = _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1,
+                                 -1, 14, -1, -1, 15);
+  auto out0 = _mm_or_si128(
+      _mm_or_si128(_mm_shuffle_epi8(c0, m00), _mm_shuffle_epi8(c1, m01)),
+      _mm_shuffle_epi8(c2, m02));
+  auto out1 = _mm_or_si128(
+      _mm_or_si128(_mm_shuffle_epi8(c0, m10), _mm_shuffle_epi8(c1, m11)),
+      _mm_shuffle_epi8(c2, m12));
+  auto out2 = _mm_or_si128(
+      _mm_or_si128(_mm_shuffle_epi8(c0, m20), _mm_shuffle_epi8(c1, m21)),
+      _mm_shuffle_epi8(c2, m22));
+  _mm_storeu_si128((__m128i *)dst, out0);
+  _mm_storeu_si128((__m128i *)(dst + 16), out1);
+  _mm_storeu_si128((__m128i *)(dst + 32), out2);
+}
+
+/* split 48 bytes of packed pixels into three planes of 16 pixels */
+__attribute__((target("ssse3"))) static inline void LoadPacked3SSSE3(
+    const uint8_t *src, __m128i *c0, __m128i *c1, __m128i *c2) {
+  auto in0 = _mm_loadu_si128((const __m128i *)src);
+  auto in1 = _mm_loadu_si128((const __m128i *)(src + 16));
+  auto in2 = _mm_loadu_si128((const __m128i *)(src + 32));
+  const auto m00 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1,
+                                 -1, -1, -1, -1);
+  const auto m01 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1,
+                                 -1, -1, -1, -1);
+  const auto m02 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                 1, 4, 7, 10, 13);
+  const auto m10 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1,
+                                 -1, -1, -1, -1);
+  const auto m11 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1,
+                                 -1, -1, -1, -1);
+  const auto m12 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                 2, 5, 8, 11, 14);
+  const auto m20 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1,
+                                 -1, -1, -1, -1);
+  const auto m21 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1,
+                                 -1, -1, -1, -1);
+  const auto m22 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3,
+                                 6, 9, 12, 15);
+  *c0 = _mm_or_si128(
+      _mm_or_si128(_mm_shuffle_epi8(in0, m00), _mm_shuffle_epi8(in1, m01)),
+      _mm_shuffle_epi8(in2, m02));
+  *c1 = _mm_or_si128(
+      _mm_or_si128(_mm_shuffle_epi8(in0, m10), _mm_shuffle_epi8(in1, m11)),
+      _mm_shuffle_epi8(in2, m12));
+  *c2 = _mm_or_si128(
+      _mm_or_si128(_mm_shuffle_epi8(in0, m20), _mm_shuffle_epi8(in1, m21)),
+      _mm_shuffle_epi8(in2, m22));
+}
+
+/* return number of converted pixels, the rest is left to scalar code */
+__attribute__((target("ssse3"))) static int32_t YUVToRGBRowSSSE3(
+    const uint8_t *y, const uint8_t *u, const uint8_t *v, bool nv12,
+    uint8_t *dst, int32_t width, bool bgr) {
+  const auto zero = _mm_setzero_si128();
+  const auto dup_u = _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12,
+                                   12, 14, 14);
+  const auto dup_v = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13,
+                                   13, 15, 15);
+  int32_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    auto y16 = _mm_loadu_si128((const __m128i *)(y + x));
+    __m128i u16;
+    __m128i v16;
+    if (nv12) {
+      auto uv = _mm_loadu_si128((const __m128i *)(u + x));
+      u16 = _mm_shuffle_epi8(uv, dup_u);
+      v16 = _mm_shuffle_epi8(uv, dup_v);
+    } else {
+      auto u8 = _mm_loadl_epi64((const __m128i *)(u + x / 2));
+      auto v8 = _mm_loadl_epi64((const __m128i *)(v + x / 2));
+      u16 = _mm_unpacklo_epi8(u8, u8);
+      v16 = _mm_unpacklo_epi8(v8, v8);
+    }
+
+    __m128i r_lo;
+    __m128i g_lo;
+    __m128i b_lo;
+    __m128i r_hi;
+    __m128i g_hi;
+    __m128i b_hi;
+    YUVToRGB8SSSE3(_mm_unpacklo_epi8(y16, y16), _mm_unpacklo_epi8(u16, zero),
+                   _mm_unpacklo_epi8(v16, zero), &r_lo, &g_lo, &b_lo);
+    YUVToRGB8SSSE3(_mm_unpackhi_epi8(y16, y16), _mm_unpackhi_epi8(u16, zero),
+                   _mm_unpackhi_epi8(v16, zero), &r_hi, &g_hi, &b_hi);
+    auto r = _mm_packus_epi16(r_lo, r_hi);
+    auto g = _mm_packus_epi16(g_lo, g_hi);
+    auto b = _mm_packus_epi16(b_lo, b_hi);
+    if (bgr) {
+      StorePacked3SSSE3(b, g, r, dst + x * 3);
+    } else {
+      StorePacked3SSSE3(r, g, b, dst + x * 3);
+    }
+  }
+
+  return x;
+}
+
+/* y of 8 pixels in 16 bits lanes */
+__attribute__((target("ssse3"))) static inline __m128i RGBToY8SSSE3(
+    __m128i r, __m128i g, __m128i b) {
+  auto sum = _mm_add_epi16(
+      _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)),
+                    _mm_mullo_epi16(g, _mm_set1_epi16(129))),
+      _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(25)),
+                    _mm_set1_epi16(128)));
+  return _mm_add_epi16(_mm_srli_epi16(sum, 8), _mm_set1_epi16(16));
+}
+
+/* y of 16 pixels */
+__attribute__((target("ssse3"))) static inline __m128i RGBToY16SSSE3(
+    __m128i r, __m128i g, __m128i b) {
+  const auto zero = _mm_setzero_si128();
+  auto y_lo = RGBToY8SSSE3(_mm_unpacklo_epi8(r, zero),
+                           _mm_unpacklo_epi8(g, zero),
+                           _mm_unpacklo_epi8(b, zero));
+  auto y_hi = RGBToY8SSSE3(_mm_unpackhi_epi8(r, zero),
+                           _mm_unpackhi_epi8(g, zero),
+                           _mm_unpackhi_epi8(b, zero));
+  return _mm_packus_epi16(y_lo, y_hi);
+}
+
+/* rounded average of 2x2 blocks, 8 results in 16 bits lanes */
+__attribute__((target("ssse3"))) static inline __m128i Avg2x2SSSE3(
+    __m128i row0, __m128i row1) {
+  const auto zero = _mm_setzero_si128();
+  auto s0 = _mm_hadd_epi16(_mm_unpacklo_epi8(row0, zero),
+                           _mm_unpackhi_epi8(row0, zero));
+  auto s1 = _mm_hadd_epi16(_mm_unpacklo_epi8(row1, zero),
+                           _mm_unpackhi_epi8(row1, zero));
+  return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(s0, s1),
+                                      _mm_set1_epi16(2)),
+                        2);
+}
+
+/* return number of converted pixels, the rest is left to scalar code */
+__attribute__((target("ssse3"))) static int32_t RGBToYUVRowSSSE3(
+    const uint8_t *row0, const uint8_t *row1, uint8_t *y0, uint8_t *y1,
+    uint8_t *u, uint8_t *v, bool nv12, int32_t width, bool bgr) {
+  int32_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    __m128i r0;
+    __m128i g0;
+    __m128i b0;
+    __m128i r1;
+    __m128i g1;
+    __m128i b1;
+    if (bgr) {
+      LoadPacked3SSSE3(row0 + x * 3, &b0, &g0, &r0);
+      LoadPacked3SSSE3(row1 + x * 3, &b1, &g1, &r1);
+    } else {
+      LoadPacked3SSSE3(row0 + x * 3, &r0, &g0, &b0);
+      LoadPacked3SSSE3(row1 + x * 3, &r1, &g1, &b1);
+    }
+
+    _mm_storeu_si128((__m128i *)(y0 + x), RGBToY16SSSE3(r0, g0, b0));
+    if (y1 != nullptr) {
+      _mm_storeu_si128((__m128i *)(y1 + x), RGBToY16SSSE3(r1, g1, b1));
+    }
+
+    auto r = Avg2x2SSSE3(r0, r1);
+    auto g = Avg2x2SSSE3(g0, g1);
+    auto b = Avg2x2SSSE3(b0, b1);
+    /* modular 16 bits arithmetic, the result after >> 8 is in [16, 240] */
+    auto u16 = _mm_srli_epi16(
+        _mm_add_epi16(
+            _mm_sub_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(112)),
+                          _mm_add_epi16(_mm_mullo_epi16(g, _mm_set1_epi16(74)),
+                                        _mm_mullo_epi16(r, _mm_set1_epi16(38)))),
+            _mm_set1_epi16(0x8080)),
+        8);
+    auto v16 = _mm_srli_epi16(
+        _mm_add_epi16(
+            _mm_sub_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(112)),
+                          _mm_add_epi16(_mm_mullo_epi16(g, _mm_set1_epi16(94)),
+                                        _mm_mullo_epi16(b, _mm_set1_epi16(18)))),
+            _mm_set1_epi16(0x8080)),
+        8);
+    if (nv12) {
+      auto uv = _mm_or_si128(u16, _mm_slli_epi16(v16, 8));
+      _mm_storeu_si128((__m128i *)(u + x), uv);
+    } else {
+      _mm_storel_epi64((__m128i *)(u + x / 2), _mm_packus_epi16(u16, u16));
+      _mm_storel_epi64((__m128i *)(v + x / 2), _mm_packus_epi16(v16, v16));
+    }
+  }
+
+  return x;
+}
+
+#endif  // COLOR_CVT_SSSE3
+
+#ifdef COLOR_CVT_NEON
+
+static inline void YUVToRGB8NEON(uint8x8_t y, uint8x8_t u, uint8x8_t v,
+                                 uint8x8_t *r, uint8x8_t *g, uint8x8_t *b) {
+  /* (y * 0x0101 * kYMul) >> 16, the same as x86 mulhi */
+  auto y16 = vmulq_n_u16(vmovl_u8(y), 0x0101);
+  auto lo = vmull_u16(vget_low_u16(y16), vdup_n_u16(kYMul));
+  auto hi = vmull_u16(vget_high_u16(y16), vdup_n_u16(kYMul));
+  auto yt = vsubq_s16(vreinterpretq_s16_u16(vcombine_u16(
+                          vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16))),
+                      vdupq_n_s16(kYSub));
+  auto u16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+  auto v16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+  auto r16 = vqaddq_s16(yt, vmulq_n_s16(v16, kVToR));
+  auto g16 = vsubq_s16(yt, vaddq_s16(vmulq_n_s16(u16, kUToG),
+                                     vmulq_n_s16(v16, kVToG)));
+  auto b16 = vqaddq_s16(yt, vmulq_n_s16(u16, kUToB));
+  *r = vqmovun_s16(vshrq_n_s16(r16, 6));
+  *g = vqmovun_s16(vshrq_n_s16(g16, 6));
+  *b = vqmovun_s16(vshrq_n_s16(b16, 6));
+}
+
+static int32_t YUVToRGBRowNEON(const uint8_t *y, const uint8_t *u,
+                               const uint8_t *v, bool nv12, uint8_t *dst,
+                               int32_t width, bool bgr) {
+  int32_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    auto y16 = vld1q_u8(y + x);
+    uint8x16_t u16;
+    uint8x16_t v16;
+    if (nv12) {
+      auto uv = vld2_u8(u + x);
+      u16 = vcombine_u8(vzip_u8(uv.val[0], uv.val[0]).val[0],
+                        vzip_u8(uv.val[0], uv.val[0]).val[1]);
+      v16 = vcombine_u8(vzip_u8(uv.val[1], uv.val[1]).val[0],
+                        vzip_u8(uv.val[1], uv.val[1]).val[1]);
+    } else {
+      auto u8 = vld1_u8(u + x / 2);
+      auto v8 = vld1_u8(v + x / 2);
+      u16 = vcombine_u8(vzip_u8(u8, u8).val[0], vzip_u8(u8, u8).val[1]);
+      v16 = vcombine_u8(vzip_u8(v8, v8).val[0], vzip_u8(v8, v8).val[1]);
+    }
+
+    uint8x8_t r[2];
+    uint8x8_t g[2];
+    uint8x8_t b[2];
+    YUVToRGB8NEON(vget_low_u8(y16), vget_low_u8(u16), vget_low_u8(v16), &r[0],
+                  &g[0], &b[0]);
+    YUVToRGB8NEON(vget_high_u8(y16), vget_high_u8(u16), vget_high_u8(v16),
+                  &r[1], &g[1], &b[1]);
+    uint8x16x3_t rgb;
+    rgb.val[0] = vcombine_u8(bgr ? b[0] : r[0], bgr ? b[1] : r[1]);
+    rgb.val[1] = vcombine_u8(g[0], g[1]);
+    rgb.val[2] = vcombine_u8(bgr ? r[0] : b[0], bgr ? r[1] : b[1]);
+    vst3q_u8(dst + x * 3, rgb);
+  }
+
+  return x;
+}
+
+static inline uint8x16_t RGBToY16NEON(uint8x16_t r, uint8x16_t g,
+                                      uint8x16_t b) {
+  auto lo = vmull_u8(vget_low_u8(r), vdup_n_u8(66));
+  lo = vmlal_u8(lo, vget_low_u8(g), vdup_n_u8(129));
+  lo = vmlal_u8(lo, vget_low_u8(b), vdup_n_u8(25));
+  auto hi = vmull_u8(vget_high_u8(r), vdup_n_u8(66));
+  hi = vmlal_u8(hi, vget_high_u8(g), vdup_n_u8(129));
+  hi = vmlal_u8(hi, vget_high_u8(b), vdup_n_u8(25));
+  auto y = vcombine_u8(vshrn_n_u16(vaddq_u16(lo, vdupq_n_u16(128)), 8),
+                       vshrn_n_u16(vaddq_u16(hi, vdupq_n_u16(128)), 8));
+  return vaddq_u8(y, vdupq_n_u8(16));
+}
+
+static int32_t RGBToYUVRowNEON(const uint8_t *row0, const uint8_t *row1,
+                               uint8_t *y0, uint8_t *y1, uint8_t *u,
+                               uint8_t *v, bool nv12, int32_t width,
+                               bool bgr) {
+  const int32_t r_idx = bgr ? 2 : 0;
+  const int32_t b_idx = bgr ? 0 : 2;
+  int32_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    auto p0 = vld3q_u8(row0 + x * 3);
+    auto p1 = vld3q_u8(row1 + x * 3);
+    vst1q_u8(y0 + x, RGBToY16NEON(p0.val[r_idx], p0.val[1], p0.val[b_idx]));
+    if (y1 != nullptr) {
+      vst1q_u8(y1 + x, RGBToY16NEON(p1.val[r_idx], p1.val[1], p1.val[b_idx]));
+    }
+
+    auto r = vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p0.val[r_idx]), p1.val[r_idx]), 2);
+    auto g = vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p0.val[1]), p1.val[1]), 2);
+    auto b = vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p0.val[b_idx]), p1.val[b_idx]), 2);
+    auto u16 = vsubq_u16(vmulq_n_u16(b, 112),
+                         vaddq_u16(vmulq_n_u16(g, 74), vmulq_n_u16(r, 38)));
+    auto v16 = vsubq_u16(vmulq_n_u16(r, 112),
+                         vaddq_u16(vmulq_n_u16(g, 94), vmulq_n_u16(b, 18)));
+    auto u8 = vshrn_n_u16(vaddq_u16(u16, vdupq_n_u16(0x8080)), 8);
+    auto v8 = vshrn_n_u16(vaddq_u16(v16, vdupq_n_u16(0x8080)), 8);
+    if (nv12) {
+      uint8x8x2_t uv;
+      uv.val[0] = u8;
+      uv.val[1] = v8;
+      vst2_u8(u + x, uv);
+    } else {
+      vst1_u8(u + x / 2, u8);
+      vst1_u8(v + x / 2, v8);
+    }
+  }
+
+  return x;
+}
+
+#endif  // COLOR_CVT_NEON
+
+static int32_t YUVToRGBRowSIMD(const uint8_t *y, const uint8_t *u,
+                               const uint8_t *v, bool nv12, uint8_t *dst,
+                               int32_t width, bool bgr) {
+#if defined(COLOR_CVT_SSSE3)
+  if (IsSSSE3Supported()) {
+    return YUVToRGBRowSSSE3(y, u, v, nv12, dst, width, bgr);
+  }
+#elif defined(COLOR_CVT_NEON)
+  return YUVToRGBRowNEON(y, u, v, nv12, dst, width, bgr);
+#endif
+  return 0;
+}
+
+static int32_t RGBToYUVRowSIMD(const uint8_t *row0, const uint8_t *row1,
+                               uint8_t *y0, uint8_t *y1, uint8_t *u,
+                               uint8_t *v, bool nv12, int32_t width,
+                               bool bgr) {
+#if defined(COLOR_CVT_SSSE3)
+  if (IsSSSE3Supported()) {
+    return RGBToYUVRowSSSE3(row0, row1, y0, y1, u, v, nv12, width, bgr);
+  }
+#elif defined(COLOR_CVT_NEON)
+  return RGBToYUVRowNEON(row0, row1, y0, y1, u, v, nv12, width, bgr);
+#endif
+  return 0;
+}
+
+static modelbox::Status CheckParam(const void *src, const void *dst,
+                                   int32_t width, int32_t height) {
+  if (src == nullptr || dst == nullptr) {
+    MBLOG_ERROR << "color convert input or output is null";
+    return modelbox::STATUS_INVALID;
+  }
+
+  if (width <= 0 || height <= 0) {
+    MBLOG_ERROR << "color convert size " << width << "x" << height
+                << " is invalid";
+    return modelbox::STATUS_INVALID;
+  }
+
+  return modelbox::STATUS_OK;
+}
+
+static modelbox::Status YUVToRGB(const uint8_t *src_y, int32_t src_y_stride,
+                                 const uint8_t *src_u, int32_t src_u_stride,
+                                 const uint8_t *src_v, int32_t src_v_stride,
+                                 bool nv12, uint8_t *dst, int32_t dst_stride,
+                                 int32_t width, int32_t height,
+                                 RGBFormat dst_fmt) {
+  auto ret = CheckParam(src_y, dst, width, height);
+  if (!ret) {
+    return ret;
+  }
+
+  if (src_u == nullptr || src_v == nullptr) {
+    MBLOG_ERROR << "color convert input chroma plane is null";
+    return modelbox::STATUS_INVALID;
+  }
+
+  auto bgr = (dst_fmt == RGBFormat::BGR24);
+  auto uv_step = nv12 ? 2 : 1;
+  for (int32_t h = 0; h < height; ++h) {
+    const auto *y = src_y + h * src_y_stride;
+    const auto *u = src_u + (h / 2) * src_u_stride;
+    const auto *v = src_v + (h / 2) * src_v_stride;
+    auto *out = dst + h * dst_stride;
+    auto done = YUVToRGBRowSIMD(y, u, v, nv12, out, width, bgr);
+    YUVToRGBRowC(y, u, v, uv_step, out, done, width, bgr);
+  }
+
+  return modelbox::STATUS_OK;
+}
+
+static modelbox::Status RGBToYUV(const uint8_t *src, int32_t src_stride,
+                                 uint8_t *dst_y, int32_t dst_y_stride,
+                                 uint8_t *dst_u, int32_t dst_u_stride,
+                                 uint8_t *dst_v, int32_t dst_v_stride,
+                                 bool nv12, int32_t width, int32_t height,
+                                 RGBFormat src_fmt) {
+  auto ret = CheckParam(src, dst_y, width, height);
+  if (!ret) {
+    return ret;
+  }
+
+  if (dst_u == nullptr || dst_v == nullptr) {
+    MBLOG_ERROR << "color convert output chroma plane is null";
+    return modelbox::STATUS_INVALID;
+  }
+
+  auto bgr = (src_fmt == RGBFormat::BGR24);
+  auto uv_step = nv12 ? 2 : 1;
+  for (int32_t h = 0; h < height; h += 2) {
+    const auto *row0 = src + h * src_stride;
+    const auto *row1 = (h + 1 < height) ? row0 + src_stride : row0;
+    auto *y0 = dst_y + h * dst_y_stride;
+    auto *y1 = (h + 1 < height) ? y0 + dst_y_stride : nullptr;
+    auto *u = dst_u + (h / 2) * dst_u_stride;
+    auto *v = dst_v + (h / 2) * dst_v_stride;
+    auto done = RGBToYUVRowSIMD(row0, row1, y0, y1, u, v, nv12, width, bgr);
+    RGBToYUVRowC(row0, row1, y0, y1, u, v, uv_step, done, width, bgr);
+  }
+
+  return modelbox::STATUS_OK;
+}
+
+modelbox::Status NV12ToRGB(const uint8_t *src_y, int32_t src_y_stride,
+                           const uint8_t *src_uv, int32_t src_uv_stride,
+                           uint8_t *dst, int32_t dst_stride, int32_t width,
+                           int32_t height, RGBFormat dst_fmt) {
+  const uint8_t *src_v = (src_uv == nullptr) ? nullptr : src_uv + 1;
+  return YUVToRGB(src_y, src_y_stride, src_uv, src_uv_stride, src_v,
+                  src_uv_stride, true, dst, dst_stride, width, height,
+                  dst_fmt);
+}
+
+modelbox::Status I420ToRGB(const uint8_t *src_y, int32_t src_y_stride,
+                           const uint8_t *src_u, int32_t src_u_stride,
+                           const uint8_t *src_v, int32_t src_v_stride,
+                           uint8_t *dst, int32_t dst_stride, int32_t width,
+                           int32_t height, RGBFormat dst_fmt) {
+  return YUVToRGB(src_y, src_y_stride, src_u, src_u_stride, src_v,
+                  src_v_stride, false, dst, dst_stride, width, height,
+                  dst_fmt);
+}
+
+modelbox::Status RGBToNV12(const uint8_t *src, int32_t src_stride,
+                           uint8_t *dst_y, int32_t dst_y_stride,
+                           uint8_t *dst_uv, int32_t dst_uv_stride,
+                           int32_t width, int32_t height, RGBFormat src_fmt) {
+  uint8_t *dst_v = (dst_uv == nullptr) ? nullptr : dst_uv + 1;
+  return RGBToYUV(src, src_stride, dst_y, dst_y_stride, dst_uv, dst_uv_stride,
+                  dst_v, dst_uv_stride, true, width, height, src_fmt);
+}
+
+modelbox::Status RGBToI420(const uint8_t *src, int32_t src_stride,
+                           uint8_t *dst_y, int32_t dst_y_stride,
+                           uint8_t *dst_u, int32_t dst_u_stride,
+                           uint8_t *dst_v, int32_t dst_v_stride, int32_t width,
+                           int32_t height, RGBFormat src_fmt) {
+  return RGBToYUV(src, src_stride, dst_y, dst_y_stride, dst_u, dst_u_stride,
+                  dst_v, dst_v_stride, false, width, height, src_fmt);
+}
+
+}  // namespace videodecode
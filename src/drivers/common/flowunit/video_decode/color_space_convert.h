@@ -0,0 +1,124 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODELBOX_FLOWUNIT_COLOR_SPACE_CONVERT_H_
+#define MODELBOX_FLOWUNIT_COLOR_SPACE_CONVERT_H_
+
+#include <modelbox/base/status.h>
+
+#include <stdint.h>
+
+namespace videodecode {
+
+/**
+ * @brief Packed rgb pixel order
+ */
+enum class RGBFormat {
+  /// r, g, b
+  RGB24 = 0,
+  /// b, g, r
+  BGR24 = 1,
+};
+
+/*
+ * Conversions below use BT.601 limited range, the same as swscale default.
+ * SSSE3 on x86_64 and NEON on aarch64 are used when available, the result is
+ * bit exact with the scalar implementation.
+ */
+
+/**
+ * @brief Convert nv12 image to packed rgb
+ * @param src_y y plane
+ * @param src_y_stride y plane stride in bytes
+ * @param src_uv interleaved uv plane
+ * @param src_uv_stride uv plane stride in bytes
+ * @param dst packed rgb output
+ * @param dst_stride output stride in bytes
+ * @param width image width
+ * @param height image height
+ * @param dst_fmt output pixel order
+ * @return convert result
+ */
+modelbox::Status NV12ToRGB(const uint8_t *src_y, int32_t src_y_stride,
+                           const uint8_t *src_uv, int32_t src_uv_stride,
+                           uint8_t *dst, int32_t dst_stride, int32_t width,
+                           int32_t height, RGBFormat dst_fmt);
+
+/**
+ * @brief Convert i420(yuv420p) image to packed rgb
+ * @param src_y y plane
+ * @param src_y_stride y plane stride in bytes
+ * @param src_u u plane
+ * @param src_u_stride u plane stride in bytes
+ * @param src_v v plane
+ * @param src_v_stride v plane stride in bytes
+ * @param dst packed rgb output
+ * @param dst_stride output stride in bytes
+ * @param width image width
+ * @param height image height
+ * @param dst_fmt output pixel order
+ * @return convert result
+ */
+modelbox::Status I420ToRGB(const uint8_t *src_y, int32_t src_y_stride,
+                           const uint8_t *src_u, int32_t src_u_stride,
+                           const uint8_t *src_v, int32_t src_v_stride,
+                           uint8_t *dst, int32_t dst_stride, int32_t width,
+                           int32_t height, RGBFormat dst_fmt);
+
+/**
+ * @brief Convert packed rgb image to nv12, chroma is the average of 2x2
+ * pixels
+ * @param src packed rgb input
+ * @param src_stride input stride in bytes
+ * @param dst_y y plane output
+ * @param dst_y_stride y plane stride in bytes
+ * @param dst_uv interleaved uv plane output
+ * @param dst_uv_stride uv plane stride in bytes
+ * @param width image width
+ * @param height image height
+ * @param src_fmt input pixel order
+ * @return convert result
+ */
+modelbox::Status RGBToNV12(const uint8_t *src, int32_t src_stride,
+                           uint8_t *dst_y, int32_t dst_y_stride,
+                           uint8_t *dst_uv, int32_t dst_uv_stride,
+                           int32_t width, int32_t height, RGBFormat src_fmt);
+
+/**
+ * @brief Convert packed rgb image to i420(yuv420p), chroma is the average of
+ * 2x2 pixels
+ * @param src packed rgb input
+ * @param src_stride input stride in bytes
+ * @param dst_y y plane output
+ * @param dst_y_stride y plane stride in bytes
+ * @param dst_u u plane output
+ * @param dst_u_stride u plane stride in bytes
+ * @param dst_v v plane output
+ * @param dst_v_stride v plane stride in bytes
+ * @param width image width
+ * @param height image height
+ * @param src_fmt input pixel order
+ * @return convert result
+ */
+modelbox::Status RGBToI420(const uint8_t *src, int32_t src_stride,
+                           uint8_t *dst_y, int32_t dst_y_stride,
+                           uint8_t *dst_u, int32_t dst_u_stride,
+                           uint8_t *dst_v, int32_t dst_v_stride, int32_t width,
+                           int32_t height, RGBFormat src_fmt);
+
+}  // namespace videodecode
+
+#endif  // MODELBOX_FLOWUNIT_COLOR_SPACE_CONVERT_H_
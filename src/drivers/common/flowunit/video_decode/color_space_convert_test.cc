@@ -0,0 +1,279 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "color_space_convert.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "modelbox/base/log.h"
+
+extern "C" {
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+namespace videodecode {
+
+class ColorSpaceConvertTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::mt19937 gen(0);
+    y_.resize(kWidth * kHeight);
+    uv_.resize(kWidth * kHeight / 2);
+    rgb_.resize(kWidth * kHeight * 3);
+    for (auto &val : y_) {
+      val = (uint8_t)gen();
+    }
+
+    for (auto &val : uv_) {
+      val = (uint8_t)gen();
+    }
+
+    for (auto &val : rgb_) {
+      val = (uint8_t)gen();
+    }
+  }
+
+  int32_t MaxDiff(const uint8_t *a, const uint8_t *b, size_t size) {
+    int32_t max_diff = 0;
+    for (size_t i = 0; i < size; ++i) {
+      max_diff = std::max(max_diff, std::abs((int32_t)a[i] - (int32_t)b[i]));
+    }
+
+    return max_diff;
+  }
+
+  /* index of first different byte, size of a when equal */
+  size_t FirstDiff(const std::vector<uint8_t> &a,
+                   const std::vector<uint8_t> &b) {
+    auto diff = std::mismatch(a.begin(), a.end(), b.begin(), b.end());
+    return diff.first - a.begin();
+  }
+
+  static uint8_t RefClamp(int32_t val) {
+    return (uint8_t)std::min(std::max(val, 0), 255);
+  }
+
+  /* plain scalar form of the fixed point formulas in color_space_convert.cc,
+   * chroma of pixel (w, h) is at (h / 2) * uv_stride + (w / 2) * uv_step */
+  void RefYUVToRGB(const uint8_t *u, const uint8_t *v, int32_t uv_stride,
+                   int32_t uv_step, uint8_t *dst, bool bgr) {
+    for (int32_t h = 0; h < kHeight; ++h) {
+      for (int32_t w = 0; w < kWidth; ++w) {
+        auto uv_index = (h / 2) * uv_stride + (w / 2) * uv_step;
+        int32_t y = y_[h * kWidth + w];
+        int32_t cb = u[uv_index] - 128;
+        int32_t cr = v[uv_index] - 128;
+        int32_t yt = (int32_t)(((uint32_t)y * 0x0101 * 18997) >> 16) - 1160;
+        auto *pixel = dst + (h * kWidth + w) * 3;
+        auto r = RefClamp((yt + 102 * cr) >> 6);
+        auto b = RefClamp((yt + 129 * cb) >> 6);
+        pixel[0] = bgr ? b : r;
+        pixel[1] = RefClamp((yt - 25 * cb - 52 * cr) >> 6);
+        pixel[2] = bgr ? r : b;
+      }
+    }
+  }
+
+  void RefRGBToYUV(uint8_t *y, uint8_t *u, uint8_t *v, int32_t uv_stride,
+                   int32_t uv_step, bool bgr) {
+    const int32_t r_idx = bgr ? 2 : 0;
+    const int32_t b_idx = bgr ? 0 : 2;
+    for (int32_t h = 0; h < kHeight; ++h) {
+      for (int32_t w = 0; w < kWidth; ++w) {
+        const auto *pixel = rgb_.data() + (h * kWidth + w) * 3;
+        y[h * kWidth + w] =
+            (uint8_t)(((66 * pixel[r_idx] + 129 * pixel[1] +
+                        25 * pixel[b_idx] + 128) >>
+                       8) +
+                      16);
+      }
+    }
+
+    for (int32_t h = 0; h < kHeight; h += 2) {
+      for (int32_t w = 0; w < kWidth; w += 2) {
+        int32_t sum[3] = {0, 0, 0};
+        for (int32_t i = 0; i < 4; ++i) {
+          const auto *pixel =
+              rgb_.data() + ((h + i / 2) * kWidth + w + i % 2) * 3;
+          for (int32_t c = 0; c < 3; ++c) {
+            sum[c] += pixel[c];
+          }
+        }
+
+        int32_t r = (sum[r_idx] + 2) >> 2;
+        int32_t g = (sum[1] + 2) >> 2;
+        int32_t b = (sum[b_idx] + 2) >> 2;
+        auto uv_index = (h / 2) * uv_stride + (w / 2) * uv_step;
+        u[uv_index] = (uint8_t)((112 * b - 74 * g - 38 * r + 0x8080) >> 8);
+        v[uv_index] = (uint8_t)((112 * r - 94 * g - 18 * b + 0x8080) >> 8);
+      }
+    }
+  }
+
+  const int32_t kWidth = 1920;
+  const int32_t kHeight = 1080;
+  std::vector<uint8_t> y_;
+  std::vector<uint8_t> uv_;
+  std::vector<uint8_t> rgb_;
+};
+
+TEST_F(ColorSpaceConvertTest, NV12ToBGR) {
+  std::vector<uint8_t> out(kWidth * kHeight * 3);
+  std::vector<uint8_t> ref_out(kWidth * kHeight * 3);
+  auto ret = NV12ToRGB(y_.data(), kWidth, uv_.data(), kWidth, out.data(),
+                       kWidth * 3, kWidth, kHeight, RGBFormat::BGR24);
+  ASSERT_EQ(ret, modelbox::STATUS_OK);
+
+  RefYUVToRGB(uv_.data(), uv_.data() + 1, kWidth, 2, ref_out.data(), true);
+  EXPECT_EQ(FirstDiff(out, ref_out), out.size());
+}
+
+TEST_F(ColorSpaceConvertTest, I420ToRGB) {
+  std::vector<uint8_t> out(kWidth * kHeight * 3);
+  std::vector<uint8_t> ref_out(kWidth * kHeight * 3);
+  auto *u = uv_.data();
+  auto *v = u + kWidth * kHeight / 4;
+  auto ret = I420ToRGB(y_.data(), kWidth, u, kWidth / 2, v, kWidth / 2,
+                       out.data(), kWidth * 3, kWidth, kHeight,
+                       RGBFormat::RGB24);
+  ASSERT_EQ(ret, modelbox::STATUS_OK);
+
+  RefYUVToRGB(u, v, kWidth / 2, 1, ref_out.data(), false);
+  EXPECT_EQ(FirstDiff(out, ref_out), out.size());
+}
+
+TEST_F(ColorSpaceConvertTest, RGBToI420) {
+  std::vector<uint8_t> out(kWidth * kHeight * 3 / 2);
+  std::vector<uint8_t> ref_out(kWidth * kHeight * 3 / 2);
+  auto y_size = kWidth * kHeight;
+  auto ret = RGBToI420(rgb_.data(), kWidth * 3, out.data(), kWidth,
+                       out.data() + y_size, kWidth / 2,
+                       out.data() + y_size * 5 / 4, kWidth / 2, kWidth,
+                       kHeight, RGBFormat::RGB24);
+  ASSERT_EQ(ret, modelbox::STATUS_OK);
+
+  RefRGBToYUV(ref_out.data(), ref_out.data() + y_size,
+              ref_out.data() + y_size * 5 / 4, kWidth / 2, 1, false);
+  EXPECT_EQ(FirstDiff(out, ref_out), out.size());
+}
+
+TEST_F(ColorSpaceConvertTest, BGRToNV12) {
+  std::vector<uint8_t> out(kWidth * kHeight * 3 / 2);
+  std::vector<uint8_t> ref_out(kWidth * kHeight * 3 / 2);
+  auto y_size = kWidth * kHeight;
+  auto ret = RGBToNV12(rgb_.data(), kWidth * 3, out.data(), kWidth,
+                       out.data() + y_size, kWidth, kWidth, kHeight,
+                       RGBFormat::BGR24);
+  ASSERT_EQ(ret, modelbox::STATUS_OK);
+
+  RefRGBToYUV(ref_out.data(), ref_out.data() + y_size,
+              ref_out.data() + y_size + 1, kWidth, 2, true);
+  EXPECT_EQ(FirstDiff(out, ref_out), out.size());
+}
+
+TEST_F(ColorSpaceConvertTest, OddSizeMatchFullSize) {
+  /* simd handles 16 pixels each step, the tail is done by scalar code */
+  const int32_t width = 37;
+  const int32_t height = 5;
+  std::vector<uint8_t> full(kWidth * height * 3);
+  std::vector<uint8_t> part(kWidth * height * 3);
+  auto ret = NV12ToRGB(y_.data(), kWidth, uv_.data(), kWidth, full.data(),
+                       kWidth * 3, width + 11, height, RGBFormat::RGB24);
+  ASSERT_EQ(ret, modelbox::STATUS_OK);
+  ret = NV12ToRGB(y_.data(), kWidth, uv_.data(), kWidth, part.data(),
+                  kWidth * 3, width, height, RGBFormat::RGB24);
+  ASSERT_EQ(ret, modelbox::STATUS_OK);
+  for (int32_t h = 0; h < height; ++h) {
+    auto offset = h * kWidth * 3;
+    EXPECT_EQ(MaxDiff(full.data() + offset, part.data() + offset, width * 3),
+              0);
+  }
+
+  std::vector<uint8_t> full_yuv(kWidth * kHeight * 3 / 2);
+  std::vector<uint8_t> part_yuv(kWidth * kHeight * 3 / 2);
+  auto *full_uv = full_yuv.data() + kWidth * kHeight;
+  auto *part_uv = part_yuv.data() + kWidth * kHeight;
+  ret = RGBToNV12(rgb_.data(), kWidth * 3, full_yuv.data(), kWidth, full_uv,
+                  kWidth, width + 11, height, RGBFormat::BGR24);
+  ASSERT_EQ(ret, modelbox::STATUS_OK);
+  ret = RGBToNV12(rgb_.data(), kWidth * 3, part_yuv.data(), kWidth, part_uv,
+                  kWidth, width - 1, height, RGBFormat::BGR24);
+  ASSERT_EQ(ret, modelbox::STATUS_OK);
+  for (int32_t h = 0; h < height; ++h) {
+    auto offset = h * kWidth;
+    EXPECT_EQ(
+        MaxDiff(full_yuv.data() + offset, part_yuv.data() + offset, width - 1),
+        0);
+  }
+
+  for (int32_t h = 0; h < height / 2; ++h) {
+    auto offset = h * kWidth;
+    EXPECT_EQ(MaxDiff(full_uv + offset, part_uv + offset, width - 1), 0);
+  }
+}
+
+TEST_F(ColorSpaceConvertTest, InvalidParam) {
+  std::vector<uint8_t> out(16 * 16 * 3);
+  EXPECT_EQ(NV12ToRGB(nullptr, 16, uv_.data(), 16, out.data(), 48, 16, 16,
+                      RGBFormat::RGB24),
+            modelbox::STATUS_INVALID);
+  EXPECT_EQ(NV12ToRGB(y_.data(), 16, uv_.data(), 16, out.data(), 48, 0, 16,
+                      RGBFormat::RGB24),
+            modelbox::STATUS_INVALID);
+}
+
+/* benchmark against swscale, run with --gtest_also_run_disabled_tests */
+TEST_F(ColorSpaceConvertTest, DISABLED_Perf) {
+  const int32_t loop = 50;
+  std::vector<uint8_t> out(kWidth * kHeight * 3);
+  auto begin = std::chrono::steady_clock::now();
+  for (int32_t i = 0; i < loop; ++i) {
+    NV12ToRGB(y_.data(), kWidth, uv_.data(), kWidth, out.data(), kWidth * 3,
+              kWidth, kHeight, RGBFormat::BGR24);
+  }
+  auto cost = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - begin)
+                  .count();
+
+  const uint8_t *src[4] = {y_.data(), uv_.data(), nullptr, nullptr};
+  int32_t src_stride[4] = {kWidth, kWidth, 0, 0};
+  uint8_t *dst[4] = {out.data(), nullptr, nullptr, nullptr};
+  int32_t dst_stride[4] = {kWidth * 3, 0, 0, 0};
+  auto *ctx = sws_getContext(kWidth, kHeight, AV_PIX_FMT_NV12, kWidth,
+                             kHeight, AV_PIX_FMT_BGR24, 0, nullptr, nullptr,
+                             nullptr);
+  ASSERT_NE(ctx, nullptr);
+  begin = std::chrono::steady_clock::now();
+  for (int32_t i = 0; i < loop; ++i) {
+    sws_scale(ctx, src, src_stride, 0, kHeight, dst, dst_stride);
+  }
+  auto sws_cost = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - begin)
+                      .count();
+  sws_freeContext(ctx);
+
+  MBLOG_INFO << "nv12 to bgr " << kWidth << "x" << kHeight
+             << ", color_space_convert: " << cost / loop
+             << "us/frame, sws_scale: " << sws_cost / loop << "us/frame";
+}
+
+}  // namespace videodecode
@@ -18,6 +18,8 @@
 #include "ffmpeg_color_converter.h"
 
 #include <modelbox/base/log.h>
+
+#include "color_space_convert.h"
 #include <video_decode_common.h>
 
 using namespace modelbox;
@@ -25,31 +27,60 @@ using namespace modelbox;
 modelbox::Status FfmpegColorConverter::CvtColor(
     const std::shared_ptr<AVFrame> &src_frame, uint8_t *out_frame_data,
     AVPixelFormat out_pix_fmt) {
+  return CvtColor(src_frame, out_frame_data, out_pix_fmt, 0, 0, 0);
+}
+
+modelbox::Status FfmpegColorConverter::CvtColor(
+    const std::shared_ptr<AVFrame> &src_frame, uint8_t *out_frame_data,
+    AVPixelFormat out_pix_fmt, int32_t out_width, int32_t out_height,
+    int32_t sws_flags) {
   if (!SupportCvtPixFmt(out_pix_fmt)) {
     return STATUS_INVALID;
   }
 
   auto &width = src_frame->width;
   auto &height = src_frame->height;
-  if (width_ != width || height != height_) {
-    width_ = width;
-    height_ = height;
-    auto ret = InitSwsCtx(width, height, (AVPixelFormat)src_frame->format,
-                          out_pix_fmt);
-    if (ret != STATUS_SUCCESS) {
-      return ret;
-    }
+  auto src_pix_fmt = (AVPixelFormat)src_frame->format;
+  if (out_width <= 0 || out_height <= 0) {
+    out_width = width;
+    out_height = height;
   }
 
   int32_t linesize[4];
-  GetLineSize(out_pix_fmt, width, linesize, 4);
+  GetLineSize(out_pix_fmt, out_width, linesize, 4);
   uint8_t *data[4] = {0};
   data[0] = out_frame_data;
+  auto out_plane_size = out_width * out_height;
   if (out_pix_fmt == AVPixelFormat::AV_PIX_FMT_NV12) {
-    data[1] = out_frame_data + width * height;  // For UV plane
+    data[1] = out_frame_data + out_plane_size;  // For UV plane
   } else if (out_pix_fmt == AVPixelFormat::AV_PIX_FMT_YUV420P) {
-    data[1] = out_frame_data + width * height;  // For U plane
-    data[2] = data[1] + width * height / 4;     // For V plane
+    data[1] = out_frame_data + out_plane_size;  // For U plane
+    data[2] = data[1] + out_plane_size / 4;     // For V plane
+  }
+
+  if (out_width == width && out_height == height) {
+    auto ret = FastCvtColor(src_frame, data, linesize, out_pix_fmt);
+    if (ret != STATUS_NOTSUPPORT) {
+      return ret;
+    }
+  }
+
+  if (width_ != width || height != height_ || src_pix_fmt_ != src_pix_fmt ||
+      out_width_ != out_width || out_height_ != out_height ||
+      out_pix_fmt_ != out_pix_fmt || sws_flags_ != sws_flags) {
+    auto ret = InitSwsCtx(width, height, src_pix_fmt, out_width, out_height,
+                          out_pix_fmt, sws_flags);
+    if (ret != STATUS_SUCCESS) {
+      return ret;
+    }
+
+    width_ = width;
+    height_ = height;
+    src_pix_fmt_ = src_pix_fmt;
+    out_width_ = out_width;
+    out_height_ = out_height;
+    out_pix_fmt_ = out_pix_fmt;
+    sws_flags_ = sws_flags;
   }
 
   auto ffmpeg_ret = sws_scale(sws_ctx_.get(), src_frame->data,
@@ -74,11 +105,70 @@ bool FfmpegColorConverter::SupportCvtPixFmt(AVPixelFormat pix_fmt) {
   return false;
 }
 
+Status FfmpegColorConverter::FastCvtColor(
+    const std::shared_ptr<AVFrame> &src_frame, uint8_t *data[4],
+    int32_t linesize[4], AVPixelFormat out_pix_fmt) {
+  auto &width = src_frame->width;
+  auto &height = src_frame->height;
+  if (width % 2 != 0 || height % 2 != 0) {
+    return STATUS_NOTSUPPORT;
+  }
+
+  auto src_pix_fmt = (AVPixelFormat)src_frame->format;
+  auto *src = src_frame->data;
+  auto *src_linesize = src_frame->linesize;
+  if (out_pix_fmt == AVPixelFormat::AV_PIX_FMT_RGB24 ||
+      out_pix_fmt == AVPixelFormat::AV_PIX_FMT_BGR24) {
+    auto rgb_fmt = (out_pix_fmt == AVPixelFormat::AV_PIX_FMT_RGB24)
+                       ? videodecode::RGBFormat::RGB24
+                       : videodecode::RGBFormat::BGR24;
+    if (src_pix_fmt == AVPixelFormat::AV_PIX_FMT_NV12) {
+      return videodecode::NV12ToRGB(src[0], src_linesize[0], src[1],
+                                    src_linesize[1], data[0], linesize[0],
+                                    width, height, rgb_fmt);
+    }
+
+    if (src_pix_fmt == AVPixelFormat::AV_PIX_FMT_YUV420P) {
+      return videodecode::I420ToRGB(src[0], src_linesize[0], src[1],
+                                    src_linesize[1], src[2], src_linesize[2],
+                                    data[0], linesize[0], width, height,
+                                    rgb_fmt);
+    }
+
+    return STATUS_NOTSUPPORT;
+  }
+
+  if (src_pix_fmt != AVPixelFormat::AV_PIX_FMT_RGB24 &&
+      src_pix_fmt != AVPixelFormat::AV_PIX_FMT_BGR24) {
+    return STATUS_NOTSUPPORT;
+  }
+
+  auto rgb_fmt = (src_pix_fmt == AVPixelFormat::AV_PIX_FMT_RGB24)
+                     ? videodecode::RGBFormat::RGB24
+                     : videodecode::RGBFormat::BGR24;
+  if (out_pix_fmt == AVPixelFormat::AV_PIX_FMT_NV12) {
+    return videodecode::RGBToNV12(src[0], src_linesize[0], data[0],
+                                  linesize[0], data[1], linesize[1], width,
+                                  height, rgb_fmt);
+  }
+
+  if (out_pix_fmt == AVPixelFormat::AV_PIX_FMT_YUV420P) {
+    return videodecode::RGBToI420(src[0], src_linesize[0], data[0],
+                                  linesize[0], data[1], linesize[1], data[2],
+                                  linesize[2], width, height, rgb_fmt);
+  }
+
+  return STATUS_NOTSUPPORT;
+}
+
 Status FfmpegColorConverter::InitSwsCtx(int32_t width, int32_t height,
                                         AVPixelFormat src_pix_fmt,
-                                        AVPixelFormat dest_pix_fmt) {
-  auto sws_ctx = sws_getContext(width, height, src_pix_fmt, width, height,
-                                dest_pix_fmt, 0, nullptr, nullptr, nullptr);
+                                        int32_t dest_width, int32_t dest_height,
+                                        AVPixelFormat dest_pix_fmt,
+                                        int32_t sws_flags) {
+  auto sws_ctx =
+      sws_getContext(width, height, src_pix_fmt, dest_width, dest_height,
+                     dest_pix_fmt, sws_flags, nullptr, nullptr, nullptr);
   if (sws_ctx == nullptr) {
     auto fmt_name = std::to_string(dest_pix_fmt);
     auto name_c = av_get_pix_fmt_name(dest_pix_fmt);
@@ -90,9 +180,9 @@ Status FfmpegColorConverter::InitSwsCtx(int32_t width, int32_t height,
       pix_fmt_name = "unknown";
     }
 
-    MBLOG_ERROR << "Failed to create sws_ctx for [f:" << fmt_name
-                << " w:" << width << " h:" << height << "]->[f:" << pix_fmt_name
-                << " w:" << width << " h:" << height << "]";
+    MBLOG_ERROR << "Failed to create sws_ctx for [f:" << pix_fmt_name
+                << " w:" << width << " h:" << height << "]->[f:" << fmt_name
+                << " w:" << dest_width << " h:" << dest_height << "]";
     return STATUS_FAULT;
   }
 
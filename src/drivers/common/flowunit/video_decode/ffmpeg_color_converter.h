@@ -32,11 +32,32 @@ class FfmpegColorConverter {
   modelbox::Status CvtColor(const std::shared_ptr<AVFrame> &src_frame,
                           uint8_t *out_frame_data, AVPixelFormat out_pix_fmt);
 
+  /**
+   * @brief Convert color and scale to out size in one pass
+   * @param src_frame source frame
+   * @param out_frame_data output buffer, size is decided by out size and fmt
+   * @param out_pix_fmt output pixel format
+   * @param out_width output width, 0 means the same as source
+   * @param out_height output height, 0 means the same as source
+   * @param sws_flags sws scale algorithm, such as SWS_BILINEAR
+   * @return convert result
+   */
+  modelbox::Status CvtColor(const std::shared_ptr<AVFrame> &src_frame,
+                          uint8_t *out_frame_data, AVPixelFormat out_pix_fmt,
+                          int32_t out_width, int32_t out_height,
+                          int32_t sws_flags);
+
  private:
   bool SupportCvtPixFmt(AVPixelFormat pix_fmt);
 
+  modelbox::Status FastCvtColor(const std::shared_ptr<AVFrame> &src_frame,
+                              uint8_t *data[4], int32_t linesize[4],
+                              AVPixelFormat out_pix_fmt);
+
   modelbox::Status InitSwsCtx(int32_t width, int32_t height,
-                            AVPixelFormat src_pix_fmt, AVPixelFormat dest_pix_fmt);
+                            AVPixelFormat src_pix_fmt, int32_t dest_width,
+                            int32_t dest_height, AVPixelFormat dest_pix_fmt,
+                            int32_t sws_flags);
 
   modelbox::Status GetLineSize(AVPixelFormat pix_fmt, int32_t width,
                              int32_t linesize[4], int32_t linesize_size);
@@ -48,6 +69,11 @@ class FfmpegColorConverter {
   std::shared_ptr<SwsContext> sws_ctx_;
   int32_t width_{0};
   int32_t height_{0};
+  AVPixelFormat src_pix_fmt_{AV_PIX_FMT_NONE};
+  int32_t out_width_{0};
+  int32_t out_height_{0};
+  AVPixelFormat out_pix_fmt_{AV_PIX_FMT_NONE};
+  int32_t sws_flags_{0};
 };
 
 #endif  // MODELBOX_FLOWUNIT_FFMPEG_COLOR_CONVERTER_H_
\ No newline at end of file
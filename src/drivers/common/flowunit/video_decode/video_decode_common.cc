@@ -24,6 +24,8 @@
 
 namespace videodecode {
 
+constexpr const char *DECODE_STATS_CTX = "decode_stats_ctx";
+
 size_t NV12BufferSize(int32_t width, int32_t height) {
   return width * height * 3 / 2;
 }
@@ -55,13 +57,45 @@ modelbox::Status GetBufferSize(int32_t width, int32_t height,
   return modelbox::STATUS_SUCCESS;
 }
 
+/**
+ * @brief statistics of one stream, resolved once and cached in data context
+ */
+struct DecodeStats {
+  std::shared_ptr<modelbox::StatisticsItem> item;
+  std::shared_ptr<modelbox::StatisticsItem> frame_count;
+  int32_t width{0};
+  int32_t height{0};
+};
+
 void UpdateStatsInfo(std::shared_ptr<modelbox::DataContext> &ctx, int32_t width,
                      int32_t height) {
-  auto stats = ctx->GetStatistics();
-  stats->AddItem("frame_width", width, true);
-  stats->AddItem("frame_height", height, true);
-  uint64_t one_frame = 1;
-  stats->IncreaseValue("frame_count", one_frame);
+  auto decode_stats =
+      std::static_pointer_cast<DecodeStats>(ctx->GetPrivate(DECODE_STATS_CTX));
+  if (decode_stats == nullptr) {
+    auto stats = ctx->GetStatistics();
+    if (stats == nullptr) {
+      return;
+    }
+
+    decode_stats = std::make_shared<DecodeStats>();
+    decode_stats->item = stats;
+    decode_stats->frame_count = stats->AddCounter("frame_count");
+
+    ctx->SetPrivate(DECODE_STATS_CTX, decode_stats);
+  }
+
+  if (width != decode_stats->width || height != decode_stats->height) {
+    decode_stats->item->AddItem("frame_width", width, true);
+    decode_stats->item->AddItem("frame_height", height, true);
+    decode_stats->width = width;
+    decode_stats->height = height;
+  }
+
+  if (decode_stats->frame_count != nullptr) {
+    // go through item to keep CHANGE notify of frame_count
+    uint64_t one_frame = 1;
+    decode_stats->frame_count->IncreaseValue(one_frame);
+  }
 }
 
 }  // namespace videodecode
\ No newline at end of file
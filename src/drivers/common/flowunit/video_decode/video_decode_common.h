@@ -44,6 +44,10 @@ extern const std::map<std::string, AVPixelFormat> g_av_pix_fmt_map;
 modelbox::Status GetBufferSize(int32_t width, int32_t height,
                              const std::string &pix_fmt, size_t &size);
 
+/**
+ * @brief Update statistics for one decoded frame, statistics items are
+ * resolved on first frame of stream and cached in data context
+ */
 void UpdateStatsInfo(std::shared_ptr<modelbox::DataContext> &ctx, int32_t width,
                      int32_t height);
 }  // namespace videodecode
@@ -127,8 +127,14 @@ std::shared_ptr<modelbox::SourceContext> DataSourceParserFlowUnit::Parse(
   DestroyUriFunc destroy_uri_func;
   std::string stream_type;
 
-  auto ret = plugin->Parse(session_context, data_source_cfg, uri_str,
-                           destroy_uri_func);
+  modelbox::Status ret;
+  {
+    // parser may request remote service, such as obs and restful source
+    modelbox::BlockingSection blocking;
+    ret = plugin->Parse(session_context, data_source_cfg, uri_str,
+                        destroy_uri_func);
+  }
+
   if (!ret) {
     MBLOG_ERROR << "Parse config failed, source uri is empty";
   }
@@ -16,8 +16,6 @@
 
 #include "httpserver_async.h"
 
-#include <securec.h>
-
 #include "modelbox/base/crypto.h"
 #include "modelbox/flowunit_api_helper.h"
 
@@ -32,8 +30,9 @@ modelbox::Status HTTPServerAsync::HandleFunc(web::http::http_request request) {
     request_info.headers_map[head.first] = head.second;
   }
 
-  request.extract_string().then(
-      [request, request_info, this](pplx::task<utility::string_t> t) mutable {
+  ReadRequestBody(request).then(
+      [request, request_info,
+       this](pplx::task<std::shared_ptr<std::string>> t) mutable {
         try {
           request_info.request_body = t.get();
           auto handle_status = HandleTask(request, request_info);
@@ -59,46 +58,74 @@ modelbox::Status HTTPServerAsync::HandleTask(web::http::http_request request,
     return modelbox::STATUS_BUSY;
   }
 
-  auto size = request_info.request_body.size();
-  std::vector<std::size_t> shape = {size};
+  PendingRequest pending{request, request_info, http_limiter};
+  if (batcher_ != nullptr) {
+    batcher_->Push(std::move(pending));
+    return modelbox::STATUS_OK;
+  }
+
+  std::vector<PendingRequest> requests;
+  requests.push_back(std::move(pending));
+  return SendToGraph(requests);
+}
+
+void HTTPServerAsync::SendRequests(std::vector<PendingRequest> &requests) {
+  auto status = SendToGraph(requests);
+  if (status) {
+    return;
+  }
+
+  for (auto &request : requests) {
+    SafeReply(request.request, web::http::status_codes::InternalError);
+  }
+}
+
+modelbox::Status HTTPServerAsync::SendToGraph(
+    std::vector<PendingRequest> &requests) {
   auto ext_data = this->CreateExternalData();
   if (!ext_data) {
     MBLOG_ERROR << "can not get external data.";
     return modelbox::STATUS_FAULT;
   }
+
+  // limiters are released when the session ends
+  auto limiters =
+      std::make_shared<std::vector<std::shared_ptr<HttpRequestLimiter>>>();
+  for (auto &request : requests) {
+    limiters->push_back(request.limiter);
+  }
   auto session_cxt = ext_data->GetSessionContext();
   session_cxt->SetPrivate("http_limiter_" + session_cxt->GetSessionId(),
-                          http_limiter);
+                          limiters);
+
+  // one buffer for each request in the same session, body is not copied
   auto output_buf = ext_data->CreateBufferList();
-  output_buf->Build(shape);
-  if (size > 0) {
-    auto outmem = output_buf->MutableBufferData(0);
-    if (outmem == nullptr) {
-      MBLOG_ERROR << "outmem buffer is nullptr.";
+  for (auto &request : requests) {
+    const auto &request_info = request.request_info;
+    auto ret = AdoptRequestBody(output_buf, request_info.request_body);
+    if (!ret) {
+      MBLOG_ERROR << "adopt request body failed, " << ret;
       return modelbox::STATUS_NOMEM;
     }
 
-    auto ret = memcpy_s(outmem, size, request_info.request_body.data(), size);
-    if (EOK != ret) {
-      MBLOG_ERROR << "Cpu memcpy failed, ret " << ret << ", src size " << size
-                  << ", dest size " << size;
-      return modelbox::STATUS_FAULT;
-    }
+    auto buffer = output_buf->Back();
+    buffer->Set("size", request_info.request_body->size());
+    buffer->Set("method", (std::string)request_info.method);
+    buffer->Set("uri", (std::string)request_info.uri);
+    buffer->Set("headers", request_info.headers_map);
+    buffer->Set("endpoint", request_url_);
+    buffer->SetGetBufferType(modelbox::BufferEnumType::STR);
   }
 
-  output_buf->At(0)->Set("size", size);
-  output_buf->At(0)->Set("method", (std::string)request_info.method);
-  output_buf->At(0)->Set("uri", (std::string)request_info.uri);
-  output_buf->At(0)->Set("headers", request_info.headers_map);
-  output_buf->At(0)->Set("endpoint", request_url_);
-  output_buf->At(0)->SetGetBufferType(modelbox::BufferEnumType::STR);
   auto status = ext_data->Send(output_buf);
   if (!status) {
     MBLOG_ERROR << "external data send buffer list failed:" << status;
     return modelbox::STATUS_FAULT;
   }
 
-  SafeReply(request, web::http::status_codes::Accepted);
+  for (auto &request : requests) {
+    SafeReply(request.request, web::http::status_codes::Accepted);
+  }
 
   status = ext_data->Close();
   if (!status) {
@@ -117,6 +144,18 @@ modelbox::Status HTTPServerAsync::Open(
   }
   HttpRequestLimiter::max_request_ = opts->GetUint64("max_requests", 1000);
   std::atomic_init(&HttpRequestLimiter::request_count_, (size_t)0);
+  auto batch_window_ms = opts->GetUint64("batch_window_ms", 0);
+  if (batch_window_ms > 0) {
+    auto max_batch_size = opts->GetUint64("max_batch_size", 16);
+    batcher_ = std::make_shared<HttpRequestBatcher<PendingRequest>>(
+        max_batch_size, batch_window_ms,
+        [this](std::vector<PendingRequest> &requests) {
+          SendRequests(requests);
+        });
+    batcher_->Start();
+    MBLOG_INFO << "batch requests, window " << batch_window_ms
+               << "ms, max batch size " << max_batch_size;
+  }
 
   std::string key;
   std::string enpass;
@@ -204,6 +243,11 @@ modelbox::Status HTTPServerAsync::Open(
 
 modelbox::Status HTTPServerAsync::Close() {
   listener_->close().wait();
+  if (batcher_ != nullptr) {
+    batcher_->Stop();
+    batcher_ = nullptr;
+  }
+
   return modelbox::STATUS_OK;
 }
 
@@ -229,6 +273,13 @@ MODELBOX_FLOWUNIT(HTTPServerAsync, desc) {
                                                   "http server listen URL."));
   desc.AddFlowUnitOption(modelbox::FlowUnitOption(
       "max_requests", "integer", true, "1000", "max http request."));
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "batch_window_ms", "integer", false, "0",
+      "wait time to coalesce concurrent requests into one session, 0 is "
+      "disabled."));
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "max_batch_size", "integer", false, "16",
+      "max requests coalesced into one session."));
   desc.AddFlowUnitOption(
       modelbox::FlowUnitOption("cert", "string", false, "", "cert file path"));
   desc.AddFlowUnitOption(
@@ -40,7 +40,13 @@ struct RequestInfo {
   web::http::method method;
   utility::string_t uri;
   std::map<std::string, std::string> headers_map;
-  utility::string_t request_body;
+  std::shared_ptr<std::string> request_body;
+};
+
+struct PendingRequest {
+  web::http::http_request request;
+  RequestInfo request_info;
+  std::shared_ptr<HttpRequestLimiter> limiter;
 };
 
 class HTTPServerAsync : public modelbox::FlowUnit {
@@ -60,9 +66,14 @@ class HTTPServerAsync : public modelbox::FlowUnit {
   modelbox::Status HandleTask(web::http::http_request request,
                               const RequestInfo &request_info);
 
+  void SendRequests(std::vector<PendingRequest> &requests);
+
+  modelbox::Status SendToGraph(std::vector<PendingRequest> &requests);
+
  private:
   std::shared_ptr<web::http::experimental::listener::http_listener> listener_;
   std::string request_url_;
+  std::shared_ptr<HttpRequestBatcher<PendingRequest>> batcher_;
 };
 
 #endif  // MODELBOX_FLOWUNIT_HTTPSERVER_ASYNC_CPU_H_
\ No newline at end of file
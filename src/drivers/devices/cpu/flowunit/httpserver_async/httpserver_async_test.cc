@@ -16,6 +16,11 @@
 
 #include <securec.h>
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <set>
+
 #include "common/mock_cert.h"
 #include "driver_flow_test.h"
 #include "flowunit_mockflowunit/flowunit_mockflowunit.h"
@@ -41,6 +46,10 @@ class HttpServerAsyncFlowUnitTest : public testing::Test {
   virtual void TearDown() { driver_flow_ = nullptr; };
   std::shared_ptr<MockFlow> GetDriverFlow();
 
+  // request bodies received by batch unit, grouped by session
+  std::mutex batch_mutex_;
+  std::map<std::string, std::vector<std::string>> batch_bodies_;
+
  private:
   Status AddMockFlowUnit();
   std::shared_ptr<MockFlow> driver_flow_;
@@ -108,6 +117,28 @@ Status HttpServerAsyncFlowUnitTest::AddMockFlowUnit() {
         mock_desc, mock_funcitons->GenerateCreateFunc(), TEST_DRIVER_DIR);
   }
 
+  {
+    auto mock_desc =
+        GenerateFlowunitDesc("httpserver_async_batch_unit", {"In_1"}, {});
+    auto process_func =
+        [this](std::shared_ptr<DataContext> op_ctx,
+               std::shared_ptr<MockFlowUnit> mock_flowunit) -> Status {
+      auto input_buf = op_ctx->Input("In_1");
+      auto session_id = op_ctx->GetSessionContext()->GetSessionId();
+      std::lock_guard<std::mutex> lock(batch_mutex_);
+      for (size_t i = 0; i < input_buf->Size(); ++i) {
+        auto input_data = (const char*)input_buf->ConstBufferData(i);
+        batch_bodies_[session_id].emplace_back(input_data,
+                                               input_buf->At(i)->GetBytes());
+      }
+      return modelbox::STATUS_OK;
+    };
+    auto mock_funcitons = std::make_shared<MockFunctionCollection>();
+    mock_funcitons->RegisterProcessFunc(process_func);
+    driver_flow_->AddFlowUnitDesc(
+        mock_desc, mock_funcitons->GenerateCreateFunc(), TEST_DRIVER_DIR);
+  }
+
   return STATUS_OK;
 }
 
@@ -277,4 +308,106 @@ TEST_F(HttpServerAsyncFlowUnitTest, InitUnit) {
   }
 }
 
+void BatchPostRequestAsync(web::http::uri uri,
+                           web::http::client::http_client_config client_config,
+                           int index) {
+  web::http::client::http_client client(web::http::uri_builder(uri).to_uri(),
+                                        client_config);
+  web::http::http_request msg_post;
+  msg_post.set_method(web::http::methods::POST);
+  msg_post.set_request_uri(_XPLATSTR("/restdemo_post"));
+  msg_post.set_body("request_" + std::to_string(index));
+  try {
+    web::http::http_response resp_post = client.request(msg_post).get();
+    EXPECT_EQ(resp_post.status_code(), web::http::status_codes::Accepted);
+  } catch (std::exception const& e) {
+    MBLOG_ERROR << e.what();
+    ASSERT_TRUE(false);
+  }
+}
+
+TEST_F(HttpServerAsyncFlowUnitTest, BatchRequests) {
+  const std::string test_lib_dir = TEST_DRIVER_DIR;
+  std::string cert_file_path = std::string(TEST_DATA_DIR) + "/certificate.pem";
+  std::string key_file_path = std::string(TEST_DATA_DIR) + "/private_key.pem";
+  std::string encrypt_passwd;
+  std::string passwd_key;
+
+  ASSERT_EQ(
+      GenerateCert(&encrypt_passwd, &passwd_key, key_file_path, cert_file_path),
+      STATUS_OK);
+
+  Defer {
+    remove(key_file_path.c_str());
+    remove(cert_file_path.c_str());
+  };
+
+  std::string toml_content = R"(
+    [driver]
+    skip-default=true
+    dir=[")" + test_lib_dir + "\"]\n    " +
+                             R"([graph]
+    graphconf = '''digraph demo {
+          httpserver_async[type=flowunit, flowunit=httpserver_async, device=cpu, deviceid=0, label="<Out_1>", endpoint=")" +
+                             std::string(REQUEST_URL) + R"(", cert=")" +
+                             cert_file_path + R"(", key=")" + key_file_path +
+                             R"(", passwd=")" + encrypt_passwd +
+                             R"(", key_pass=")" + passwd_key +
+                             R"(", max_requests=100, batch_window_ms=20, max_batch_size=8]
+          httpserver_async_batch_unit[type=flowunit, flowunit=httpserver_async_batch_unit, device=cpu, deviceid=0, label="<In_1>"]
+          httpserver_async:out_request_info -> httpserver_async_batch_unit:In_1
+        }'''
+    format = "graphviz"
+  )";
+
+  auto driver_flow = GetDriverFlow();
+  driver_flow->BuildAndRun("BatchRequests", toml_content, -1);
+
+  web::http::uri uri = web::http::uri(_XPLATSTR(REQUEST_URL));
+  web::http::client::http_client_config client_config;
+  client_config.set_timeout(utility::seconds(60));
+  client_config.set_ssl_context_callback([&](boost::asio::ssl::context& ctx) {
+    ctx.load_verify_file(cert_file_path);
+  });
+
+  // concurrent requests are coalesced into shared sessions
+  const size_t request_num = 16;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < request_num; ++i) {
+    threads.push_back(
+        std::thread(BatchPostRequestAsync, uri, client_config, (int)i));
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  // reply is sent before graph runs, wait for all bodies to arrive
+  std::set<std::string> bodies;
+  size_t max_session_requests = 0;
+  for (int retry = 0; retry < 500; ++retry) {
+    {
+      std::lock_guard<std::mutex> lock(batch_mutex_);
+      bodies.clear();
+      max_session_requests = 0;
+      for (auto& session : batch_bodies_) {
+        bodies.insert(session.second.begin(), session.second.end());
+        max_session_requests =
+            std::max(max_session_requests, session.second.size());
+      }
+    }
+
+    if (bodies.size() == request_num) {
+      break;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  ASSERT_EQ(bodies.size(), request_num);
+  for (size_t i = 0; i < request_num; ++i) {
+    EXPECT_EQ(bodies.count("request_" + std::to_string(i)), 1);
+  }
+  EXPECT_GT(max_session_requests, 1);
+}
+
 }  // namespace modelbox
\ No newline at end of file
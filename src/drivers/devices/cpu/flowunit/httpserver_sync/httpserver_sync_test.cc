@@ -19,6 +19,7 @@
 #include <securec.h>
 
 #include "modelbox/base/crypto.h"
+#include "modelbox/statistics.h"
 #include "common/mock_cert.h"
 #include "driver_flow_test.h"
 #define _TURN_OFF_PLATFORM_STRING
@@ -121,6 +122,37 @@ Status HttpServerSyncFlowUnitTest::AddMockFlowUnit() {
         mock_desc, mock_funcitons->GenerateCreateFunc(), TEST_DRIVER_DIR);
   }
 
+  {
+    auto mock_desc =
+        GenerateFlowunitDesc("batch_echo_unit", {"In_1"}, {"Out_1"});
+    auto process_func =
+        [=](std::shared_ptr<DataContext> op_ctx,
+            std::shared_ptr<MockFlowUnit> mock_flowunit) -> Status {
+      auto input_buf = op_ctx->Input("In_1");
+      auto output_buf = op_ctx->Output("Out_1");
+      std::vector<std::string> response_bodys;
+      std::vector<std::size_t> shape;
+      for (size_t i = 0; i < input_buf->Size(); ++i) {
+        auto input_data =
+            static_cast<const char *>(input_buf->ConstBufferData(i));
+        std::string request_body(input_data, input_buf->At(i)->GetBytes());
+        response_bodys.push_back("response_body: " + request_body);
+        shape.push_back(response_bodys.back().size());
+      }
+
+      output_buf->Build(shape);
+      for (size_t i = 0; i < response_bodys.size(); ++i) {
+        memcpy_s(output_buf->MutableBufferData(i), shape[i],
+                 response_bodys[i].data(), shape[i]);
+      }
+      return modelbox::STATUS_OK;
+    };
+    auto mock_funcitons = std::make_shared<MockFunctionCollection>();
+    mock_funcitons->RegisterProcessFunc(process_func);
+    driver_flow_->AddFlowUnitDesc(
+        mock_desc, mock_funcitons->GenerateCreateFunc(), TEST_DRIVER_DIR);
+  }
+
   return STATUS_OK;
 }
 
@@ -302,4 +334,92 @@ TEST_F(HttpServerSyncFlowUnitTest, InitUnit) {
   }
 }
 
+void BatchPostRequestSync(web::http::uri uri,
+                          web::http::client::http_client_config client_config,
+                          int index) {
+  web::http::client::http_client client(web::http::uri_builder(uri).to_uri(),
+                                        client_config);
+  web::http::http_request msg_post;
+  msg_post.set_method(web::http::methods::POST);
+  msg_post.set_request_uri(_XPLATSTR("/restdemo_post"));
+  auto request_body = "request_" + std::to_string(index);
+  msg_post.set_body(request_body);
+  try {
+    web::http::http_response resp_post = client.request(msg_post).get();
+    EXPECT_EQ(resp_post.status_code(), web::http::status_codes::OK);
+    EXPECT_EQ("response_body: " + request_body,
+              resp_post.extract_string().get());
+  } catch (std::exception const& e) {
+    MBLOG_ERROR << e.what();
+    ASSERT_TRUE(false);
+  }
+}
+
+TEST_F(HttpServerSyncFlowUnitTest, BatchRequests) {
+  const std::string test_lib_dir = TEST_DRIVER_DIR;
+  std::string cert_file_path = std::string(TEST_DATA_DIR) + "/certificate.pem";
+  std::string key_file_path = std::string(TEST_DATA_DIR) + "/private_key.pem";
+  std::string encrypt_passwd;
+  std::string passwd_key;
+
+  ASSERT_EQ(
+      GenerateCert(&encrypt_passwd, &passwd_key, key_file_path, cert_file_path),
+      STATUS_OK);
+
+  Defer {
+    remove(key_file_path.c_str());
+    remove(cert_file_path.c_str());
+  };
+
+  std::string toml_content = R"(
+    [driver]
+    skip-default=true
+    dir=[")" + test_lib_dir + "\"]\n    " +
+                             R"([graph]
+    graphconf = '''digraph demo {
+          httpserver_sync_receive[type=flowunit, flowunit=httpserver_sync_receive, device=cpu, deviceid=0, label="<out_request_info>", endpoint=")" +
+                             std::string(REQUEST_URL) + R"(", cert=")" +
+                             cert_file_path + R"(", key=")" + key_file_path +
+                             R"(", passwd=")" + encrypt_passwd +
+                             R"(", key_pass=")" + passwd_key +
+                             R"(", max_requests=100, time_out_ms=5000, batch_window_ms=20, max_batch_size=8]
+          batch_echo_unit[type=flowunit, flowunit=batch_echo_unit, device=cpu, deviceid=0, label="<In_1> | <Out_1>", batch_size=4]
+          httpserver_sync_reply[type=flowunit, flowunit=httpserver_sync_reply, device=cpu, deviceid=0, label="<In_1>"]
+          httpserver_sync_receive:out_request_info -> batch_echo_unit:In_1
+          batch_echo_unit:Out_1 -> httpserver_sync_reply:in_reply_info
+        }'''
+    format = "graphviz"
+  )";
+
+  auto driver_flow = GetDriverFlow();
+  driver_flow->BuildAndRun("BatchRequests", toml_content, -1);
+
+  web::http::uri uri = web::http::uri(_XPLATSTR(REQUEST_URL));
+  web::http::client::http_client_config client_config;
+  client_config.set_timeout(utility::seconds(60));
+  client_config.set_ssl_context_callback([&](boost::asio::ssl::context& ctx) {
+    ctx.load_verify_file(cert_file_path);
+  });
+
+  // concurrent requests share sessions, each gets its own response
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 16; ++i) {
+    threads.push_back(std::thread(BatchPostRequestSync, uri, client_config, i));
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  auto stats_path = std::string(STATISTICS_ITEM_FLOW) + "." +
+                    driver_flow->GetFlow()->GetGraphId() +
+                    ".httpserver_sync_receive.";
+  auto global_stats = Statistics::GetGlobalItem();
+  auto batch_requests = global_stats->GetItem(stats_path + "batch_requests");
+  auto max_batch_size = global_stats->GetItem(stats_path + "max_batch_size");
+  ASSERT_NE(batch_requests, nullptr);
+  ASSERT_NE(max_batch_size, nullptr);
+  EXPECT_EQ(batch_requests->GetGauge()->Get(), 16);
+  EXPECT_GT(max_batch_size->GetGauge()->Get(), 1);
+}
+
 }  // namespace modelbox
\ No newline at end of file
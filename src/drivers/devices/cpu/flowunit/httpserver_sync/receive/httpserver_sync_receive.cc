@@ -16,8 +16,6 @@
 
 #include "httpserver_sync_receive.h"
 
-#include <securec.h>
-
 #include "modelbox/base/crypto.h"
 #include "modelbox/device/cpu/device_cpu.h"
 #include "modelbox/flowunit_api_helper.h"
@@ -43,8 +41,9 @@ modelbox::Status HTTPServerReceiveSync::HandleFunc(
   for (auto &head : request.headers()) {
     request_info.headers_map[head.first] = head.second;
   }
-  request.extract_string().then(
-      [this, request_info, request](pplx::task<utility::string_t> t) mutable {
+  ReadRequestBody(request).then(
+      [this, request_info,
+       request](pplx::task<std::shared_ptr<std::string>> t) mutable {
         try {
           request_info.request_body = t.get();
           HandleTask(request, request_info);
@@ -60,54 +59,20 @@ modelbox::Status HTTPServerReceiveSync::HandleFunc(
 
 modelbox::Status HTTPServerReceiveSync::HandleTask(
     web::http::http_request request, const RequestInfo &request_info) {
-  auto return_ret = modelbox::STATUS_OK;
-  Defer {
-    if (return_ret != modelbox::STATUS_OK) {
-      SafeReply(request, web::http::status_codes::InternalError);
-      --*sum_cnt_;
-    }
-  };
-  auto ext_data = this->CreateExternalData();
-  if (!ext_data) {
-    MBLOG_ERROR << "can not get external data.";
-    return_ret = modelbox::STATUS_FAULT;
-    return return_ret;
+  PendingRequest pending{request_info, CreateReplyHandle(request)};
+  if (batcher_ != nullptr) {
+    batcher_->Push(std::move(pending));
+    return modelbox::STATUS_OK;
   }
 
-  auto output_buf = ext_data->CreateBufferList();
-  if (output_buf == nullptr) {
-    MBLOG_ERROR << "Create buffer list failed.";
-    return_ret = modelbox::STATUS_NOMEM;
-    return return_ret;
-  }
-
-  auto size = request_info.request_body.size();
-  std::vector<std::size_t> shape = {size};
-  output_buf->Build(shape);
-  if (size > 0) {
-    auto outmem = output_buf->MutableBufferData(0);
-    if (outmem == nullptr) {
-      MBLOG_ERROR << "outmem buffer is nullptr.";
-      return_ret = modelbox::STATUS_NOMEM;
-      return return_ret;
-    }
-
-    auto ret = memcpy_s(outmem, size, request_info.request_body.data(), size);
-    if (EOK != ret) {
-      MBLOG_ERROR << "Cpu memcpy failed, ret " << ret << ", src size " << size
-                  << ", dest size " << size;
-      return_ret = modelbox::STATUS_FAULT;
-      return return_ret;
-    }
-  }
-
-  output_buf->At(0)->Set("size", size);
-  output_buf->At(0)->Set("method", (std::string)request_info.method);
-  output_buf->At(0)->Set("uri", (std::string)request_info.uri);
-  output_buf->At(0)->Set("headers", request_info.headers_map);
-  output_buf->At(0)->Set("endpoint", request_url_);
-  output_buf->At(0)->SetGetBufferType(modelbox::BufferEnumType::STR);
+  std::vector<PendingRequest> requests;
+  requests.push_back(std::move(pending));
+  SendRequests(requests);
+  return modelbox::STATUS_OK;
+}
 
+std::shared_ptr<ReplyHandle> HTTPServerReceiveSync::CreateReplyHandle(
+    web::http::http_request request) {
   auto replied = std::make_shared<std::atomic_bool>(false);
   auto timeout_task = std::make_shared<modelbox::TimerTask>(
       [](web::http::http_request request,
@@ -122,35 +87,94 @@ modelbox::Status HTTPServerReceiveSync::HandleTask(
       request, replied, this->sum_cnt_);
 
   auto reply = std::make_shared<ReplyHandle>(
-      [request, replied, timeout_task, this](
-          uint16_t status, const concurrency::streams::istream &body_data,
-          const utility::string_t &content_type) mutable {
+      [request, replied, timeout_task,
+       this](const ReplyHandle::SendFunc &send_func) mutable {
         auto replied_before = replied->exchange(true);
         if (replied_before) {
           return;
         }
 
-        SafeReply(request, status, body_data, content_type);
+        send_func(request);
         timeout_task->Stop();
         --*(this->sum_cnt_);
       });
+
+  // time in batch window counts in request timeout
+  timer_.Schedule(timeout_task, time_out_ms_, 0, false);
+  return reply;
+}
+
+void HTTPServerReceiveSync::SendRequests(
+    std::vector<PendingRequest> &requests) {
+  auto status = SendToGraph(requests);
+  if (status) {
+    return;
+  }
+
+  for (auto &request : requests) {
+    request.reply->Reply(
+        web::http::status_codes::InternalError,
+        concurrency::streams::bytestream::open_istream<std::string>(""),
+        "text/plain;charset=utf-8");
+  }
+}
+
+modelbox::Status HTTPServerReceiveSync::SendToGraph(
+    std::vector<PendingRequest> &requests) {
+  auto ext_data = this->CreateExternalData();
+  if (!ext_data) {
+    MBLOG_ERROR << "can not get external data.";
+    return modelbox::STATUS_FAULT;
+  }
+
+  auto output_buf = ext_data->CreateBufferList();
+  if (output_buf == nullptr) {
+    MBLOG_ERROR << "Create buffer list failed.";
+    return modelbox::STATUS_NOMEM;
+  }
+
+  // one buffer for each request in the same session, body is not copied
+  for (auto &request : requests) {
+    const auto &request_info = request.request_info;
+    auto ret = AdoptRequestBody(output_buf, request_info.request_body);
+    if (!ret) {
+      MBLOG_ERROR << "adopt request body failed, " << ret;
+      return modelbox::STATUS_NOMEM;
+    }
+
+    auto buffer = output_buf->Back();
+    buffer->Set("size", request_info.request_body->size());
+    buffer->Set("method", (std::string)request_info.method);
+    buffer->Set("uri", (std::string)request_info.uri);
+    buffer->Set("headers", request_info.headers_map);
+    buffer->Set("endpoint", request_url_);
+    buffer->SetGetBufferType(modelbox::BufferEnumType::STR);
+  }
+
   auto session_ctx = ext_data->GetSessionContext();
-  session_ctx->SetPrivate("reply", reply);
+  if (requests.size() == 1) {
+    session_ctx->SetPrivate("reply", requests[0].reply);
+  } else {
+    std::vector<std::shared_ptr<ReplyHandle>> replies;
+    for (auto &request : requests) {
+      replies.push_back(request.reply);
+    }
+    session_ctx->SetPrivate(REPLY_BATCH_PRIVATE,
+                            std::make_shared<ReplyBatch>(std::move(replies)));
+  }
 
   auto status = ext_data->Send(output_buf);
   if (!status) {
     MBLOG_ERROR << "external data send buffer list failed:" << status;
-    return_ret = modelbox::STATUS_FAULT;
-    return return_ret;
+    return modelbox::STATUS_FAULT;
   }
 
-  timer_.Schedule(timeout_task, time_out_ms_, 0, false);
   status = ext_data->Close();
   if (!status) {
     MBLOG_ERROR << "external data close failed:" << status;
   }
 
-  return return_ret;
+  return modelbox::STATUS_OK;
 }
 
 modelbox::Status HTTPServerReceiveSync::Open(
@@ -163,6 +187,19 @@ modelbox::Status HTTPServerReceiveSync::Open(
   }
   max_requests_ = opts->GetUint64("max_requests", 1000);
   time_out_ms_ = opts->GetUint64("time_out_ms", 5000);
+  auto batch_window_ms = opts->GetUint64("batch_window_ms", 0);
+  if (batch_window_ms > 0) {
+    auto max_batch_size = opts->GetUint64("max_batch_size", 16);
+    batcher_ = std::make_shared<HttpRequestBatcher<PendingRequest>>(
+        max_batch_size, batch_window_ms,
+        [this](std::vector<PendingRequest> &requests) {
+          SendRequests(requests);
+        });
+    batcher_->Start();
+    MBLOG_INFO << "batch requests, window " << batch_window_ms
+               << "ms, max batch size " << max_batch_size;
+  }
+
   std::string key;
   std::string enpass;
   std::string keypass;
@@ -247,8 +284,13 @@ modelbox::Status HTTPServerReceiveSync::Open(
 }
 
 modelbox::Status HTTPServerReceiveSync::Close() {
-  timer_.Stop();
   listener_->close().wait();
+  if (batcher_ != nullptr) {
+    batcher_->Stop();
+    batcher_ = nullptr;
+  }
+
+  timer_.Stop();
   return modelbox::STATUS_OK;
 }
 
@@ -260,9 +302,49 @@ modelbox::Status HTTPServerReceiveSync::Process(
   for (auto &buf : *input_buf) {
     output_buf->PushBack(buf);
   }
+
+  if (batcher_ != nullptr) {
+    UpdateBatchStatistics(ctx);
+  }
+
   return modelbox::STATUS_OK;
 }
 
+void HTTPServerReceiveSync::UpdateBatchStatistics(
+    const std::shared_ptr<modelbox::DataContext> &ctx) {
+  // sessions run concurrently, keep read and set in order so the gauges
+  // never go back to an older value
+  std::lock_guard<std::mutex> lock(batch_stats_mutex_);
+  if (max_batch_size_stats_ == nullptr) {
+    auto graph_stats =
+        ctx->GetStatistics(modelbox::DataContextStatsType::GRAPH);
+    if (graph_stats == nullptr) {
+      return;
+    }
+
+    auto stats = graph_stats->AddItem(FLOWUNIT_NAME_RECEIVE);
+    if (stats == nullptr) {
+      return;
+    }
+
+    auto batch_count = stats->AddGauge("batch_count");
+    auto batch_requests = stats->AddGauge("batch_requests");
+    auto max_batch_size = stats->AddGauge("max_batch_size");
+    if (batch_count == nullptr || batch_requests == nullptr ||
+        max_batch_size == nullptr) {
+      return;
+    }
+
+    batch_count_stats_ = batch_count->GetGauge();
+    batch_requests_stats_ = batch_requests->GetGauge();
+    max_batch_size_stats_ = max_batch_size->GetGauge();
+  }
+
+  batch_count_stats_->Set(batcher_->GetBatchCount());
+  batch_requests_stats_->Set(batcher_->GetRequestCount());
+  max_batch_size_stats_->Set(batcher_->GetMaxBatchSize());
+}
+
 MODELBOX_FLOWUNIT(HTTPServerReceiveSync, desc) {
   desc.SetFlowUnitName(FLOWUNIT_NAME_RECEIVE);
   desc.AddFlowUnitOutput({"out_request_info"});
@@ -277,6 +359,13 @@ MODELBOX_FLOWUNIT(HTTPServerReceiveSync, desc) {
   desc.AddFlowUnitOption(
       modelbox::FlowUnitOption("time_out", "integer", false, "100",
                                "max http request timeout. measured in 100ms"));
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "batch_window_ms", "integer", false, "0",
+      "wait time to coalesce concurrent requests into one session, 0 is "
+      "disabled. graph must output one buffer for each request in order."));
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "max_batch_size", "integer", false, "16",
+      "max requests coalesced into one session."));
   desc.AddFlowUnitOption(
       modelbox::FlowUnitOption("cert", "string", false, "", "cert file path"));
   desc.AddFlowUnitOption(
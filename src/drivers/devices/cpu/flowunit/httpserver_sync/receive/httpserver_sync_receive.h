@@ -40,29 +40,79 @@ struct RequestInfo {
   web::http::method method;
   utility::string_t uri;
   std::map<std::string, std::string> headers_map;
-  utility::string_t request_body;
+  std::shared_ptr<std::string> request_body;
 };
 
 class ReplyHandle {
  public:
+  using SendFunc = std::function<void(const web::http::http_request &request)>;
+
+  /**
+   * @param reply_func called with the function sending reply, replies at most
+   * once for one request
+   */
   ReplyHandle(
-      const std::function<
-          void(uint16_t status, const concurrency::streams::istream &body_data,
-               const utility::string_t &content_type)> &reply_func) {
+      const std::function<void(const SendFunc &send_func)> &reply_func) {
     reply_func_ = reply_func;
   }
 
   virtual ~ReplyHandle() {}
   void Reply(uint16_t status, const concurrency::streams::istream &body_data,
              const utility::string_t &content_type) {
-    reply_func_(status, body_data, content_type);
+    reply_func_([&](const web::http::http_request &request) {
+      SafeReply(request, status, body_data, content_type);
+    });
+  }
+
+  /**
+   * @brief Reply with buffer data in place, buffer is kept until reply is sent
+   */
+  void Reply(uint16_t status, const std::shared_ptr<modelbox::Buffer> &buffer,
+             const utility::string_t &content_type) {
+    reply_func_([&](const web::http::http_request &request) {
+      SafeReply(request, status, buffer->ConstData(), buffer->GetBytes(),
+                buffer, content_type);
+    });
+  }
+
+ private:
+  std::function<void(const SendFunc &send_func)> reply_func_;
+};
+
+constexpr const char *REPLY_BATCH_PRIVATE = "reply_batch";
+
+/**
+ * @brief Reply handles of requests coalesced into one session, in order of
+ * buffers sent to graph
+ */
+class ReplyBatch {
+ public:
+  explicit ReplyBatch(std::vector<std::shared_ptr<ReplyHandle>> replies)
+      : replies_(std::move(replies)) {}
+
+  virtual ~ReplyBatch() {}
+
+  /**
+   * @brief Reply handle of next output
+   * @return nullptr when all requests are replied
+   */
+  std::shared_ptr<ReplyHandle> Next() {
+    auto index = next_++;
+    if (index >= replies_.size()) {
+      return nullptr;
+    }
+
+    return replies_[index];
   }
 
  private:
-  std::function<void(uint16_t status,
-                     const concurrency::streams::istream &body_data,
-                     const utility::string_t &content_type)>
-      reply_func_;
+  std::vector<std::shared_ptr<ReplyHandle>> replies_;
+  std::atomic<size_t> next_{0};
+};
+
+struct PendingRequest {
+  RequestInfo request_info;
+  std::shared_ptr<ReplyHandle> reply;
 };
 
 class HTTPServerReceiveSync : public modelbox::FlowUnit {
@@ -82,6 +132,14 @@ class HTTPServerReceiveSync : public modelbox::FlowUnit {
   modelbox::Status HandleTask(web::http::http_request request,
                               const RequestInfo &request_info);
 
+  std::shared_ptr<ReplyHandle> CreateReplyHandle(
+      web::http::http_request request);
+
+  void SendRequests(std::vector<PendingRequest> &requests);
+
+  modelbox::Status SendToGraph(std::vector<PendingRequest> &requests);
+  void UpdateBatchStatistics(const std::shared_ptr<modelbox::DataContext> &ctx);
+
  private:
   std::shared_ptr<std::atomic<uint64_t>> sum_cnt_ =
       std::make_shared<std::atomic<uint64_t>>(0);
@@ -91,6 +149,11 @@ class HTTPServerReceiveSync : public modelbox::FlowUnit {
   uint64_t time_out_ms_{5000};
   std::mutex request_mutex_;
   modelbox::Timer timer_;
+  std::shared_ptr<HttpRequestBatcher<PendingRequest>> batcher_;
+  std::mutex batch_stats_mutex_;
+  std::shared_ptr<modelbox::StatisticsGauge> batch_count_stats_;
+  std::shared_ptr<modelbox::StatisticsGauge> batch_requests_stats_;
+  std::shared_ptr<modelbox::StatisticsGauge> max_batch_size_stats_;
 };
 
 #endif  // MODELBOX_FLOWUNIT_HTTPSERVER_SYNC_RECEIVE_CPU_H_
\ No newline at end of file
@@ -63,6 +63,12 @@ modelbox::Status HTTPServerReplySync::Close() { return modelbox::STATUS_OK; }
 modelbox::Status HTTPServerReplySync::Process(
     std::shared_ptr<modelbox::DataContext> ctx) {
   auto session_ctx = ctx->GetSessionContext();
+  auto reply_batch = std::static_pointer_cast<ReplyBatch>(
+      session_ctx->GetPrivate(REPLY_BATCH_PRIVATE));
+  if (reply_batch != nullptr) {
+    return ReplyBatchRequests(ctx, reply_batch);
+  }
+
   auto reply =
       std::static_pointer_cast<ReplyHandle>(session_ctx->GetPrivate("reply"));
   if (reply == nullptr) {
@@ -82,16 +88,36 @@ modelbox::Status HTTPServerReplySync::Process(
     return {modelbox::STATUS_NOMEM, err_msg};
   }
 
-  auto bytes = input_data->GetBytes();
-  auto data = input_data->ConstData();
-  std::string ss((char*)data, bytes);
-  auto resp_body =
-      concurrency::streams::bytestream::open_istream<std::string>(ss);
-  reply->Reply(web::http::status_codes::OK, resp_body, content_type_);
+  ReplyBuffer(reply, input_data);
+  return modelbox::STATUS_OK;
+}
+
+modelbox::Status HTTPServerReplySync::ReplyBatchRequests(
+    std::shared_ptr<modelbox::DataContext> ctx,
+    std::shared_ptr<ReplyBatch> reply_batch) {
+  // session is processed in order, the nth output belongs to nth request
+  auto input_buf = ctx->Input("in_reply_info");
+  for (auto &input_data : *input_buf) {
+    auto reply = reply_batch->Next();
+    if (reply == nullptr) {
+      auto err_msg = "http reply output is more than batched requests.";
+      MBLOG_ERROR << err_msg;
+      return {modelbox::STATUS_FAULT, err_msg};
+    }
+
+    ReplyBuffer(reply, input_data);
+  }
 
   return modelbox::STATUS_OK;
 }
 
+void HTTPServerReplySync::ReplyBuffer(
+    std::shared_ptr<ReplyHandle> reply,
+    std::shared_ptr<modelbox::Buffer> input_data) {
+  // stream from output buffer, no copy to string
+  reply->Reply(web::http::status_codes::OK, input_data, content_type_);
+}
+
 MODELBOX_FLOWUNIT(HTTPServerReplySync, desc) {
   desc.SetFlowUnitName(FLOWUNIT_NAME_REPLY);
   desc.AddFlowUnitInput({"in_reply_info"});
@@ -19,6 +19,9 @@
 
 #include "modelbox/flowunit.h"
 
+class ReplyBatch;
+class ReplyHandle;
+
 constexpr const char *FLOWUNIT_NAME_REPLY = "httpserver_sync_reply";
 constexpr const char *FLOWUNIT_DESC_REPLY =
     "\n\t@Brief: Send reply when receive a response info."
@@ -44,6 +47,13 @@ class HTTPServerReplySync : public modelbox::FlowUnit {
   modelbox::Status Process(std::shared_ptr<modelbox::DataContext> data_ctx);
 
  private:
+  modelbox::Status ReplyBatchRequests(
+      std::shared_ptr<modelbox::DataContext> ctx,
+      std::shared_ptr<ReplyBatch> reply_batch);
+
+  void ReplyBuffer(std::shared_ptr<ReplyHandle> reply,
+                   std::shared_ptr<modelbox::Buffer> input_data);
+
   std::string content_type_;
 };
 
@@ -16,10 +16,16 @@
 
 #include "image_decoder.h"
 
+#include "color_space_convert.h"
+
 #include "modelbox/flowunit_api_helper.h"
 
 #include <securec.h>
 
+#ifdef ENABLE_TURBOJPEG
+#include "turbo_jpeg_decoder.h"
+#endif
+
 ImageDecoderFlowUnit::ImageDecoderFlowUnit(){};
 ImageDecoderFlowUnit::~ImageDecoderFlowUnit(){};
 
@@ -44,10 +50,26 @@ modelbox::Status ImageDecoderFlowUnit::Open(
   }
   MBLOG_DEBUG << "pixel_format " << pixel_format_;
 
+  decode_width_ = opts->GetInt32("decode_width", 0);
+  decode_height_ = opts->GetInt32("decode_height", 0);
+  auto decode_threads = opts->GetInt32("decode_threads", 0);
+  if (decode_threads <= 0) {
+    decode_threads = -1;
+  }
+
+  pool_ = std::make_shared<modelbox::ThreadPool>(decode_threads);
+  pool_->SetName("Image-Decoder");
   return modelbox::STATUS_OK;
 }
 
-modelbox::Status ImageDecoderFlowUnit::Close() { return modelbox::STATUS_OK; }
+modelbox::Status ImageDecoderFlowUnit::Close() {
+  if (pool_ != nullptr) {
+    pool_->Shutdown();
+    pool_ = nullptr;
+  }
+
+  return modelbox::STATUS_OK;
+}
 
 modelbox::Status ImageDecoderFlowUnit::DataPre(
     std::shared_ptr<modelbox::DataContext> ctx) {
@@ -67,51 +89,57 @@ modelbox::Status ImageDecoderFlowUnit::Process(
     return {modelbox::STATUS_FAULT, errMsg};
   }
 
-  // decode
-  std::vector<cv::Mat> output_img_list;
-  std::vector<size_t> output_shape;
-  for (auto &buffer : *input_bufs) {
-    auto input_data = static_cast<const u_char *>(buffer->ConstData());
-    std::vector<u_char> input_data2(
-        input_data, input_data + buffer->GetBytes() / sizeof(u_char));
-
-    cv::Mat img_bgr = cv::imdecode(input_data2, cv::IMREAD_COLOR);
-    if (img_bgr.data == NULL) {
-      MBLOG_ERROR << "input image buffer is invalid, imdecode failed.";
-      return modelbox::STATUS_FAULT;
-    }
-    cv::Mat img_dest;
-    if (pixel_format_ == "bgr") {
-      img_dest = img_bgr;
-    } else if (pixel_format_ == "rgb") {
-      cv::cvtColor(img_bgr, img_dest, cv::COLOR_BGR2RGB);
-    } else if (pixel_format_ == "nv12") {
-      img_dest = BGR2YUV_NV12(img_bgr);
+  // decode in parallel, the last one is decoded in current thread
+  std::vector<cv::Mat> img_list(input_bufs->Size());
+  std::vector<std::future<modelbox::Status>> decode_results;
+  for (size_t i = 0; i + 1 < input_bufs->Size(); ++i) {
+    decode_results.push_back(pool_->Submit(&ImageDecoderFlowUnit::DecodeImage,
+                                           this, input_bufs->At(i),
+                                           &img_list[i]));
+  }
+
+  auto last_index = input_bufs->Size() - 1;
+  auto decode_ret = DecodeImage(input_bufs->At(last_index),
+                                &img_list[last_index]);
+  for (auto &result : decode_results) {
+    if (!result.valid()) {
+      // pool is stopping, task is not submitted
+      decode_ret = {modelbox::STATUS_FAULT, "submit decode task failed"};
+      continue;
     }
 
-    if (!modelbox::StatusError) {
-      MBLOG_ERROR << "dest image data is invalid, imdecode failed.";
-      return modelbox::STATUS_FAULT;
+    auto ret = result.get();
+    if (!ret) {
+      decode_ret = ret;
     }
+  }
 
-    MBLOG_DEBUG << "decode image clos : " << img_bgr.cols
-                << ", rows : " << img_bgr.rows
-                << "channles : " << img_bgr.channels();
+  if (!decode_ret) {
+    MBLOG_ERROR << "decode image failed, " << decode_ret;
+    return decode_ret;
+  }
+
+  for (auto &img_dest : img_list) {
+    auto width = (int32_t)img_dest.cols;
+    auto height = (int32_t)img_dest.rows;
+    if (pixel_format_ == "nv12") {
+      height = height * 2 / 3;
+    }
 
     // build output_buffer
     output_bufs->EmplaceBack(img_dest.data,
                              img_dest.total() * img_dest.elemSize(),
                              [img_dest](void *) { /* hold img dest*/ });
     auto output_buffer = output_bufs->Back();
-    output_buffer->Set("width", (int32_t)img_bgr.cols);
-    output_buffer->Set("height", (int32_t)img_bgr.rows);
-    auto width_stride = (int32_t)img_bgr.cols;
+    output_buffer->Set("width", width);
+    output_buffer->Set("height", height);
+    auto width_stride = width;
     if (pixel_format_ == "rgb" || pixel_format_ == "bgr") {
       width_stride *= 3;
     }
     
     output_buffer->Set("width_stride", width_stride);
-    output_buffer->Set("height_stride", (int32_t)img_bgr.rows);
+    output_buffer->Set("height_stride", height);
     output_buffer->Set("channel", (int32_t)img_dest.channels());
     output_buffer->Set("pix_fmt", pixel_format_);
     output_buffer->Set("type", modelbox::ModelBoxDataType::MODELBOX_UINT8);
@@ -125,25 +153,86 @@ modelbox::Status ImageDecoderFlowUnit::Process(
   return modelbox::STATUS_OK;
 }
 
-cv::Mat ImageDecoderFlowUnit::BGR2YUV_NV12(const cv::Mat &src_bgr) {
+modelbox::Status ImageDecoderFlowUnit::DecodeImage(
+    const std::shared_ptr<modelbox::Buffer> &buffer, cv::Mat *img_dest) {
+  auto input_data = static_cast<const uint8_t *>(buffer->ConstData());
+  auto input_size = buffer->GetBytes();
+  if (input_data == nullptr || input_size == 0) {
+    return {modelbox::STATUS_INVALID, "input image buffer is empty"};
+  }
+
+  cv::Mat img;
+  bool is_bgr = true;
+#ifdef ENABLE_TURBOJPEG
+  if (TurboJpegDecoder::IsJpeg(input_data, input_size)) {
+    // nv12 is converted from rgb
+    is_bgr = (pixel_format_ == "bgr");
+    TurboJpegDecoder decoder;
+    auto ret = decoder.Decode(input_data, input_size, decode_width_,
+                              decode_height_, is_bgr, img);
+    if (!ret) {
+      // such as cmyk or exif rotated jpeg, opencv applies exif orientation
+      MBLOG_DEBUG << "turbo jpeg decode failed, try opencv, " << ret;
+      is_bgr = true;
+    }
+  }
+#endif
+
+  if (img.empty()) {
+    // wrap input data without copy
+    cv::Mat input_mat(1, (int)input_size, CV_8UC1, (void *)input_data);
+    img = cv::imdecode(input_mat, cv::IMREAD_COLOR);
+    if (img.data == NULL) {
+      return {modelbox::STATUS_FAULT,
+              "input image buffer is invalid, imdecode failed."};
+    }
+  }
+
+  MBLOG_DEBUG << "decode image clos : " << img.cols << ", rows : " << img.rows
+              << "channles : " << img.channels();
+
+  if (pixel_format_ == "nv12") {
+    *img_dest = RGB2YUV_NV12(img, is_bgr);
+    if (!modelbox::StatusError) {
+      return {modelbox::StatusError, "dest image data is invalid."};
+    }
+
+    return modelbox::STATUS_OK;
+  }
+
+  if ((pixel_format_ == "rgb") == is_bgr) {
+    cv::cvtColor(img, *img_dest, cv::COLOR_BGR2RGB);
+    return modelbox::STATUS_OK;
+  }
+
+  *img_dest = img;
+  return modelbox::STATUS_OK;
+}
+
+cv::Mat ImageDecoderFlowUnit::RGB2YUV_NV12(const cv::Mat &src_rgb,
+                                           bool is_bgr) {
   modelbox::StatusError = modelbox::STATUS_OK;
-  cv::Mat dst_nv12(src_bgr.rows * 1.5, src_bgr.cols, CV_8UC1, cv::Scalar(0));
-  cv::Mat src_yuv_i420;
-  cv::cvtColor(src_bgr, src_yuv_i420, cv::COLOR_BGR2YUV_I420);
-
-  size_t len_y = src_bgr.rows * src_bgr.cols;
-  size_t len_u = len_y / 4;
-  auto ret = memcpy_s(dst_nv12.data, len_y, src_yuv_i420.data, len_y);
-  if (ret != EOK) {
-    MBLOG_ERROR << "Cpu memcpy failed, ret " << ret << ", size " << len_y;
+  if (src_rgb.cols % 2 != 0 || src_rgb.rows % 2 != 0) {
+    MBLOG_ERROR << "nv12 requires even size, image size " << src_rgb.cols
+                << "x" << src_rgb.rows;
+    modelbox::StatusError = {modelbox::STATUS_INVALID};
+    return cv::Mat();
+  }
+
+  auto rgb_fmt = is_bgr ? videodecode::RGBFormat::BGR24
+                        : videodecode::RGBFormat::RGB24;
+  cv::Mat dst_nv12(src_rgb.rows * 3 / 2, src_rgb.cols, CV_8UC1);
+  auto *dst_y = dst_nv12.data;
+  auto *dst_uv = dst_y + src_rgb.rows * src_rgb.cols;
+  auto ret = videodecode::RGBToNV12(
+      src_rgb.data, (int32_t)src_rgb.step, dst_y, src_rgb.cols, dst_uv,
+      src_rgb.cols, src_rgb.cols, src_rgb.rows, rgb_fmt);
+  if (!ret) {
+    MBLOG_ERROR << "convert to nv12 failed, " << ret;
     dst_nv12.release();
-    modelbox::StatusError = {modelbox::STATUS_FAULT};
+    modelbox::StatusError = ret;
     return dst_nv12;
   }
-  for (size_t i = 0; i < len_u; ++i) {
-    dst_nv12.data[len_y + 2 * i] = src_yuv_i420.data[len_y + i];
-    dst_nv12.data[len_y + 2 * i + 1] = src_yuv_i420.data[len_y + len_u + i];
-  }
 
   return dst_nv12;
 }
@@ -171,6 +260,15 @@ MODELBOX_FLOWUNIT(ImageDecoderFlowUnit, desc) {
 
   desc.AddFlowUnitOption(modelbox::FlowUnitOption(
       "pix_fmt", "string", true, "bgr", "the output pixel format"));
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "decode_width", "int", false, "0",
+      "the min jpeg decode width, 0 means no scale"));
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "decode_height", "int", false, "0",
+      "the min jpeg decode height, 0 means no scale"));
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "decode_threads", "int", false, "0",
+      "the decode thread number, 0 means cpu number"));
 
   desc.SetFlowType(modelbox::NORMAL);
   desc.SetInputContiguous(false);
@@ -21,6 +21,8 @@
 #include <modelbox/flow.h>
 #include <modelbox/flowunit.h>
 
+#include <modelbox/base/thread_pool.h>
+
 #include <opencv2/opencv.hpp>
 
 constexpr const char *FLOWUNIT_NAME = "image_decoder";
@@ -39,7 +41,9 @@ constexpr const char *FLOWUNIT_DESC =
     "\t\tField Name: layout,        Type: int32_t\n"
     "\t\tField Name: shape,         Type: vector<size_t>\n"
     "\t\tField Name: type,          Type: ModelBoxDataType::MODELBOX_UINT8\n"
-    "\t@Constraint:";
+    "\t@Constraint: Jpeg image is decoded by libjpeg-turbo when available, "
+    "'decode_width' and 'decode_height' let it scale the image down in dct "
+    "domain, the output size is the smallest scaled size not less than them.";
 
 class ImageDecoderFlowUnit : public modelbox::FlowUnit {
  public:
@@ -55,10 +59,15 @@ class ImageDecoderFlowUnit : public modelbox::FlowUnit {
   modelbox::Status DataGroupPost(std::shared_ptr<modelbox::DataContext> ct);
 
  private:
-  cv::Mat BGR2YUV_NV12(const cv::Mat &src_bgr);
+  modelbox::Status DecodeImage(const std::shared_ptr<modelbox::Buffer> &buffer,
+                               cv::Mat *img_dest);
+  cv::Mat RGB2YUV_NV12(const cv::Mat &src_rgb, bool is_bgr);
 
  private:
   std::string pixel_format_{"bgr"};
+  int32_t decode_width_{0};
+  int32_t decode_height_{0};
+  std::shared_ptr<modelbox::ThreadPool> pool_;
 };
 
 #endif  // MODELBOX_FLOWUNIT_HTTPSERVER_CPU_H_
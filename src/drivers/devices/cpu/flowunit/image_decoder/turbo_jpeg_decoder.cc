@@ -0,0 +1,222 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "turbo_jpeg_decoder.h"
+
+#include <modelbox/base/log.h>
+
+#include <cstring>
+
+constexpr uint8_t JPEG_MARKER_APP1 = 0xE1;
+constexpr uint8_t JPEG_MARKER_SOS = 0xDA;
+constexpr uint8_t JPEG_MARKER_EOI = 0xD9;
+constexpr uint16_t EXIF_TAG_ORIENTATION = 0x0112;
+constexpr int32_t EXIF_ORIENTATION_NORMAL = 1;
+
+static uint16_t ReadU16(const uint8_t *data, bool little_endian) {
+  if (little_endian) {
+    return (uint16_t)(data[0] | (data[1] << 8));
+  }
+
+  return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+static uint32_t ReadU32(const uint8_t *data, bool little_endian) {
+  if (little_endian) {
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+  }
+
+  return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) |
+         ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+}
+
+/**
+ * @brief Find orientation in tiff block of exif segment
+ */
+static int32_t GetTiffOrientation(const uint8_t *tiff, size_t size) {
+  if (size < 8) {
+    return EXIF_ORIENTATION_NORMAL;
+  }
+
+  bool little_endian = false;
+  if (tiff[0] == 'I' && tiff[1] == 'I') {
+    little_endian = true;
+  } else if (tiff[0] != 'M' || tiff[1] != 'M') {
+    return EXIF_ORIENTATION_NORMAL;
+  }
+
+  if (ReadU16(tiff + 2, little_endian) != 42) {
+    return EXIF_ORIENTATION_NORMAL;
+  }
+
+  size_t ifd = ReadU32(tiff + 4, little_endian);
+  if (ifd > size - 2) {
+    return EXIF_ORIENTATION_NORMAL;
+  }
+
+  size_t entry_num = ReadU16(tiff + ifd, little_endian);
+  const size_t entry_size = 12;
+  for (size_t i = 0; i < entry_num; ++i) {
+    auto entry = ifd + 2 + i * entry_size;
+    if (entry + entry_size > size) {
+      break;
+    }
+
+    if (ReadU16(tiff + entry, little_endian) != EXIF_TAG_ORIENTATION) {
+      continue;
+    }
+
+    // short value is stored in the first two bytes of value field
+    int32_t orientation = ReadU16(tiff + entry + 8, little_endian);
+    if (orientation < 1 || orientation > 8) {
+      return EXIF_ORIENTATION_NORMAL;
+    }
+
+    return orientation;
+  }
+
+  return EXIF_ORIENTATION_NORMAL;
+}
+
+TurboJpegDecoder::TurboJpegDecoder() { handle_ = tjInitDecompress(); }
+
+TurboJpegDecoder::~TurboJpegDecoder() {
+  if (handle_ != nullptr) {
+    tjDestroy(handle_);
+    handle_ = nullptr;
+  }
+}
+
+bool TurboJpegDecoder::IsJpeg(const uint8_t *data, size_t size) {
+  return size > 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+}
+
+int32_t TurboJpegDecoder::GetOrientation(const uint8_t *data, size_t size) {
+  if (!IsJpeg(data, size)) {
+    return EXIF_ORIENTATION_NORMAL;
+  }
+
+  // walk segments after soi until scan data starts
+  size_t pos = 2;
+  while (pos + 4 <= size) {
+    if (data[pos] != 0xFF) {
+      break;
+    }
+
+    auto marker = data[pos + 1];
+    if (marker == 0xFF) {
+      // fill byte
+      ++pos;
+      continue;
+    }
+
+    if (marker == JPEG_MARKER_SOS || marker == JPEG_MARKER_EOI) {
+      break;
+    }
+
+    size_t length = ReadU16(data + pos + 2, false);
+    if (length < 2 || pos + 2 + length > size) {
+      break;
+    }
+
+    const size_t exif_header_size = 6;
+    if (marker == JPEG_MARKER_APP1 && length >= 2 + exif_header_size &&
+        memcmp(data + pos + 4, "Exif\0\0", exif_header_size) == 0) {
+      return GetTiffOrientation(data + pos + 4 + exif_header_size,
+                                length - 2 - exif_header_size);
+    }
+
+    pos += 2 + length;
+  }
+
+  return EXIF_ORIENTATION_NORMAL;
+}
+
+modelbox::Status TurboJpegDecoder::Decode(const uint8_t *data, size_t size,
+                                          int32_t min_width,
+                                          int32_t min_height, bool bgr,
+                                          cv::Mat &image) {
+  if (handle_ == nullptr) {
+    MBLOG_ERROR << "tjInitDecompress failed, " << tjGetErrorStr();
+    return modelbox::STATUS_FAULT;
+  }
+
+  auto orientation = GetOrientation(data, size);
+  if (orientation != EXIF_ORIENTATION_NORMAL) {
+    return {modelbox::STATUS_NOTSUPPORT,
+            "exif orientation " + std::to_string(orientation) +
+                " is not applied by turbo jpeg"};
+  }
+
+  int32_t width = 0;
+  int32_t height = 0;
+  int32_t subsamp = 0;
+  int32_t colorspace = 0;
+  auto ret = tjDecompressHeader3(handle_, data, (unsigned long)size, &width,
+                                 &height, &subsamp, &colorspace);
+  if (ret != 0) {
+    return {modelbox::STATUS_INVALID,
+            std::string("read jpeg header failed, ") + tjGetErrorStr2(handle_)};
+  }
+
+  int32_t scaled_width = width;
+  int32_t scaled_height = height;
+  GetScaledSize(width, height, min_width, min_height, scaled_width,
+                scaled_height);
+  image.create(scaled_height, scaled_width, CV_8UC3);
+  ret = tjDecompress2(handle_, data, (unsigned long)size, image.data,
+                      scaled_width, (int32_t)image.step, scaled_height,
+                      bgr ? TJPF_BGR : TJPF_RGB, 0);
+  if (ret != 0 && tjGetErrorCode(handle_) == TJERR_FATAL) {
+    image.release();
+    return {modelbox::STATUS_FAULT,
+            std::string("decode jpeg failed, ") + tjGetErrorStr2(handle_)};
+  }
+
+  return modelbox::STATUS_OK;
+}
+
+void TurboJpegDecoder::GetScaledSize(int32_t width, int32_t height,
+                                     int32_t min_width, int32_t min_height,
+                                     int32_t &scaled_width,
+                                     int32_t &scaled_height) {
+  scaled_width = width;
+  scaled_height = height;
+  if (min_width <= 0 || min_height <= 0) {
+    return;
+  }
+
+  int32_t factor_num = 0;
+  auto *factors = tjGetScalingFactors(&factor_num);
+  if (factors == nullptr) {
+    return;
+  }
+
+  for (int32_t i = 0; i < factor_num; ++i) {
+    auto &factor = factors[i];
+    if (factor.num >= factor.denom) {
+      continue;
+    }
+
+    auto w = TJSCALED(width, factor);
+    auto h = TJSCALED(height, factor);
+    if (w >= min_width && h >= min_height && w < scaled_width) {
+      scaled_width = w;
+      scaled_height = h;
+    }
+  }
+}
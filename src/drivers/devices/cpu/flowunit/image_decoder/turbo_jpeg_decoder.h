@@ -0,0 +1,74 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODELBOX_FLOWUNIT_TURBO_JPEG_DECODER_CPU_H_
+#define MODELBOX_FLOWUNIT_TURBO_JPEG_DECODER_CPU_H_
+
+#include <modelbox/base/status.h>
+#include <turbojpeg.h>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Jpeg decoder based on libjpeg-turbo, the image is scaled in dct
+ * domain and decoded into packed rgb or bgr directly
+ */
+class TurboJpegDecoder {
+ public:
+  TurboJpegDecoder();
+  virtual ~TurboJpegDecoder();
+
+  /**
+   * @brief Whether data is a jpeg image
+   * @param data image data
+   * @param size image data size
+   * @return true if data starts with jpeg soi marker
+   */
+  static bool IsJpeg(const uint8_t *data, size_t size);
+
+  /**
+   * @brief Read exif orientation tag of jpeg image
+   * @param data jpeg data
+   * @param size jpeg data size
+   * @return orientation 1 to 8, 1 if image has no orientation tag
+   */
+  static int32_t GetOrientation(const uint8_t *data, size_t size);
+
+  /**
+   * @brief Decode jpeg image
+   * @param data jpeg data
+   * @param size jpeg data size
+   * @param min_width decoded width is scaled down to the smallest size not
+   * less than min_width, 0 means no scale
+   * @param min_height decoded height is scaled down to the smallest size not
+   * less than min_height, 0 means no scale
+   * @param bgr output bgr if true, else rgb
+   * @param image decoded image, CV_8UC3
+   * @return decode result, STATUS_NOTSUPPORT if image has exif orientation
+   * other than 1, which turbo jpeg does not apply
+   */
+  modelbox::Status Decode(const uint8_t *data, size_t size, int32_t min_width,
+                          int32_t min_height, bool bgr, cv::Mat &image);
+
+ private:
+  void GetScaledSize(int32_t width, int32_t height, int32_t min_width,
+                     int32_t min_height, int32_t &scaled_width,
+                     int32_t &scaled_height);
+
+  tjhandle handle_{nullptr};
+};
+
+#endif  // MODELBOX_FLOWUNIT_TURBO_JPEG_DECODER_CPU_H_
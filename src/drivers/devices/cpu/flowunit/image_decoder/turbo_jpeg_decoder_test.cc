@@ -0,0 +1,130 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "turbo_jpeg_decoder.h"
+
+#include <opencv2/opencv.hpp>
+
+#include "gtest/gtest.h"
+#include "modelbox/base/log.h"
+
+namespace modelbox {
+class TurboJpegDecoderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    auto img_path = std::string(TEST_ASSETS) + "/test.jpg";
+    origin_ = cv::imread(img_path);
+    ASSERT_FALSE(origin_.empty());
+    cv::imencode(".jpg", origin_, jpeg_data_);
+  };
+
+  cv::Mat origin_;
+  std::vector<uint8_t> jpeg_data_;
+};
+
+TEST_F(TurboJpegDecoderTest, DecodeSameAsOpenCV) {
+  ASSERT_TRUE(TurboJpegDecoder::IsJpeg(jpeg_data_.data(), jpeg_data_.size()));
+  TurboJpegDecoder decoder;
+  cv::Mat img;
+  auto ret = decoder.Decode(jpeg_data_.data(), jpeg_data_.size(), 0, 0, true,
+                            img);
+  ASSERT_EQ(ret, STATUS_OK);
+
+  auto expected = cv::imdecode(jpeg_data_, cv::IMREAD_COLOR);
+  ASSERT_EQ(img.cols, expected.cols);
+  ASSERT_EQ(img.rows, expected.rows);
+  EXPECT_EQ(cv::norm(img, expected, cv::NORM_INF), 0);
+
+  cv::Mat rgb_img;
+  ret = decoder.Decode(jpeg_data_.data(), jpeg_data_.size(), 0, 0, false,
+                       rgb_img);
+  ASSERT_EQ(ret, STATUS_OK);
+  cv::Mat expected_rgb;
+  cv::cvtColor(expected, expected_rgb, cv::COLOR_BGR2RGB);
+  EXPECT_EQ(cv::norm(rgb_img, expected_rgb, cv::NORM_INF), 0);
+}
+
+TEST_F(TurboJpegDecoderTest, ScaledDecode) {
+  TurboJpegDecoder decoder;
+  cv::Mat img;
+  auto min_width = origin_.cols / 2;
+  auto min_height = origin_.rows / 2;
+  auto ret = decoder.Decode(jpeg_data_.data(), jpeg_data_.size(), min_width,
+                            min_height, true, img);
+  ASSERT_EQ(ret, STATUS_OK);
+  EXPECT_EQ(img.cols, (origin_.cols + 1) / 2);
+  EXPECT_EQ(img.rows, (origin_.rows + 1) / 2);
+
+  ret = decoder.Decode(jpeg_data_.data(), jpeg_data_.size(), 1, 1, true, img);
+  ASSERT_EQ(ret, STATUS_OK);
+  EXPECT_EQ(img.cols, (origin_.cols + 7) / 8);
+  EXPECT_EQ(img.rows, (origin_.rows + 7) / 8);
+}
+
+TEST_F(TurboJpegDecoderTest, ExifRotated) {
+  // app1 exif segment, big endian tiff with orientation 6, which means
+  // rotate 90 degrees clockwise to display
+  const std::vector<uint8_t> exif = {
+      0xFF, 0xE1, 0x00, 0x22, 'E',  'x',  'i',  'f',  0x00, 0x00, 'M',  'M',
+      0x00, 0x2A, 0x00, 0x00, 0x00, 0x08, 0x00, 0x01, 0x01, 0x12, 0x00, 0x03,
+      0x00, 0x00, 0x00, 0x01, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  std::vector<uint8_t> rotated(jpeg_data_.begin(), jpeg_data_.begin() + 2);
+  rotated.insert(rotated.end(), exif.begin(), exif.end());
+  rotated.insert(rotated.end(), jpeg_data_.begin() + 2, jpeg_data_.end());
+
+  EXPECT_EQ(TurboJpegDecoder::GetOrientation(jpeg_data_.data(),
+                                             jpeg_data_.size()),
+            1);
+  EXPECT_EQ(TurboJpegDecoder::GetOrientation(rotated.data(), rotated.size()),
+            6);
+
+  // orientation is not applied by turbo jpeg, decoder falls back to opencv
+  TurboJpegDecoder decoder;
+  cv::Mat img;
+  auto ret = decoder.Decode(rotated.data(), rotated.size(), 0, 0, true, img);
+  EXPECT_EQ(ret, STATUS_NOTSUPPORT);
+  EXPECT_TRUE(img.empty());
+
+  auto expected = cv::imdecode(rotated, cv::IMREAD_COLOR);
+  ASSERT_FALSE(expected.empty());
+  EXPECT_EQ(expected.cols, origin_.rows);
+  EXPECT_EQ(expected.rows, origin_.cols);
+
+  // little endian tiff with orientation 1 is decoded by turbo jpeg
+  const std::vector<uint8_t> exif_normal = {
+      0xFF, 0xE1, 0x00, 0x22, 'E',  'x',  'i',  'f',  0x00, 0x00, 'I',  'I',
+      0x2A, 0x00, 0x08, 0x00, 0x00, 0x00, 0x01, 0x00, 0x12, 0x01, 0x03, 0x00,
+      0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  std::vector<uint8_t> normal(jpeg_data_.begin(), jpeg_data_.begin() + 2);
+  normal.insert(normal.end(), exif_normal.begin(), exif_normal.end());
+  normal.insert(normal.end(), jpeg_data_.begin() + 2, jpeg_data_.end());
+  EXPECT_EQ(TurboJpegDecoder::GetOrientation(normal.data(), normal.size()), 1);
+  ret = decoder.Decode(normal.data(), normal.size(), 0, 0, true, img);
+  EXPECT_EQ(ret, STATUS_OK);
+}
+
+TEST_F(TurboJpegDecoderTest, NotJpeg) {
+  std::vector<uint8_t> png_data;
+  cv::imencode(".png", origin_, png_data);
+  EXPECT_FALSE(TurboJpegDecoder::IsJpeg(png_data.data(), png_data.size()));
+
+  TurboJpegDecoder decoder;
+  cv::Mat img;
+  auto ret = decoder.Decode(png_data.data(), png_data.size(), 0, 0, true, img);
+  EXPECT_NE(ret, STATUS_OK);
+}
+
+}  // namespace modelbox
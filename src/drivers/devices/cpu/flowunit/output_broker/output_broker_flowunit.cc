@@ -325,7 +325,12 @@ modelbox::Status OutputBrokerFlowUnit::SendData(
 
     auto &broker = item->second;
     if (mode_ == SYNC_MODE) {
-      auto ret = broker->Write(buffer);
+      modelbox::Status ret;
+      {
+        modelbox::BlockingSection blocking;
+        ret = broker->Write(buffer);
+      }
+
       if (!ret) {
         MBLOG_ERROR << "Write data to " << target_broker_name
                     << " failed, drop this data, detail: " << ret.Errormsg();
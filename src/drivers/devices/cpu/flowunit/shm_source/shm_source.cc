@@ -0,0 +1,285 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shm_source.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include "modelbox/flowunit.h"
+#include "modelbox/flowunit_api_helper.h"
+
+constexpr int SHM_SOURCE_POLL_MS = 200;
+
+ShmSourceFlowUnit::ShmSourceFlowUnit(){};
+ShmSourceFlowUnit::~ShmSourceFlowUnit(){};
+
+static void SetFrameMeta(const std::shared_ptr<modelbox::Buffer> &buffer,
+                         const std::string &meta) {
+  if (meta.empty()) {
+    return;
+  }
+
+  nlohmann::json meta_json;
+  try {
+    meta_json = nlohmann::json::parse(meta);
+  } catch (const std::exception &e) {
+    meta_json = nullptr;
+  }
+
+  // not a json object, keep it as is
+  if (!meta_json.is_object()) {
+    buffer->Set("meta", meta);
+    return;
+  }
+
+  for (auto &item : meta_json.items()) {
+    auto &value = item.value();
+    if (value.is_string()) {
+      buffer->Set(item.key(), value.get<std::string>());
+    } else if (value.is_boolean()) {
+      buffer->Set(item.key(), value.get<bool>());
+    } else if (value.is_number_integer()) {
+      buffer->Set(item.key(), value.get<int64_t>());
+    } else if (value.is_number_float()) {
+      buffer->Set(item.key(), value.get<double>());
+    } else {
+      buffer->Set(item.key(), value.dump());
+    }
+  }
+}
+
+modelbox::Status ShmSourceFlowUnit::Open(
+    const std::shared_ptr<modelbox::Configuration> &opts) {
+  path_ = opts->GetString("path", "");
+  if (path_.empty()) {
+    MBLOG_ERROR << "path must be set in config";
+    return modelbox::STATUS_BADCONF;
+  }
+
+  max_batch_size_ = opts->GetUint64("max_batch_size", 8);
+  max_producers_ = opts->GetUint64("max_producers", 16);
+  if (max_batch_size_ == 0) {
+    max_batch_size_ = 1;
+  }
+
+  auto ret = modelbox::ShmRing::Listen(path_, &listen_fd_);
+  if (!ret) {
+    MBLOG_ERROR << "listen shared memory source failed, " << ret;
+    return ret;
+  }
+
+  run_ = true;
+  accept_thread_ = std::thread(&ShmSourceFlowUnit::AcceptWork, this);
+  MBLOG_INFO << "shared memory source listen on " << path_;
+  return modelbox::STATUS_OK;
+}
+
+modelbox::Status ShmSourceFlowUnit::Close() {
+  run_ = false;
+  if (accept_thread_.joinable()) {
+    accept_thread_.join();
+  }
+
+  ReapSessions(true);
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+    unlink(path_.c_str());
+  }
+
+  return modelbox::STATUS_OK;
+}
+
+void ShmSourceFlowUnit::AcceptWork() {
+  while (run_) {
+    ReapSessions(false);
+
+    struct pollfd fds;
+    fds.fd = listen_fd_;
+    fds.events = POLLIN;
+    fds.revents = 0;
+    if (poll(&fds, 1, SHM_SOURCE_POLL_MS) <= 0 || !(fds.revents & POLLIN)) {
+      continue;
+    }
+
+    auto session = std::make_shared<ShmSourceSession>();
+    auto ret = modelbox::ShmRing::Accept(listen_fd_, &session->ring,
+                                         SHM_SOURCE_POLL_MS);
+    if (!ret) {
+      MBLOG_WARN << "accept shared memory producer failed, " << ret;
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock(sessions_lock_);
+    if (sessions_.size() >= max_producers_) {
+      MBLOG_WARN << "too many shared memory producers, max "
+                 << max_producers_;
+      continue;
+    }
+
+    session->external = CreateExternalData();
+    if (session->external == nullptr) {
+      MBLOG_ERROR << "can not get external data.";
+      continue;
+    }
+
+    session->reader =
+        std::thread(&ShmSourceFlowUnit::ReadWork, this, session);
+    sessions_.push_back(session);
+  }
+}
+
+void ShmSourceFlowUnit::ReapSessions(bool wait_all) {
+  std::list<std::shared_ptr<ShmSourceSession>> finished;
+  {
+    std::lock_guard<std::mutex> lock(sessions_lock_);
+    for (auto iter = sessions_.begin(); iter != sessions_.end();) {
+      if (!wait_all && !(*iter)->finished) {
+        ++iter;
+        continue;
+      }
+
+      finished.push_back(*iter);
+      iter = sessions_.erase(iter);
+    }
+  }
+
+  for (auto &session : finished) {
+    if (session->reader.joinable()) {
+      session->reader.join();
+    }
+  }
+}
+
+void ShmSourceFlowUnit::ReadWork(std::shared_ptr<ShmSourceSession> session) {
+  auto &ring = session->ring;
+  auto ret = modelbox::STATUS_OK;
+  std::vector<modelbox::ShmRingFrame> frames;
+  while (run_) {
+    frames.resize(1);
+    ret = ring->Read(&frames[0], SHM_SOURCE_POLL_MS);
+    if (ret == modelbox::STATUS_TIMEDOUT) {
+      continue;
+    }
+
+    if (!ret) {
+      break;
+    }
+
+    // take frames already written without waiting
+    modelbox::ShmRingFrame frame;
+    while (frames.size() < max_batch_size_ && ring->Read(&frame, 0)) {
+      frames.push_back(frame);
+    }
+
+    ret = SendFrames(session, frames);
+    if (!ret) {
+      MBLOG_ERROR << "send shared memory frames failed, " << ret;
+      break;
+    }
+  }
+
+  if (ret == modelbox::STATUS_EOF) {
+    session->external->Close();
+  } else {
+    session->external->Shutdown();
+  }
+
+  session->finished = true;
+}
+
+modelbox::Status ShmSourceFlowUnit::SendFrames(
+    std::shared_ptr<ShmSourceSession> session,
+    std::vector<modelbox::ShmRingFrame> &frames) {
+  auto &ring = session->ring;
+  auto buffer_list = session->external->CreateBufferList();
+  if (buffer_list == nullptr) {
+    for (auto &frame : frames) {
+      ring->Release(frame.slot);
+    }
+
+    return modelbox::STATUS_NOMEM;
+  }
+
+  // slot is released when graph drops the buffer
+  auto ret = modelbox::STATUS_OK;
+  for (auto &frame : frames) {
+    if (!ret) {
+      ring->Release(frame.slot);
+      continue;
+    }
+
+    if (frame.size == 0) {
+      ring->Release(frame.slot);
+      auto buffer =
+          std::make_shared<modelbox::Buffer>(buffer_list->GetDevice());
+      ret = buffer->Build(0);
+      if (ret) {
+        buffer_list->PushBack(buffer);
+      }
+    } else {
+      ret = buffer_list->EmplaceBack(ring->Adopt(frame), frame.size);
+    }
+
+    if (ret) {
+      SetFrameMeta(buffer_list->Back(), frame.meta);
+    }
+  }
+
+  if (!ret) {
+    return ret;
+  }
+
+  return session->external->Send(buffer_list);
+}
+
+modelbox::Status ShmSourceFlowUnit::Process(
+    std::shared_ptr<modelbox::DataContext> ctx) {
+  auto output_buffers = ctx->Output("out_data");
+  auto input_buffers = ctx->External();
+  for (auto &buffer : *input_buffers) {
+    output_buffers->PushBack(buffer);
+  }
+
+  return modelbox::STATUS_OK;
+}
+
+MODELBOX_FLOWUNIT(ShmSourceFlowUnit, desc) {
+  desc.SetFlowUnitName(FLOWUNIT_NAME);
+  desc.SetFlowUnitGroupType("Input");
+  desc.AddFlowUnitOutput({"out_data"});
+  desc.SetFlowType(modelbox::NORMAL);
+  desc.SetDescription(FLOWUNIT_DESC);
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "path", "string", true, "", "unix socket path producers connect to."));
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "max_batch_size", "integer", false, "8",
+      "max frames sent to graph at once, frames are not waited for."));
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "max_producers", "integer", false, "16",
+      "max producer connections, one session for each."));
+}
+
+MODELBOX_DRIVER_FLOWUNIT(desc) {
+  desc.Desc.SetName(FLOWUNIT_NAME);
+  desc.Desc.SetClass(modelbox::DRIVER_CLASS_FLOWUNIT);
+  desc.Desc.SetType(FLOWUNIT_TYPE);
+  desc.Desc.SetDescription(FLOWUNIT_DESC);
+  desc.Desc.SetVersion("1.0.0");
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODELBOX_FLOWUNIT_SHM_SOURCE_CPU_H_
+#define MODELBOX_FLOWUNIT_SHM_SOURCE_CPU_H_
+
+#include <modelbox/base/shm_ring.h>
+#include <modelbox/base/status.h>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "modelbox/buffer.h"
+#include "modelbox/flowunit.h"
+
+constexpr const char *FLOWUNIT_NAME = "shm_source";
+constexpr const char *FLOWUNIT_TYPE = "cpu";
+constexpr const char *FLOWUNIT_DESC =
+    "\n\t@Brief: Receive frames from local processes through shared memory "
+    "ring, see modelbox/base/shm_ring.h. Each producer connection is one "
+    "session. \n"
+    "\t@Port parameter: The output port buffer data is frame data in shared "
+    "memory, not copied. Frame meta in json object is set to buffer meta. \n"
+    "\t@Constraint: Ring slot is reused after the buffer is released by "
+    "graph, hold buffer long will block the producer.";
+
+struct ShmSourceSession {
+  std::shared_ptr<modelbox::ShmRing> ring;
+  std::shared_ptr<modelbox::ExternalData> external;
+  std::thread reader;
+  std::atomic_bool finished{false};
+};
+
+class ShmSourceFlowUnit : public modelbox::FlowUnit {
+ public:
+  ShmSourceFlowUnit();
+  virtual ~ShmSourceFlowUnit();
+
+  modelbox::Status Open(const std::shared_ptr<modelbox::Configuration> &opts);
+
+  modelbox::Status Close();
+
+  /* run when processing data */
+  modelbox::Status Process(std::shared_ptr<modelbox::DataContext> data_ctx);
+
+ private:
+  void AcceptWork();
+
+  void ReadWork(std::shared_ptr<ShmSourceSession> session);
+
+  modelbox::Status SendFrames(std::shared_ptr<ShmSourceSession> session,
+                              std::vector<modelbox::ShmRingFrame> &frames);
+
+  void ReapSessions(bool wait_all);
+
+  std::string path_;
+  uint64_t max_batch_size_{8};
+  uint64_t max_producers_{16};
+
+  int listen_fd_{-1};
+  std::atomic_bool run_{false};
+  std::thread accept_thread_;
+
+  std::mutex sessions_lock_;
+  std::list<std::shared_ptr<ShmSourceSession>> sessions_;
+};
+
+#endif  // MODELBOX_FLOWUNIT_SHM_SOURCE_CPU_H_
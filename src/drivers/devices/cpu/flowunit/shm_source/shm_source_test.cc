@@ -0,0 +1,124 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shm_source.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "driver_flow_test.h"
+#include "flowunit_mockflowunit/flowunit_mockflowunit.h"
+#include "gtest/gtest.h"
+#include "modelbox/base/log.h"
+#include "modelbox/base/shm_ring.h"
+#include "modelbox/buffer.h"
+#include "test/mock/minimodelbox/mockflow.h"
+
+#define SHM_SOURCE_PATH "/tmp/modelbox-shm-source-test.sock"
+
+namespace modelbox {
+
+class ShmSourceFlowUnitTest : public testing::Test {
+ public:
+  ShmSourceFlowUnitTest() : driver_flow_(std::make_shared<MockFlow>()) {}
+
+ protected:
+  virtual void SetUp() {
+    auto ret = AddMockFlowUnit();
+    EXPECT_EQ(ret, STATUS_OK);
+  };
+
+  virtual void TearDown() { driver_flow_ = nullptr; };
+  std::shared_ptr<MockFlow> GetDriverFlow();
+
+  std::atomic<int> frame_count_{0};
+
+ private:
+  Status AddMockFlowUnit();
+  std::shared_ptr<MockFlow> driver_flow_;
+};
+
+std::shared_ptr<MockFlow> ShmSourceFlowUnitTest::GetDriverFlow() {
+  return driver_flow_;
+}
+
+Status ShmSourceFlowUnitTest::AddMockFlowUnit() {
+  auto mock_desc = GenerateFlowunitDesc("shm_source_checker", {"In_1"}, {});
+  auto process_func =
+      [=](std::shared_ptr<DataContext> op_ctx,
+          std::shared_ptr<MockFlowUnit> mock_flowunit) -> Status {
+    auto input_buf = op_ctx->Input("In_1");
+    for (auto &buffer : *input_buf) {
+      int64_t index = -1;
+      buffer->Get("index", index);
+      EXPECT_EQ(buffer->GetBytes(), 1024);
+      EXPECT_EQ(((const uint8_t *)buffer->ConstData())[1023],
+                (uint8_t)index);
+      frame_count_++;
+    }
+
+    return modelbox::STATUS_OK;
+  };
+  auto mock_funcitons = std::make_shared<MockFunctionCollection>();
+  mock_funcitons->RegisterProcessFunc(process_func);
+  driver_flow_->AddFlowUnitDesc(mock_desc, mock_funcitons->GenerateCreateFunc(),
+                                TEST_DRIVER_DIR);
+  return STATUS_OK;
+}
+
+TEST_F(ShmSourceFlowUnitTest, SendFrames) {
+  const std::string test_lib_dir = TEST_DRIVER_DIR;
+  std::string toml_content = R"(
+    [driver]
+    skip-default=true
+    dir=[")" + test_lib_dir + "\"]\n    " +
+                             R"([graph]
+    graphconf = '''digraph demo {
+          shm_source[type=flowunit, flowunit=shm_source, device=cpu, deviceid=0, path=")" +
+                             std::string(SHM_SOURCE_PATH) + R"(", max_batch_size=4]
+          shm_source_checker[type=flowunit, flowunit=shm_source_checker, device=cpu, deviceid=0]
+          shm_source:out_data -> shm_source_checker:In_1
+        }'''
+    format = "graphviz"
+  )";
+
+  auto driver_flow = GetDriverFlow();
+  auto ret = driver_flow->BuildAndRun("SendFrames", toml_content, -1);
+  ASSERT_EQ(ret, STATUS_OK);
+
+  // fewer slots than frames, slots must be released by graph to go on
+  std::shared_ptr<ShmRing> ring;
+  ASSERT_TRUE(ShmRing::Connect(SHM_SOURCE_PATH, 2, 1024, &ring));
+  const int frame_num = 32;
+  for (int i = 0; i < frame_num; i++) {
+    void *data = nullptr;
+    auto meta = "{\"index\":" + std::to_string(i) + "}";
+    ASSERT_TRUE(ring->Reserve(1024, &data, 5000, meta));
+    memset(data, i, 1024);
+    ASSERT_TRUE(ring->Commit(1024));
+  }
+  ring->Close();
+
+  for (int i = 0; i < 50 && frame_count_ < frame_num; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  EXPECT_EQ(frame_count_, frame_num);
+  driver_flow->GetFlow()->Stop();
+}
+
+}  // namespace modelbox
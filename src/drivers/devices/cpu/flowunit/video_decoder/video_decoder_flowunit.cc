@@ -27,6 +27,12 @@ VideoDecoderFlowUnit::~VideoDecoderFlowUnit(){};
 
 const std::set<std::string> g_supported_pix_fmt = {"nv12", "rgb", "bgr"};
 
+const std::map<std::string, int32_t> g_sws_scale_method = {
+    {"inter_nearest", SWS_POINT},  {"inter_linear", SWS_BILINEAR},
+    {"inter_cubic", SWS_BICUBIC},  {"inter_area", SWS_AREA},
+    {"inter_lanczos4", SWS_LANCZOS},
+};
+
 modelbox::Status VideoDecoderFlowUnit::Open(
     const std::shared_ptr<modelbox::Configuration> &opts) {
   auto fmt = opts->GetString("pix_fmt", "nv12");
@@ -42,6 +48,35 @@ modelbox::Status VideoDecoderFlowUnit::Open(
   }
 
   out_pix_fmt_str_ = fmt;
+  out_width_ = opts->GetInt32("width", 0);
+  out_height_ = opts->GetInt32("height", 0);
+  if (out_width_ < 0 || out_height_ < 0 ||
+      (out_width_ == 0) != (out_height_ == 0)) {
+    MBLOG_ERROR << "Output width " << out_width_ << " and height "
+                << out_height_ << " should be both positive or both 0";
+    return modelbox::STATUS_BADCONF;
+  }
+
+  if (out_pix_fmt_ == AVPixelFormat::AV_PIX_FMT_NV12 &&
+      (out_width_ % 2 != 0 || out_height_ % 2 != 0)) {
+    MBLOG_ERROR << "Output width " << out_width_ << " and height "
+                << out_height_ << " should be even for nv12";
+    return modelbox::STATUS_BADCONF;
+  }
+
+  auto interpolation = opts->GetString("interpolation", "inter_linear");
+  auto item = g_sws_scale_method.find(interpolation);
+  if (item == g_sws_scale_method.end()) {
+    MBLOG_ERROR << "Not support interpolation " << interpolation;
+    return modelbox::STATUS_BADCONF;
+  }
+
+  sws_flags_ = item->second;
+  if (out_width_ != 0) {
+    MBLOG_INFO << "Video decoder output size " << out_width_ << "x"
+               << out_height_ << ", interpolation " << interpolation;
+  }
+
   return modelbox::STATUS_OK;
 }
 
@@ -135,7 +170,40 @@ modelbox::Status VideoDecoderFlowUnit::ReadAVPacket(
   int64_t pts = 0, dts = 0;
   packet_buffer->Get("pts", pts);
   packet_buffer->Get("dts", dts);
-  return BuildAVPacket(pkt, size, (uint8_t *)data, pts, dts);
+  auto ret = BuildAVPacket(pkt, size, (uint8_t *)data, pts, dts);
+  if (ret != modelbox::STATUS_SUCCESS) {
+    return ret;
+  }
+
+  int32_t padding_size = 0;
+  packet_buffer->Get(PACKET_PADDING_META, padding_size);
+  if (padding_size < AV_INPUT_BUFFER_PADDING_SIZE) {
+    // Packet without padding will be copied by decoder
+    return modelbox::STATUS_SUCCESS;
+  }
+
+  pkt->buf = RefBuffer(packet_buffer, (uint8_t *)data, size);
+  return modelbox::STATUS_SUCCESS;
+}
+
+AVBufferRef *VideoDecoderFlowUnit::RefBuffer(
+    std::shared_ptr<modelbox::Buffer> &packet_buffer, uint8_t *data,
+    size_t size) {
+  // Decoder refers to packet memory directly, buffer will be held until
+  // decoder release the packet
+  auto *buffer_holder = new std::shared_ptr<modelbox::Buffer>(packet_buffer);
+  auto *buf_ref = av_buffer_create(
+      data, size,
+      [](void *opaque, uint8_t *data) {
+        delete static_cast<std::shared_ptr<modelbox::Buffer> *>(opaque);
+      },
+      buffer_holder, AV_BUFFER_FLAG_READONLY);
+  if (buf_ref == nullptr) {
+    MBLOG_WARN << "av_buffer_create failed, packet will be copied";
+    delete buffer_holder;
+  }
+
+  return buf_ref;
 }
 
 modelbox::Status VideoDecoderFlowUnit::BuildAVPacket(
@@ -199,7 +267,8 @@ modelbox::Status VideoDecoderFlowUnit::WriteData(
   std::vector<size_t> shape;
   size_t buffer_size;
   for (auto &frame : frame_list) {
-    auto ret = videodecode::GetBufferSize(frame->width, frame->height,
+    auto ret = videodecode::GetBufferSize(GetOutWidth(frame),
+                                          GetOutHeight(frame),
                                           out_pix_fmt_str_, buffer_size);
     if (ret != modelbox::STATUS_SUCCESS) {
       return ret;
@@ -217,17 +286,20 @@ modelbox::Status VideoDecoderFlowUnit::WriteData(
     videodecode::UpdateStatsInfo(ctx, frame_ptr->width, frame_ptr->height);
     auto frame_buff = frame_buff_list->At(i);
     ++i;
+    auto out_width = GetOutWidth(frame_ptr);
+    auto out_height = GetOutHeight(frame_ptr);
     auto ret = color_cvt->CvtColor(
-        frame_ptr, (uint8_t *)(frame_buff->MutableData()), out_pix_fmt_);
+        frame_ptr, (uint8_t *)(frame_buff->MutableData()), out_pix_fmt_,
+        out_width, out_height, sws_flags_);
     if (ret != modelbox::STATUS_SUCCESS) {
       return ret;
     }
 
     frame_buff->Set("index", *frame_index);
     *frame_index = *frame_index + 1;
-    frame_buff->Set("width", frame_ptr->width);
-    frame_buff->Set("height", frame_ptr->height);
-    frame_buff->Set("height_stride", frame_ptr->height);
+    frame_buff->Set("width", out_width);
+    frame_buff->Set("height", out_height);
+    frame_buff->Set("height_stride", out_height);
     frame_buff->Set("rate_num", rate_num);
     frame_buff->Set("rate_den", rate_den);
     frame_buff->Set("rotate_angle", rotate_angle);
@@ -235,14 +307,14 @@ modelbox::Status VideoDecoderFlowUnit::WriteData(
     frame_buff->Set("eos", false);
     frame_buff->Set("pix_fmt", out_pix_fmt_str_);
     frame_buff->Set("url", *source_url);
-    auto width_stride = frame_ptr->width;
+    auto width_stride = out_width;
     if (out_pix_fmt_str_ == "rgb" || out_pix_fmt_str_ == "bgr") {
       width_stride *= 3;
       int32_t channel = 3;
       frame_buff->Set("channel", channel);
       frame_buff->Set(
-          "shape", std::vector<size_t>({static_cast<size_t>(frame_ptr->height),
-                                        static_cast<size_t>(frame_ptr->width),
+          "shape", std::vector<size_t>({static_cast<size_t>(out_height),
+                                        static_cast<size_t>(out_width),
                                         static_cast<size_t>(channel)}));
       frame_buff->Set("layout", std::string("hwc"));
     }
@@ -258,6 +330,16 @@ modelbox::Status VideoDecoderFlowUnit::WriteData(
   return modelbox::STATUS_SUCCESS;
 }
 
+int32_t VideoDecoderFlowUnit::GetOutWidth(
+    const std::shared_ptr<AVFrame> &frame) {
+  return out_width_ == 0 ? frame->width : out_width_;
+}
+
+int32_t VideoDecoderFlowUnit::GetOutHeight(
+    const std::shared_ptr<AVFrame> &frame) {
+  return out_height_ == 0 ? frame->height : out_height_;
+}
+
 modelbox::Status VideoDecoderFlowUnit::DataPre(
     std::shared_ptr<modelbox::DataContext> data_ctx) {
   auto in_meta = data_ctx->GetInputMeta(VIDEO_PACKET_INPUT);
@@ -316,6 +398,19 @@ MODELBOX_FLOWUNIT(VideoDecoderFlowUnit, desc) {
   }
   desc.AddFlowUnitOption(modelbox::FlowUnitOption(
       "pix_fmt", "list", true, "0", "the decoder pixel format", pix_fmt_list));
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "width", "int", false, "0", "the output width, 0 means source width"));
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "height", "int", false, "0", "the output height, 0 means source height"));
+
+  std::map<std::string, std::string> method_list;
+  for (auto &item : g_sws_scale_method) {
+    method_list[item.first] = item.first;
+  }
+
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "interpolation", "list", false, "inter_linear",
+      "the scale interpolation method", method_list));
 }
 
 MODELBOX_DRIVER_FLOWUNIT(desc) {
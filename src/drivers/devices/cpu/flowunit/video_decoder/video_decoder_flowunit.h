@@ -21,6 +21,7 @@
 #include <modelbox/base/status.h>
 #include <modelbox/flow.h>
 
+#include "ffmpeg_color_converter.h"
 #include "ffmpeg_video_decoder.h"
 #include "modelbox/flowunit.h"
 
@@ -57,7 +58,9 @@ constexpr const char *FLOWUNIT_DESC =
     "\t\tField Name: shape,         Type: vector<size_t>\n"
     "\t\tField Name: type,          Type: ModelBoxDataType::MODELBOX_UINT8\n"
     "\t@Constraint: The flowuint 'video_decoder' must be used pair "
-    "with 'video_demuxer. the output buffer meta fields 'pix_fmt' is 'brg_packed' or 'rgb_packed', 'layout' is 'hcw'.";
+    "with 'video_demuxer. the output buffer meta fields 'pix_fmt' is 'brg_packed' or 'rgb_packed', 'layout' is 'hcw'. "
+    "When 'width' and 'height' are configured, frame is scaled to this size "
+    "together with color conversion.";
 constexpr const char *CODEC_META = "codec_meta";
 constexpr const char *DECODER_CTX = "decoder_ctx";
 constexpr const char *CVT_CTX = "converter_ctx";
@@ -66,6 +69,7 @@ constexpr const char *VIDEO_PACKET_INPUT = "in_video_packet";
 constexpr const char *FRAME_INFO_OUTPUT = "out_video_frame";
 constexpr const char *SOURCE_URL_META = "source_url";
 constexpr const char *LAST_FRAME = "last_frame";
+constexpr const char *PACKET_PADDING_META = "padding_size";
 
 class VideoDecoderFlowUnit : public modelbox::FlowUnit {
  public:
@@ -97,15 +101,22 @@ class VideoDecoderFlowUnit : public modelbox::FlowUnit {
                             std::vector<std::shared_ptr<AVPacket>> &pkt);
   modelbox::Status ReadAVPacket(std::shared_ptr<modelbox::Buffer> packet_buffer,
                                 std::shared_ptr<AVPacket> &pkt);
+  AVBufferRef *RefBuffer(std::shared_ptr<modelbox::Buffer> &packet_buffer,
+                         uint8_t *data, size_t size);
   modelbox::Status BuildAVPacket(std::shared_ptr<AVPacket> &pkt, size_t size,
                                  uint8_t *data, int64_t pts, int64_t dts);
   modelbox::Status WriteData(std::shared_ptr<modelbox::DataContext> &ctx,
                              std::list<std::shared_ptr<AVFrame>> &frame_list,
                              bool eos);
+  int32_t GetOutWidth(const std::shared_ptr<AVFrame> &frame);
+  int32_t GetOutHeight(const std::shared_ptr<AVFrame> &frame);
 
  private:
   AVPixelFormat out_pix_fmt_{AV_PIX_FMT_NV12};
   std::string out_pix_fmt_str_;
+  int32_t out_width_{0};
+  int32_t out_height_{0};
+  int32_t sws_flags_{SWS_BILINEAR};
 };
 
 #endif  // MODELBOX_FLOWUNIT_VIDEO_DECODER_CPU_H_
@@ -15,6 +15,8 @@
  */
 
 
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <future>
@@ -43,13 +45,17 @@ class VideoDecoderFlowUnitTest : public testing::Test {
  public:
   std::shared_ptr<MockFlow> flow_;
 
-  void StartFlow(std::string& toml_content, const uint64_t millisecond);
+  void StartFlow(std::string& toml_content, const uint64_t millisecond,
+                 int32_t expect_width = 480, int32_t expect_height = 320);
 };
 
 void VideoDecoderFlowUnitTest::StartFlow(std::string& toml_content,
-                                         const uint64_t millisecond) {
+                                         const uint64_t millisecond,
+                                         int32_t expect_width,
+                                         int32_t expect_height) {
   flow_ = std::make_shared<MockFlow>();
-  auto ret = videodecoder::AddMockFlowUnit(flow_);
+  auto ret = videodecoder::AddMockFlowUnit(flow_, false, expect_width,
+                                           expect_height);
   EXPECT_EQ(ret, STATUS_SUCCESS);
 
   ret = flow_->BuildAndRun("VideoDecoder", toml_content, millisecond);
@@ -71,4 +77,80 @@ TEST_F(VideoDecoderFlowUnitTest, cpuDecoderBgrTest) {
   StartFlow(toml_content, 5 * 1000);
 }
 
+TEST_F(VideoDecoderFlowUnitTest, cpuDecoderResizeRgbTest) {
+  auto toml_content = videodecoder::GetTomlConfig(
+      "cpu", "rgb", ", width=240, height=160, interpolation=inter_area");
+  StartFlow(toml_content, 5 * 1000, 240, 160);
+}
+
+TEST_F(VideoDecoderFlowUnitTest, cpuDecoderResizeNv12Test) {
+  auto toml_content =
+      videodecoder::GetTomlConfig("cpu", "nv12", ", width=320, height=240");
+  StartFlow(toml_content, 5 * 1000, 320, 240);
+}
+
+TEST_F(VideoDecoderFlowUnitTest, cpuDecoderZeroCopyPacketTest) {
+  flow_ = std::make_shared<MockFlow>();
+  auto ret = videodecoder::AddMockFlowUnit(flow_, false);
+  EXPECT_EQ(ret, STATUS_SUCCESS);
+
+  // packet_check sits between demuxer and decoder, it checks each packet
+  // shares the padded ffmpeg payload and passes the same memory on
+  auto shared_packet_count = std::make_shared<std::atomic<size_t>>(0);
+  auto mock_desc =
+      GenerateFlowunitDesc("packet_check", {"in_packet"}, {"out_packet"});
+  mock_desc->SetFlowType(STREAM);
+  auto data_pre_func = [](std::shared_ptr<DataContext> data_ctx,
+                          std::shared_ptr<MockFlowUnit> mock_flowunit) {
+    data_ctx->SetOutputMeta("out_packet", data_ctx->GetInputMeta("in_packet"));
+    return modelbox::STATUS_OK;
+  };
+  auto process_func = [shared_packet_count](
+                          std::shared_ptr<DataContext> data_ctx,
+                          std::shared_ptr<MockFlowUnit> mock_flowunit) {
+    auto input = data_ctx->Input("in_packet");
+    auto output = data_ctx->Output("out_packet");
+    for (auto& packet : *input) {
+      output->PushBack(packet);
+      int32_t padding_size = 0;
+      if (!packet->Get("padding_size", padding_size)) {
+        continue;
+      }
+
+      EXPECT_GT(padding_size, 0);
+      const auto* data = static_cast<const uint8_t*>(packet->ConstData());
+      const std::vector<uint8_t> zero_padding(padding_size, 0);
+      EXPECT_EQ(memcmp(data + packet->GetBytes(), zero_padding.data(),
+                       padding_size),
+                0);
+      EXPECT_EQ(output->At(output->Size() - 1)->ConstData(), data);
+      ++(*shared_packet_count);
+    }
+
+    return modelbox::STATUS_OK;
+  };
+  auto mock_functions = std::make_shared<MockFunctionCollection>();
+  mock_functions->RegisterDataPreFunc(data_pre_func);
+  mock_functions->RegisterProcessFunc(process_func);
+  flow_->AddFlowUnitDesc(mock_desc, mock_functions->GenerateCreateFunc(),
+                         TEST_DRIVER_DIR);
+
+  auto toml_content = videodecoder::GetTomlConfig("cpu", "nv12");
+  const std::string demuxer_to_decoder =
+      "videodemuxer:out_video_packet -> videodecoder:in_video_packet";
+  auto pos = toml_content.find(demuxer_to_decoder);
+  ASSERT_NE(pos, std::string::npos);
+  toml_content.replace(
+      pos, demuxer_to_decoder.size(),
+      "packet_check[type=flowunit, flowunit=packet_check, device=cpu, "
+      "deviceid=0, label=\"<in_packet> | <out_packet>\"]\n"
+      "            videodemuxer:out_video_packet -> packet_check:in_packet\n"
+      "            packet_check:out_packet -> videodecoder:in_video_packet");
+
+  // read_frame checks every decoded frame of the shared packets
+  ret = flow_->BuildAndRun("VideoDecoder", toml_content, 5 * 1000);
+  EXPECT_EQ(ret, STATUS_SUCCESS);
+  EXPECT_GT(*shared_packet_count, 0);
+}
+
 }  // namespace modelbox
\ No newline at end of file
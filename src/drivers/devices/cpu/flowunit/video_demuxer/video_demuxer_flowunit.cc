@@ -105,9 +105,30 @@ modelbox::Status VideoDemuxerFlowUnit::WriteData(
     std::shared_ptr<FfmpegVideoDemuxer> video_demuxer) {
   auto video_packet_output = ctx->Output(VIDEO_PACKET_OUTPUT);
   std::vector<size_t> shape(1, (size_t)pkt->size);
+  bool shared_payload = false;
   if (pkt->size == 0) {
     // Tell decoder end of stream
     video_packet_output->Build({1});
+  } else if (pkt->buf != nullptr) {
+    // Buffer takes a reference of the packet payload, no copy is needed and
+    // the packet itself could be released right now
+    auto *buf_ref_ptr = av_buffer_ref(pkt->buf);
+    if (buf_ref_ptr == nullptr) {
+      MBLOG_ERROR << "reference av packet buffer failed";
+      return STATUS_NOMEM;
+    }
+
+    std::shared_ptr<AVBufferRef> buf_ref(
+        buf_ref_ptr, [](AVBufferRef *ref) { av_buffer_unref(&ref); });
+    auto ret = video_packet_output->BuildFromHost(
+        shape, pkt->data, pkt->size,
+        [buf_ref](void *ptr) { /* Only capture buf_ref */ });
+    if (!ret) {
+      MBLOG_ERROR << "build video packet buffer failed, " << ret;
+      return ret;
+    }
+
+    shared_payload = true;
   } else {
     video_packet_output->BuildFromHost(
         shape, pkt->data, pkt->size,
@@ -115,6 +136,12 @@ modelbox::Status VideoDemuxerFlowUnit::WriteData(
   }
 
   auto packet_buffer = video_packet_output->At(0);
+  if (shared_payload) {
+    // Payload in AVBufferRef is always padded, decoder could use it directly
+    packet_buffer->Set(PACKET_PADDING_META,
+                       (int32_t)AV_INPUT_BUFFER_PADDING_SIZE);
+  }
+
   packet_buffer->Set("pts", pkt->pts);
   packet_buffer->Set("dts", pkt->dts);
   packet_buffer->Set("time_base", video_demuxer->GetTimeBase());
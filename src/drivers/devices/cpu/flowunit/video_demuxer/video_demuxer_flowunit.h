@@ -51,6 +51,7 @@ constexpr const char *STREAM_META_INPUT = "in_video_url";
 constexpr const char *VIDEO_PACKET_OUTPUT = "out_video_packet";
 constexpr const char *DEMUX_RETRY_CONTEXT = "source_context";
 constexpr const char *DEMUX_TIMER_TASK = "demux_timer_task";
+constexpr const char *PACKET_PADDING_META = "padding_size";
 
 enum DemuxStatus { DEMUX_FAIL = 0, DEMUX_SUCCESS = 1 };
 
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ffmpeg_async_video_muxer.h"
+
+#include <modelbox/base/log.h>
+#include <modelbox/base/os.h>
+
+using namespace modelbox;
+
+FfmpegAsyncVideoMuxer::FfmpegAsyncVideoMuxer(
+    std::shared_ptr<FfmpegVideoMuxer> muxer, size_t queue_size,
+    MuxDropPolicy drop_policy)
+    : muxer_(std::move(muxer)),
+      mux_queue_(queue_size),
+      drop_policy_(drop_policy) {}
+
+FfmpegAsyncVideoMuxer::~FfmpegAsyncVideoMuxer() { Stop(); }
+
+Status FfmpegAsyncVideoMuxer::Start() {
+  if (muxer_ == nullptr) {
+    MBLOG_ERROR << "Muxer is null";
+    return STATUS_INVALID;
+  }
+
+  mux_thread_ =
+      std::make_shared<std::thread>(&FfmpegAsyncVideoMuxer::MuxWorker, this);
+  return STATUS_SUCCESS;
+}
+
+Status FfmpegAsyncVideoMuxer::Mux(const AVRational &time_base,
+                                  const std::shared_ptr<AVPacket> &av_packet) {
+  if (mux_failed_) {
+    return STATUS_FAULT;
+  }
+
+  bool is_key_frame = av_packet->flags & AV_PKT_FLAG_KEY;
+  if (wait_key_frame_ && !is_key_frame) {
+    DropPacket();
+    return STATUS_SUCCESS;
+  }
+
+  MuxItem item{time_base, av_packet};
+  if (drop_policy_ == MuxDropPolicy::BLOCK) {
+    if (!mux_queue_.Push(item)) {
+      MBLOG_ERROR << "Push packet to mux queue failed";
+      return STATUS_FAULT;
+    }
+
+    return STATUS_SUCCESS;
+  }
+
+  // Rest of the gop is useless when one of it is dropped, so skip to next key
+  // frame to keep destination decodable.
+  wait_key_frame_ = !mux_queue_.Push(item, -1);
+  if (wait_key_frame_) {
+    DropPacket();
+    MBLOG_DEBUG << "Mux queue is full, drop packets until next key frame";
+  }
+
+  return STATUS_SUCCESS;
+}
+
+void FfmpegAsyncVideoMuxer::DropPacket() {
+  ++dropped_packet_count_;
+  if (drop_counter_ != nullptr) {
+    drop_counter_->Increase();
+  }
+}
+
+void FfmpegAsyncVideoMuxer::Stop() {
+  if (mux_thread_ == nullptr) {
+    return;
+  }
+
+  // queued packets are still popped after shutdown
+  mux_queue_.Shutdown();
+  mux_thread_->join();
+  mux_thread_ = nullptr;
+  if (dropped_packet_count_ > 0) {
+    MBLOG_INFO << "Mux finished, dropped packet count "
+               << dropped_packet_count_;
+  }
+}
+
+void FfmpegAsyncVideoMuxer::MuxWorker() {
+  os->Thread->SetName("Video-Muxer");
+  MuxItem item;
+  while (mux_queue_.Pop(&item)) {
+    if (mux_failed_) {
+      continue;
+    }
+
+    auto ret = muxer_->Mux(item.time_base, item.packet);
+    if (ret != STATUS_SUCCESS) {
+      MBLOG_ERROR << "Muxer mux packet failed";
+      mux_failed_ = true;
+    }
+  }
+}
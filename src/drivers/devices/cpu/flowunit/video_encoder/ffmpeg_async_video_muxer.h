@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODELBOX_FLOWUNIT_FFMPEG_ASYNC_MUXER_H_
+#define MODELBOX_FLOWUNIT_FFMPEG_ASYNC_MUXER_H_
+
+#include <modelbox/base/blocking_queue.h>
+#include <modelbox/base/status.h>
+#include <modelbox/statistics_metric.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "ffmpeg_video_muxer.h"
+
+enum class MuxDropPolicy {
+  /// block encoder when mux queue is full
+  BLOCK = 0,
+  /// drop packets until next key frame when mux queue is full
+  DROP_GOP = 1,
+};
+
+/**
+ * @brief Mux packets in a dedicated thread, so network writing of the
+ * destination does not block encoding.
+ */
+class FfmpegAsyncVideoMuxer {
+ public:
+  FfmpegAsyncVideoMuxer(std::shared_ptr<FfmpegVideoMuxer> muxer,
+                        size_t queue_size, MuxDropPolicy drop_policy);
+
+  virtual ~FfmpegAsyncVideoMuxer();
+
+  modelbox::Status Start();
+
+  /**
+   * @brief Queue packet to mux thread
+   * @param time_base time base of packet
+   * @param av_packet packet to mux
+   * @return STATUS_SUCCESS when packet is queued or dropped by policy, error
+   * when mux thread failed.
+   */
+  modelbox::Status Mux(const AVRational &time_base,
+                       const std::shared_ptr<AVPacket> &av_packet);
+
+  /**
+   * @brief Mux all queued packets and stop mux thread
+   */
+  void Stop();
+
+  uint64_t GetDroppedPacketCount() { return dropped_packet_count_; }
+
+  /**
+   * @brief Set counter shared by streams, increased for each dropped packet
+   * @param counter drop counter, must be set before Start
+   */
+  void SetDropCounter(std::shared_ptr<modelbox::StatisticsCounter> counter) {
+    drop_counter_ = std::move(counter);
+  }
+
+ private:
+  struct MuxItem {
+    AVRational time_base;
+    std::shared_ptr<AVPacket> packet;
+  };
+
+  void MuxWorker();
+
+  void DropPacket();
+
+  std::shared_ptr<FfmpegVideoMuxer> muxer_;
+  modelbox::BlockingQueue<MuxItem> mux_queue_;
+  MuxDropPolicy drop_policy_{MuxDropPolicy::BLOCK};
+  bool wait_key_frame_{false};
+  std::atomic<uint64_t> dropped_packet_count_{0};
+  std::shared_ptr<modelbox::StatisticsCounter> drop_counter_;
+  std::atomic<bool> mux_failed_{false};
+  std::shared_ptr<std::thread> mux_thread_;
+};
+
+#endif  // MODELBOX_FLOWUNIT_FFMPEG_ASYNC_MUXER_H_
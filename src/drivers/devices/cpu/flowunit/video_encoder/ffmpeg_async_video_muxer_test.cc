@@ -0,0 +1,140 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ffmpeg_async_video_muxer.h"
+
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace modelbox {
+
+/**
+ * @brief Muxer records packets and blocks until released, like a slow
+ * network destination
+ */
+class BlockingVideoMuxer : public FfmpegVideoMuxer {
+ public:
+  Status Mux(const AVRational &time_base,
+             const std::shared_ptr<AVPacket> &av_packet) override {
+    std::unique_lock<std::mutex> lock(lock_);
+    muxed_.push_back(av_packet->pts);
+    cv_.notify_all();
+    cv_.wait(lock, [this]() { return released_; });
+    return STATUS_SUCCESS;
+  }
+
+  void Release() {
+    std::lock_guard<std::mutex> lock(lock_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+  void WaitMuxed(size_t count) {
+    std::unique_lock<std::mutex> lock(lock_);
+    cv_.wait(lock, [this, count]() { return muxed_.size() >= count; });
+  }
+
+  std::vector<int64_t> GetMuxed() {
+    std::lock_guard<std::mutex> lock(lock_);
+    return muxed_;
+  }
+
+ private:
+  std::mutex lock_;
+  std::condition_variable cv_;
+  bool released_{false};
+  std::vector<int64_t> muxed_;
+};
+
+class FfmpegAsyncVideoMuxerTest : public testing::Test {
+ protected:
+  std::shared_ptr<AVPacket> MakePacket(int64_t pts, bool key_frame) {
+    std::shared_ptr<AVPacket> packet(av_packet_alloc(), [](AVPacket *pkt) {
+      av_packet_free(&pkt);
+    });
+    packet->pts = pts;
+    packet->flags = key_frame ? AV_PKT_FLAG_KEY : 0;
+    return packet;
+  }
+
+  AVRational time_base_{1, 25};
+};
+
+TEST_F(FfmpegAsyncVideoMuxerTest, BlockWhenQueueFull) {
+  auto muxer = std::make_shared<BlockingVideoMuxer>();
+  FfmpegAsyncVideoMuxer async_muxer(muxer, 2, MuxDropPolicy::BLOCK);
+  ASSERT_EQ(async_muxer.Start(), STATUS_SUCCESS);
+
+  // first packet is held in mux thread, the next two fill the queue
+  ASSERT_EQ(async_muxer.Mux(time_base_, MakePacket(0, true)), STATUS_SUCCESS);
+  muxer->WaitMuxed(1);
+  ASSERT_EQ(async_muxer.Mux(time_base_, MakePacket(1, false)), STATUS_SUCCESS);
+  ASSERT_EQ(async_muxer.Mux(time_base_, MakePacket(2, false)), STATUS_SUCCESS);
+
+  auto blocked_mux = std::async(std::launch::async, [&]() {
+    return async_muxer.Mux(time_base_, MakePacket(3, false));
+  });
+  EXPECT_EQ(blocked_mux.wait_for(std::chrono::milliseconds(100)),
+            std::future_status::timeout);
+
+  muxer->Release();
+  EXPECT_EQ(blocked_mux.get(), STATUS_SUCCESS);
+  async_muxer.Stop();
+  EXPECT_EQ(muxer->GetMuxed(), std::vector<int64_t>({0, 1, 2, 3}));
+  EXPECT_EQ(async_muxer.GetDroppedPacketCount(), 0);
+}
+
+TEST_F(FfmpegAsyncVideoMuxerTest, DropGopWhenQueueFull) {
+  auto muxer = std::make_shared<BlockingVideoMuxer>();
+  auto counter = std::make_shared<StatisticsCounter>();
+  counter->Increase(10);
+  FfmpegAsyncVideoMuxer async_muxer(muxer, 1, MuxDropPolicy::DROP_GOP);
+  async_muxer.SetDropCounter(counter);
+  ASSERT_EQ(async_muxer.Start(), STATUS_SUCCESS);
+
+  ASSERT_EQ(async_muxer.Mux(time_base_, MakePacket(0, true)), STATUS_SUCCESS);
+  muxer->WaitMuxed(1);
+  ASSERT_EQ(async_muxer.Mux(time_base_, MakePacket(1, false)), STATUS_SUCCESS);
+
+  // queue is full, the rest of gop is dropped, including the key frame
+  // which still finds queue full
+  ASSERT_EQ(async_muxer.Mux(time_base_, MakePacket(2, false)), STATUS_SUCCESS);
+  ASSERT_EQ(async_muxer.Mux(time_base_, MakePacket(3, false)), STATUS_SUCCESS);
+  ASSERT_EQ(async_muxer.Mux(time_base_, MakePacket(4, true)), STATUS_SUCCESS);
+  EXPECT_EQ(async_muxer.GetDroppedPacketCount(), 3);
+
+  muxer->Release();
+  muxer->WaitMuxed(2);
+
+  // non key frame is still dropped until next key frame
+  ASSERT_EQ(async_muxer.Mux(time_base_, MakePacket(5, false)), STATUS_SUCCESS);
+  ASSERT_EQ(async_muxer.Mux(time_base_, MakePacket(6, true)), STATUS_SUCCESS);
+  muxer->WaitMuxed(3);
+  ASSERT_EQ(async_muxer.Mux(time_base_, MakePacket(7, false)), STATUS_SUCCESS);
+  async_muxer.Stop();
+
+  EXPECT_EQ(muxer->GetMuxed(), std::vector<int64_t>({0, 1, 6, 7}));
+  EXPECT_EQ(async_muxer.GetDroppedPacketCount(), 4);
+  // counter is shared with other streams, drops are added to it
+  EXPECT_EQ(counter->Get(), 14);
+}
+
+}  // namespace modelbox
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ffmpeg_frame_pool.h"
+
+#include <modelbox/base/log.h>
+
+#include "video_decode_common.h"
+
+extern "C" {
+#include <libavutil/imgutils.h>
+}
+
+using namespace modelbox;
+
+FfmpegFramePool::FfmpegFramePool() = default;
+
+FfmpegFramePool::~FfmpegFramePool() {
+  std::lock_guard<std::mutex> lock(frame_list_lock_);
+  for (auto *frame : frame_list_) {
+    av_frame_free(&frame);
+  }
+
+  frame_list_.clear();
+}
+
+Status FfmpegFramePool::Init(int32_t width, int32_t height,
+                             AVPixelFormat pix_fmt, size_t max_cached_frame) {
+  auto size = av_image_get_buffer_size(pix_fmt, width, height, 1);
+  if (size <= 0) {
+    GET_FFMPEG_ERR(size, ffmpeg_err);
+    MBLOG_ERROR << "Get image buffer size failed, width " << width
+                << ", height " << height << ", err " << ffmpeg_err;
+    return STATUS_FAULT;
+  }
+
+  auto *buffer_pool = av_buffer_pool_init(size, av_buffer_alloc);
+  if (buffer_pool == nullptr) {
+    MBLOG_ERROR << "Init av buffer pool failed, size " << size;
+    return STATUS_NOMEM;
+  }
+
+  // buffers still in use keep the pool alive after uninit
+  buffer_pool_.reset(buffer_pool,
+                     [](AVBufferPool *pool) { av_buffer_pool_uninit(&pool); });
+  width_ = width;
+  height_ = height;
+  pix_fmt_ = pix_fmt;
+  max_cached_frame_ = max_cached_frame;
+  return STATUS_SUCCESS;
+}
+
+std::shared_ptr<AVFrame> FfmpegFramePool::Get() {
+  AVFrame *frame = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(frame_list_lock_);
+    if (!frame_list_.empty()) {
+      frame = frame_list_.front();
+      frame_list_.pop_front();
+    }
+  }
+
+  if (frame == nullptr) {
+    frame = av_frame_alloc();
+    if (frame == nullptr) {
+      MBLOG_ERROR << "Alloc frame failed";
+      return nullptr;
+    }
+  }
+
+  // Buffer returns to pool only when encoder drops its reference as well, so
+  // the data got here is never shared with a pending encode.
+  frame->buf[0] = av_buffer_pool_get(buffer_pool_.get());
+  if (frame->buf[0] == nullptr) {
+    MBLOG_ERROR << "Get buffer from pool failed";
+    av_frame_free(&frame);
+    return nullptr;
+  }
+
+  auto ret = av_image_fill_arrays(frame->data, frame->linesize,
+                                  frame->buf[0]->data, pix_fmt_, width_,
+                                  height_, 1);
+  if (ret < 0) {
+    GET_FFMPEG_ERR(ret, ffmpeg_err);
+    MBLOG_ERROR << "av_image_fill_arrays failed, err " << ffmpeg_err;
+    av_frame_free(&frame);
+    return nullptr;
+  }
+
+  frame->width = width_;
+  frame->height = height_;
+  frame->format = pix_fmt_;
+  std::weak_ptr<FfmpegFramePool> pool_ref = shared_from_this();
+  return std::shared_ptr<AVFrame>(frame, [pool_ref](AVFrame *frame) {
+    auto pool = pool_ref.lock();
+    if (pool == nullptr) {
+      av_frame_free(&frame);
+      return;
+    }
+
+    pool->Put(frame);
+  });
+}
+
+void FfmpegFramePool::Put(AVFrame *frame) {
+  av_frame_unref(frame);
+  std::lock_guard<std::mutex> lock(frame_list_lock_);
+  if (frame_list_.size() >= max_cached_frame_) {
+    av_frame_free(&frame);
+    return;
+  }
+
+  frame_list_.push_back(frame);
+}
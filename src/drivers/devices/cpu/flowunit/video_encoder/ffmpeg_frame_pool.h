@@ -0,0 +1,68 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODELBOX_FLOWUNIT_FFMPEG_FRAME_POOL_H_
+#define MODELBOX_FLOWUNIT_FFMPEG_FRAME_POOL_H_
+
+#include <modelbox/base/status.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+/**
+ * @brief Pool of frames with fixed size and pixel format, frame data is
+ * allocated once as a single contiguous plane block and reused after the
+ * encoder and the caller release all references of it.
+ */
+class FfmpegFramePool : public std::enable_shared_from_this<FfmpegFramePool> {
+ public:
+  FfmpegFramePool();
+
+  virtual ~FfmpegFramePool();
+
+  modelbox::Status Init(int32_t width, int32_t height, AVPixelFormat pix_fmt,
+                        size_t max_cached_frame);
+
+  /**
+   * @brief Get a writable frame from pool
+   * @return frame with data planes allocated, nullptr when failed
+   */
+  std::shared_ptr<AVFrame> Get();
+
+  int32_t GetWidth() { return width_; }
+
+  int32_t GetHeight() { return height_; }
+
+ private:
+  void Put(AVFrame *frame);
+
+  int32_t width_{0};
+  int32_t height_{0};
+  AVPixelFormat pix_fmt_{AV_PIX_FMT_NONE};
+  size_t max_cached_frame_{0};
+  std::shared_ptr<AVBufferPool> buffer_pool_;
+  std::mutex frame_list_lock_;
+  std::list<AVFrame *> frame_list_;
+};
+
+#endif  // MODELBOX_FLOWUNIT_FFMPEG_FRAME_POOL_H_
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ffmpeg_frame_pool.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace modelbox {
+class FfmpegFramePoolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    pool_ = std::make_shared<FfmpegFramePool>();
+    auto ret = pool_->Init(64, 48, AV_PIX_FMT_YUV420P, 2);
+    ASSERT_EQ(ret, STATUS_SUCCESS);
+  };
+
+  std::shared_ptr<FfmpegFramePool> pool_;
+};
+
+TEST_F(FfmpegFramePoolTest, ReuseFrame) {
+  auto frame = pool_->Get();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(frame->width, 64);
+  EXPECT_EQ(frame->height, 48);
+  EXPECT_EQ(frame->format, AV_PIX_FMT_YUV420P);
+  EXPECT_EQ(frame->data[1], frame->data[0] + 64 * 48);
+  auto *frame_ptr = frame.get();
+  auto *data = frame->data[0];
+
+  // frame and buffer released by caller are got again
+  frame = nullptr;
+  frame = pool_->Get();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(frame.get(), frame_ptr);
+  EXPECT_EQ(frame->data[0], data);
+
+  // frame in use is never returned twice
+  auto other_frame = pool_->Get();
+  ASSERT_NE(other_frame, nullptr);
+  EXPECT_NE(other_frame.get(), frame.get());
+  EXPECT_NE(other_frame->data[0], frame->data[0]);
+}
+
+TEST_F(FfmpegFramePoolTest, BufferHeldByEncoder) {
+  auto frame = pool_->Get();
+  ASSERT_NE(frame, nullptr);
+  auto *data = frame->data[0];
+
+  // encoder keeps a reference of frame data after caller releases it
+  auto *encoder_ref = av_frame_alloc();
+  ASSERT_NE(encoder_ref, nullptr);
+  ASSERT_EQ(av_frame_ref(encoder_ref, frame.get()), 0);
+  frame = nullptr;
+
+  frame = pool_->Get();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_NE(frame->data[0], data);
+
+  // data returns to pool when encoder drops it
+  av_frame_free(&encoder_ref);
+  auto next_frame = pool_->Get();
+  ASSERT_NE(next_frame, nullptr);
+  EXPECT_EQ(next_frame->data[0], data);
+}
+
+TEST_F(FfmpegFramePoolTest, ReleaseAfterPool) {
+  auto frame = pool_->Get();
+  ASSERT_NE(frame, nullptr);
+  pool_ = nullptr;
+  memset(frame->data[0], 0, 64 * 48);
+  frame = nullptr;
+}
+
+TEST_F(FfmpegFramePoolTest, InitFailed) {
+  auto pool = std::make_shared<FfmpegFramePool>();
+  EXPECT_NE(pool->Init(0, 0, AV_PIX_FMT_YUV420P, 2), STATUS_SUCCESS);
+}
+
+}  // namespace modelbox
@@ -28,8 +28,8 @@ class FfmpegVideoMuxer {
   modelbox::Status Init(const std::shared_ptr<AVCodecContext> &codec_ctx,
                       std::shared_ptr<FfmpegWriter> writer);
 
-  modelbox::Status Mux(const AVRational &time_base,
-                     const std::shared_ptr<AVPacket> &av_packet);
+  virtual modelbox::Status Mux(const AVRational &time_base,
+                               const std::shared_ptr<AVPacket> &av_packet);
 
   virtual ~FfmpegVideoMuxer();
  private:
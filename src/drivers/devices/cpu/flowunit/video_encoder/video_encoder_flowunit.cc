@@ -25,6 +25,9 @@ VideoEncoderFlowUnit::VideoEncoderFlowUnit(){};
 VideoEncoderFlowUnit::~VideoEncoderFlowUnit(){};
 
 const std::set<std::string> g_supported_fmt = {"rtsp", "flv", "mp4"};
+const std::set<std::string> g_live_fmt = {"rtsp", "flv"};
+constexpr size_t DEFAULT_MUX_QUEUE_SIZE = 64;
+constexpr size_t FRAME_POOL_CACHED_SIZE = 8;
 
 modelbox::Status VideoEncoderFlowUnit::Open(
     const std::shared_ptr<modelbox::Configuration> &opts) {
@@ -39,6 +42,29 @@ modelbox::Status VideoEncoderFlowUnit::Open(
   }
 
   encoder_name_ = opts->GetString("encoder", "mpeg4");
+  mux_queue_size_ = opts->GetUint64("mux_queue_size", DEFAULT_MUX_QUEUE_SIZE);
+  if (mux_queue_size_ == 0) {
+    MBLOG_ERROR << "mux_queue_size must be greater than 0";
+    return STATUS_BADCONF;
+  }
+
+  auto drop_policy = opts->GetString("mux_drop_policy", "");
+  if (drop_policy.empty()) {
+    // live stream prefers dropping to falling behind, file output keeps all
+    auto is_live = g_live_fmt.find(format_name_) != g_live_fmt.end();
+    drop_policy = is_live ? "drop_gop" : "block";
+  }
+
+  if (drop_policy == "drop_gop") {
+    mux_drop_policy_ = MuxDropPolicy::DROP_GOP;
+  } else if (drop_policy == "block") {
+    mux_drop_policy_ = MuxDropPolicy::BLOCK;
+  } else {
+    MBLOG_ERROR << "Bad value [" << drop_policy
+                << "] for mux_drop_policy, must be one of [block|drop_gop]";
+    return STATUS_BADCONF;
+  }
+
   return STATUS_OK;
 }
 
@@ -46,8 +72,8 @@ modelbox::Status VideoEncoderFlowUnit::Close() { return modelbox::STATUS_OK; }
 
 modelbox::Status VideoEncoderFlowUnit::Process(
     std::shared_ptr<modelbox::DataContext> ctx) {
-  auto muxer =
-      std::static_pointer_cast<FfmpegVideoMuxer>(ctx->GetPrivate(MUXER_CTX));
+  auto muxer = std::static_pointer_cast<FfmpegAsyncVideoMuxer>(
+      ctx->GetPrivate(MUXER_CTX));
   auto encoder = std::static_pointer_cast<FfmpegVideoEncoder>(
       ctx->GetPrivate(ENCODER_CTX));
   auto color_cvt = std::static_pointer_cast<FfmpegColorConverter>(
@@ -92,6 +118,8 @@ modelbox::Status VideoEncoderFlowUnit::ReadFrames(
 
   auto frame_index_ptr =
       std::static_pointer_cast<int64_t>(ctx->GetPrivate(FRAME_INDEX_CTX));
+  auto frame_pool =
+      std::static_pointer_cast<FfmpegFramePool>(ctx->GetPrivate(FRAME_POOL_CTX));
   for (auto frame_buffer : *frame_buffer_list) {
     std::shared_ptr<AVFrame> av_frame;
     auto ret = ReadFrameFromBuffer(frame_buffer, av_frame);
@@ -103,7 +131,7 @@ modelbox::Status VideoEncoderFlowUnit::ReadFrames(
     }
 
     std::shared_ptr<AVFrame> yuv420p_frame;
-    ret = CvtFrameToYUV420P(color_cvt, av_frame, yuv420p_frame);
+    ret = CvtFrameToYUV420P(color_cvt, frame_pool, av_frame, yuv420p_frame);
     if (ret != STATUS_SUCCESS) {
       MBLOG_ERROR << "Convert frame to yuv420p failed";
       return ret;
@@ -150,6 +178,32 @@ modelbox::Status VideoEncoderFlowUnit::ReadFrameFromBuffer(
 
 modelbox::Status VideoEncoderFlowUnit::CvtFrameToYUV420P(
     std::shared_ptr<FfmpegColorConverter> color_cvt,
+    std::shared_ptr<FfmpegFramePool> frame_pool,
+    std::shared_ptr<AVFrame> origin, std::shared_ptr<AVFrame> &yuv420p_frame) {
+  if (frame_pool != nullptr && frame_pool->GetWidth() == origin->width &&
+      frame_pool->GetHeight() == origin->height) {
+    yuv420p_frame = frame_pool->Get();
+  }
+
+  if (yuv420p_frame == nullptr) {
+    auto ret = AllocYUV420PFrame(origin, yuv420p_frame);
+    if (ret != STATUS_SUCCESS) {
+      return ret;
+    }
+  }
+
+  yuv420p_frame->pts = origin->pts;
+  auto ret = color_cvt->CvtColor(origin, yuv420p_frame->data[0],
+                                 AVPixelFormat::AV_PIX_FMT_YUV420P);
+  if (ret != STATUS_SUCCESS) {
+    MBLOG_ERROR << "Conver color failed";
+    return ret;
+  }
+
+  return STATUS_SUCCESS;
+}
+
+modelbox::Status VideoEncoderFlowUnit::AllocYUV420PFrame(
     std::shared_ptr<AVFrame> origin, std::shared_ptr<AVFrame> &yuv420p_frame) {
   auto frame = av_frame_alloc();
   if (frame == nullptr) {
@@ -175,13 +229,6 @@ modelbox::Status VideoEncoderFlowUnit::CvtFrameToYUV420P(
     return STATUS_FAULT;
   }
 
-  auto ret = color_cvt->CvtColor(origin, yuv420p_frame->data[0],
-                                 AVPixelFormat::AV_PIX_FMT_YUV420P);
-  if (ret != STATUS_SUCCESS) {
-    MBLOG_ERROR << "Conver color failed";
-    return ret;
-  }
-
   return STATUS_SUCCESS;
 }
 
@@ -201,7 +248,8 @@ modelbox::Status VideoEncoderFlowUnit::EncodeFrame(
 }
 
 modelbox::Status VideoEncoderFlowUnit::MuxPacket(
-    const std::shared_ptr<FfmpegVideoMuxer> &muxer, const AVRational &time_base,
+    const std::shared_ptr<FfmpegAsyncVideoMuxer> &muxer,
+    const AVRational &time_base,
     std::vector<std::shared_ptr<AVPacket>> &av_packet_list) {
   for (auto packet : av_packet_list) {
     auto ret = muxer->Mux(time_base, packet);
@@ -270,9 +318,35 @@ modelbox::Status VideoEncoderFlowUnit::DataPre(
     return STATUS_FAULT;
   }
 
+  auto async_muxer = std::make_shared<FfmpegAsyncVideoMuxer>(
+      muxer, mux_queue_size_, mux_drop_policy_);
+  auto stats = data_ctx->GetStatistics();
+  if (stats != nullptr) {
+    // shared by all streams of this node, returns the existing counter
+    auto drop_item = stats->AddCounter("mux_dropped_packets");
+    if (drop_item != nullptr) {
+      async_muxer->SetDropCounter(drop_item->GetCounter());
+    }
+  }
+
+  ret = async_muxer->Start();
+  if (ret != modelbox::STATUS_SUCCESS) {
+    MBLOG_ERROR << "Start async muxer failed";
+    return STATUS_FAULT;
+  }
+
+  auto frame_pool = std::make_shared<FfmpegFramePool>();
+  ret = frame_pool->Init(width, height, AVPixelFormat::AV_PIX_FMT_YUV420P,
+                         FRAME_POOL_CACHED_SIZE);
+  if (ret != modelbox::STATUS_SUCCESS) {
+    MBLOG_ERROR << "Init frame pool failed";
+    return STATUS_FAULT;
+  }
+
   auto color_cvt = std::make_shared<FfmpegColorConverter>();
 
-  data_ctx->SetPrivate(MUXER_CTX, muxer);
+  data_ctx->SetPrivate(MUXER_CTX, async_muxer);
+  data_ctx->SetPrivate(FRAME_POOL_CTX, frame_pool);
   data_ctx->SetPrivate(ENCODER_CTX, encoder);
   data_ctx->SetPrivate(COLOR_CVT_CTX, color_cvt);
   auto frame_index_ptr = std::make_shared<int64_t>(0);
@@ -311,6 +385,13 @@ modelbox::Status VideoEncoderFlowUnit::GetDestUrl(
 
 modelbox::Status VideoEncoderFlowUnit::DataPost(
     std::shared_ptr<modelbox::DataContext> data_ctx) {
+  auto muxer = std::static_pointer_cast<FfmpegAsyncVideoMuxer>(
+      data_ctx->GetPrivate(MUXER_CTX));
+  if (muxer == nullptr) {
+    return STATUS_OK;
+  }
+
+  muxer->Stop();
   return STATUS_OK;
 }
 
@@ -333,6 +414,19 @@ MODELBOX_FLOWUNIT(VideoEncoderFlowUnit, desc) {
       "format", "list", true, "rtsp", "the encoder format", fmt_list));
   desc.AddFlowUnitOption(modelbox::FlowUnitOption(
       "encoder", "string", true, "mpeg4", "the encoder method"));
+  desc.AddFlowUnitOption(
+      modelbox::FlowUnitOption("mux_queue_size", "int", false,
+                               std::to_string(DEFAULT_MUX_QUEUE_SIZE),
+                               "the max packets waiting for muxing"));
+  std::string live_fmt_list;
+  for (auto &item : g_live_fmt) {
+    live_fmt_list += live_fmt_list.empty() ? item : "|" + item;
+  }
+  desc.AddFlowUnitOption(modelbox::FlowUnitOption(
+      "mux_drop_policy", "list", false, "",
+      "the policy when mux queue is full, empty to choose by format: drop_gop "
+      "for " + live_fmt_list + ", block for others",
+      {{"block", "block"}, {"drop_gop", "drop_gop"}}));
 }
 
 MODELBOX_DRIVER_FLOWUNIT(desc) {
@@ -22,6 +22,8 @@
 #include <modelbox/flow.h>
 
 #include <vector>
+#include "ffmpeg_async_video_muxer.h"
+#include "ffmpeg_frame_pool.h"
 #include "ffmpeg_video_encoder.h"
 #include "ffmpeg_video_muxer.h"
 #include "ffmpeg_writer.h"
@@ -50,6 +52,7 @@ constexpr const char *COLOR_CVT_CTX = "color_cvt_ctx";
 constexpr const char *FRAME_INDEX_CTX = "frame_index_ctx";
 constexpr const char *ENCODER_CTX = "encoder_ctx";
 constexpr const char *MUXER_CTX = "muxer_ctx";
+constexpr const char *FRAME_POOL_CTX = "frame_pool_ctx";
 constexpr const char *FORMAT_NAME = "format_name";
 constexpr const char *CODEC_NAME = "codec_name";
 constexpr const char *DESTINATION_URL = "destination_url";
@@ -95,21 +98,27 @@ class VideoEncoderFlowUnit : public modelbox::FlowUnit {
 
   modelbox::Status CvtFrameToYUV420P(
       std::shared_ptr<FfmpegColorConverter> color_cvt,
+      std::shared_ptr<FfmpegFramePool> frame_pool,
       std::shared_ptr<AVFrame> origin, std::shared_ptr<AVFrame> &yuv420p_frame);
 
+  modelbox::Status AllocYUV420PFrame(std::shared_ptr<AVFrame> origin,
+                                     std::shared_ptr<AVFrame> &yuv420p_frame);
+
   modelbox::Status EncodeFrame(
       const std::shared_ptr<FfmpegVideoEncoder> &encoder,
       const std::vector<std::shared_ptr<AVFrame>> &av_frame_list,
       std::vector<std::shared_ptr<AVPacket>> &av_packet_list);
 
   modelbox::Status MuxPacket(
-      const std::shared_ptr<FfmpegVideoMuxer> &muxer,
+      const std::shared_ptr<FfmpegAsyncVideoMuxer> &muxer,
       const AVRational &time_base,
       std::vector<std::shared_ptr<AVPacket>> &av_packet_list);
 
   std::string default_dest_url_;
   std::string format_name_;
   std::string encoder_name_;
+  size_t mux_queue_size_{0};
+  MuxDropPolicy mux_drop_policy_{MuxDropPolicy::BLOCK};
 };
 
 #endif  // MODELBOX_FLOWUNIT_VIDEO_ENCODER_CPU_H_
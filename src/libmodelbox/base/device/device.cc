@@ -105,7 +105,6 @@ std::shared_ptr<DeviceMemory> Device::MemAlloc(size_t size, uint32_t mem_flags,
 std::shared_ptr<DeviceMemory> Device::MemAlloc(size_t size, size_t capacity,
                                                uint32_t mem_flags,
                                                const std::string &user_id) {
-  // TODO: Get user_id from thread module
   if (size > capacity) {
     StatusError = {STATUS_RANGE, "Mem capacity must >= size"};
     MBLOG_ERROR << StatusError.Errormsg();
@@ -129,6 +128,12 @@ std::shared_ptr<DeviceMemory> Device::MemAlloc(size_t size, size_t capacity,
     return nullptr;
   }
 
+  auto *account_scope = DeviceMemoryAccountScope::Current();
+  if (account_scope != nullptr) {
+    device_mem_shared_ptr =
+        account_scope->Charge(device_mem_shared_ptr, capacity);
+  }
+
   auto device_mem = memory_manager_->MakeDeviceMemory(
       shared_from_this(), device_mem_shared_ptr, capacity);
   if (device_mem == nullptr) {
@@ -137,7 +142,13 @@ std::shared_ptr<DeviceMemory> Device::MemAlloc(size_t size, size_t capacity,
 
   device_mem->SetMemFlags(mem_flags);
   device_mem->Resize(size);
-  memory_trace_->TraceMemoryAlloc(device_mem->GetMemoryID(), user_id,
+  auto owner_id = user_id;
+  if (owner_id.empty() && account_scope != nullptr &&
+      account_scope->GetNode() != nullptr) {
+    owner_id = account_scope->GetNode()->GetName();
+  }
+
+  memory_trace_->TraceMemoryAlloc(device_mem->GetMemoryID(), owner_id,
                                   GetDeviceID(), capacity);
 
   return device_mem;
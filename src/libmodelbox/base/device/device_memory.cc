@@ -699,4 +699,143 @@ std::shared_ptr<DeviceMemoryLog> DeviceMemoryTrace::GetMemoryLog(
   return item->second;
 }
 
-}  // namespace modelbox
\ No newline at end of file
+// scopes live on stack of their thread, keep raw pointer to stay trivial
+static thread_local DeviceMemoryAccountScope *current_account_scope = nullptr;
+
+DeviceMemoryAccount::DeviceMemoryAccount(const std::string &name)
+    : name_(name) {}
+
+DeviceMemoryAccount::~DeviceMemoryAccount() {}
+
+std::atomic<size_t> *DeviceMemoryAccount::GetOwnerBytes(
+    const std::string &owner) {
+  std::lock_guard<std::mutex> lock(owner_bytes_lock_);
+  auto &owner_bytes = owner_bytes_[owner];
+  if (owner_bytes == nullptr) {
+    owner_bytes.reset(new std::atomic<size_t>(0));
+  }
+
+  return owner_bytes.get();
+}
+
+void DeviceMemoryAccount::Charge(size_t size,
+                                 std::atomic<size_t> *owner_bytes) {
+  refs_.fetch_add(1, std::memory_order_relaxed);
+  auto live = live_bytes_.fetch_add(size, std::memory_order_relaxed) + size;
+  live_blocks_.fetch_add(1, std::memory_order_relaxed);
+  auto peak = peak_bytes_.load(std::memory_order_relaxed);
+  while (live > peak && !peak_bytes_.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+
+  if (owner_bytes != nullptr) {
+    owner_bytes->fetch_add(size, std::memory_order_relaxed);
+  }
+
+  OnUpdate(size, live > peak ? live : peak);
+}
+
+void DeviceMemoryAccount::Uncharge(size_t size,
+                                   std::atomic<size_t> *owner_bytes) {
+  live_bytes_.fetch_sub(size, std::memory_order_relaxed);
+  live_blocks_.fetch_sub(1, std::memory_order_relaxed);
+  if (owner_bytes != nullptr) {
+    owner_bytes->fetch_sub(size, std::memory_order_relaxed);
+  }
+
+  OnUpdate(-(int64_t)size, GetPeakBytes());
+  Release();
+}
+
+void DeviceMemoryAccount::Release() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+std::map<std::string, size_t> DeviceMemoryAccount::GetOwnerLiveBytes() {
+  std::map<std::string, size_t> owner_live_bytes;
+  std::lock_guard<std::mutex> lock(owner_bytes_lock_);
+  for (const auto &owner_bytes : owner_bytes_) {
+    auto bytes = owner_bytes.second->load(std::memory_order_relaxed);
+    if (bytes > 0) {
+      owner_live_bytes[owner_bytes.first] = bytes;
+    }
+  }
+
+  return owner_live_bytes;
+}
+
+void DeviceMemoryAccount::OnUpdate(int64_t live_delta, size_t peak_bytes) {}
+
+DeviceMemoryAccountScope::DeviceMemoryAccountScope(
+    const std::shared_ptr<DeviceMemoryAccount> &node,
+    const std::shared_ptr<DeviceMemoryAccount> &session)
+    : prev_(current_account_scope), node_(node.get()), session_(session.get()) {
+  // resolve sub owner once, charges of the scope are lock free
+  if (node_ != nullptr && session_ != nullptr) {
+    owner_bytes_ = session_->GetOwnerBytes(node_->GetName());
+  }
+
+  current_account_scope = this;
+}
+
+DeviceMemoryAccountScope::~DeviceMemoryAccountScope() {
+  current_account_scope = prev_;
+}
+
+DeviceMemoryAccountScope *DeviceMemoryAccountScope::Current() {
+  return current_account_scope;
+}
+
+std::shared_ptr<DeviceMemoryAccount>
+DeviceMemoryAccountScope::GetNodeAccount() {
+  if (current_account_scope == nullptr ||
+      current_account_scope->node_ == nullptr) {
+    return nullptr;
+  }
+
+  return current_account_scope->node_->shared_from_this();
+}
+
+std::shared_ptr<DeviceMemoryAccount>
+DeviceMemoryAccountScope::GetSessionAccount() {
+  if (current_account_scope == nullptr ||
+      current_account_scope->session_ == nullptr) {
+    return nullptr;
+  }
+
+  return current_account_scope->session_->shared_from_this();
+}
+
+std::shared_ptr<void> DeviceMemoryAccountScope::Charge(
+    const std::shared_ptr<void> &mem_ptr, size_t size) const {
+  if (node_ == nullptr && session_ == nullptr) {
+    return mem_ptr;
+  }
+
+  auto *node = node_;
+  auto *session = session_;
+  auto *owner_bytes = owner_bytes_;
+  if (node != nullptr) {
+    node->Charge(size);
+  }
+
+  if (session != nullptr) {
+    session->Charge(size, owner_bytes);
+  }
+
+  // each charge holds its account, raw pointers stay valid until uncharge
+  return std::shared_ptr<void>(
+      mem_ptr.get(), [mem_ptr, size, node, session, owner_bytes](void *ptr) {
+        if (node != nullptr) {
+          node->Uncharge(size);
+        }
+
+        if (session != nullptr) {
+          session->Uncharge(size, owner_bytes);
+        }
+      });
+}
+
+}  // namespace modelbox
@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <atomic>
@@ -37,6 +38,10 @@
 
 namespace modelbox {
 
+constexpr const char *DRIVER_FILE_FILTER = "libmodelbox-*.so*";
+// scan info of older version is not keyed by file, rescan all
+constexpr int DRIVER_SCAN_INFO_VERSION = 2;
+
 Driver::Driver(){};
 
 Driver::~Driver() {
@@ -382,7 +387,6 @@ Status Drivers::Scan(const std::string &path, const std::string &filter) {
   }
 
   if (!S_ISDIR(s.st_mode)) {
-    last_modify_time_sum_ += s.st_mtim.tv_sec;
     auto status = Add(path);
     if (status == STATUS_OK) {
       drivers_scan_result_info_->GetLoadSuccessInfo().push_back(path);
@@ -413,7 +417,6 @@ Status Drivers::Scan(const std::string &path, const std::string &filter) {
     if (S_ISLNK(buf.st_mode)) {
       continue;
     }
-    last_modify_time_sum_ += buf.st_mtim.tv_sec;
 
     auto result = Add(driver_file);
     if (result == STATUS_OK) {
@@ -446,175 +449,159 @@ Status Drivers::Initialize(std::shared_ptr<Configuration> config) {
   return STATUS_OK;
 }
 
-Status Drivers::WriteScanInfo(const std::string &scan_info_path,
-                              const std::string &check_code) {
-  std::ofstream scan_info_file(scan_info_path);
-  if (!scan_info_file.is_open()) {
-    return {STATUS_FAULT, "Open file " + scan_info_path + " for write failed"};
-  }
-
-  nlohmann::json dump_json;
-
+static int64_t GetLdCacheTime() {
   struct stat buffer;
   if (stat(DEFAULT_LD_CACHE, &buffer) == -1) {
-    dump_json["ld_cache_time"] = 0;
-  } else {
-    dump_json["ld_cache_time"] = buffer.st_mtim.tv_sec;
+    return 0;
   }
 
-  dump_json["check_code"] = check_code;
+  return buffer.st_mtim.tv_sec;
+}
+
+static inline int64_t GetModifyTime(const struct stat &buf) {
+  return (int64_t)buf.st_mtim.tv_sec * 1000000000 + buf.st_mtim.tv_nsec;
+}
+
+Status Drivers::WriteScanInfo(const std::string &scan_info_path) {
+  nlohmann::json dump_json;
+  dump_json["version"] = DRIVER_SCAN_INFO_VERSION;
   std::time_t tt =
       std::chrono::system_clock::to_time_t(std::chrono::system_clock().now());
   dump_json["version_record"] = std::ctime(&tt);
   nlohmann::json dump_driver_json_arr = nlohmann::json::array();
 
   MBLOG_DEBUG << "write info begin";
-  for (auto &driver : drivers_list_) {
+  for (auto &item : scan_cache_) {
+    auto &cache = item.second;
     nlohmann::json dump_driver_json;
-    auto desc = driver->GetDriverDesc();
-    auto cls = desc->GetClass();
-    auto type = desc->GetType();
-    auto name = desc->GetName();
-    auto description = desc->GetDescription();
-    auto version = desc->GetVersion();
-    auto file_path = desc->GetFilePath();
-    auto no_delete = desc->GetNoDelete();
-    auto global = desc->GetGlobal();
-    auto deep_bind = desc->GetDeepBind();
-    dump_driver_json["class"] = cls;
-    dump_driver_json["type"] = type;
-    dump_driver_json["name"] = name;
-    dump_driver_json["description"] = description;
-    dump_driver_json["version"] = version;
-    dump_driver_json["file_path"] = file_path;
-    dump_driver_json["no_delete"] = no_delete;
-    dump_driver_json["global"] = global;
-    dump_driver_json["deep_bind"] = deep_bind;
+    dump_driver_json["file_path"] = cache->file_path;
+    dump_driver_json["size"] = cache->size;
+    dump_driver_json["mtime"] = cache->mtime;
+    dump_driver_json["hash"] = cache->hash;
+    dump_driver_json["ld_cache_time"] = cache->ld_cache_time;
+    if (cache->desc == nullptr) {
+      dump_driver_json["err_msg"] = cache->err_msg;
+      dump_driver_json["load_success"] = false;
+      dump_driver_json_arr.push_back(dump_driver_json);
+      continue;
+    }
+
+    auto desc = cache->desc;
+    dump_driver_json["class"] = desc->GetClass();
+    dump_driver_json["type"] = desc->GetType();
+    dump_driver_json["name"] = desc->GetName();
+    dump_driver_json["description"] = desc->GetDescription();
+    dump_driver_json["version"] = desc->GetVersion();
+    dump_driver_json["no_delete"] = desc->GetNoDelete();
+    dump_driver_json["global"] = desc->GetGlobal();
+    dump_driver_json["deep_bind"] = desc->GetDeepBind();
     dump_driver_json["load_success"] = true;
     dump_driver_json_arr.push_back(dump_driver_json);
   }
 
-  auto load_failed_info = drivers_scan_result_info_->GetLoadFailedInfo();
-  MBLOG_DEBUG << "load_failed_info size " << load_failed_info.size();
-  for (auto &fail_info : load_failed_info) {
-    nlohmann::json dump_driver_json;
-    dump_driver_json["file_path"] = fail_info.first;
-    dump_driver_json["err_msg"] = fail_info.second;
-    dump_driver_json["load_success"] = false;
-    dump_driver_json_arr.push_back(dump_driver_json);
+  dump_json["scan_drivers"] = dump_driver_json_arr;
+
+  // processes may scan at the same time, replace file as a whole
+  auto tmp_path = scan_info_path + "." + std::to_string(getpid());
+  std::ofstream scan_info_file(tmp_path);
+  if (!scan_info_file.is_open()) {
+    return {STATUS_FAULT, "Open file " + tmp_path + " for write failed"};
   }
 
-  dump_json["scan_drivers"] = dump_driver_json_arr;
   scan_info_file << dump_json;
-  MBLOG_DEBUG << "write info end";
-
   scan_info_file.close();
+  if (rename(tmp_path.c_str(), scan_info_path.c_str()) != 0) {
+    auto err_msg = "rename " + tmp_path + " failed, " + StrError(errno);
+    remove(tmp_path.c_str());
+    return {STATUS_FAULT, err_msg};
+  }
+
+  MBLOG_DEBUG << "write info end";
+  scan_cache_dirty_ = false;
   return STATUS_OK;
 }
 
-Status Drivers::GatherScanInfo(const std::string &scan_path) {
+Status Drivers::LoadScanInfo(const std::string &scan_path) {
+  scan_cache_.clear();
+  scan_cache_dirty_ = false;
   std::ifstream scan_info_file(scan_path);
   if (!scan_info_file.is_open()) {
-    MBLOG_ERROR << "Open file " << scan_path << " for read failed";
-    return STATUS_FAULT;
+    MBLOG_DEBUG << scan_path << " does not exist.";
+    return STATUS_NOTFOUND;
   }
 
-  nlohmann::json dump_json;
-  scan_info_file >> dump_json;
-
-  auto driver_json_arr = dump_json["scan_drivers"];
-  for (auto &driver_info : driver_json_arr) {
-    if (!driver_info["load_success"]) {
-      continue;
-    }
-
-    auto driver = std::make_shared<Driver>();
-    auto desc = driver->GetDriverDesc();
-    desc->SetClass(driver_info["class"]);
-    desc->SetType(driver_info["type"]);
-    desc->SetName(driver_info["name"]);
-    desc->SetDescription(driver_info["description"]);
-    desc->SetVersion(driver_info["version"]);
-    desc->SetFilePath(driver_info["file_path"]);
-    desc->SetNodelete(driver_info["no_delete"]);
-    desc->SetGlobal(driver_info["global"]);
-    desc->SetDeepBind(driver_info["deep_bind"]);
-    auto tmp_driver = GetDriver(driver_info["class"], driver_info["type"],
-                                driver_info["name"], driver_info["version"]);
-    if (tmp_driver == nullptr) {
-      drivers_list_.push_back(driver);
+  try {
+    nlohmann::json dump_json;
+    scan_info_file >> dump_json;
+    if (dump_json.value("version", 0) != DRIVER_SCAN_INFO_VERSION) {
+      MBLOG_INFO << "driver scan info version changed, rescan all drivers";
+      return STATUS_NOTSUPPORT;
     }
-  }
 
-  MBLOG_INFO << "Gather scan info success, drivers count "
-             << drivers_list_.size();
-  return STATUS_OK;
-}
-
-void Drivers::FillCheckInfo(std::string &file_check_node,
-                            std::unordered_map<std::string, bool> &file_map,
-                            int64_t &ld_cache_time) {
-  std::ifstream scan_info(DEFAULT_SCAN_INFO);
-  nlohmann::json dump_json;
-  scan_info >> dump_json;
-  file_check_node = dump_json["check_code"];
-  ld_cache_time = dump_json["ld_cache_time"];
-  auto driver_json_arr = dump_json["scan_drivers"];
-  for (const auto &driver_info : driver_json_arr) {
-    if (file_map.find(driver_info["file_path"]) != file_map.end()) {
-      continue;
-    }
-    file_map[driver_info["file_path"]] = true;
-  }
-}
+    for (auto &driver_info : dump_json["scan_drivers"]) {
+      auto cache = std::make_shared<DriverScanCache>();
+      cache->file_path = driver_info["file_path"];
+      // cache is shared by all driver dirs, drop removed files only
+      if (access(cache->file_path.c_str(), F_OK) != 0) {
+        scan_cache_dirty_ = true;
+        continue;
+      }
 
-bool Drivers::CheckPathAndMagicCode() {
-  struct stat buffer;
-  if (stat(DEFAULT_SCAN_INFO, &buffer) == -1) {
-    MBLOG_DEBUG << DEFAULT_SCAN_INFO << " does not exist.";
-    return false;
-  }
+      cache->size = driver_info["size"];
+      cache->mtime = driver_info["mtime"];
+      cache->hash = driver_info["hash"];
+      cache->ld_cache_time = driver_info["ld_cache_time"];
+      if (!driver_info["load_success"]) {
+        cache->err_msg = driver_info["err_msg"];
+        scan_cache_[cache->file_path] = cache;
+        continue;
+      }
 
-  if (stat(DEFAULT_LD_CACHE, &buffer) == -1) {
-    MBLOG_DEBUG << DEFAULT_LD_CACHE << " does not exit.";
-    return false;
+      auto desc = std::make_shared<DriverDesc>();
+      desc->SetClass(driver_info["class"]);
+      desc->SetType(driver_info["type"]);
+      desc->SetName(driver_info["name"]);
+      desc->SetDescription(driver_info["description"]);
+      desc->SetVersion(driver_info["version"]);
+      desc->SetFilePath(cache->file_path);
+      desc->SetNodelete(driver_info["no_delete"]);
+      desc->SetGlobal(driver_info["global"]);
+      desc->SetDeepBind(driver_info["deep_bind"]);
+      cache->desc = desc;
+      scan_cache_[cache->file_path] = cache;
+    }
+  } catch (const std::exception &e) {
+    MBLOG_WARN << "driver scan info " << scan_path << " is invalid, "
+               << e.what();
+    scan_cache_.clear();
+    return STATUS_BADCONF;
   }
 
-  std::string file_check_node;
-  std::unordered_map<std::string, bool> file_map;
-  int64_t ld_cache_time;
-  FillCheckInfo(file_check_node, file_map, ld_cache_time);
-
-  if (ld_cache_time != buffer.st_mtim.tv_sec) {
-    return false;
-  }
+  return STATUS_OK;
+}
 
-  int64_t check_sum = 0;
+std::vector<std::string> Drivers::ListDriverFiles() {
+  std::vector<std::string> driver_files;
   for (const auto &dir : driver_dirs_) {
-    std::vector<std::string> drivers_list;
-    std::string filter = "libmodelbox-*.so*";
     struct stat s;
     auto ret = lstat(dir.c_str(), &s);
     if (ret) {
-      MBLOG_ERROR << "lstat " << dir << " failed, errno:" << StrError(errno);
-      return false;
+      MBLOG_WARN << "lstat " << dir << " failed, errno:" << StrError(errno);
+      continue;
     }
 
     if (!S_ISDIR(s.st_mode)) {
-      check_sum += s.st_mtim.tv_sec;
+      driver_files.push_back(dir);
       continue;
     }
 
-    Status status = ListFiles(dir, filter, &drivers_list);
+    std::vector<std::string> drivers_list;
+    auto status = ListFiles(dir, DRIVER_FILE_FILTER, &drivers_list);
     if (status != STATUS_OK) {
-      auto err_msg = "list directory:  " + dir + "/" + filter + " failed, ";
       if (status != STATUS_NOTFOUND) {
-        MBLOG_ERROR << err_msg << status.WrapErrormsgs();
+        MBLOG_WARN << "list directory: " << dir << "/" << DRIVER_FILE_FILTER
+                   << " failed, " << status.WrapErrormsgs();
       }
-      return false;
-    }
-
-    if (drivers_list.size() == 0) {
       continue;
     }
 
@@ -622,7 +609,6 @@ bool Drivers::CheckPathAndMagicCode() {
       struct stat buf;
       auto ret = lstat(driver_file.c_str(), &buf);
       if (ret) {
-        MBLOG_DEBUG << "lstat " << dir << " failed, errno:" << StrError(errno);
         continue;
       }
 
@@ -630,36 +616,76 @@ bool Drivers::CheckPathAndMagicCode() {
         continue;
       }
 
-      if (file_map.count(driver_file) == 0) {
-        return false;
-      }
-
-      check_sum += buf.st_mtim.tv_sec;
+      driver_files.push_back(driver_file);
     }
   }
-  auto check_code = GenerateKey(check_sum);
-  if (file_check_node != check_code) {
+
+  return driver_files;
+}
+
+bool Drivers::IsScanCacheValid(const std::string &file,
+                               int64_t ld_cache_time) {
+  auto iter = scan_cache_.find(file);
+  if (iter == scan_cache_.end()) {
+    return false;
+  }
+
+  auto &cache = iter->second;
+  if (cache->desc == nullptr && cache->ld_cache_time != ld_cache_time) {
     return false;
   }
 
+  struct stat buf;
+  if (stat(file.c_str(), &buf) != 0 || buf.st_size != cache->size) {
+    return false;
+  }
+
+  if (GetModifyTime(buf) == cache->mtime) {
+    return true;
+  }
+
+  // touched but not changed, like reinstalled by package
+  std::string hash;
+  if (!GenerateFileKey(file, &hash) || hash != cache->hash) {
+    return false;
+  }
+
+  cache->mtime = GetModifyTime(buf);
+  scan_cache_dirty_ = true;
   return true;
 }
 
-Status Drivers::InnerScan() {
-  Status ret = STATUS_NOTFOUND;
-  for (const auto &dir : driver_dirs_) {
-    ret = Scan(dir, "libmodelbox-*.so*");
-    if (!ret && ret != STATUS_NOTFOUND) {
-      MBLOG_WARN << "scan " << dir << " failed";
+Status Drivers::InnerScan(const std::vector<std::string> &changed_files) {
+  auto ld_cache_time = GetLdCacheTime();
+  for (const auto &file : changed_files) {
+    struct stat buf;
+    if (stat(file.c_str(), &buf) != 0) {
+      continue;
     }
-    ret = STATUS_OK;
-  }
 
-  auto check_code = GenerateKey(last_modify_time_sum_);
+    auto cache = std::make_shared<DriverScanCache>();
+    cache->file_path = file;
+    cache->size = buf.st_size;
+    cache->mtime = GetModifyTime(buf);
+    cache->ld_cache_time = ld_cache_time;
+    auto ret = GenerateFileKey(file, &cache->hash);
+    if (!ret) {
+      MBLOG_WARN << "generate key of " << file << " failed, " << ret;
+    }
+
+    ret = Add(file);
+    if (ret == STATUS_OK) {
+      cache->desc = drivers_list_.back()->GetDriverDesc();
+    } else {
+      cache->err_msg = ret.Errormsg();
+    }
 
-  ret = WriteScanInfo(DEFAULT_SCAN_INFO, check_code);
+    scan_cache_[file] = cache;
+  }
+
+  auto ret = WriteScanInfo(DEFAULT_SCAN_INFO);
   if (ret != STATUS_OK) {
-    auto err_msg = "write scan info failed";
+    auto err_msg = "write scan info failed, " + ret.WrapErrormsgs();
     MBLOG_ERROR << err_msg;
     return {STATUS_FAULT, err_msg};
   }
@@ -667,37 +693,57 @@ Status Drivers::InnerScan() {
   return ret;
 }
 
-void Drivers::PrintScanResults(const std::string &scan_path) {
-  std::ifstream scan_info_file(scan_path);
-  if (!scan_info_file.is_open()) {
-    MBLOG_ERROR << "Open file " << scan_path << " for read failed";
-  }
-
-  nlohmann::json dump_json;
-  scan_info_file >> dump_json;
-
-  nlohmann::json dump_driver_json_arr = nlohmann::json::array();
-  dump_driver_json_arr = dump_json["scan_drivers"];
-
+Status Drivers::GatherScanInfo(const std::vector<std::string> &driver_files) {
   std::list<std::string> load_success_info;
   std::map<std::string, std::string> load_failed_info;
+  for (const auto &file : driver_files) {
+    auto iter = scan_cache_.find(file);
+    if (iter == scan_cache_.end()) {
+      load_failed_info.emplace(file, file + " : driver is not scanned.");
+      continue;
+    }
 
-  for (auto &dump_json : dump_driver_json_arr) {
-    if (dump_json["load_success"]) {
-      load_success_info.push_back(dump_json["file_path"]);
+    auto &cache = iter->second;
+    if (cache->desc == nullptr) {
+      load_failed_info.emplace(file, cache->err_msg);
       continue;
     }
 
-    load_failed_info.emplace(dump_json["file_path"], dump_json["err_msg"]);
+    load_success_info.push_back(file);
+    auto driver = std::make_shared<Driver>();
+    driver->SetDriverDesc(std::make_shared<DriverDesc>(*cache->desc));
+    auto desc = driver->GetDriverDesc();
+    auto tmp_driver = GetDriver(desc->GetClass(), desc->GetType(),
+                                desc->GetName(), desc->GetVersion());
+    if (tmp_driver == nullptr) {
+      drivers_list_.push_back(driver);
+    }
   }
 
+  MBLOG_INFO << "Gather scan info success, drivers count "
+             << drivers_list_.size();
   PrintScanResult(load_success_info, load_failed_info);
+  return STATUS_OK;
 }
 
 Status Drivers::Scan() {
-  Status status = STATUS_FAULT;
-  if (!CheckPathAndMagicCode()) {
-    auto exec_func = std::bind(&Drivers::InnerScan, this);
+  // missing or old scan info only makes all drivers scanned
+  LoadScanInfo(DEFAULT_SCAN_INFO);
+
+  auto ld_cache_time = GetLdCacheTime();
+  auto driver_files = ListDriverFiles();
+  std::vector<std::string> changed_files;
+  for (const auto &file : driver_files) {
+    if (!IsScanCacheValid(file, ld_cache_time)) {
+      changed_files.push_back(file);
+    }
+  }
+
+  if (!changed_files.empty()) {
+    MBLOG_INFO << "scan " << changed_files.size() << " new or changed drivers"
+               << ", total " << driver_files.size();
+    // dlopen in subprocess, driver may crash or pollute process
+    auto exec_func = std::bind(&Drivers::InnerScan, this, changed_files);
     auto status = SubProcessRun(exec_func);
     if (status != STATUS_OK) {
       auto err_msg =
@@ -705,16 +751,27 @@ Status Drivers::Scan() {
       MBLOG_ERROR << err_msg;
       return {STATUS_FAULT, err_msg};
     }
+
+    status = LoadScanInfo(DEFAULT_SCAN_INFO);
+    if (status != STATUS_OK) {
+      auto err_msg = "gather scan info failed";
+      MBLOG_ERROR << err_msg;
+      return {STATUS_FAULT, err_msg};
+    }
+  } else if (scan_cache_dirty_) {
+    auto status = WriteScanInfo(DEFAULT_SCAN_INFO);
+    if (!status) {
+      MBLOG_WARN << "update scan info failed, " << status;
+    }
   }
 
-  status = GatherScanInfo(DEFAULT_SCAN_INFO);
+  auto status = GatherScanInfo(driver_files);
   if (status != STATUS_OK) {
     auto err_msg = "gather scan info failed";
     MBLOG_ERROR << err_msg;
     return {STATUS_FAULT, err_msg};
   }
 
-  PrintScanResults(DEFAULT_SCAN_INFO);
   MBLOG_INFO << "begin scan virtual drivers";
   status = VirtualDriverScan();
   MBLOG_INFO << "end scan virtual drivers";
@@ -735,7 +792,8 @@ void Drivers::Clear() {
   drivers_list_.clear();
   driver_dirs_.clear();
   config_ = nullptr;
-  last_modify_time_sum_ = 0;
+  scan_cache_.clear();
+  scan_cache_dirty_ = false;
 }
 
 Status Drivers::VirtualDriverScan() {
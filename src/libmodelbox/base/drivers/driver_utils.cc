@@ -16,7 +16,12 @@
 
 #include "modelbox/base/driver_utils.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include "modelbox/base/crypto.h"
+#include "modelbox/base/utils.h"
 
 namespace modelbox {
 
@@ -31,4 +36,38 @@ std::string GenerateKey(int64_t check_sum) {
   return HmacToString(output.data(), output.size());
 }
 
+Status GenerateFileKey(const std::string &file, std::string *key) {
+  int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return {STATUS_FAULT, "open " + file + " failed, " + StrError(errno)};
+  }
+  Defer { close(fd); };
+
+  struct stat buf;
+  if (fstat(fd, &buf) != 0) {
+    return {STATUS_FAULT, "stat " + file + " failed, " + StrError(errno)};
+  }
+
+  std::vector<unsigned char> output;
+  Status ret;
+  if (buf.st_size == 0) {
+    ret = HmacEncode("sha256", "", 0, &output);
+  } else {
+    auto *data = mmap(nullptr, buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      return {STATUS_FAULT, "mmap " + file + " failed, " + StrError(errno)};
+    }
+
+    ret = HmacEncode("sha256", data, buf.st_size, &output);
+    munmap(data, buf.st_size);
+  }
+
+  if (!ret) {
+    return ret;
+  }
+
+  *key = HmacToString(output.data(), output.size());
+  return STATUS_OK;
+}
+
 }  // namespace modelbox
\ No newline at end of file
@@ -17,9 +17,11 @@
 #ifndef MODELBOX_DEVICE_MEMORY_H_
 #define MODELBOX_DEVICE_MEMORY_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include "modelbox/base/status.h"
@@ -563,6 +565,145 @@ class DeviceMemoryTrace {
   std::mutex memory_logs_lock_;
 };
 
+/**
+ * @brief Live and peak bytes of device memory owned by a node or a session
+ */
+class DeviceMemoryAccount
+    : public std::enable_shared_from_this<DeviceMemoryAccount> {
+ public:
+  explicit DeviceMemoryAccount(const std::string &name);
+
+  virtual ~DeviceMemoryAccount();
+
+  /**
+   * @brief Create account, memory charged to it keeps it alive after the
+   * returned pointer is released
+   * @param args Arguments of account constructor
+   * @return account
+   */
+  template <typename T = DeviceMemoryAccount, typename... Args>
+  static std::shared_ptr<T> Create(Args &&...args) {
+    return std::shared_ptr<T>(new T(std::forward<Args>(args)...),
+                              [](T *account) { account->Release(); });
+  }
+
+  /**
+   * @brief Get live bytes counter of a sub owner, resolve once and pass it to
+   * Charge and Uncharge
+   * @param owner Sub owner of memory, e.g. node name of session memory
+   * @return counter, valid while account is alive
+   */
+  std::atomic<size_t> *GetOwnerBytes(const std::string &owner);
+
+  /**
+   * @brief Account allocated memory, account is held until Uncharge
+   * @param size Memory size
+   * @param owner_bytes Counter of sub owner, nullable
+   */
+  void Charge(size_t size, std::atomic<size_t> *owner_bytes = nullptr);
+
+  /**
+   * @brief Account freed memory
+   * @param size Memory size
+   * @param owner_bytes Counter passed to Charge
+   */
+  void Uncharge(size_t size, std::atomic<size_t> *owner_bytes = nullptr);
+
+  inline const std::string &GetName() const { return name_; }
+
+  inline size_t GetLiveBytes() const {
+    return live_bytes_.load(std::memory_order_relaxed);
+  }
+
+  inline size_t GetPeakBytes() const {
+    return peak_bytes_.load(std::memory_order_relaxed);
+  }
+
+  inline size_t GetLiveBlocks() const {
+    return live_blocks_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get live bytes of each sub owner
+   * @return owner name and live bytes, owner without live bytes is omitted
+   */
+  std::map<std::string, size_t> GetOwnerLiveBytes();
+
+ protected:
+  /**
+   * @brief Called after each charge and uncharge, default does nothing
+   * @param live_delta Change of live bytes
+   * @param peak_bytes Peak bytes after the change
+   */
+  virtual void OnUpdate(int64_t live_delta, size_t peak_bytes);
+
+ private:
+  void Release();
+
+  std::string name_;
+  // one reference of creator and one of each live block
+  std::atomic<size_t> refs_{1};
+  std::atomic<size_t> live_bytes_{0};
+  std::atomic<size_t> peak_bytes_{0};
+  std::atomic<size_t> live_blocks_{0};
+  std::mutex owner_bytes_lock_;
+  // counters are never erased, pointers stay valid
+  std::map<std::string, std::unique_ptr<std::atomic<size_t>>> owner_bytes_;
+};
+
+/**
+ * @brief Charge device memory allocated in current thread to node and session
+ * accounts until the scope ends, scopes can be nested
+ */
+class DeviceMemoryAccountScope {
+ public:
+  /**
+   * @brief Accounts must be created by DeviceMemoryAccount::Create
+   * @param node Node account, nullable
+   * @param session Session account, nullable
+   */
+  DeviceMemoryAccountScope(const std::shared_ptr<DeviceMemoryAccount> &node,
+                           const std::shared_ptr<DeviceMemoryAccount> &session);
+
+  virtual ~DeviceMemoryAccountScope();
+
+  /**
+   * @brief Get scope of current thread
+   * @return scope, nullptr when not in a scope
+   */
+  static DeviceMemoryAccountScope *Current();
+
+  /**
+   * @brief Get node account of current thread
+   * @return account, nullptr when not in a scope
+   */
+  static std::shared_ptr<DeviceMemoryAccount> GetNodeAccount();
+
+  /**
+   * @brief Get session account of current thread
+   * @return account, nullptr when not in a scope
+   */
+  static std::shared_ptr<DeviceMemoryAccount> GetSessionAccount();
+
+  /**
+   * @brief Charge memory to accounts of this scope
+   * @param mem_ptr Allocated memory
+   * @param size Memory size
+   * @return memory which uncharges when released, mem_ptr when scope has no
+   * account
+   */
+  std::shared_ptr<void> Charge(const std::shared_ptr<void> &mem_ptr,
+                               size_t size) const;
+
+  inline DeviceMemoryAccount *GetNode() const { return node_; }
+
+ private:
+  DeviceMemoryAccountScope *prev_;
+  DeviceMemoryAccount *node_;
+  DeviceMemoryAccount *session_;
+  std::atomic<size_t> *owner_bytes_{nullptr};
+};
+
 }  // namespace modelbox
 
 #endif  // MODELBOX_DEVICE_MEMORY_H_
\ No newline at end of file
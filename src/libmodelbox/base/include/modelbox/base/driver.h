@@ -161,6 +161,23 @@ class VirtualDriver : public Driver {
   std::shared_ptr<VirtualDriverDesc> virtual_driver_desc_;
 };
 
+/**
+ * @brief Scan result of a driver file, reused until the file changes
+ */
+struct DriverScanCache {
+  std::string file_path;
+  int64_t size{0};
+  // modify time in ns
+  int64_t mtime{0};
+  // sha256 of file content
+  std::string hash;
+  // failed driver may load after libraries update
+  int64_t ld_cache_time{0};
+  // nullptr when load failed
+  std::shared_ptr<DriverDesc> desc;
+  std::string err_msg;
+};
+
 class Drivers;
 class VirtualDriverManager : public DriverFactory {
  public:
@@ -220,15 +237,12 @@ class Drivers {
   static std::shared_ptr<Drivers> GetInstance();
 
  private:
-  Status InnerScan();
-  Status WriteScanInfo(const std::string &scan_info_path,
-                       const std::string &check_code);
-  Status GatherScanInfo(const std::string &scan_path);
-  void FillCheckInfo(std::string &file_check_node,
-                     std::unordered_map<std::string, bool> &file_map,
-                     int64_t &ld_cache_time);
-  bool CheckPathAndMagicCode();
-  void PrintScanResults(const std::string &scan_path);
+  Status InnerScan(const std::vector<std::string> &changed_files);
+  Status WriteScanInfo(const std::string &scan_info_path);
+  Status LoadScanInfo(const std::string &scan_path);
+  Status GatherScanInfo(const std::vector<std::string> &driver_files);
+  std::vector<std::string> ListDriverFiles();
+  bool IsScanCacheValid(const std::string &file, int64_t ld_cache_time);
   void PrintScanResult(
       const std::list<std::string> &load_success_info,
       const std::map<std::string, std::string> &load_failed_info);
@@ -241,7 +255,9 @@ class Drivers {
       virtual_driver_manager_list_;
   std::vector<std::string> driver_dirs_;
   std::shared_ptr<DriversScanResultInfo> drivers_scan_result_info_;
-  uint64_t last_modify_time_sum_{0};
+  std::unordered_map<std::string, std::shared_ptr<DriverScanCache>>
+      scan_cache_;
+  bool scan_cache_dirty_{false};
 };
 
 }  // namespace modelbox
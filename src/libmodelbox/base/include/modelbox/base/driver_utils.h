@@ -76,6 +76,14 @@ Status SubProcessRun(func &&fun, ts &&...params) {
  */
 std::string GenerateKey(int64_t check_sum);
 
+/**
+ * @brief generate sha256 key from file content
+ * @param file file path
+ * @param key sha256 result
+ * @return generate result
+ */
+Status GenerateFileKey(const std::string &file, std::string *key);
+
 }  // namespace modelbox
 
 #endif
\ No newline at end of file
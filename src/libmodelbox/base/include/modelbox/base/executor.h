@@ -30,10 +30,13 @@ class Executor {
   Executor() {
     thread_pool_ = std::make_shared<ThreadPool>();
     thread_pool_->SetName("Executor");
+    thread_pool_->SetAdaptive(true);
   };
   Executor(int thread_count) {
     thread_pool_ = std::make_shared<ThreadPool>(thread_count);
     thread_pool_->SetName("Executor");
+    // flowunit in BlockingSection gets a compensating thread
+    thread_pool_->SetAdaptive(true);
   }
 
   Executor(const Executor &) = delete;
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODELBOX_SHM_RING_H_
+#define MODELBOX_SHM_RING_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "modelbox/base/status.h"
+
+namespace modelbox {
+
+struct ShmRingHeader;
+struct ShmRingSlot;
+
+/**
+ * @brief Frame read from ring, data points to shared memory until released
+ */
+struct ShmRingFrame {
+  uint32_t slot{0};
+  std::string meta;
+  void *data{nullptr};
+  size_t size{0};
+};
+
+/**
+ * @brief Single producer single consumer frame ring in shared memory
+ * between processes on the same host.
+ *
+ * memory is a memfd, slots are written in order by producer and can be
+ * released out of order by consumer, a slot is reused only after release.
+ * eventfd doorbells wake the other side, and are only rung when it waits.
+ *
+ * producer creates the ring and connects to the consumer unix socket,
+ * memfd and eventfds are passed with SCM_RIGHTS, the socket is kept open
+ * to detect the other side exit.
+ */
+class ShmRing : public std::enable_shared_from_this<ShmRing> {
+ public:
+  virtual ~ShmRing();
+
+  /**
+   * @brief Create ring and connect to consumer, producer side
+   * @param path unix socket path of consumer
+   * @param slot_num slot number, rounded up to power of 2
+   * @param slot_size max meta and data bytes of one frame
+   * @param ring created ring
+   * @return create result
+   */
+  static Status Connect(const std::string &path, uint32_t slot_num,
+                        size_t slot_size, std::shared_ptr<ShmRing> *ring);
+
+  /**
+   * @brief Accept one producer on listen socket, consumer side
+   * @param listen_fd unix socket listen fd
+   * @param ring attached ring
+   * @param timeout wait time in ms for producer handshake
+   * @return accept result, STATUS_TIMEDOUT when producer sends nothing
+   */
+  static Status Accept(int listen_fd, std::shared_ptr<ShmRing> *ring,
+                       int32_t timeout = 1000);
+
+  /**
+   * @brief Create unix socket for producers to connect
+   * @param path unix socket path
+   * @param listen_fd listen fd
+   * @return listen result
+   */
+  static Status Listen(const std::string &path, int *listen_fd);
+
+  /**
+   * @brief Get slot memory to fill in place, producer side
+   * @param size data size
+   * @param data pointer to slot memory
+   * @param timeout wait time in ms for free slot, < 0 wait forever
+   * @param meta frame meta, json is recommended
+   * @return STATUS_TIMEDOUT when no slot is free,
+   *         STATUS_EOF when consumer exited
+   */
+  Status Reserve(size_t size, void **data, int32_t timeout = -1,
+                 const std::string &meta = "");
+
+  /**
+   * @brief Publish reserved slot
+   * @param size data size filled, not larger than reserved
+   */
+  Status Commit(size_t size);
+
+  /**
+   * @brief Copy one frame into ring, producer side
+   * @param meta frame meta, json is recommended
+   */
+  Status Write(const void *data, size_t size, const std::string &meta = "",
+               int32_t timeout = -1);
+
+  /**
+   * @brief Notify no more frame, producer side
+   */
+  void Close();
+
+  /**
+   * @brief Read one frame, consumer side
+   * @param frame frame in shared memory, must be released after use
+   * @param timeout wait time in ms, < 0 wait forever
+   * @return STATUS_TIMEDOUT when no frame,
+   *         STATUS_EOF when producer closed or exited and ring is drained
+   */
+  Status Read(ShmRingFrame *frame, int32_t timeout = -1);
+
+  /**
+   * @brief Release slot of frame, may be called from any thread in any
+   * order, consumer side
+   */
+  void Release(uint32_t slot);
+
+  /**
+   * @brief Wrap frame data, slot is released when the last reference gone
+   */
+  std::shared_ptr<void> Adopt(const ShmRingFrame &frame);
+
+  uint32_t GetSlotNum() const;
+
+  size_t GetSlotSize() const;
+
+  /**
+   * @brief Slots read but not released yet
+   */
+  uint32_t GetInUseCount() const;
+
+ private:
+  ShmRing();
+
+  Status Map(size_t map_size, bool init, uint32_t slot_num, size_t slot_size);
+
+  ShmRingSlot *GetSlot(uint64_t seq) const;
+
+  uint8_t *GetSlotData(uint64_t seq) const;
+
+  Status Wait(int doorbell_fd, std::atomic<uint32_t> *waiting,
+              const std::function<bool()> &ready, int32_t timeout);
+
+  void Ring(int doorbell_fd, std::atomic<uint32_t> *waiting);
+
+  int sock_fd_{-1};
+  int mem_fd_{-1};
+  // producer to consumer
+  int data_fd_{-1};
+  // consumer to producer
+  int space_fd_{-1};
+
+  void *map_{nullptr};
+  size_t map_size_{0};
+  ShmRingHeader *header_{nullptr};
+  ShmRingSlot *slots_{nullptr};
+  uint8_t *data_{nullptr};
+  // copied from header after check, header may be changed by peer
+  uint32_t slot_num_{0};
+  size_t slot_size_{0};
+
+  // producer reserved slot
+  uint64_t reserved_seq_{0};
+  bool reserved_{false};
+  std::atomic<uint32_t> in_use_{0};
+};
+
+}  // namespace modelbox
+
+#endif  // MODELBOX_SHM_RING_H_
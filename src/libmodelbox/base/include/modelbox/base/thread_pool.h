@@ -24,6 +24,7 @@
 #include <sched.h>
 #include <unistd.h>
 
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <future>
@@ -35,9 +36,15 @@
 
 namespace modelbox {
 
+/**
+ * @brief Default queue wait above which adaptive pool adds a thread
+ */
+constexpr uint32_t DEFAULT_ADAPTIVE_TARGET_WAIT_US = 2000;
+
 struct ThreadFunction {
   std::string name;
   std::function<void()> func;
+  std::chrono::steady_clock::time_point submit_time;
 };
 
 class ThreadPool;
@@ -151,6 +158,25 @@ class ThreadPool {
    */
   void SetKeepAlive(uint32_t timeout);
 
+  /**
+   * @brief Size the pool from measured queue wait and blocked threads,
+   * instead of only growing when queue is full. A thread is added when
+   * queued tasks wait longer than target and no thread is idle, and a
+   * compensating thread is added when a thread enters BlockingSection,
+   * max thread size only limits threads not blocked. Queue wait does not
+   * grow the pool beyond thread size or cpu number, whichever is larger.
+   * @param enable enable adaptive sizing.
+   * @param target_wait_us queue wait to keep tasks under.
+   */
+  void SetAdaptive(bool enable,
+                   uint32_t target_wait_us = DEFAULT_ADAPTIVE_TARGET_WAIT_US);
+
+  /**
+   * @brief Is adaptive sizing enabled.
+   * @return is adaptive.
+   */
+  bool IsAdaptive();
+
   /**
    * @brief Shutdown thread pool.
    * @param force force shutdown.
@@ -212,12 +238,41 @@ class ThreadPool {
    */
   int GetMaxThreadsNum();
 
+  /**
+   * @brief Get idle thread number.
+   * @return number of threads waiting for work.
+   */
+  int GetIdleThreadsNum();
+
   /**
    * @brief Get waiting work.
    * @return waiting work number.
    */
   int GetWaitingWorkCount();
 
+  /**
+   * @brief Get blocked thread number.
+   * @return number of threads in BlockingSection.
+   */
+  int GetBlockingThreadsNum();
+
+  /**
+   * @brief Get queue wait of recent tasks, only measured when adaptive.
+   * @return moving average of queue wait in microseconds.
+   */
+  uint64_t GetQueueWaitTime();
+
+  /**
+   * @brief Mark current thread entering a blocking call, nested call is
+   * counted once. No effect when current thread is not a pool thread.
+   */
+  static void BeginBlocking();
+
+  /**
+   * @brief Mark current thread leaving a blocking call.
+   */
+  static void EndBlocking();
+
  private:
   friend class ThreadWorker;
   void ExitWorker(ThreadWorker *worker);
@@ -234,6 +289,12 @@ class ThreadPool {
 
   bool SubmitTask(ThreadFunction &task);
 
+  void AdaptiveGrow();
+
+  void CompensateBlocking();
+
+  bool IsOverAdaptiveLimit(ThreadWorker *worker);
+
  private:
   std::shared_ptr<BlockingQueue<ThreadFunction>> work_queue_;
   bool quit_{false};
@@ -243,10 +304,30 @@ class ThreadPool {
   int keep_alive_{60000};
   std::atomic<int> worker_num_{0};
   std::atomic<int> available_num_{0};
+  std::atomic<bool> adaptive_{false};
+  std::atomic<int64_t> target_wait_ns_{DEFAULT_ADAPTIVE_TARGET_WAIT_US * 1000};
+  std::atomic<int> blocking_num_{0};
+  std::atomic<int64_t> queue_wait_ns_{0};
+  std::atomic<int64_t> last_grow_ns_{0};
+  int cpu_num_{(int)std::thread::hardware_concurrency()};
   std::mutex lock_;
   std::condition_variable exit_cond_;
   std::string name_;
 };
+
+/**
+ * @brief Scope of a blocking call in flowunit, such as network or storage
+ * io, an adaptive pool keeps other work running with a compensating thread
+ */
+class BlockingSection {
+ public:
+  BlockingSection() { ThreadPool::BeginBlocking(); }
+  virtual ~BlockingSection() { ThreadPool::EndBlocking(); }
+
+  BlockingSection(const BlockingSection &) = delete;
+  BlockingSection &operator=(const BlockingSection &) = delete;
+};
+
 }  // namespace modelbox
 
 #endif  // MODELBOX_THREAD_POOL_H
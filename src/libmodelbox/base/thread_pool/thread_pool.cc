@@ -23,6 +23,20 @@
 namespace modelbox {
 
 constexpr int MIN_KEEP_ALIVE_TIME = 100;
+// weight of new sample in queue wait moving average
+constexpr int QUEUE_WAIT_AVG_WEIGHT = 8;
+
+// pool of current worker thread, null for threads not in pool
+static thread_local ThreadPool *current_pool = nullptr;
+static thread_local int blocking_depth = 0;
+// pool counted this thread as blocked
+static thread_local ThreadPool *blocking_pool = nullptr;
+
+static inline int64_t SteadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
 
 ThreadWorker::ThreadWorker(ThreadPool *pool, int thread_id, bool core_worker) {
   pool_ = pool;
@@ -53,6 +67,7 @@ bool ThreadWorker::IsCore() { return is_core_worker_; }
 void ThreadWorker::SetCore(bool is_core) { is_core_worker_ = is_core; }
 
 void ThreadWorker::Run(ThreadWorker *worker) {
+  current_pool = worker->pool_;
   while (worker->running_) {
     worker->ChangeNameNow();
     worker->pool_->RunWorker(worker);
@@ -60,6 +75,7 @@ void ThreadWorker::Run(ThreadWorker *worker) {
 
   auto pool = worker->pool_;
   worker->pool_ = nullptr;
+  current_pool = nullptr;
   auto thread = worker->thread_;
   std::unique_lock<std::mutex> lock(worker->lock_);
   if (!worker->is_joining_ && worker->thread_) {
@@ -157,6 +173,11 @@ void ThreadPool::ExitWorker(ThreadWorker *worker) {
 }
 
 bool ThreadPool::Park(ThreadWorker *worker, ThreadFunction &task) {
+  if (IsOverAdaptiveLimit(worker)) {
+    worker->Stop();
+    return false;
+  }
+
   auto wait_time = 0;
   if (worker->IsCore() == false) {
     int extend_thread_size = worker_num_ - thread_size_;
@@ -197,6 +218,17 @@ void ThreadPool::RunWorker(ThreadWorker *worker) {
     return;
   }
 
+  if (adaptive_ && task.submit_time.time_since_epoch().count() != 0) {
+    auto wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - task.submit_time)
+                       .count();
+    // concurrent update may lose a sample, it is an estimate only
+    auto avg = queue_wait_ns_.load(std::memory_order_relaxed);
+    queue_wait_ns_.store(avg + (wait_ns - avg) / QUEUE_WAIT_AVG_WEIGHT,
+                         std::memory_order_relaxed);
+    AdaptiveGrow();
+  }
+
   if (task.name.length() > 0) {
     worker->SetName(task.name);
     worker->ChangeNameNow();
@@ -244,22 +276,30 @@ Status ThreadPool::AddWorker(bool core_worker) {
 
 bool ThreadPool::SubmitTask(ThreadFunction &task) {
   bool is_queued = false;
+  bool adaptive = adaptive_;
   if (worker_num_++ < thread_size_) {
     AddWorker(true);
   }
   worker_num_--;
 
+  if (adaptive) {
+    task.submit_time = std::chrono::steady_clock::now();
+  }
+
   auto ret = work_queue_->Push(task, -1);
   if (ret == true) {
     is_queued = true;
     if ((!work_queue_->Full() && thread_size_ > 0) || available_num_ > 0) {
+      if (adaptive) {
+        AdaptiveGrow();
+      }
       return ret;
     }
   }
 
-  // expand extend thread pool
+  // expand extend thread pool, blocked threads are not counted if adaptive
   auto num = worker_num_++;
-  if (num < max_thread_size_) {
+  if (num < max_thread_size_ + (adaptive ? blocking_num_.load() : 0)) {
     bool create_core = false;
     if (num < thread_size_) {
       create_core = true;
@@ -282,6 +322,73 @@ bool ThreadPool::SubmitTask(ThreadFunction &task) {
   return ret;
 }
 
+void ThreadPool::AdaptiveGrow() {
+  auto target_wait_ns = target_wait_ns_.load(std::memory_order_relaxed);
+  if (available_num_ > 0 || work_queue_->Size() == 0 ||
+      queue_wait_ns_.load(std::memory_order_relaxed) < target_wait_ns) {
+    return;
+  }
+
+  // at most one thread per target wait, give new thread time to drain queue
+  auto now = SteadyNowNs();
+  auto last = last_grow_ns_.load();
+  if (now - last < target_wait_ns ||
+      !last_grow_ns_.compare_exchange_strong(last, now)) {
+    return;
+  }
+
+  // more running threads than cpus do not shorten queue wait of cpu bound
+  // tasks, blocked threads are compensated separately
+  auto grow_limit =
+      std::min(max_thread_size_, std::max(thread_size_, cpu_num_));
+  auto num = worker_num_++;
+  if (num < grow_limit + blocking_num_) {
+    AddWorker(num < thread_size_);
+  }
+  worker_num_--;
+}
+
+void ThreadPool::CompensateBlocking() {
+  // keep thread size threads not blocked, so other tasks are not starved
+  if (available_num_ > 0 || worker_num_ - blocking_num_ >= thread_size_) {
+    return;
+  }
+
+  auto num = worker_num_++;
+  if (num < max_thread_size_ + blocking_num_) {
+    AddWorker(false);
+  }
+  worker_num_--;
+}
+
+bool ThreadPool::IsOverAdaptiveLimit(ThreadWorker *worker) {
+  // compensating thread leaves once blocked threads return
+  return adaptive_ && worker->IsCore() == false &&
+         worker_num_ - blocking_num_ > max_thread_size_;
+}
+
+void ThreadPool::BeginBlocking() {
+  if (blocking_depth++ > 0 || current_pool == nullptr ||
+      current_pool->adaptive_ == false) {
+    return;
+  }
+
+  blocking_pool = current_pool;
+  blocking_pool->blocking_num_++;
+  blocking_pool->CompensateBlocking();
+}
+
+void ThreadPool::EndBlocking() {
+  if (blocking_depth == 0 || --blocking_depth > 0) {
+    return;
+  }
+
+  if (blocking_pool != nullptr) {
+    blocking_pool->blocking_num_--;
+    blocking_pool = nullptr;
+  }
+}
+
 void ThreadPool::StopWokers() {
   work_queue_->Shutdown();
   std::unique_lock<std::mutex> lock(lock_);
@@ -335,12 +442,28 @@ void ThreadPool::SetKeepAlive(uint32_t timeout) {
   work_queue_->Wakeup();
 }
 
+void ThreadPool::SetAdaptive(bool enable, uint32_t target_wait_us) {
+  target_wait_ns_ = (int64_t)target_wait_us * 1000;
+  adaptive_ = enable;
+  work_queue_->Wakeup();
+}
+
+bool ThreadPool::IsAdaptive() { return adaptive_; }
+
 int ThreadPool::GetThreadsNum() { return worker_num_; }
 
 int ThreadPool::GetMaxThreadsNum() { return max_thread_size_; }
 
+int ThreadPool::GetIdleThreadsNum() { return available_num_; }
+
 int ThreadPool::GetWaitingWorkCount() {
   return work_queue_ ? work_queue_->Size() : 0;
 }
 
+int ThreadPool::GetBlockingThreadsNum() { return blocking_num_; }
+
+uint64_t ThreadPool::GetQueueWaitTime() {
+  return queue_wait_ns_.load(std::memory_order_relaxed) / 1000;
+}
+
 }  // namespace modelbox
@@ -0,0 +1,561 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "modelbox/base/shm_ring.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+
+#include "modelbox/base/log.h"
+#include "modelbox/base/utils.h"
+#include "securec.h"
+
+namespace modelbox {
+
+constexpr uint32_t SHM_RING_MAGIC = 0x474e5253;
+constexpr uint32_t SHM_RING_VERSION = 1;
+constexpr uint32_t SHM_RING_MAX_SLOTS = 1 << 16;
+constexpr size_t SHM_RING_MAX_SLOT_SIZE = 1UL << 30;
+constexpr size_t SHM_RING_ALIGN = 64;
+constexpr size_t SHM_RING_PAGE = 4096;
+constexpr int SHM_RING_FD_NUM = 3;
+constexpr unsigned int SHM_RING_MFD_FLAGS = 0x0001U | 0x0002U;
+
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#define F_GET_SEALS (1024 + 10)
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+
+// producer can not resize memory after handshake, or consumer gets SIGBUS
+constexpr int SHM_RING_SEALS = F_SEAL_SHRINK | F_SEAL_GROW;
+
+enum ShmRingSlotState : uint32_t {
+  SHM_SLOT_FREE = 0,
+  SHM_SLOT_READY = 1,
+  SHM_SLOT_READING = 2,
+};
+
+struct ShmRingHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_num;
+  uint32_t reserved;
+  uint64_t slot_size;
+  uint64_t map_size;
+  // written by producer
+  alignas(SHM_RING_ALIGN) std::atomic<uint64_t> head;
+  std::atomic<uint32_t> producer_closed;
+  std::atomic<uint32_t> producer_waiting;
+  // written by consumer
+  alignas(SHM_RING_ALIGN) std::atomic<uint64_t> tail;
+  std::atomic<uint32_t> consumer_waiting;
+};
+
+struct ShmRingSlot {
+  std::atomic<uint32_t> state;
+  uint32_t meta_len;
+  uint64_t size;
+};
+
+static inline size_t AlignUp(size_t size, size_t align) {
+  return (size + align - 1) / align * align;
+}
+
+static size_t SlotsOffset() {
+  return AlignUp(sizeof(ShmRingHeader), SHM_RING_ALIGN);
+}
+
+static size_t DataOffset(uint32_t slot_num) {
+  return AlignUp(SlotsOffset() + sizeof(ShmRingSlot) * slot_num, SHM_RING_PAGE);
+}
+
+static size_t MapSize(uint32_t slot_num, size_t slot_size) {
+  return DataOffset(slot_num) + slot_size * slot_num;
+}
+
+ShmRing::ShmRing() {}
+
+ShmRing::~ShmRing() {
+  if (map_ != nullptr) {
+    munmap(map_, map_size_);
+    map_ = nullptr;
+  }
+
+  for (auto *fd : {&sock_fd_, &mem_fd_, &data_fd_, &space_fd_}) {
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+}
+
+Status ShmRing::Map(size_t map_size, bool init, uint32_t slot_num,
+                    size_t slot_size) {
+  map_ = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd_,
+              0);
+  if (map_ == MAP_FAILED) {
+    map_ = nullptr;
+    return {STATUS_NOMEM, "map shared ring failed, " + StrError(errno)};
+  }
+
+  map_size_ = map_size;
+  header_ = (ShmRingHeader *)map_;
+  if (init) {
+    // memfd is zero filled, all slots are free
+    header_->magic = SHM_RING_MAGIC;
+    header_->version = SHM_RING_VERSION;
+    header_->slot_num = slot_num;
+    header_->slot_size = slot_size;
+    header_->map_size = map_size;
+  } else {
+    // header is writable by peer, read once and only use the checked copy
+    volatile ShmRingHeader *header = header_;
+    uint32_t magic = header->magic;
+    uint32_t version = header->version;
+    uint64_t header_map_size = header->map_size;
+    slot_num = header->slot_num;
+    slot_size = header->slot_size;
+    if (magic != SHM_RING_MAGIC || version != SHM_RING_VERSION ||
+        header_map_size != map_size || slot_num == 0 ||
+        slot_num > SHM_RING_MAX_SLOTS || (slot_num & (slot_num - 1)) != 0 ||
+        slot_size > SHM_RING_MAX_SLOT_SIZE ||
+        MapSize(slot_num, slot_size) != map_size) {
+      return {STATUS_INVALID, "invalid shared ring header"};
+    }
+  }
+
+  slot_num_ = slot_num;
+  slot_size_ = slot_size;
+  slots_ = (ShmRingSlot *)((uint8_t *)map_ + SlotsOffset());
+  data_ = (uint8_t *)map_ + DataOffset(slot_num_);
+  return STATUS_OK;
+}
+
+ShmRingSlot *ShmRing::GetSlot(uint64_t seq) const {
+  return &slots_[seq & (slot_num_ - 1)];
+}
+
+uint8_t *ShmRing::GetSlotData(uint64_t seq) const {
+  return data_ + (seq & (slot_num_ - 1)) * slot_size_;
+}
+
+Status ShmRing::Listen(const std::string &path, int *listen_fd) {
+  struct sockaddr_un addr;
+  memset_s(&addr, sizeof(addr), 0, sizeof(addr));
+  if (path.empty() || path.length() >= sizeof(addr.sun_path)) {
+    return {STATUS_INVALID, "invalid unix socket path " + path};
+  }
+
+  addr.sun_family = AF_UNIX;
+  strncpy_s(addr.sun_path, sizeof(addr.sun_path), path.c_str(),
+            path.length());
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return {STATUS_FAULT, "create socket failed, " + StrError(errno)};
+  }
+
+  unlink(addr.sun_path);
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    auto err = errno;
+    close(fd);
+    return {STATUS_FAULT, "listen " + path + " failed, " + StrError(err)};
+  }
+
+  chmod(addr.sun_path, 0660);
+  *listen_fd = fd;
+  return STATUS_OK;
+}
+
+Status ShmRing::Connect(const std::string &path, uint32_t slot_num,
+                        size_t slot_size, std::shared_ptr<ShmRing> *ring) {
+  if (slot_num == 0 || slot_num > SHM_RING_MAX_SLOTS || slot_size == 0 ||
+      slot_size > SHM_RING_MAX_SLOT_SIZE) {
+    return {STATUS_INVALID, "invalid shared ring size"};
+  }
+
+  uint32_t num = 1;
+  while (num < slot_num) {
+    num <<= 1;
+  }
+
+  slot_size = AlignUp(slot_size, SHM_RING_ALIGN);
+  auto map_size = MapSize(num, slot_size);
+  std::shared_ptr<ShmRing> new_ring(new ShmRing());
+  new_ring->mem_fd_ =
+      syscall(SYS_memfd_create, "modelbox-shm-ring", SHM_RING_MFD_FLAGS);
+  if (new_ring->mem_fd_ < 0) {
+    return {STATUS_FAULT, "create memfd failed, " + StrError(errno)};
+  }
+
+  if (ftruncate(new_ring->mem_fd_, map_size) != 0) {
+    return {STATUS_NOMEM, "resize memfd failed, " + StrError(errno)};
+  }
+
+  if (fcntl(new_ring->mem_fd_, F_ADD_SEALS, SHM_RING_SEALS) != 0) {
+    return {STATUS_FAULT, "seal memfd failed, " + StrError(errno)};
+  }
+
+  auto ret = new_ring->Map(map_size, true, num, slot_size);
+  if (!ret) {
+    return ret;
+  }
+
+  new_ring->data_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  new_ring->space_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  new_ring->sock_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (new_ring->data_fd_ < 0 || new_ring->space_fd_ < 0 ||
+      new_ring->sock_fd_ < 0) {
+    return {STATUS_FAULT, "create ring fd failed, " + StrError(errno)};
+  }
+
+  struct sockaddr_un addr;
+  memset_s(&addr, sizeof(addr), 0, sizeof(addr));
+  if (path.empty() || path.length() >= sizeof(addr.sun_path)) {
+    return {STATUS_INVALID, "invalid unix socket path " + path};
+  }
+
+  addr.sun_family = AF_UNIX;
+  strncpy_s(addr.sun_path, sizeof(addr.sun_path), path.c_str(),
+            path.length());
+  if (connect(new_ring->sock_fd_, (struct sockaddr *)&addr, sizeof(addr)) !=
+      0) {
+    return {STATUS_FAULT, "connect " + path + " failed, " + StrError(errno)};
+  }
+
+  // map size as payload, fds as ancillary data
+  uint64_t payload = map_size;
+  struct iovec iov;
+  iov.iov_base = &payload;
+  iov.iov_len = sizeof(payload);
+  char control[CMSG_SPACE(sizeof(int) * SHM_RING_FD_NUM)];
+  memset_s(control, sizeof(control), 0, sizeof(control));
+  struct msghdr msg;
+  memset_s(&msg, sizeof(msg), 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  auto *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int) * SHM_RING_FD_NUM);
+  int fds[SHM_RING_FD_NUM] = {new_ring->mem_fd_, new_ring->data_fd_,
+                              new_ring->space_fd_};
+  memcpy_s(CMSG_DATA(cmsg), sizeof(fds), fds, sizeof(fds));
+  if (sendmsg(new_ring->sock_fd_, &msg, MSG_NOSIGNAL) != sizeof(payload)) {
+    return {STATUS_FAULT, "send ring fds failed, " + StrError(errno)};
+  }
+
+  *ring = new_ring;
+  return STATUS_OK;
+}
+
+Status ShmRing::Accept(int listen_fd, std::shared_ptr<ShmRing> *ring,
+                       int32_t timeout) {
+  std::shared_ptr<ShmRing> new_ring(new ShmRing());
+  new_ring->sock_fd_ = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+  if (new_ring->sock_fd_ < 0) {
+    return {STATUS_FAULT, "accept producer failed, " + StrError(errno)};
+  }
+
+  // a silent peer must not block the accepting thread
+  struct pollfd pfd;
+  pfd.fd = new_ring->sock_fd_;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  auto poll_ret = poll(&pfd, 1, timeout);
+  if (poll_ret == 0) {
+    return {STATUS_TIMEDOUT, "wait shared ring handshake timeout"};
+  }
+
+  if (poll_ret < 0 || !(pfd.revents & POLLIN)) {
+    return {STATUS_FAULT, "wait shared ring handshake failed"};
+  }
+
+  uint64_t payload = 0;
+  struct iovec iov;
+  iov.iov_base = &payload;
+  iov.iov_len = sizeof(payload);
+  char control[CMSG_SPACE(sizeof(int) * SHM_RING_FD_NUM)];
+  struct msghdr msg;
+  memset_s(&msg, sizeof(msg), 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  auto len =
+      recvmsg(new_ring->sock_fd_, &msg, MSG_CMSG_CLOEXEC | MSG_DONTWAIT);
+  auto *cmsg = CMSG_FIRSTHDR(&msg);
+  if (len != sizeof(payload) || cmsg == nullptr ||
+      cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(sizeof(int) * SHM_RING_FD_NUM)) {
+    if (cmsg != nullptr && cmsg->cmsg_type == SCM_RIGHTS) {
+      auto fd_num = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      for (size_t i = 0; i < fd_num; ++i) {
+        close(((int *)CMSG_DATA(cmsg))[i]);
+      }
+    }
+
+    return {STATUS_INVALID, "invalid shared ring handshake"};
+  }
+
+  int fds[SHM_RING_FD_NUM];
+  memcpy_s(fds, sizeof(fds), CMSG_DATA(cmsg), sizeof(fds));
+  new_ring->mem_fd_ = fds[0];
+  new_ring->data_fd_ = fds[1];
+  new_ring->space_fd_ = fds[2];
+
+  struct stat mem_stat;
+  if (fstat(new_ring->mem_fd_, &mem_stat) != 0 ||
+      (uint64_t)mem_stat.st_size < payload) {
+    return {STATUS_INVALID, "shared ring memory is smaller than header"};
+  }
+
+  auto seals = fcntl(new_ring->mem_fd_, F_GET_SEALS);
+  if (seals < 0 || (seals & SHM_RING_SEALS) != SHM_RING_SEALS) {
+    return {STATUS_INVALID, "shared ring memory is not sealed"};
+  }
+
+  auto ret = new_ring->Map(payload, false, 0, 0);
+  if (!ret) {
+    return ret;
+  }
+
+  *ring = new_ring;
+  return STATUS_OK;
+}
+
+Status ShmRing::Wait(int doorbell_fd, std::atomic<uint32_t> *waiting,
+                     const std::function<bool()> &ready, int32_t timeout) {
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+  while (true) {
+    if (ready()) {
+      return STATUS_OK;
+    }
+
+    // announce wait before the last check, so the other side rings
+    waiting->store(1);
+    if (ready()) {
+      waiting->store(0);
+      return STATUS_OK;
+    }
+
+    int wait_ms = -1;
+    if (timeout >= 0) {
+      wait_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now())
+                    .count();
+      wait_ms = wait_ms < 0 ? 0 : wait_ms;
+    }
+
+    struct pollfd fds[2];
+    fds[0].fd = doorbell_fd;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = sock_fd_;
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+    auto ret = poll(fds, 2, wait_ms);
+    waiting->store(0);
+    if (ret < 0 && errno != EINTR) {
+      return {STATUS_FAULT, "wait shared ring failed, " + StrError(errno)};
+    }
+
+    if (fds[0].revents & POLLIN) {
+      uint64_t value = 0;
+      auto len = read(doorbell_fd, &value, sizeof(value));
+      UNUSED_VAR(len);
+    }
+
+    // nothing is sent after handshake, readable means peer exited
+    if (fds[1].revents & (POLLIN | POLLHUP | POLLERR)) {
+      return ready() ? STATUS_OK : Status(STATUS_EOF);
+    }
+
+    if (ret == 0 && wait_ms == 0) {
+      return ready() ? STATUS_OK : Status(STATUS_TIMEDOUT);
+    }
+  }
+}
+
+void ShmRing::Ring(int doorbell_fd, std::atomic<uint32_t> *waiting) {
+  if (waiting != nullptr && waiting->load() == 0) {
+    return;
+  }
+
+  uint64_t value = 1;
+  auto len = write(doorbell_fd, &value, sizeof(value));
+  UNUSED_VAR(len);
+}
+
+Status ShmRing::Reserve(size_t size, void **data, int32_t timeout,
+                        const std::string &meta) {
+  if (reserved_) {
+    return {STATUS_BUSY, "last reserved slot is not committed"};
+  }
+
+  if (size + meta.length() > slot_size_) {
+    return {STATUS_RANGE, "frame size " + std::to_string(size) +
+                              " exceeds slot size " +
+                              std::to_string(slot_size_)};
+  }
+
+  if (header_->producer_closed.load()) {
+    return {STATUS_SHUTDOWN, "shared ring is closed"};
+  }
+
+  auto seq = header_->head.load(std::memory_order_relaxed);
+  auto *slot = GetSlot(seq);
+  auto ret = Wait(space_fd_, &header_->producer_waiting,
+                  [slot]() { return slot->state.load() == SHM_SLOT_FREE; },
+                  timeout);
+  if (!ret) {
+    return ret;
+  }
+
+  // meta at slot end, data keeps slot alignment
+  auto *slot_data = GetSlotData(seq);
+  if (!meta.empty()) {
+    memcpy_s(slot_data + slot_size_ - meta.length(), meta.length(),
+             meta.data(), meta.length());
+  }
+
+  slot->meta_len = meta.length();
+  slot->size = size;
+  reserved_seq_ = seq;
+  reserved_ = true;
+  *data = slot_data;
+  return STATUS_OK;
+}
+
+Status ShmRing::Commit(size_t size) {
+  if (!reserved_) {
+    return {STATUS_INVALID, "no slot is reserved"};
+  }
+
+  auto *slot = GetSlot(reserved_seq_);
+  if (size > slot->size) {
+    return {STATUS_RANGE, "commit size exceeds reserved size"};
+  }
+
+  slot->size = size;
+  slot->state.store(SHM_SLOT_READY);
+  header_->head.store(reserved_seq_ + 1);
+  reserved_ = false;
+  Ring(data_fd_, &header_->consumer_waiting);
+  return STATUS_OK;
+}
+
+Status ShmRing::Write(const void *data, size_t size, const std::string &meta,
+                      int32_t timeout) {
+  void *slot_data = nullptr;
+  auto ret = Reserve(size, &slot_data, timeout, meta);
+  if (!ret) {
+    return ret;
+  }
+
+  if (size > 0) {
+    memcpy_s(slot_data, size, data, size);
+  }
+
+  return Commit(size);
+}
+
+void ShmRing::Close() {
+  header_->producer_closed.store(1);
+  Ring(data_fd_, nullptr);
+}
+
+Status ShmRing::Read(ShmRingFrame *frame, int32_t timeout) {
+  auto seq = header_->tail.load(std::memory_order_relaxed);
+  auto *slot = GetSlot(seq);
+  auto *header = header_;
+  auto ret = Wait(data_fd_, &header_->consumer_waiting,
+                  [slot, header]() {
+                    return slot->state.load() == SHM_SLOT_READY ||
+                           header->producer_closed.load() != 0;
+                  },
+                  timeout);
+  if (!ret) {
+    return ret;
+  }
+
+  if (slot->state.load() != SHM_SLOT_READY) {
+    return STATUS_EOF;
+  }
+
+  // producer memory is not trusted
+  uint64_t size = slot->size;
+  uint32_t meta_len = slot->meta_len;
+  if (meta_len > slot_size_ || size > slot_size_ - meta_len) {
+    return {STATUS_INVALID, "invalid shared ring frame size"};
+  }
+
+  auto *slot_data = GetSlotData(seq);
+  slot->state.store(SHM_SLOT_READING);
+  header_->tail.store(seq + 1);
+  in_use_++;
+  frame->slot = seq & (slot_num_ - 1);
+  frame->data = slot_data;
+  frame->size = size;
+  frame->meta.assign(
+      (const char *)slot_data + slot_size_ - meta_len, meta_len);
+  return STATUS_OK;
+}
+
+void ShmRing::Release(uint32_t slot) {
+  if (slot >= slot_num_) {
+    return;
+  }
+
+  uint32_t state = SHM_SLOT_READING;
+  if (!slots_[slot].state.compare_exchange_strong(state, SHM_SLOT_FREE)) {
+    MBLOG_WARN << "release shared ring slot " << slot << " not in use";
+    return;
+  }
+
+  in_use_--;
+  Ring(space_fd_, &header_->producer_waiting);
+}
+
+std::shared_ptr<void> ShmRing::Adopt(const ShmRingFrame &frame) {
+  auto self = shared_from_this();
+  auto slot = frame.slot;
+  return std::shared_ptr<void>(frame.data,
+                               [self, slot](void *) { self->Release(slot); });
+}
+
+uint32_t ShmRing::GetSlotNum() const { return slot_num_; }
+
+size_t ShmRing::GetSlotSize() const { return slot_size_; }
+
+uint32_t ShmRing::GetInUseCount() const { return in_use_.load(); }
+
+}  // namespace modelbox
@@ -102,6 +102,12 @@ std::shared_ptr<BufferProcessInfo> BufferIndexInfo::GetProcessInfo() {
   return process_info_;
 }
 
+void BufferIndexInfo::SetOriginTime(uint64_t origin_time) {
+  origin_time_ = origin_time;
+}
+
+uint64_t BufferIndexInfo::GetOriginTime() { return origin_time_; }
+
 std::shared_ptr<BufferIndexInfo> BufferManageView::GetIndexInfo(
     const std::shared_ptr<Buffer> &buffer) {
   return buffer->index_info_;
@@ -245,6 +245,9 @@ void DefaultDataHub::RemoveFromActivePort(
 
 size_t DefaultDataHub::GetPortNum() const { return priority_ports_.size(); }
 
-size_t DefaultDataHub::GetActivePortNum() const { return active_ports_.size(); }
+size_t DefaultDataHub::GetActivePortNum() const {
+  std::lock_guard<std::mutex> lock(active_mutex_);
+  return active_ports_.size();
+}
 
 }  // namespace modelbox
@@ -131,7 +131,7 @@ class DefaultDataHub : public DataHub {
   std::vector<std::shared_ptr<PriorityPort>> priority_ports_;
   std::set<std::shared_ptr<PriorityPort>, PortCompare> active_ports_;
 
-  std::mutex active_mutex_;
+  mutable std::mutex active_mutex_;
   std::condition_variable cv_;
 };
 
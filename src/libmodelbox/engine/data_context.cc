@@ -661,6 +661,11 @@ Status FlowUnitDataContext::UpdateOutputIndexInfo() {
       auto first_input_port = cur_node_process_info->GetParentBuffers().begin();
       auto first_buffer_info_in_port = first_input_port->second.front();
       UpdateBufferIndexInfo(cur_buffer_index_info, first_buffer_info_in_port);
+      // sampled for latency if the first input is sampled
+      if (cur_buffer_index_info->GetOriginTime() == 0) {
+        cur_buffer_index_info->SetOriginTime(
+            first_buffer_info_in_port->GetOriginTime());
+      }
     }
   }
   return STATUS_OK;
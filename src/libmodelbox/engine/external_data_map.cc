@@ -16,8 +16,14 @@
 
 #include "modelbox/external_data_map.h"
 
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cstring>
 #include <functional>
 
+#include "modelbox/base/utils.h"
 #include "modelbox/node.h"
 #include "modelbox/session.h"
 #include "modelbox/session_context.h"
@@ -150,6 +156,7 @@ Status ExternalDataMapImpl::SendMatchData(
       inherit_info->SetInheritFrom(root_buffer_);
       inherit_info->SetType(BufferProcessType::EXPAND);
       port_buffer_index_info->SetInheritInfo(inherit_info);
+      graph_input_node_->SampleLatency(port_buffer_index_info);
       graph_input_port->Send(port_data);
     }
   }
@@ -208,6 +215,11 @@ Status ExternalDataMapImpl::Recv(OutputBufferList& map_buffer_list,
     }
   }
 
+  // keep selectable while output or end is left, like level trigger
+  if (GetReadyFlag()) {
+    NotifySelector();
+  }
+
   return STATUS_OK;
 }
 
@@ -306,23 +318,22 @@ bool ExternalDataMapImpl::GetReadyFlag() {
   return !(graph_output_cache_->Empty());
 }
 
-void ExternalDataMapImpl::PushGraphOutputBuffer(OutputBufferList& output) {
-  auto size = graph_output_cache_->Size();
-  if (!graph_output_cache_->Push(output)) {
-    MBLOG_ERROR << "graph save output failed";
+void ExternalDataMapImpl::NotifySelector() {
+  auto selector = selector_.lock();
+  if (selector == nullptr) {
     return;
   }
 
-  if (size != 0) {
-    return;
-  }
+  selector->NotifySelect(shared_from_this());
+}
 
-  auto selector = selector_.lock();
-  if (selector == nullptr) {
+void ExternalDataMapImpl::PushGraphOutputBuffer(OutputBufferList& output) {
+  if (!graph_output_cache_->Push(output)) {
+    MBLOG_ERROR << "graph save output failed";
     return;
   }
 
-  selector->NotifySelect();
+  NotifySelector();
 }
 
 void ExternalDataMapImpl::SessionEnd(std::shared_ptr<FlowUnitError> error) {
@@ -337,87 +348,156 @@ void ExternalDataMapImpl::SessionEnd(std::shared_ptr<FlowUnitError> error) {
     graph_output_cache_->Shutdown();
   }
 
-  auto selector = selector_.lock();
-  if (selector != nullptr) {
-    selector->NotifySelect();
+  NotifySelector();
+}
+
+ExternalDataSelect::ExternalDataSelect() {
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd_ < 0) {
+    MBLOG_ERROR << "create select eventfd failed, " << StrError(errno);
+    return;
+  }
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    MBLOG_ERROR << "create select epoll failed, " << StrError(errno);
+    return;
+  }
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = event_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &event) != 0) {
+    MBLOG_ERROR << "add select eventfd to epoll failed, " << StrError(errno);
+    close(epoll_fd_);
+    epoll_fd_ = -1;
   }
 }
 
-ExternalDataSelect::ExternalDataSelect() {}
+ExternalDataSelect::~ExternalDataSelect() {
+  if (epoll_fd_ >= 0) {
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
 
-ExternalDataSelect::~ExternalDataSelect() {}
+  if (event_fd_ >= 0) {
+    close(event_fd_);
+    event_fd_ = -1;
+  }
+}
 
 void ExternalDataSelect::RegisterExternalData(
     std::shared_ptr<ExternalDataMap> externl) {
-  std::lock_guard<std::mutex> lock(external_list_lock_);
   std::shared_ptr<ExternalDataMapImpl> externl_data =
       std::dynamic_pointer_cast<ExternalDataMapImpl>(externl);
-  external_list_.push_back(externl_data);
+  if (externl_data == nullptr) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(external_list_lock_);
+    external_maps_[externl_data.get()] = externl_data;
+  }
+
   externl_data->SetSelector(shared_from_this());
+  // output may arrive before selector is set
+  if (externl_data->GetReadyFlag()) {
+    NotifySelect(externl_data);
+  }
 }
 
 void ExternalDataSelect::RemoveExternalData(
     const std::shared_ptr<ExternalDataMap>& externl_data) {
+  auto* data = dynamic_cast<ExternalDataMapImpl*>(externl_data.get());
   std::lock_guard<std::mutex> lock(external_list_lock_);
-  auto iter = external_list_.begin();
-  while (iter != external_list_.end()) {
-    if (*iter == std::dynamic_pointer_cast<ExternalDataMapImpl>(externl_data)) {
-      iter = external_list_.erase(iter);
-      break;
-    } else {
-      iter++;
-    }
-  }
+  // entry left in ready list is skipped when popped
+  external_maps_.erase(data);
 }
 
 bool ExternalDataSelect::IsExternalDataReady() {
   std::lock_guard<std::mutex> lock(external_list_lock_);
-  if (external_list_.empty()) {
-    // wait for external_data_map insert
-    return false;
-  }
-
-  for (auto external_data : external_list_) {
-    if (external_data->GetReadyFlag()) {
-      return true;
-    }
-  }
-
-  return false;
+  return !ready_list_.empty();
 }
 
+int ExternalDataSelect::GetSelectFd() { return epoll_fd_; }
+
 Status ExternalDataSelect::SelectExternalData(
     std::list<std::shared_ptr<ExternalDataMap>>& external_list,
-    std::chrono::duration<long, std::milli> waittime) {
-  MBLOG_DEBUG << "SelectExternalData";
-  // wait for data ready
-  {
-    std::unique_lock<std::mutex> lck(data_ready_mtx_);
-    auto data_ready_func = [this]() { return IsExternalDataReady(); };
-    if (waittime <= std::chrono::milliseconds(0)) {
-      data_ready_cv_.wait(lck, data_ready_func);
-    } else {
-      if (!data_ready_cv_.wait_for(lck, waittime, data_ready_func)) {
+    std::chrono::duration<long, std::milli> waittime, size_t max_num) {
+  if (epoll_fd_ < 0) {
+    return {STATUS_FAULT, "select fd is invalid"};
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + waittime;
+  while (!PopReadyList(external_list, max_num)) {
+    int timeout = -1;
+    if (waittime > std::chrono::milliseconds(0)) {
+      auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      deadline - std::chrono::steady_clock::now())
+                      .count();
+      if (left <= 0) {
         return STATUS_TIMEDOUT;
       }
+
+      timeout = left;
+    }
+
+    struct epoll_event event;
+    if (epoll_wait(epoll_fd_, &event, 1, timeout) < 0 && errno != EINTR) {
+      return {STATUS_FAULT, "wait select fd failed, " + StrError(errno)};
     }
   }
 
-  // get ready external data
+  return STATUS_SUCCESS;
+}
+
+bool ExternalDataSelect::PopReadyList(
+    std::list<std::shared_ptr<ExternalDataMap>>& external_list,
+    size_t max_num) {
+  size_t count = 0;
   std::lock_guard<std::mutex> lock(external_list_lock_);
-  for (auto external_data : external_list_) {
-    if (external_data->GetReadyFlag()) {
-      external_list.push_back(external_data);
+  while (!ready_list_.empty() && (max_num == 0 || count < max_num)) {
+    auto external_data = ready_list_.front();
+    ready_list_.pop_front();
+    // clear before checking, output pushed later will queue it again
+    external_data->select_ready_ = false;
+    if (external_maps_.find(external_data.get()) == external_maps_.end() ||
+        !external_data->GetReadyFlag()) {
+      continue;
     }
+
+    external_list.push_back(external_data);
+    count++;
   }
 
-  return STATUS_SUCCESS;
+  if (ready_list_.empty()) {
+    uint64_t value = 0;
+    while (read(event_fd_, &value, sizeof(value)) < 0 && errno == EINTR) {
+    }
+  }
+
+  return count > 0;
 }
 
-void ExternalDataSelect::NotifySelect() {
-  std::unique_lock<std::mutex> lck(data_ready_mtx_);
-  data_ready_cv_.notify_one();
-  MBLOG_DEBUG << "NotifySelect";
+void ExternalDataSelect::NotifySelect(
+    const std::shared_ptr<ExternalDataMapImpl>& external_data) {
+  if (external_data->select_ready_.exchange(true)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(external_list_lock_);
+  if (external_maps_.find(external_data.get()) == external_maps_.end()) {
+    external_data->select_ready_ = false;
+    return;
+  }
+
+  ready_list_.push_back(external_data);
+  if (ready_list_.size() == 1) {
+    uint64_t value = 1;
+    while (write(event_fd_, &value, sizeof(value)) < 0 && errno == EINTR) {
+    }
+  }
 }
 
-}  // namespace modelbox
\ No newline at end of file
+}  // namespace modelbox
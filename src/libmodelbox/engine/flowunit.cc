@@ -176,4 +176,96 @@ Status FlowUnitDesc::CheckOptionDuplication(
   return STATUS_OK;
 }
 
+SharedFlowUnit::SharedFlowUnit(std::shared_ptr<FlowUnit> flowunit,
+                               std::shared_ptr<FlowUnitFactory> factory)
+    : flowunit_(flowunit), factory_(factory) {}
+
+SharedFlowUnit::~SharedFlowUnit() {
+  if (!opened_) {
+    return;
+  }
+
+  auto name = flowunit_->GetFlowUnitDesc()->GetFlowUnitName();
+  Status status;
+  try {
+    status = flowunit_->Close();
+  } catch (const std::exception &e) {
+    status = {STATUS_FAULT, e.what()};
+  }
+
+  if (!status) {
+    MBLOG_WARN << "shared flowunit " << name << " close failed: " << status;
+    return;
+  }
+
+  MBLOG_INFO << "shared flowunit " << name << " closed.";
+}
+
+std::shared_ptr<FlowUnit> SharedFlowUnit::GetFlowUnit() { return flowunit_; }
+
+Status SharedFlowUnit::Open(const std::shared_ptr<Configuration> &config) {
+  std::lock_guard<std::mutex> lock(open_lock_);
+  if (opened_) {
+    return STATUS_OK;
+  }
+
+  // open failed may retry by next node
+  auto status = flowunit_->Open(config);
+  if (!status) {
+    return status;
+  }
+
+  opened_ = true;
+  MBLOG_INFO << "shared flowunit "
+             << flowunit_->GetFlowUnitDesc()->GetFlowUnitName() << " opened.";
+  return STATUS_OK;
+}
+
+SharedFlowUnitRegistry &SharedFlowUnitRegistry::GetInstance() {
+  static SharedFlowUnitRegistry registry;
+  return registry;
+}
+
+std::shared_ptr<SharedFlowUnit> SharedFlowUnitRegistry::GetOrCreate(
+    const std::string &key,
+    const std::function<std::shared_ptr<SharedFlowUnit>()> &create) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto shared_flowunit = shared_flowunits_[key].lock();
+  if (shared_flowunit == nullptr) {
+    shared_flowunit = create();
+  }
+
+  if (shared_flowunit == nullptr) {
+    shared_flowunits_.erase(key);
+  } else {
+    shared_flowunits_[key] = shared_flowunit;
+  }
+
+  PurgeExpired();
+  return shared_flowunit;
+}
+
+void SharedFlowUnitRegistry::Clear() {
+  std::lock_guard<std::mutex> lock(lock_);
+  shared_flowunits_.clear();
+}
+
+size_t SharedFlowUnitRegistry::Size() {
+  std::lock_guard<std::mutex> lock(lock_);
+  PurgeExpired();
+  return shared_flowunits_.size();
+}
+
+void SharedFlowUnitRegistry::PurgeExpired() {
+  for (auto iter = shared_flowunits_.begin();
+       iter != shared_flowunits_.end();) {
+    if (iter->second.expired()) {
+      iter = shared_flowunits_.erase(iter);
+      continue;
+    }
+
+    iter++;
+  }
+}
+
 }  // namespace modelbox
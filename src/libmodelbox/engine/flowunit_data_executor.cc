@@ -17,6 +17,7 @@
 #include "modelbox/flowunit_data_executor.h"
 
 #include "modelbox/node.h"
+#include "modelbox/profiler.h"
 
 namespace modelbox {
 
@@ -1047,7 +1048,21 @@ Status FlowUnitDataExecutor::DataCtxExecuteFunc(
     FlowUnit *flowunit, const BatchedFUExecDataCtxList &process_data,
     size_t data_ctx_idx) {
   auto &batched_fu_data_ctx = process_data[data_ctx_idx];
+  auto is_sampling = CpuSampler::IsSampling();
   for (auto &data_ctx : batched_fu_data_ctx) {
+    // process may run in device executor thread, tag it with node and session
+    uint32_t session_id = 0;
+    std::shared_ptr<DeviceMemoryAccount> session_account;
+    auto session_ctx = data_ctx->GetSessionContext();
+    if (session_ctx != nullptr) {
+      session_account = session_ctx->GetMemoryAccount();
+      if (is_sampling) {
+        session_id = CpuSampler::Intern(session_ctx->GetSessionId());
+      }
+    }
+
+    CpuSampleScope sample_scope(cpu_sample_id_, session_id);
+    DeviceMemoryAccountScope memory_scope(memory_account_, session_account);
     Status status = STATUS_FAULT;
     try {
       status = flowunit->Process(data_ctx);
@@ -1075,6 +1090,15 @@ void FlowUnitDataExecutor::SetNeedCheckOutput(bool need_check) {
   need_check_output_ = need_check;
 }
 
+void FlowUnitDataExecutor::SetCpuSampleId(uint32_t cpu_sample_id) {
+  cpu_sample_id_ = cpu_sample_id;
+}
+
+void FlowUnitDataExecutor::SetMemoryAccount(
+    std::shared_ptr<DeviceMemoryAccount> memory_account) {
+  memory_account_ = memory_account;
+}
+
 Status FlowUnitDataExecutor::Process(const FUExecContextList &exec_ctx_list) {
   /**
    * for event type data ctx list, all inputs is 0. (videodemuxer event input)
@@ -40,25 +40,29 @@ void FlowUnitGroup::InitTrace() {
     return;
   }
 
-  flowunit_trace_ = trace->FlowUnit(node->GetName());
-  if (flowunit_trace_ == nullptr) {
-    MBLOG_WARN << "create trace for node " << node->GetName() << " failed";
+  trace_recorder_ = trace->GetRecorder();
+  trace_name_id_ = trace_recorder_->Intern(node->GetName());
+  auto perf = profiler_->GetPerf();
+  if (perf != nullptr) {
+    perf_ctx_ = perf->GetFlowUnitPerfCtx(node->GetName());
   }
 }
 
-std::shared_ptr<TraceSlice> FlowUnitGroup::StartTrace(
+void FlowUnitGroup::RecordTrace(
+    const std::chrono::steady_clock::time_point &begin,
+    const std::chrono::steady_clock::time_point &end,
     FUExecContextList &exec_ctx_list) {
   std::call_once(trace_init_flag_, &FlowUnitGroup::InitTrace, this);
 
-  if (flowunit_trace_ == nullptr) {
-    return nullptr;
+  if (trace_recorder_ == nullptr || !trace_recorder_->IsEnable()) {
+    return;
   }
 
   auto total_input_count = std::accumulate(
       exec_ctx_list.begin(), exec_ctx_list.end(), (size_t)0,
       [](size_t sum, std::shared_ptr<FlowUnitExecContext> &exec_ctx) {
         const auto &data_ctx = exec_ctx->GetDataCtx();
-        auto inputs = data_ctx->GetInputs();
+        const auto &inputs = data_ctx->GetInputs();
         if (inputs.empty()) {
           // this is event
           return sum + 1;
@@ -68,16 +72,61 @@ std::shared_ptr<TraceSlice> FlowUnitGroup::StartTrace(
         return sum + input_count;
       });
 
-  auto slice = flowunit_trace_->Slice(TraceSliceType::PROCESS, "");
-  slice->SetBatchSize(total_input_count);
-  slice->Begin();
-  return slice;
+  trace_recorder_->Record(trace_name_id_, TraceSliceType::PROCESS, begin, end,
+                          total_input_count);
+  if (perf_ctx_ != nullptr) {
+    perf_ctx_->UpdateProcessLatency(
+        std::chrono::duration_cast<std::chrono::microseconds>(end - begin)
+            .count());
+  }
+}
+
+void FlowUnitGroup::SetStats(std::shared_ptr<StatisticsItem> node_stats) {
+  if (node_stats == nullptr) {
+    return;
+  }
+
+  auto latency_item = node_stats->AddHistogram("process_latency_us");
+  if (latency_item == nullptr) {
+    MBLOG_WARN << "add process latency statistics for " << unit_name_
+               << " failed, " << StatusError;
+    return;
+  }
+
+  process_latency_ = latency_item->GetHistogram();
+
+  auto buffers_item = node_stats->AddCounter("buffer_count");
+  if (buffers_item != nullptr) {
+    process_buffers_ = buffers_item->GetCounter();
+  }
+}
+
+void FlowUnitGroup::RecordProcessLatency(
+    const std::chrono::steady_clock::time_point &begin,
+    const std::chrono::steady_clock::time_point &end) {
+  if (process_latency_ == nullptr) {
+    return;
+  }
+
+  auto cost =
+      std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
+  process_latency_->Record(cost.count());
 }
 
-void FlowUnitGroup::StopTrace(std::shared_ptr<TraceSlice> &slice) {
-  if (slice != nullptr) {
-    slice->End();
+void FlowUnitGroup::RecordProcessBuffers(FUExecContextList &exec_ctx_list) {
+  if (process_buffers_ == nullptr) {
+    return;
+  }
+
+  uint64_t buffer_count = 0;
+  for (auto &exec_ctx : exec_ctx_list) {
+    const auto &inputs = exec_ctx->GetDataCtx()->GetInputs();
+    if (!inputs.empty()) {
+      buffer_count += inputs.begin()->second.size();
+    }
   }
+
+  process_buffers_->Increase(buffer_count);
 }
 
 void FlowUnitGroup::PreProcess(FUExecContextList &exec_ctx_list,
@@ -133,9 +182,12 @@ Status FlowUnitGroup::Process(FUExecContextList &exec_ctx_list) {
     return STATUS_SUCCESS;
   }
 
-  auto slice = StartTrace(actual_exec_ctx_list);
+  auto begin = std::chrono::steady_clock::now();
   auto status = executor_->Process(actual_exec_ctx_list);
-  StopTrace(slice);
+  auto end = std::chrono::steady_clock::now();
+  RecordProcessLatency(begin, end);
+  RecordProcessBuffers(actual_exec_ctx_list);
+  RecordTrace(begin, end, actual_exec_ctx_list);
   if (!status) {
     MBLOG_WARN << "execute unit " << unit_name_ << " failed: " << status;
     return STATUS_STOP;
@@ -214,6 +266,8 @@ FUExecContextList FlowUnitGroup::CreateExecCtx(
 
 Status FlowUnitGroup::Run(
     std::list<std::shared_ptr<FlowUnitDataContext>> &data_ctx_list) {
+  CpuSampleScope sample_scope(cpu_sample_id_);
+  DeviceMemoryAccountScope memory_scope(memory_account_, nullptr);
   FUExecContextList err_exec_ctx_list;
   Status status = STATUS_OK;
   Status ret_status = STATUS_OK;
@@ -251,7 +305,11 @@ Status FlowUnitGroup::Run(
   return ret_status;
 }
 
-void FlowUnitGroup::SetNode(std::shared_ptr<Node> node) { node_ = node; }
+void FlowUnitGroup::SetNode(std::shared_ptr<Node> node) {
+  node_ = node;
+  cpu_sample_id_ = CpuSampler::Intern(node->GetName());
+  memory_account_ = node->GetMemoryAccount();
+}
 
 std::shared_ptr<FlowUnit> FlowUnitGroup::GetExecutorUnit() {
   return flowunit_group_[0];
@@ -339,8 +397,23 @@ Status FlowUnitGroup::Init(const std::set<std::string> &input_ports_name,
     return STATUS_FAULT;
   }
 
-  flowunit_group_ =
-      flowunit_mgr->CreateFlowUnit(unit_name_, unit_type_, unit_device_id_);
+  if (config_ != nullptr && config_->GetBool("share_instance", false)) {
+    shared_flowunits_ = flowunit_mgr->CreateSharedFlowUnit(
+        unit_name_, unit_type_, unit_device_id_, config_);
+    if (shared_flowunits_.empty() && StatusError == STATUS_NOTSUPPORT) {
+      MBLOG_WARN << StatusError.Errormsg() << ", create for node only";
+    }
+
+    for (auto &shared_flowunit : shared_flowunits_) {
+      flowunit_group_.push_back(shared_flowunit->GetFlowUnit());
+    }
+  }
+
+  if (shared_flowunits_.empty()) {
+    flowunit_group_ =
+        flowunit_mgr->CreateFlowUnit(unit_name_, unit_type_, unit_device_id_);
+  }
+
   if (flowunit_group_.size() == 0) {
     if (StatusError == STATUS_OK) {
       StatusError = STATUS_NOTFOUND;
@@ -364,6 +437,8 @@ Status FlowUnitGroup::Init(const std::set<std::string> &input_ports_name,
 }
 
 Status FlowUnitGroup::Open(const CreateExternalDataFunc &create_func) {
+  // memory loaded in open, such as model, is charged to node
+  DeviceMemoryAccountScope memory_scope(memory_account_, nullptr);
   auto status = STATUS_OK;
   for (auto &flowunit : flowunit_group_) {
     if (!flowunit) {
@@ -372,9 +447,14 @@ Status FlowUnitGroup::Open(const CreateExternalDataFunc &create_func) {
     }
 
     auto flowunit_desc = flowunit->GetFlowUnitDesc();
-    flowunit->SetExternalData(create_func);
+    auto shared_flowunit = GetSharedFlowUnit(flowunit);
     try {
-      status = flowunit->Open(config_);
+      if (shared_flowunit != nullptr) {
+        status = shared_flowunit->Open(config_);
+      } else {
+        flowunit->SetExternalData(create_func);
+        status = flowunit->Open(config_);
+      }
     } catch (const std::exception &e) {
       status = {STATUS_FAULT,
                 flowunit_desc->GetFlowUnitName() + " open failed, " + e.what()};
@@ -427,9 +507,22 @@ Status FlowUnitGroup::Open(const CreateExternalDataFunc &create_func) {
 
   executor_ = std::make_shared<FlowUnitDataExecutor>(node_, batch_size_);
   executor_->SetNeedCheckOutput(need_check_output);
+  executor_->SetCpuSampleId(cpu_sample_id_);
+  executor_->SetMemoryAccount(memory_account_);
   return status;
 }
 
+std::shared_ptr<SharedFlowUnit> FlowUnitGroup::GetSharedFlowUnit(
+    const std::shared_ptr<FlowUnit> &flowunit) {
+  for (auto &shared_flowunit : shared_flowunits_) {
+    if (shared_flowunit->GetFlowUnit() == flowunit) {
+      return shared_flowunit;
+    }
+  }
+
+  return nullptr;
+}
+
 Status FlowUnitGroup::Close() {
   auto status = STATUS_OK;
   for (auto &flowunit : flowunit_group_) {
@@ -438,6 +531,11 @@ Status FlowUnitGroup::Close() {
       continue;
     }
 
+    if (GetSharedFlowUnit(flowunit) != nullptr) {
+      // closed by last node releases it
+      continue;
+    }
+
     auto flowunit_desc = flowunit->GetFlowUnitDesc();
     try {
       status = flowunit->Close();
@@ -457,6 +555,7 @@ Status FlowUnitGroup::Close() {
                 << flowunit_desc->GetFlowUnitAliasName() << " closed.";
   }
 
+  shared_flowunits_.clear();
   return status;
 }
 
@@ -15,6 +15,8 @@
  */
 
 #include <algorithm>
+#include <mutex>
+#include <unordered_map>
 
 #include "modelbox/base/log.h"
 #include "modelbox/flowunit.h"
@@ -32,6 +34,12 @@ std::shared_ptr<FlowUnitManager> FlowUnitManager::GetInstance() {
 
 std::shared_ptr<FlowUnitDesc> FlowUnitManager::GetFlowUnitDesc(
     const std::string &flowunit_type, const std::string &flowunit_name) {
+  auto type_iter = flowunit_desc_list_.find(flowunit_type);
+  if (type_iter == flowunit_desc_list_.end() ||
+      type_iter->second.find(flowunit_name) == type_iter->second.end()) {
+    LoadLazyDrivers();
+  }
+
   auto iter_device_type = flowunit_desc_list_.find(flowunit_type);
   if (iter_device_type == flowunit_desc_list_.end()) {
     MBLOG_ERROR << "do not find device_type " << flowunit_type
@@ -74,15 +82,79 @@ Status FlowUnitManager::Initialize(std::shared_ptr<Drivers> driver,
   return status;
 }
 
+void FlowUnitManager::SetFlowUnitFilter(
+    const std::set<std::string> &flowunit_names) {
+  flowunit_filter_ = flowunit_names;
+}
+
 Status FlowUnitManager::InitFlowUnitFactory(std::shared_ptr<Drivers> driver) {
   std::vector<std::shared_ptr<Driver>> driver_list =
       driver->GetDriverListByClass("DRIVER-FLOWUNIT");
   std::vector<std::shared_ptr<Driver>> inference_driver_list =
       driver->GetDriverListByClass("DRIVER-INFERENCE");
-  for (auto &infer_driver : inference_driver_list) {
-    driver_list.emplace_back(infer_driver);
+  if (flowunit_filter_.empty()) {
+    for (auto &infer_driver : inference_driver_list) {
+      driver_list.emplace_back(infer_driver);
+    }
+
+    return AddFlowUnitFactory(driver_list);
+  }
+
+  // driver name is flowunit name mostly, dlopen them only. inference
+  // flowunit is named by model, its driver is always loaded
+  std::vector<std::shared_ptr<Driver>> load_list = inference_driver_list;
+  std::set<std::string> unmatched_names = flowunit_filter_;
+  for (auto &flowunit_driver : driver_list) {
+    auto name = flowunit_driver->GetDriverDesc()->GetName();
+    if (flowunit_filter_.find(name) == flowunit_filter_.end()) {
+      lazy_drivers_.push_back(flowunit_driver);
+      continue;
+    }
+
+    unmatched_names.erase(name);
+    load_list.push_back(flowunit_driver);
+  }
+
+  // flowunit is provided by driver of other name, which one is unknown
+  // before dlopen, load all of them now rather than at first lookup
+  if (!unmatched_names.empty()) {
+    std::string names;
+    for (const auto &name : unmatched_names) {
+      names += (names.empty() ? "" : ", ") + name;
+    }
+
+    MBLOG_INFO << "no driver named as flowunit " << names
+               << ", load all flowunit drivers";
+    load_list.insert(load_list.end(), lazy_drivers_.begin(),
+                     lazy_drivers_.end());
+    lazy_drivers_.clear();
   }
 
+  MBLOG_DEBUG << "load " << load_list.size() << " flowunit drivers, "
+              << lazy_drivers_.size() << " drivers are loaded on demand";
+  return AddFlowUnitFactory(load_list);
+}
+
+size_t FlowUnitManager::GetLazyDriverCount() { return lazy_drivers_.size(); }
+
+void FlowUnitManager::LoadLazyDrivers() {
+  if (lazy_drivers_.empty()) {
+    return;
+  }
+
+  MBLOG_INFO << "load other " << lazy_drivers_.size() << " flowunit drivers";
+  std::vector<std::shared_ptr<Driver>> driver_list;
+  driver_list.swap(lazy_drivers_);
+  AddFlowUnitFactory(driver_list);
+  FlowUnitProbe();
+  auto ret = SetUpFlowUnitDesc();
+  if (!ret) {
+    MBLOG_WARN << "set up flowunit desc failed, " << ret;
+  }
+}
+
+Status FlowUnitManager::AddFlowUnitFactory(
+    const std::vector<std::shared_ptr<Driver>> &driver_list) {
   std::shared_ptr<DriverDesc> desc;
   for (auto &flowunit_driver : driver_list) {
     auto temp_factory = flowunit_driver->CreateFactory();
@@ -151,6 +223,7 @@ Status FlowUnitManager::Register(std::shared_ptr<FlowUnitFactory> factory) {
 }
 
 std::vector<std::string> FlowUnitManager::GetFlowUnitTypes() {
+  LoadLazyDrivers();
   std::vector<std::string> flowunit_type;
   std::set<std::string> tmp_set;
   for (auto &iter : flowunit_factory_) {
@@ -164,6 +237,20 @@ std::vector<std::string> FlowUnitManager::GetFlowUnitTypes() {
 std::vector<std::string> FlowUnitManager::GetFlowUnitTypes(
     const std::string &unit_name) {
   std::vector<std::string> unit_types;
+  auto has_unit = [&]() -> bool {
+    for (auto &iter : flowunit_desc_list_) {
+      if (iter.second.find(unit_name) != iter.second.end()) {
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  if (!has_unit()) {
+    LoadLazyDrivers();
+  }
+
   for (auto &iter : flowunit_desc_list_) {
     auto &dev_type = iter.first;
     auto &units = iter.second;
@@ -180,6 +267,7 @@ std::vector<std::string> FlowUnitManager::GetFlowUnitTypes(
 
 std::vector<std::string> FlowUnitManager::GetFlowUnitList(
     const std::string &unit_type) {
+  LoadLazyDrivers();
   std::vector<std::string> flowunit_name;
   auto iter = flowunit_desc_list_.find(unit_type);
   if (iter == flowunit_desc_list_.end()) {
@@ -346,6 +434,112 @@ std::vector<std::shared_ptr<FlowUnit>> FlowUnitManager::CreateFlowUnit(
   return flowunit_list;
 }
 
+// node keys not passed to flowunit open, nodes differ in them can share
+static const std::set<std::string> kShareIgnoreKeys = {
+    "label", "queue_size", "share_instance"};
+
+static std::string GetShareConfigKey(
+    const std::shared_ptr<Configuration> &config) {
+  std::string key;
+  if (config == nullptr) {
+    return key;
+  }
+
+  for (const auto &item : config->GetKeys()) {
+    if (kShareIgnoreKeys.find(item) != kShareIgnoreKeys.end()) {
+      continue;
+    }
+
+    key += item + "=" + config->GetString(item) + ";";
+  }
+
+  return key;
+}
+
+std::vector<std::shared_ptr<SharedFlowUnit>>
+FlowUnitManager::CreateSharedFlowUnit(
+    const std::string &unit_name, const std::string &unit_type,
+    const std::string &unit_device_id,
+    const std::shared_ptr<Configuration> &config) {
+  std::vector<std::shared_ptr<SharedFlowUnit>> shared_list;
+
+  StatusError = {STATUS_NOTFOUND};
+
+  auto ret = CheckParams(unit_name, unit_type, unit_device_id);
+  if (ret != modelbox::STATUS_OK) {
+    return shared_list;
+  }
+
+  FlowUnitDeviceConfig unit_dev_cfg;
+  ret = ParseUnitDeviceConf(unit_name, unit_type, unit_device_id, unit_dev_cfg);
+  if (!ret) {
+    MBLOG_ERROR << "Parse unit device config failed, err " << ret;
+    return shared_list;
+  }
+
+  auto config_key = GetShareConfigKey(config);
+  auto &registry = SharedFlowUnitRegistry::GetInstance();
+  for (auto &cfg_item : unit_dev_cfg) {
+    auto &dev_type = cfg_item.first;
+    auto desc = GetFlowUnitDesc(dev_type, unit_name);
+    if (desc != nullptr && desc->GetFlowUnitInput().empty()) {
+      // external data of source flowunit is bound to node
+      StatusError = {STATUS_NOTSUPPORT,
+                     "source flowunit " + unit_name + " can not be shared"};
+      shared_list.clear();
+      return shared_list;
+    }
+
+    // flowunits of same name from other driver file or version differ
+    auto factory_key = std::make_pair(dev_type, unit_name);
+    auto factory_iter = flowunit_factory_.find(factory_key);
+    if (factory_iter == flowunit_factory_.end()) {
+      LoadLazyDrivers();
+      factory_iter = flowunit_factory_.find(factory_key);
+    }
+
+    if (factory_iter == flowunit_factory_.end()) {
+      MBLOG_WARN << "CreateSharedFlowUnit: " << unit_name << ", " << dev_type
+                 << " failed, flowunit factory not found";
+      continue;
+    }
+
+    auto factory = factory_iter->second;
+    auto driver_desc = factory->GetDriver()->GetDriverDesc();
+    auto driver_key =
+        driver_desc->GetFilePath() + "@" + driver_desc->GetVersion();
+    for (auto &id : cfg_item.second) {
+      auto key = unit_name + "@" + dev_type + ":" + id + "#" + driver_key +
+                 "#" + config_key;
+      bool created = false;
+      auto shared_flowunit = registry.GetOrCreate(
+          key, [&]() -> std::shared_ptr<SharedFlowUnit> {
+            auto flowunit = CreateSingleFlowUnit(unit_name, dev_type, id);
+            if (flowunit == nullptr) {
+              return nullptr;
+            }
+
+            created = true;
+            return std::make_shared<SharedFlowUnit>(flowunit, factory);
+          });
+      if (shared_flowunit == nullptr) {
+        MBLOG_WARN << "CreateSharedFlowUnit: " << unit_name << " failed, "
+                   << StatusError;
+        continue;
+      }
+
+      if (!created) {
+        MBLOG_INFO << "reuse shared flowunit " << unit_name << ", " << dev_type
+                   << ":" << id;
+      }
+
+      shared_list.push_back(shared_flowunit);
+    }
+  }
+
+  return shared_list;
+}
+
 std::shared_ptr<FlowUnit> FlowUnitManager::CreateSingleFlowUnit(
     const std::string &unit_name, const std::string &unit_type,
     const std::string &unit_device_id) {
@@ -366,6 +560,11 @@ std::shared_ptr<FlowUnit> FlowUnitManager::CreateSingleFlowUnit(
   std::shared_ptr<modelbox::DeviceManager> device_mgr = GetDeviceManager();
 
   auto iter = flowunit_factory_.find(std::make_pair(unit_type, unit_name));
+  if (iter == flowunit_factory_.end()) {
+    LoadLazyDrivers();
+    iter = flowunit_factory_.find(std::make_pair(unit_type, unit_name));
+  }
+
   if (iter == flowunit_factory_.end()) {
     StatusError = {STATUS_NOTFOUND, "can not find flowunit[type: " + unit_type +
                                         ", name:" + unit_name +
@@ -427,15 +626,19 @@ std::shared_ptr<FlowUnit> FlowUnitManager::CreateSingleFlowUnit(
 void FlowUnitManager::Clear() {
   flowunit_desc_list_.clear();
   flowunit_factory_.clear();
+  flowunit_filter_.clear();
+  lazy_drivers_.clear();
 }
 
 std::map<std::pair<std::string, std::string>, std::shared_ptr<FlowUnitFactory>>
 FlowUnitManager::GetFlowUnitFactoryList() {
+  LoadLazyDrivers();
   return flowunit_factory_;
 }
 
 std::map<std::string, std::map<std::string, std::shared_ptr<FlowUnitDesc>>>
 FlowUnitManager::GetFlowUnitDescList() {
+  LoadLazyDrivers();
   return flowunit_desc_list_;
 }
 
@@ -462,6 +665,7 @@ Status FlowUnitManager::SetUpFlowUnitDesc() {
 
 std::vector<std::shared_ptr<FlowUnitDesc>>
 FlowUnitManager::GetAllFlowUnitDesc() {
+  LoadLazyDrivers();
   std::vector<std::shared_ptr<FlowUnitDesc>> desc_vec;
   for (auto &iter_device : flowunit_desc_list_) {
     for (auto &iter_name : flowunit_desc_list_[iter_device.first]) {
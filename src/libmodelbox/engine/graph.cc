@@ -34,6 +34,8 @@ constexpr const char *GRAPH_KEY_DEVICE_ID = "deviceid";
 constexpr const char *GRAPH_KEY_QUEUE_SIZE = "queue_size";
 constexpr const char *GRAPH_KEY_BATCH_SIZE = "batch_size";
 constexpr const char *GRAPH_KEY_CHECK_NODE_OUTPUT = "need_check_output";
+constexpr const char *GRAPH_KEY_LATENCY_SAMPLE_INTERVAL =
+    "graph.latency-sample-interval";
 
 Graph::Graph()
     : nodes_(),
@@ -54,6 +56,10 @@ Graph::~Graph() {
   if (flow_stats_ != nullptr) {
     flow_stats_->DelItem(id_);
   }
+
+  if (node_stats_ != nullptr) {
+    node_stats_->DelItem(id_);
+  }
 }
 
 Status Graph::Initialize(std::shared_ptr<FlowUnitManager> flowunit_mgr,
@@ -71,6 +77,7 @@ Status Graph::Initialize(std::shared_ptr<FlowUnitManager> flowunit_mgr,
   device_mgr_ = device_mgr;
   profiler_ = profiler;
   flow_stats_ = Statistics::GetGlobalItem()->GetItem(STATISTICS_ITEM_FLOW);
+  node_stats_ = Statistics::GetGlobalItem()->GetItem(STATISTICS_ITEM_NODE);
   config_ = config;
   auto ret = GetUUID(&id_);
   if (ret != STATUS_OK) {
@@ -86,6 +93,23 @@ Status Graph::Initialize(std::shared_ptr<FlowUnitManager> flowunit_mgr,
     }
   }
 
+  if (node_stats_ != nullptr) {
+    graph_node_stats_ = node_stats_->AddItem(id_);
+    if (graph_node_stats_ == nullptr) {
+      MBLOG_ERROR << "Get node stats for graph " << id_
+                  << " failed, err: " << StatusError.Errormsg();
+    }
+  }
+
+  latency_sample_interval_ =
+      config_->GetUint32(GRAPH_KEY_LATENCY_SAMPLE_INTERVAL, 0);
+  if (latency_sample_interval_ != 0 && graph_node_stats_ != nullptr) {
+    auto latency_item = graph_node_stats_->AddHistogram("graph_latency_us");
+    if (latency_item != nullptr) {
+      graph_latency_ = latency_item->GetHistogram();
+    }
+  }
+
   return STATUS_OK;
 }
 
@@ -93,6 +117,17 @@ std::string Graph::GetId() const { return id_; }
 
 std::string Graph::GetName() const { return name_; }
 
+size_t Graph::GetSessionCount() {
+  size_t count = 0;
+  for (auto &session : session_manager_.GetSessions()) {
+    if (!session.second.expired()) {
+      count++;
+    }
+  }
+
+  return count;
+}
+
 Status Graph::CheckLoopStructureNode() {
   Status status{STATUS_OK};
   for (auto &loop : loop_structures_) {
@@ -564,6 +599,13 @@ Status Graph::BuildFlowunitNode(std::shared_ptr<GCGraph> g,
   node->SetFlowUnitInfo(flowunit, device, deviceid, flowunit_mgr_);
   node->SetProfiler(profiler_);
   node->SetStats(graph_stats_);
+  node->SetLatencySampleInterval(latency_sample_interval_);
+  if (graph_node_stats_ != nullptr) {
+    node->SetNodeStats(graph_node_stats_->AddItem(name));
+  }
+  if (outports->size() == 0) {
+    node->SetGraphLatencyStats(graph_latency_);
+  }
   node->SetSessionManager(&session_manager_);
   node->SetName(name);
   auto status = InitNode(node, *inports, *outports, node_config);
@@ -657,6 +699,7 @@ Status Graph::BuildVirtualNodes(std::shared_ptr<GCGraph> g) {
   if (!input_node_ports_.empty()) {
     input_node_name_ = *input_node_ports_.begin();
     input_node_ = std::make_shared<InputVirtualNode>("cpu", "0", device_mgr_);
+    input_node_->SetLatencySampleInterval(latency_sample_interval_);
     auto input_config = input_node_config_map_.begin()->second;
     auto status = input_node_->Init({}, input_node_ports_, input_config);
     if (!status) {
@@ -685,6 +728,15 @@ Status Graph::BuildVirtualNodes(std::shared_ptr<GCGraph> g) {
       return {STATUS_INVALID, "Invalid Output Type"};
     }
 
+    auto real_output_node = std::dynamic_pointer_cast<Node>(output_node_);
+    real_output_node->SetProfiler(profiler_);
+    real_output_node->SetLatencySampleInterval(latency_sample_interval_);
+    if (latency_sample_interval_ != 0 && graph_node_stats_ != nullptr) {
+      real_output_node->SetNodeStats(
+          graph_node_stats_->AddItem(output_node_name_));
+    }
+    real_output_node->SetGraphLatencyStats(graph_latency_);
+
     auto status = output_node_->Init(output_node_ports_, {}, output_config);
     if (!status) {
       auto msg = "init virtual output node failed.";
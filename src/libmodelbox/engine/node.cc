@@ -208,6 +208,9 @@ Status Node::Init(const std::set<std::string>& input_port_names,
     return STATUS_INVALID;
   }
 
+  memory_account_ =
+      DeviceMemoryAccount::Create<StatisticsMemoryAccount>(name_, node_stats_);
+  flowunit_group_->SetStats(node_stats_);
   ret = flowunit_group_->Init(input_port_names, output_port_names,
                               flowunit_manager_);
   if (!ret) {
@@ -294,6 +297,110 @@ void Node::SetStats(std::shared_ptr<StatisticsItem> graph_stats) {
   graph_stats_ = graph_stats;
 }
 
+void Node::SetNodeStats(std::shared_ptr<StatisticsItem> node_stats) {
+  node_stats_ = node_stats;
+  if (node_stats_ == nullptr) {
+    return;
+  }
+
+  auto queue_item = node_stats_->AddGauge("input_queue_size");
+  if (queue_item != nullptr) {
+    input_queue_size_ = queue_item->GetGauge();
+  }
+
+  if (latency_sample_interval_ == 0) {
+    return;
+  }
+
+  auto queue_wait_item = node_stats_->AddHistogram("queue_wait_us");
+  if (queue_wait_item != nullptr) {
+    queue_wait_ = queue_wait_item->GetHistogram();
+  }
+}
+
+std::shared_ptr<DeviceMemoryAccount> Node::GetMemoryAccount() {
+  return memory_account_;
+}
+
+uint64_t Node::GetSteadyTimeNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Node::SetLatencySampleInterval(uint32_t interval) {
+  latency_sample_interval_ = interval;
+}
+
+void Node::SetGraphLatencyStats(
+    std::shared_ptr<StatisticsHistogram> graph_latency) {
+  graph_latency_ = graph_latency;
+}
+
+bool Node::SampleLatency(const std::shared_ptr<BufferIndexInfo>& index_info) {
+  if (latency_sample_interval_ == 0 || index_info == nullptr) {
+    return false;
+  }
+
+  auto count =
+      latency_sample_count_.fetch_add(1, std::memory_order_relaxed);
+  if (count % latency_sample_interval_ != 0) {
+    return false;
+  }
+
+  index_info->SetOriginTime(GetSteadyTimeNs());
+  return true;
+}
+
+void Node::SampleSourceOutput(
+    const std::vector<std::shared_ptr<Buffer>>& buffers) {
+  for (auto& buffer : buffers) {
+    auto index_info = BufferManageView::GetIndexInfo(buffer);
+    if (index_info->IsEndFlag() || index_info->IsPlaceholder() ||
+        index_info->GetOriginTime() != 0) {
+      continue;
+    }
+
+    SampleLatency(index_info);
+  }
+}
+
+void Node::RecordLatency(const std::shared_ptr<BufferIndexInfo>& index_info,
+                         uint64_t send_time, uint64_t begin_ns,
+                         uint64_t end_ns) {
+  auto origin_time = index_info->GetOriginTime();
+  if (origin_time == 0) {
+    return;
+  }
+
+  if (send_time != 0 && begin_ns > send_time) {
+    if (queue_wait_ != nullptr) {
+      queue_wait_->Record((begin_ns - send_time) / 1000);
+    }
+
+    std::call_once(trace_init_flag_, [this]() {
+      if (profiler_ != nullptr && profiler_->GetTrace() != nullptr) {
+        trace_recorder_ = profiler_->GetTrace()->GetRecorder();
+        trace_name_id_ = trace_recorder_->Intern(name_);
+      }
+    });
+
+    if (trace_recorder_ != nullptr) {
+      trace_recorder_->Record(
+          trace_name_id_, TraceSliceType::QUEUE_WAIT,
+          std::chrono::steady_clock::time_point(
+              std::chrono::nanoseconds(send_time)),
+          std::chrono::steady_clock::time_point(
+              std::chrono::nanoseconds(begin_ns)),
+          1);
+    }
+  }
+
+  if (graph_latency_ != nullptr && end_ns > origin_time) {
+    graph_latency_->Record((end_ns - origin_time) / 1000);
+  }
+}
+
 std::shared_ptr<ExternalData> Node::CreateExternalData(
     std::shared_ptr<Device> device) {
   if (session_mgr_ == nullptr) {
@@ -593,6 +700,11 @@ Status Node::Recv(
 
 Status Node::Process(
     std::list<std::shared_ptr<FlowUnitDataContext>>& data_ctx_list) {
+  uint64_t begin_ns = 0;
+  if (latency_sample_interval_ != 0) {
+    begin_ns = GetSteadyTimeNs();
+  }
+
   auto ret = flowunit_group_->Run(data_ctx_list);
   if (!ret) {
     MBLOG_ERROR << "node " << name_ << " run flowunit group failed, error "
@@ -600,8 +712,40 @@ Status Node::Process(
     return ret;
   }
 
+  uint64_t end_ns = 0;
+  if (latency_sample_interval_ != 0) {
+    end_ns = GetSteadyTimeNs();
+  }
+
   for (auto& data_ctx : data_ctx_list) {
     data_ctx->UpdateProcessState();
+    if (latency_sample_interval_ == 0) {
+      continue;
+    }
+
+    // buffers of all ports are matched, record first port only but take
+    // send time of every edge
+    bool first_port = true;
+    for (auto& input : data_ctx->GetInputs()) {
+      auto in_port = GetInputPort(input.first);
+      for (auto& buffer : input.second) {
+        auto index_info = BufferManageView::GetIndexInfo(buffer);
+        if (index_info->GetOriginTime() == 0) {
+          continue;
+        }
+
+        uint64_t send_ns = 0;
+        if (in_port != nullptr) {
+          send_ns = in_port->TakeSendTime(index_info);
+        }
+
+        if (first_port) {
+          RecordLatency(index_info, send_ns, begin_ns, end_ns);
+        }
+      }
+
+      first_port = false;
+    }
   }
 
   return STATUS_SUCCESS;
@@ -644,6 +788,12 @@ Status Node::Send(
 
         valid_output.push_back(buffer);
       }
+
+      // source node, buffer enters graph here
+      if (latency_sample_interval_ != 0 && GetInputNum() == 0) {
+        SampleSourceOutput(valid_output);
+      }
+
       output_port->Send(valid_output);
     }
   }
@@ -696,6 +846,15 @@ Status Node::Run(RunType type) {
     return ret;
   }
 
+  if (input_queue_size_ != nullptr && type == RunType::DATA) {
+    int64_t queue_size = 0;
+    for (auto& port : input_ports_) {
+      queue_size += port->GetDataCount();
+    }
+
+    input_queue_size_->Set(queue_size);
+  }
+
   ret = Process(data_ctx_list);
   if (!ret) {
     return ret;
@@ -16,8 +16,12 @@
 
 #include "modelbox/port.h"
 
+#include <chrono>
+
 namespace modelbox {
 
+constexpr size_t MAX_SAMPLED_SEND_TIME = 1024;
+
 Port::Port(const std::string& name, std::shared_ptr<NodeBase> node)
     : name_(name), node_(node) {}
 
@@ -72,6 +76,42 @@ std::vector<std::weak_ptr<OutPort>> InPort::GetAllOutPort() {
   return output_ports;
 }
 
+void InPort::SetSendTime(const std::shared_ptr<BufferIndexInfo>& index_info,
+                         uint64_t send_time) {
+  std::lock_guard<std::mutex> lock(send_time_lock_);
+  // buffers dropped before process never take their send time, order queue
+  // also keeps keys already taken, so bounding it bounds the records
+  while (send_time_order_.size() >= MAX_SAMPLED_SEND_TIME) {
+    auto oldest = send_time_order_.front();
+    send_time_order_.pop_front();
+    auto item = send_time_.find(oldest.first);
+    if (item != send_time_.end() && item->second.seq == oldest.second) {
+      send_time_.erase(item);
+    }
+  }
+
+  auto seq = ++send_time_seq_;
+  send_time_[index_info.get()] = {index_info, send_time, seq};
+  send_time_order_.emplace_back(index_info.get(), seq);
+}
+
+uint64_t InPort::TakeSendTime(
+    const std::shared_ptr<BufferIndexInfo>& index_info) {
+  std::lock_guard<std::mutex> lock(send_time_lock_);
+  auto item = send_time_.find(index_info.get());
+  if (item == send_time_.end()) {
+    return 0;
+  }
+
+  uint64_t send_time = 0;
+  if (item->second.index_info.lock() == index_info) {
+    send_time = item->second.send_time;
+  }
+
+  send_time_.erase(item);
+  return send_time;
+}
+
 OutPort::OutPort(const std::string& name, std::shared_ptr<NodeBase> node)
     : Port(name, node) {}
 
@@ -88,6 +128,24 @@ Status OutPort::Init() {
 Status OutPort::Send(std::vector<std::shared_ptr<Buffer>>& buffers) {
   std::vector<std::vector<std::shared_ptr<Buffer>>> buffer_vectors(
       connected_input_ports_.size(), buffers);
+  std::vector<std::shared_ptr<BufferIndexInfo>> sampled_buffers;
+  for (auto& buffer : buffers) {
+    auto index_info = BufferManageView::GetIndexInfo(buffer);
+    if (index_info->GetOriginTime() == 0 || index_info->IsEndFlag() ||
+        index_info->IsPlaceholder()) {
+      continue;
+    }
+
+    sampled_buffers.push_back(index_info);
+  }
+
+  uint64_t send_time = 0;
+  if (!sampled_buffers.empty()) {
+    send_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+  }
+
   size_t idx = 0;
   bool loop;
   auto real_node = std::dynamic_pointer_cast<Node>(GetNode());
@@ -97,6 +155,10 @@ Status OutPort::Send(std::vector<std::shared_ptr<Buffer>>& buffers) {
   }
 
   for (auto input_port : connected_input_ports_) {
+    for (auto& index_info : sampled_buffers) {
+      input_port->SetSendTime(index_info, send_time);
+    }
+
     loop = false;
     auto queue = input_port->GetQueue();
     auto priority = input_port->GetPriority();
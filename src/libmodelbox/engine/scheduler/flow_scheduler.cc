@@ -23,6 +23,35 @@ namespace modelbox {
 constexpr const char* TASK_FLOW_SCHEDUER_NAME = "Flow-Scheduler";
 constexpr const char* TASK_FLOW_POOL_NAME = "Flow-Workers";
 
+static int64_t GetSteadyTimeMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static std::shared_ptr<StatisticsGauge> AddScheduleGauge(
+    const std::shared_ptr<StatisticsItem>& item, const std::string& name) {
+  if (item == nullptr) {
+    return nullptr;
+  }
+
+  auto gauge_item = item->AddGauge(name);
+  if (gauge_item == nullptr) {
+    MBLOG_WARN << "add statistics " << item->GetPath() << "." << name
+               << " failed, " << StatusError;
+    return nullptr;
+  }
+
+  return gauge_item->GetGauge();
+}
+
+static inline void SetScheduleGauge(
+    const std::shared_ptr<StatisticsGauge>& gauge, int64_t value) {
+  if (gauge != nullptr) {
+    gauge->Set(value);
+  }
+}
+
 SchedulerPort::SchedulerPort(const std::string& name)
     : SchedulerPort(name, SIZE_MAX) {}
 
@@ -47,6 +76,11 @@ Status FlowScheduler::Init(std::shared_ptr<Configuration> config,
     auto max_threads = config->GetUint32("graph.max-thread-num", threads * 32);
     auto thread_pool = std::make_shared<ThreadPool>(threads, max_threads);
     thread_pool->SetName(TASK_FLOW_POOL_NAME);
+    if (config->GetBool("graph.thread-adaptive", false)) {
+      thread_pool->SetAdaptive(
+          true, config->GetUint32("graph.thread-target-wait-us",
+                                  DEFAULT_ADAPTIVE_TARGET_WAIT_US));
+    }
     tp_ = thread_pool;
     thread_create_ = true;
 
@@ -67,9 +101,11 @@ Status FlowScheduler::Init(std::shared_ptr<Configuration> config,
     }
 
     MBLOG_INFO << "init scheduler with " << threads << " threads, max "
-               << max_threads;
+               << max_threads << ", adaptive " << thread_pool->IsAdaptive();
   }
 
+  stall_timeout_ =
+      config->GetInt32("graph.stall-timeout-ms", SCHED_STALL_TIMEOUT_MS);
   return STATUS_OK;
 }
 
@@ -105,6 +141,8 @@ Status FlowScheduler::Build(const Graph& graph) {
     node_port_map_.emplace(iter_pair.first, std::move(priority_ports));
   }
 
+  InitScheduleStats(graph);
+
   MBLOG_DEBUG << "flow scheduler build.";
   return STATUS_OK;
 }
@@ -180,6 +218,11 @@ void FlowScheduler::RunWapper(std::shared_ptr<NodeBase> node, RunType type,
     SendSchedulerCommand(cmd_type, active_port);
   }
 
+  auto stats = node_sched_stats_.find(node);
+  if (stats != node_sched_stats_.end()) {
+    stats->second->last_run_ms = Now();
+  }
+
   EnableActivePort(node);
   std::unique_lock<std::mutex> lock(notify_mutex_);
   running_node_count_--;
@@ -335,6 +378,121 @@ void FlowScheduler::ShowScheduleStatus() {
   check_count_++;
 }
 
+void FlowScheduler::InitScheduleStats(const Graph& graph) {
+  std::shared_ptr<StatisticsItem> graph_item;
+  auto node_item = Statistics::GetGlobalItem()->GetItem(STATISTICS_ITEM_NODE);
+  if (node_item != nullptr) {
+    graph_item = node_item->GetItem(graph.GetId());
+  }
+
+  ready_port_count_ = AddScheduleGauge(graph_item, "sched_ready_ports");
+  running_node_gauge_ = AddScheduleGauge(graph_item, "sched_running_nodes");
+  thread_num_ = AddScheduleGauge(graph_item, "sched_threads");
+  busy_thread_num_ = AddScheduleGauge(graph_item, "sched_busy_threads");
+  waiting_work_count_ = AddScheduleGauge(graph_item, "sched_waiting_works");
+  blocking_thread_num_ =
+      AddScheduleGauge(graph_item, "sched_blocking_threads");
+  queue_wait_us_ = AddScheduleGauge(graph_item, "sched_queue_wait_us");
+  stalled_node_count_ = AddScheduleGauge(graph_item, "sched_stalled_nodes");
+  if (graph_item != nullptr) {
+    auto stall_item = graph_item->AddCounter("sched_stalls");
+    if (stall_item != nullptr) {
+      stall_counter_ = stall_item->GetCounter();
+    }
+  }
+
+  auto now = Now();
+  for (auto& iter : node_port_map_) {
+    auto& node = iter.first;
+    auto stats = std::make_shared<NodeScheduleStats>();
+    stats->last_run_ms = now;
+    std::shared_ptr<StatisticsItem> item;
+    if (graph_item != nullptr) {
+      // virtual nodes have no statistics item
+      item = graph_item->GetItem(node->GetName());
+      if (item == nullptr) {
+        item = graph_item->AddItem(node->GetName());
+      }
+    }
+
+    stats->queue_depth = AddScheduleGauge(item, "sched_queue_depth");
+    stats->idle_ms = AddScheduleGauge(item, "sched_idle_ms");
+    stats->running = AddScheduleGauge(item, "sched_running");
+    stats->stalled = AddScheduleGauge(item, "sched_stalled");
+    node_sched_stats_[node] = stats;
+  }
+
+  last_stats_update_ms_ = now;
+}
+
+int64_t FlowScheduler::Now() const {
+  if (clock_ != nullptr) {
+    return clock_();
+  }
+
+  return GetSteadyTimeMs();
+}
+
+void FlowScheduler::UpdateScheduleStats(int64_t now_ms) {
+  last_stats_update_ms_ = now_ms;
+  int64_t stalled_node_count = 0;
+  for (auto& iter : node_port_map_) {
+    auto& node = iter.first;
+    auto stats_iter = node_sched_stats_.find(node);
+    if (stats_iter == node_sched_stats_.end()) {
+      continue;
+    }
+
+    auto& stats = stats_iter->second;
+    size_t queue_depth = 0;
+    for (auto& port : iter.second) {
+      auto real_port = port->GetPort();
+      if (real_port != nullptr) {
+        queue_depth += real_port->GetDataCount();
+      }
+    }
+
+    bool running = false;
+    {
+      std::unique_lock<std::mutex> lock(status_mutex_);
+      auto node_status = nodes_runing_status_.find(node);
+      running = (node_status != nodes_runing_status_.end() &&
+                 node_status->second);
+    }
+
+    int64_t idle_ms = running ? 0 : now_ms - stats->last_run_ms;
+    bool stalled = !running && queue_depth > 0 && idle_ms >= stall_timeout_;
+    if (stalled && !stats->is_stalled) {
+      MBLOG_WARN << "node:" << node->GetName() << " has data:" << queue_depth
+                 << " but not run for " << idle_ms
+                 << "ms, scheduler may be blocking.";
+      stall_count_++;
+      if (stall_counter_ != nullptr) {
+        stall_counter_->Increase(1);
+      }
+    } else if (!stalled && stats->is_stalled) {
+      MBLOG_INFO << "node:" << node->GetName() << " recovered from stall.";
+    }
+
+    stats->is_stalled = stalled;
+    stalled_node_count += stalled ? 1 : 0;
+    SetScheduleGauge(stats->queue_depth, queue_depth);
+    SetScheduleGauge(stats->idle_ms, idle_ms);
+    SetScheduleGauge(stats->running, running ? 1 : 0);
+    SetScheduleGauge(stats->stalled, stalled ? 1 : 0);
+  }
+
+  auto threads = tp_->GetThreadsNum();
+  SetScheduleGauge(ready_port_count_, data_hub_->GetActivePortNum());
+  SetScheduleGauge(running_node_gauge_, running_node_count_);
+  SetScheduleGauge(thread_num_, threads);
+  SetScheduleGauge(busy_thread_num_, threads - tp_->GetIdleThreadsNum());
+  SetScheduleGauge(waiting_work_count_, tp_->GetWaitingWorkCount());
+  SetScheduleGauge(blocking_thread_num_, tp_->GetBlockingThreadsNum());
+  SetScheduleGauge(queue_wait_us_, tp_->GetQueueWaitTime());
+  SetScheduleGauge(stalled_node_count_, stalled_node_count);
+}
+
 Status FlowScheduler::RunImpl() {
   MBLOG_DEBUG << "flow schedule is begin run.";
   os->Thread->SetName("Flow-Scheduler");
@@ -346,6 +504,11 @@ Status FlowScheduler::RunImpl() {
   int timeout_count = 0;
   while (!is_stop_) {
     status = data_hub_->SelectActivePort(&active_port, check_timeout_);
+    auto now_ms = Now();
+    if (now_ms - last_stats_update_ms_ >= check_timeout_) {
+      UpdateScheduleStats(now_ms);
+    }
+
     if (status == STATUS_TIMEDOUT) {
       // The system displays the current status information every 60 seconds if
       // the system is idle.
@@ -20,8 +20,10 @@
 
 #include <modelbox/base/thread_pool.h>
 #include <modelbox/graph.h>
+#include <modelbox/statistics.h>
 
 #include <atomic>
+#include <functional>
 #include <thread>
 
 #include "../common/data_hub.h"
@@ -36,6 +38,21 @@ enum class SchedulerCommandType {
 
 constexpr const int SCHED_CHECK_TIMEOUT_MS = 1000;
 constexpr const int SCHED_MAX_CHECK_TIMEOUT_COUNT = 60;
+constexpr const int SCHED_STALL_TIMEOUT_MS = 10000;
+
+/**
+ * @brief Schedule state of one node, statistics are refreshed by the
+ * scheduler thread every check timeout
+ */
+struct NodeScheduleStats {
+  // steady clock time in ms when node finished its last run
+  std::atomic<int64_t> last_run_ms{0};
+  bool is_stalled{false};
+  std::shared_ptr<StatisticsGauge> queue_depth;
+  std::shared_ptr<StatisticsGauge> idle_ms;
+  std::shared_ptr<StatisticsGauge> running;
+  std::shared_ptr<StatisticsGauge> stalled;
+};
 
 class SchedulerCommand {
  public:
@@ -106,6 +123,19 @@ class FlowScheduler : public Scheduler {
   }
   int64_t GetCheckCount() const { return check_count_; }
 
+  /**
+   * @brief Node holding data but not run for timeout is reported as stalled
+   * @param timeout stall timeout in ms
+   */
+  void SetStallTimeout(int timeout) { stall_timeout_ = timeout; }
+  int64_t GetStallCount() const { return stall_count_; }
+
+  /**
+   * @brief Replace clock of schedule stats, must be set before Build
+   * @param clock returns steady time in ms, nullptr for steady clock
+   */
+  void SetClock(const std::function<int64_t()>& clock) { clock_ = clock; }
+
  private:
   std::shared_ptr<DataHub> data_hub_;
   std::shared_ptr<ThreadPool> tp_;
@@ -134,6 +164,25 @@ class FlowScheduler : public Scheduler {
   int max_check_timeout_count_{SCHED_MAX_CHECK_TIMEOUT_COUNT};
   std::atomic<int64_t> check_count_{0};
 
+  int64_t Now() const;
+
+  int stall_timeout_{SCHED_STALL_TIMEOUT_MS};
+  std::atomic<int64_t> stall_count_{0};
+  std::function<int64_t()> clock_;
+  int64_t last_stats_update_ms_{0};
+  std::unordered_map<std::shared_ptr<NodeBase>,
+                     std::shared_ptr<NodeScheduleStats>>
+      node_sched_stats_;
+  std::shared_ptr<StatisticsGauge> ready_port_count_;
+  std::shared_ptr<StatisticsGauge> running_node_gauge_;
+  std::shared_ptr<StatisticsGauge> thread_num_;
+  std::shared_ptr<StatisticsGauge> busy_thread_num_;
+  std::shared_ptr<StatisticsGauge> waiting_work_count_;
+  std::shared_ptr<StatisticsGauge> blocking_thread_num_;
+  std::shared_ptr<StatisticsGauge> queue_wait_us_;
+  std::shared_ptr<StatisticsGauge> stalled_node_count_;
+  std::shared_ptr<StatisticsCounter> stall_counter_;
+
   Status RunImpl();
   void RunWapper(std::shared_ptr<NodeBase> node, RunType type,
                  std::shared_ptr<PriorityPort> active_port);
@@ -149,6 +198,8 @@ class FlowScheduler : public Scheduler {
   void WaitNodeFinish();
   void ShutdownNodes();
   void ShowScheduleStatus();
+  void InitScheduleStats(const Graph& graph);
+  void UpdateScheduleStats(int64_t now_ms);
 };
 
 }  // namespace modelbox
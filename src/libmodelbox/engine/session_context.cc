@@ -33,17 +33,48 @@ SessionContext::SessionContext(std::shared_ptr<StatisticsItem> graph_stats) {
   if (graph_stats != nullptr) {
     graph_stats_ = graph_stats;
     graph_session_stats_ = graph_stats_->AddItem(session_id_);
+    if (graph_session_stats_ != nullptr) {
+      graph_session_stats_->MarkSession();
+    }
   }
+
+  memory_account_ = DeviceMemoryAccount::Create<StatisticsMemoryAccount>(
+      session_id_, graph_session_stats_);
   MBLOG_INFO << "session context start se id:" << GetSessionId();
 };
 
 SessionContext::~SessionContext() {
   MBLOG_INFO << "session context finish se id:" << GetSessionId();
+  ReportMemoryLeak();
   if (graph_stats_ != nullptr) {
     graph_stats_->DelItem(session_id_);
   }
 };
 
+void SessionContext::ReportMemoryLeak() {
+  // all buffers of session are released now, memory still live is held
+  // by flowunits, such as cached frames
+  auto live_bytes = memory_account_->GetLiveBytes();
+  if (live_bytes == 0) {
+    return;
+  }
+
+  std::stringstream leak_msg;
+  leak_msg << "session " << session_id_ << " finished with " << live_bytes
+           << " bytes in " << memory_account_->GetLiveBlocks()
+           << " blocks not freed, peak " << memory_account_->GetPeakBytes()
+           << " bytes";
+  for (const auto &owner : memory_account_->GetOwnerLiveBytes()) {
+    leak_msg << ", " << owner.first << ": " << owner.second;
+  }
+
+  MBLOG_WARN << leak_msg.str();
+}
+
+std::shared_ptr<DeviceMemoryAccount> SessionContext::GetMemoryAccount() {
+  return memory_account_;
+}
+
 void SessionContext::SetPrivate(const std::string &key,
                                 std::shared_ptr<void> private_content) {
   std::lock_guard<std::mutex> lock(private_map_lock_);
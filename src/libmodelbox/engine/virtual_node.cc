@@ -189,9 +189,11 @@ Status OutputVirtualNode::Run(RunType type) {
     }
     OutputBufferList output;
     std::shared_ptr<FlowUnitError> last_error;
+    bool record_latency = (latency_sample_interval_ != 0);
     for (auto& port_data : *stream_data_map) {
       auto& port_name = port_data.first;
       auto& data_list = port_data.second;
+      auto in_port = GetInputPort(port_name);
       std::vector<std::shared_ptr<Buffer>> valid_output;
       for (auto& data : data_list) {
         auto index_info = BufferManageView::GetIndexInfo(data);
@@ -203,6 +205,15 @@ Status OutputVirtualNode::Run(RunType type) {
           continue;
         }
 
+        if (latency_sample_interval_ != 0 &&
+            index_info->GetOriginTime() != 0 && in_port != nullptr) {
+          auto send_time = in_port->TakeSendTime(index_info);
+          if (record_latency) {
+            auto now = GetSteadyTimeNs();
+            RecordLatency(index_info, send_time, now, now);
+          }
+        }
+
         if (data->HasError()) {
           last_error = data->GetError();
         }
@@ -210,6 +221,8 @@ Status OutputVirtualNode::Run(RunType type) {
         valid_output.push_back(data);
       }
       output[port_name] = std::make_shared<BufferList>(valid_output);
+      // buffers of all ports are matched, record the first port only
+      record_latency = false;
     }
     io->PushGraphOutputBuffer(output);
     io->SetLastError(last_error);
@@ -353,6 +366,14 @@ Status OutputUnmatchVirtualNode::Run(RunType type) {
       if (session->IsAbort()) {
         continue;
       }
+
+      if (latency_sample_interval_ != 0 &&
+          buffer_index_info->GetOriginTime() != 0) {
+        auto send_time = in_port->TakeSendTime(buffer_index_info);
+        auto now = GetSteadyTimeNs();
+        RecordLatency(buffer_index_info, send_time, now, now);
+      }
+
       auto cache_item = session_cache_map_.find(session);
       std::shared_ptr<SessionUnmatchCache> session_cache;
       if (cache_item == session_cache_map_.end()) {
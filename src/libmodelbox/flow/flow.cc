@@ -57,6 +57,7 @@ void Flow::Clear() {
   }
   graph_ = nullptr;
   graphconfig_ = nullptr;
+  gcgraph_ = nullptr;
   flowunit_mgr_ = nullptr;
   device_mgr_ = nullptr;
   graphconf_mgr_ = nullptr;
@@ -144,6 +145,14 @@ Status Flow::Init(std::shared_ptr<Configuration> config) {
     return {ret, "Inital device failed."};
   }
 
+  // resolve graph early, only drivers of its flowunits are loaded
+  gcgraph_ = graphconfig_->Resolve();
+  if (gcgraph_ != nullptr) {
+    std::set<std::string> flowunit_names;
+    GetGraphFlowUnits(gcgraph_, &flowunit_names);
+    flowunit_mgr_->SetFlowUnitFilter(flowunit_names);
+  }
+
   ret = flowunit_mgr_->Initialize(drivers_, device_mgr_, config_);
   if (!ret) {
     MBLOG_ERROR << "Initial flowunit manager failed, " << ret.WrapErrormsgs();
@@ -165,6 +174,20 @@ Status Flow::Init(std::shared_ptr<Configuration> config) {
   return STATUS_OK;
 }
 
+void Flow::GetGraphFlowUnits(std::shared_ptr<GCGraph> gcgraph,
+                             std::set<std::string>* flowunit_names) {
+  for (auto& node : gcgraph->GetAllNodes()) {
+    auto flowunit = node.second->GetConfiguration()->GetString("flowunit");
+    if (!flowunit.empty()) {
+      flowunit_names->insert(flowunit);
+    }
+  }
+
+  for (auto& subgraph : gcgraph->GetAllSubGraphs()) {
+    GetGraphFlowUnits(subgraph.second, flowunit_names);
+  }
+}
+
 Status Flow::GuessConfFormat(const std::string& configfile,
                              const std::string& data, enum Format* format) {
   *format = FORMAT_UNKNOWN;
@@ -392,7 +415,12 @@ Status Flow::Build() {
     return {STATUS_FAULT, "Flow not initialized."};
   }
 
-  auto gcgraph = graphconfig_->Resolve();
+  auto gcgraph = gcgraph_;
+  gcgraph_ = nullptr;
+  if (gcgraph == nullptr) {
+    gcgraph = graphconfig_->Resolve();
+  }
+
   if (gcgraph == nullptr) {
     MBLOG_ERROR << "graph config resolve failed, "
                 << StatusError.WrapErrormsgs();
@@ -482,4 +510,14 @@ std::string Flow::GetGraphName() const {
   }
 
   return graph_->GetName();
+}
+
+std::shared_ptr<Configuration> Flow::GetConfig() const { return config_; }
+
+size_t Flow::GetSessionCount() const {
+  if (graph_ == nullptr) {
+    return 0;
+  }
+
+  return graph_->GetSessionCount();
 }
\ No newline at end of file
@@ -17,6 +17,7 @@
 #ifndef MODELBOX_BUFFER_INDEX_INFO_H_
 #define MODELBOX_BUFFER_INDEX_INFO_H_
 
+#include <cstdint>
 #include <functional>
 #include <list>
 #include <map>
@@ -130,6 +131,14 @@ class BufferIndexInfo {
 
   std::shared_ptr<BufferProcessInfo> GetProcessInfo();
 
+  /**
+   * @brief steady clock time in ns when sampled buffer entered graph
+   * 0 means buffer is not sampled for latency
+   **/
+  void SetOriginTime(uint64_t origin_time);
+
+  uint64_t GetOriginTime();
+
  private:
   std::shared_ptr<Stream> stream_belong_to_;
   size_t index_in_current_stream_{0};
@@ -139,6 +148,8 @@ class BufferIndexInfo {
 
   bool is_end_flag_{false};
   bool is_placeholder_{false};
+
+  uint64_t origin_time_{0};
 };
 
 /**
@@ -17,7 +17,10 @@
 #ifndef MODELBOX_EXTERNAL_DATA_MAP_H_
 #define MODELBOX_EXTERNAL_DATA_MAP_H_
 
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <unordered_map>
 
 #include "modelbox/base/device.h"
 #include "modelbox/error.h"
@@ -88,9 +91,13 @@ class ExternalDataMapImpl
   void SessionEnd(std::shared_ptr<FlowUnitError> error = nullptr) override;
 
  private:
+  friend class ExternalDataSelect;
+
   Status PushToInputCache(const std::string& port_name,
                           std::shared_ptr<BufferList> buffer_list);
 
+  void NotifySelector();
+
   void PopMachedInput(
       std::unordered_map<std::string, std::list<std::shared_ptr<Buffer>>>&
           matched_port_data,
@@ -120,6 +127,8 @@ class ExternalDataMapImpl
 
   std::shared_ptr<BlockingQueue<OutputBufferList>> graph_output_cache_;
   std::weak_ptr<ExternalDataSelect> selector_;
+  // in ready list of selector, avoid queueing one map twice
+  std::atomic_bool select_ready_{false};
 
   bool session_end_flag_{false};
   std::mutex session_state_lock_;
@@ -137,22 +146,45 @@ class ExternalDataSelect
   void RegisterExternalData(std::shared_ptr<ExternalDataMap> externl_data);
   void RemoveExternalData(const std::shared_ptr<ExternalDataMap>& externl_data);
 
+  /**
+   * @brief Wait for ready external data, cost is O(ready) not O(registered)
+   * @param external_list ready external data
+   * @param timeout wait time, wait forever when not positive
+   * @param max_num max ready external data to take, 0 is unlimited, limit it
+   * when several threads select so that ready data spreads among them
+   * @return STATUS_SUCCESS when any data is ready, STATUS_TIMEDOUT when wait
+   * time is up
+   */
   Status SelectExternalData(
       std::list<std::shared_ptr<ExternalDataMap>>& external_list,
       std::chrono::duration<long, std::milli> timeout =
-          std::chrono::milliseconds(-1));
+          std::chrono::milliseconds(-1),
+      size_t max_num = 0);
 
   bool IsExternalDataReady();
 
+  /**
+   * @brief Fd readable while any external data is ready, level triggered,
+   * for callers polling selector in their own event loop
+   */
+  int GetSelectFd();
+
  private:
   friend class ExternalDataMapImpl;
-  void NotifySelect();
+  void NotifySelect(const std::shared_ptr<ExternalDataMapImpl>& external_data);
 
-  std::mutex external_list_lock_;
-  std::list<std::shared_ptr<ExternalDataMapImpl>> external_list_;
+  bool PopReadyList(std::list<std::shared_ptr<ExternalDataMap>>& external_list,
+                    size_t max_num);
 
-  std::mutex data_ready_mtx_;
-  std::condition_variable data_ready_cv_;
+  std::mutex external_list_lock_;
+  std::unordered_map<ExternalDataMapImpl*,
+                     std::shared_ptr<ExternalDataMapImpl>>
+      external_maps_;
+  std::deque<std::shared_ptr<ExternalDataMapImpl>> ready_list_;
+
+  // eventfd is readable iff ready list is not empty
+  int event_fd_{-1};
+  int epoll_fd_{-1};
 };
 }  // namespace modelbox
 
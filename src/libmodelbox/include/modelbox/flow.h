@@ -26,6 +26,7 @@
 #include <modelbox/solution.h>
 
 #include <memory>
+#include <set>
 #include <string>
 
 namespace modelbox {
@@ -143,6 +144,18 @@ class Flow {
    */
   std::string GetGraphName() const;
 
+  /**
+   * @brief Get number of sessions not finished
+   * @return session number
+   */
+  size_t GetSessionCount() const;
+
+  /**
+   * @brief Get configuration the flow is initialized with
+   * @return flow configuration, nullptr before init
+   */
+  std::shared_ptr<Configuration> GetConfig() const;
+
  private:
   void Clear();
   Status ConfigFileRead(const std::string& configfile, Format format,
@@ -159,12 +172,17 @@ class Flow {
   Status GuessConfFormat(const std::string& configfile, const std::string& data,
                          enum Format* format);
 
+  void GetGraphFlowUnits(std::shared_ptr<GCGraph> gcgraph,
+                         std::set<std::string>* flowunit_names);
+
   std::shared_ptr<Drivers> drivers_;
   std::shared_ptr<DeviceManager> device_mgr_;
   std::shared_ptr<FlowUnitManager> flowunit_mgr_;
   std::shared_ptr<GraphConfigManager> graphconf_mgr_;
   std::shared_ptr<Configuration> config_;
   std::shared_ptr<GraphConfig> graphconfig_;
+  // resolved in init, used by build
+  std::shared_ptr<GCGraph> gcgraph_;
   std::shared_ptr<Graph> graph_;
   std::shared_ptr<Profiler> profiler_;
   bool timer_run_ = false;
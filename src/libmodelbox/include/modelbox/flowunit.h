@@ -30,10 +30,12 @@
 
 #include <functional>
 #include <map>
+#include <mutex>
 #include <queue>
 #include <regex>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace modelbox {
@@ -777,6 +779,72 @@ class FlowUnitFactory : public DriverFactory {
 using FlowUnitDeviceConfig =
     std::unordered_map<std::string, std::vector<std::string>>;
 
+/**
+ * @brief FlowUnit opened once and shared by nodes of different flows, it is
+ * closed when the last node releases it
+ */
+class SharedFlowUnit {
+ public:
+  SharedFlowUnit(std::shared_ptr<FlowUnit> flowunit,
+                 std::shared_ptr<FlowUnitFactory> factory);
+  virtual ~SharedFlowUnit();
+
+  std::shared_ptr<FlowUnit> GetFlowUnit();
+
+  /**
+   * @brief Open flowunit at first call, later calls reuse it
+   * @param config node configuration, same for all nodes sharing flowunit
+   * @return open result
+   */
+  Status Open(const std::shared_ptr<Configuration> &config);
+
+ private:
+  std::mutex open_lock_;
+  bool opened_{false};
+  std::shared_ptr<FlowUnit> flowunit_;
+  // keep driver of flowunit loaded
+  std::shared_ptr<FlowUnitFactory> factory_;
+};
+
+/**
+ * @brief Process wide table of shared flowunits, entries are dropped when the
+ * last node releases the flowunit
+ */
+class SharedFlowUnitRegistry {
+ public:
+  static SharedFlowUnitRegistry &GetInstance();
+
+  /**
+   * @brief Get shared flowunit of key, create it when absent or released
+   * @param key flowunit name, device, driver and configuration
+   * @param create create function, called with registry locked
+   * @return shared flowunit, nullptr when create failed
+   */
+  std::shared_ptr<SharedFlowUnit> GetOrCreate(
+      const std::string &key,
+      const std::function<std::shared_ptr<SharedFlowUnit>()> &create);
+
+  /**
+   * @brief Forget all shared flowunits, flowunits in use stay opened
+   */
+  void Clear();
+
+  /**
+   * @brief Number of shared flowunits still in use
+   */
+  size_t Size();
+
+ private:
+  SharedFlowUnitRegistry() = default;
+  virtual ~SharedFlowUnitRegistry() = default;
+
+  void PurgeExpired();
+
+  std::mutex lock_;
+  std::unordered_map<std::string, std::weak_ptr<SharedFlowUnit>>
+      shared_flowunits_;
+};
+
 class FlowUnitManager {
  public:
   FlowUnitManager();
@@ -790,6 +858,20 @@ class FlowUnitManager {
                     std::shared_ptr<DeviceManager> device_mgr,
                     std::shared_ptr<Configuration> config);
 
+  /**
+   * @brief Only load drivers of these flowunits in Initialize, other drivers
+   * are loaded when a flowunit is not found or all flowunits are listed.
+   * Drivers are matched by name, all drivers are loaded in Initialize when
+   * a flowunit has no driver of the same name
+   * @param flowunit_names flowunit names used by graph, empty loads all
+   */
+  void SetFlowUnitFilter(const std::set<std::string> &flowunit_names);
+
+  /**
+   * @brief Number of flowunit drivers not loaded yet
+   */
+  size_t GetLazyDriverCount();
+
   virtual std::vector<std::string> GetFlowUnitTypes();
 
   virtual std::vector<std::string> GetFlowUnitList(
@@ -802,6 +884,22 @@ class FlowUnitManager {
       const std::string &unit_name, const std::string &unit_type = "",
       const std::string &unit_device_id = "");
 
+  /**
+   * @brief Create flowunits shared with nodes of other flows, flowunit with
+   * same name, device and configuration is created only once in process.
+   * Process of a shared flowunit is called concurrently by nodes of different
+   * flows, so only flowunits with a thread safe Process can be shared
+   * @param unit_name flowunit name
+   * @param unit_type device type
+   * @param unit_device_id device id
+   * @param config node configuration
+   * @return shared flowunits, empty when failed or flowunit can not be shared
+   */
+  std::vector<std::shared_ptr<SharedFlowUnit>> CreateSharedFlowUnit(
+      const std::string &unit_name, const std::string &unit_type,
+      const std::string &unit_device_id,
+      const std::shared_ptr<Configuration> &config);
+
   Status FlowUnitProbe();
   Status InitFlowUnitFactory(std::shared_ptr<Drivers> driver);
   Status SetUpFlowUnitDesc();
@@ -842,6 +940,9 @@ class FlowUnitManager {
                                       FlowUnitDeviceConfig &dev_cfg);
 
   void SetDeviceManager(std::shared_ptr<DeviceManager> device_mgr);
+  Status AddFlowUnitFactory(
+      const std::vector<std::shared_ptr<Driver>> &driver_list);
+  void LoadLazyDrivers();
   std::shared_ptr<FlowUnit> CreateSingleFlowUnit(
       const std::string &unit_name, const std::string &unit_type,
       const std::string &unit_device_id);
@@ -852,6 +953,9 @@ class FlowUnitManager {
 
   std::map<std::string, std::map<std::string, std::shared_ptr<FlowUnitDesc>>>
       flowunit_desc_list_;
+
+  std::set<std::string> flowunit_filter_;
+  std::vector<std::shared_ptr<Driver>> lazy_drivers_;
 };
 }  // namespace modelbox
 #endif  // MODELBOX_FLOW_UNIT_H_
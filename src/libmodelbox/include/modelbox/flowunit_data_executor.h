@@ -283,6 +283,16 @@ class FlowUnitDataExecutor {
 
   void SetNeedCheckOutput(bool need_check);
 
+  /**
+   * @brief Set id of node to tag cpu samples taken in flowunit process
+   */
+  void SetCpuSampleId(uint32_t cpu_sample_id);
+
+  /**
+   * @brief Set account to charge device memory allocated in flowunit process
+   */
+  void SetMemoryAccount(std::shared_ptr<DeviceMemoryAccount> memory_account);
+
  private:
   Status LoadExecuteInput(std::shared_ptr<Node> node,
                           FlowUnitExecDataView &exec_view);
@@ -295,6 +305,8 @@ class FlowUnitDataExecutor {
   std::weak_ptr<Node> node_ref_;
   size_t batch_size_;
   bool need_check_output_{false};
+  uint32_t cpu_sample_id_{0};
+  std::shared_ptr<DeviceMemoryAccount> memory_account_;
 };
 
 }  // namespace modelbox
@@ -18,12 +18,14 @@
 #define MODELBOX_FLOWUNIT_GROUP_H_
 
 #include <algorithm>
+#include <chrono>
 #include <list>
 #include <set>
 
 #include "modelbox/flowunit.h"
 #include "modelbox/flowunit_data_executor.h"
 #include "modelbox/profiler.h"
+#include "modelbox/statistics.h"
 
 namespace modelbox {
 
@@ -63,6 +65,12 @@ class FlowUnitGroup {
 
   void SetNode(std::shared_ptr<Node> node);
 
+  /**
+   * @brief Record process latency of this unit into node statistics
+   * @param node_stats statistics item of node, nullable
+   */
+  void SetStats(std::shared_ptr<StatisticsItem> node_stats);
+
   Status Open(const CreateExternalDataFunc &create_func);
 
   Status Close();
@@ -72,22 +80,39 @@ class FlowUnitGroup {
   uint32_t batch_size_;
 
   std::vector<std::shared_ptr<FlowUnit>> flowunit_group_;
+  // flowunits shared with other flows, share_instance in node config,
+  // Process of these flowunits must be safe to call concurrently
+  std::vector<std::shared_ptr<SharedFlowUnit>> shared_flowunits_;
   std::string unit_name_;
   std::string unit_type_;
   std::string unit_device_id_;
   std::shared_ptr<Configuration> config_;
   std::shared_ptr<Profiler> profiler_;
-  std::shared_ptr<FlowUnitTrace> flowunit_trace_;
+  std::shared_ptr<TraceRecorder> trace_recorder_;
+  uint32_t trace_name_id_{0};
+  uint32_t cpu_sample_id_{0};
+  std::shared_ptr<DeviceMemoryAccount> memory_account_;
+  std::shared_ptr<FlowUnitPerfCtx> perf_ctx_;
   std::once_flag trace_init_flag_;
+  std::shared_ptr<StatisticsHistogram> process_latency_;
+  std::shared_ptr<StatisticsCounter> process_buffers_;
 
   std::shared_ptr<FlowUnitBalancer> balancer_;
   std::shared_ptr<FlowUnitDataExecutor> executor_;
 
+  std::shared_ptr<SharedFlowUnit> GetSharedFlowUnit(
+      const std::shared_ptr<FlowUnit> &flowunit);
+
   void InitTrace();
 
-  std::shared_ptr<TraceSlice> StartTrace(FUExecContextList &exec_ctx_list);
+  void RecordTrace(const std::chrono::steady_clock::time_point &begin,
+                   const std::chrono::steady_clock::time_point &end,
+                   FUExecContextList &exec_ctx_list);
+
+  void RecordProcessLatency(const std::chrono::steady_clock::time_point &begin,
+                            const std::chrono::steady_clock::time_point &end);
 
-  void StopTrace(std::shared_ptr<TraceSlice> &slice);
+  void RecordProcessBuffers(FUExecContextList &exec_ctx_list);
 
   void PreProcess(FUExecContextList &exec_ctx_list,
                   FUExecContextList &err_exec_ctx_list);
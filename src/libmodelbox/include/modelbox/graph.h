@@ -111,6 +111,12 @@ class Graph {
 
   std::set<std::shared_ptr<NodeBase>> GetEndPointNodes() const;
 
+  /**
+   * @brief Get number of sessions still alive in graph
+   * @return session number
+   */
+  size_t GetSessionCount();
+
  private:
   void ShowGraphInfo(std::shared_ptr<GCGraph> g);
 
@@ -198,6 +204,10 @@ class Graph {
 
   std::shared_ptr<StatisticsItem> flow_stats_;
   std::shared_ptr<StatisticsItem> graph_stats_;
+  std::shared_ptr<StatisticsItem> node_stats_;
+  std::shared_ptr<StatisticsItem> graph_node_stats_;
+  std::shared_ptr<StatisticsHistogram> graph_latency_;
+  uint32_t latency_sample_interval_{0};
 
   std::shared_ptr<Configuration> config_;
 
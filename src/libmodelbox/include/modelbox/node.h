@@ -17,6 +17,7 @@
 #ifndef MODELBOX_NODE_H_
 #define MODELBOX_NODE_H_
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <set>
@@ -165,6 +166,40 @@ class Node : public NodeBase {
 
   void SetStats(std::shared_ptr<StatisticsItem> graph_stats);
 
+  /**
+   * @brief Set statistics item shared by all sessions of this node
+   * @param node_stats item of node.graph_id.node_name
+   */
+  void SetNodeStats(std::shared_ptr<StatisticsItem> node_stats);
+
+  /**
+   * @brief Sample one of every interval buffers entering graph for latency,
+   * must be set before SetNodeStats
+   * @param interval sample interval, 0 to disable
+   */
+  void SetLatencySampleInterval(uint32_t interval);
+
+  /**
+   * @brief Stamp buffer with origin time if it is chosen by sampling
+   * @param index_info index info of buffer entering graph
+   * @return whether buffer is sampled
+   */
+  bool SampleLatency(const std::shared_ptr<BufferIndexInfo>& index_info);
+
+  /**
+   * @brief Set histogram of graph end to end latency, recorded when sampled
+   * buffer reaches this node
+   * @param graph_latency histogram of node.graph_id.graph_latency_us
+   */
+  void SetGraphLatencyStats(
+      std::shared_ptr<StatisticsHistogram> graph_latency);
+
+  /**
+   * @brief Get account of device memory allocated by this node
+   * @return account, created in Init
+   */
+  std::shared_ptr<DeviceMemoryAccount> GetMemoryAccount();
+
   /**
    * @brief Open node
    * @return open result
@@ -289,6 +324,13 @@ class Node : public NodeBase {
 
   std::unordered_map<std::string, size_t> GetStreamCountEachPort();
 
+  static uint64_t GetSteadyTimeNs();
+
+  void SampleSourceOutput(const std::vector<std::shared_ptr<Buffer>>& buffers);
+
+  void RecordLatency(const std::shared_ptr<BufferIndexInfo>& index_info,
+                     uint64_t send_time, uint64_t begin_ns, uint64_t end_ns);
+
   std::shared_ptr<FlowUnitManager> flowunit_manager_;
   std::shared_ptr<FlowUnitGroup> flowunit_group_;
   bool is_flowunit_opened_{false};
@@ -305,8 +347,19 @@ class Node : public NodeBase {
 
   std::shared_ptr<Profiler> profiler_;
   std::shared_ptr<StatisticsItem> graph_stats_;
+  std::shared_ptr<StatisticsItem> node_stats_;
+  std::shared_ptr<StatisticsGauge> input_queue_size_;
   SessionManager* session_mgr_{nullptr};
 
+  uint32_t latency_sample_interval_{0};
+  std::atomic<uint64_t> latency_sample_count_{0};
+  std::shared_ptr<StatisticsHistogram> queue_wait_;
+  std::shared_ptr<StatisticsHistogram> graph_latency_;
+  std::once_flag trace_init_flag_;
+  std::shared_ptr<TraceRecorder> trace_recorder_;
+  uint32_t trace_name_id_{0};
+  std::shared_ptr<DeviceMemoryAccount> memory_account_;
+
  protected:
   std::unordered_map<std::string, std::shared_ptr<Node>> port_match_at_node_;
   std::once_flag input_stream_count_update_flag_;
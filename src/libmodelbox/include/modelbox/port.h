@@ -17,6 +17,11 @@
 #ifndef MODELBOX_PORT_H_
 #define MODELBOX_PORT_H_
 
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
 #include "modelbox/base/blocking_queue.h"
 #include "modelbox/base/status.h"
 #include "modelbox/inner_event.h"
@@ -295,10 +300,38 @@ class InPort : public NotifyPort<Buffer, CustomCompare> {
 
   std::vector<std::weak_ptr<OutPort>> GetAllOutPort();
 
+  /**
+   * @brief Record time a latency sampled buffer is sent to this port, buffer
+   * is shared by all edges of the out port, so send time is kept per edge
+   * @param index_info index info of sampled buffer
+   * @param send_time steady clock time in ns
+   */
+  void SetSendTime(const std::shared_ptr<BufferIndexInfo>& index_info,
+                   uint64_t send_time);
+
+  /**
+   * @brief Get and remove send time of sampled buffer on this port
+   * @param index_info index info of sampled buffer
+   * @return send time in ns, 0 if not recorded
+   */
+  uint64_t TakeSendTime(const std::shared_ptr<BufferIndexInfo>& index_info);
+
  private:
   bool SetOutputPort(std::shared_ptr<OutPort> output_port);
 
   std::vector<std::weak_ptr<OutPort>> output_ports;
+
+  struct SendTimeRecord {
+    std::weak_ptr<BufferIndexInfo> index_info;
+    uint64_t send_time{0};
+    uint64_t seq{0};
+  };
+
+  std::mutex send_time_lock_;
+  std::unordered_map<const BufferIndexInfo*, SendTimeRecord> send_time_;
+  // keys in insertion order with seq, oldest records are evicted first
+  std::deque<std::pair<const BufferIndexInfo*, uint64_t>> send_time_order_;
+  uint64_t send_time_seq_{0};
 };
 
 class OutPort : public Port, public std::enable_shared_from_this<OutPort> {
@@ -24,6 +24,7 @@
 #include <modelbox/base/status.h>
 #include <modelbox/base/thread_pool.h>
 #include <modelbox/base/timer.h>
+#include <modelbox/trace_recorder.h>
 
 #include <atomic>
 #include <chrono>
@@ -37,21 +38,13 @@
 #include <thread>
 #include <type_traits>
 #include <typeinfo>
+#include <unordered_map>
 #include <vector>
 
 namespace modelbox {
 
 constexpr const char* PROFILE_PATH_ENV = "PROFILE_PATH";
 
-enum class TraceSliceType {
-  OPEN,
-  CLOSE,
-  PROCESS,
-  STREAM_OPEN,
-  STREAM_CLOSE,
-  CUSTOM
-};
-
 enum class EventType { BEGIN, END };
 
 using TimePoint = std::chrono::time_point<std::chrono::system_clock,
@@ -63,6 +56,10 @@ constexpr uint32_t DEFAULT_WRITE_PROFILE_INTERVAL = 600;
 
 constexpr uint32_t DEFAULT_WRITE_TRACE_INTERVAL = 600;
 
+constexpr uint32_t DEFAULT_CPU_SAMPLE_FREQUENCY = 99;
+
+constexpr uint32_t DEFAULT_WRITE_CPU_SAMPLE_INTERVAL = 600;
+
 class ProfilerLifeCycle {
  public:
   ProfilerLifeCycle(const std::string& name);
@@ -360,11 +357,24 @@ class Trace : public std::enable_shared_from_this<Trace>,
 
   inline void SetSessionEnable() { session_enable_ = true; }
 
+  /**
+   * @brief Recorder for hot path, records are kept only when trace is running
+   */
+  inline std::shared_ptr<TraceRecorder> GetRecorder() { return recorder_; }
+
  private:
   std::string TraceSliceTypeToString(TraceSliceType type);
 
   void TraceWork();
 
+  // append pending slices to current trace file, writer_mutex_ must be held
+  void DrainTrace();
+
+  void WriteSlice(uint32_t name_id, uint32_t session_id,
+                  TraceSliceType slice_type, uint64_t ts_ns, uint64_t dur_ns,
+                  uint32_t batch_size, const std::string& name,
+                  const std::string& session);
+
  private:
   // FlowUnit name -> FlowUnitTrace, get by lock
   std::map<std::string, std::shared_ptr<FlowUnitTrace>> traces_;
@@ -382,6 +392,104 @@ class Trace : public std::enable_shared_from_this<Trace>,
   std::shared_ptr<std::thread> timer_;
 
   std::atomic_bool session_enable_;
+
+  std::shared_ptr<TraceRecorder> recorder_;
+
+  std::mutex writer_mutex_;
+
+  std::shared_ptr<ChromeTraceWriter> writer_;
+
+  uint64_t dropped_count_{0};
+};
+
+/**
+ * @brief Tag code running on current thread with node and session, cpu
+ * samples taken in the scope are attributed to them. Scopes can be nested.
+ */
+class CpuSampleScope {
+ public:
+  /**
+   * @param node_id id from CpuSampler::Intern(node name)
+   * @param session_id id from CpuSampler::Intern(session id), 0 for none
+   */
+  CpuSampleScope(uint32_t node_id, uint32_t session_id = 0);
+
+  virtual ~CpuSampleScope();
+
+ private:
+  uint64_t prev_tag_;
+};
+
+/**
+ * @brief Sample cpu of all threads by SIGPROF timer, count samples by node and
+ * session running on the interrupted thread, and write flamegraph folded
+ * stack files
+ */
+class CpuSampler : public ProfilerLifeCycle {
+ public:
+  explicit CpuSampler(const std::string& output_dir_path);
+
+  virtual ~CpuSampler();
+
+  Status OnStart() override;
+
+  Status OnStop() override;
+
+  Status OnPause() override;
+
+  Status OnResume() override;
+
+  /**
+   * @brief Set sample frequency, takes effect on next start
+   * @param frequency samples per second of cpu time
+   */
+  inline void SetFrequency(uint32_t frequency) { frequency_ = frequency; }
+
+  inline void SetWriteFileInterval(uint32_t interval) {
+    write_file_interval_ = interval;
+  }
+
+  /**
+   * @brief Write aggregated samples to a new folded file and reset them
+   */
+  Status WriteProfile();
+
+  uint64_t GetSampleCount();
+
+  uint64_t GetDroppedCount();
+
+  /**
+   * @brief Get id of node or session name, 0 is reserved for empty name
+   */
+  static uint32_t Intern(const std::string& name);
+
+  /**
+   * @brief Whether any sampler is running, check before tagging sessions
+   */
+  static bool IsSampling();
+
+ private:
+  void SampleWork();
+
+  // aggregate pending samples, sample_mutex_ must be held
+  void DrainSamples();
+
+  std::string output_dir_path_;
+
+  uint32_t frequency_{DEFAULT_CPU_SAMPLE_FREQUENCY};
+
+  uint32_t write_file_interval_{DEFAULT_WRITE_CPU_SAMPLE_INTERVAL};
+
+  std::atomic_bool timer_run_{false};
+
+  std::shared_ptr<std::thread> timer_;
+
+  std::mutex sample_mutex_;
+
+  // node id << 32 | session id -> sample count
+  std::unordered_map<uint64_t, uint64_t> tag_counts_;
+
+  uint64_t sample_count_{0};
 };
 
 /**
@@ -421,6 +529,8 @@ class Profiler : public ProfilerLifeCycle {
 
   inline std::shared_ptr<Trace> GetTrace() { return trace_; }
 
+  inline std::shared_ptr<CpuSampler> GetCpuSampler() { return cpu_sampler_; }
+
  private:
   std::shared_ptr<DeviceManager> device_mgr_;
 
@@ -431,6 +541,8 @@ class Profiler : public ProfilerLifeCycle {
   std::shared_ptr<Performance> perf_;
 
   std::shared_ptr<Trace> trace_;
+
+  std::shared_ptr<CpuSampler> cpu_sampler_;
 };
 
 }  // namespace modelbox
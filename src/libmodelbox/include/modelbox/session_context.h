@@ -87,7 +87,15 @@ class SessionContext {
   std::shared_ptr<StatisticsItem> GetStatistics(
       SessionContexStatsType type = SessionContexStatsType::SESSION);
 
+  /**
+   * @brief Get account of device memory allocated for this session
+   * @return account, live memory is reported as leak when session finishes
+   */
+  std::shared_ptr<DeviceMemoryAccount> GetMemoryAccount();
+
  private:
+  void ReportMemoryLeak();
+
   std::mutex private_map_lock_;
   std::unordered_map<std::string, std::shared_ptr<void>> private_map_;
   std::string session_id_;
@@ -95,6 +103,7 @@ class SessionContext {
   std::shared_ptr<FlowUnitError> error_;
   std::shared_ptr<StatisticsItem> graph_stats_;
   std::shared_ptr<StatisticsItem> graph_session_stats_;
+  std::shared_ptr<DeviceMemoryAccount> memory_account_;
 };
 
 }  // namespace modelbox
@@ -27,13 +27,16 @@
 #include <unordered_map>
 
 #include "modelbox/base/any.h"
+#include "modelbox/base/device_memory.h"
 #include "modelbox/base/status.h"
 #include "modelbox/base/thread_pool.h"
 #include "modelbox/base/timer.h"
+#include "modelbox/statistics_metric.h"
 
 namespace modelbox {
 
 constexpr const char* STATISTICS_ITEM_FLOW = "flow";
+constexpr const char* STATISTICS_ITEM_NODE = "node";
 
 class StatisticsValue {
  public:
@@ -92,6 +95,10 @@ class StatisticsValue {
 
   bool GetString(std::string& val);
 
+  bool IsHistogram();
+
+  bool GetHistogram(StatisticsHistogramSnapshot& val);
+
   std::string ToString();
 
  private:
@@ -291,6 +298,23 @@ class StatisticsItem : public std::enable_shared_from_this<StatisticsItem> {
    */
   inline bool IsLeaf() { return is_leaf_; }
 
+  /**
+   * @brief Mark item as the root of one session, flow.<graph>.<session>
+   */
+  inline void MarkSession() { is_session_ = true; }
+
+  /**
+   * @brief Check item is the root of one session
+   * @return check result
+   */
+  inline bool IsSession() { return is_session_; }
+
+  /**
+   * @brief Check item is backed by counter, gauge or histogram
+   * @return check result
+   */
+  inline bool IsMetric() { return metric_ != nullptr; }
+
   /**
    * @brief Set value of this item
    * @return Result of set
@@ -362,6 +386,10 @@ class StatisticsItem : public std::enable_shared_from_this<StatisticsItem> {
     }
 
     StatusError = modelbox::STATUS_OK;
+    if (metric_ != nullptr) {
+      return std::make_shared<StatisticsValue>(metric_->GetValue());
+    }
+
     return std::make_shared<StatisticsValue>(value_);
   }
 
@@ -407,6 +435,48 @@ class StatisticsItem : public std::enable_shared_from_this<StatisticsItem> {
                                           const T& value,
                                           bool override_val = false);
 
+  /**
+   * @brief Add counter item as child, value is uint64_t, updated lock free.
+   * IncreaseValue on the item still sends CHANGE notify, update through
+   * GetCounter() does not
+   * @param name Name of new item
+   * @return New item, or the existing item if it is a counter too
+   */
+  std::shared_ptr<StatisticsItem> AddCounter(const std::string& name);
+
+  /**
+   * @brief Add gauge item as child, value is int64_t, updated lock free
+   * @param name Name of new item
+   * @return New item, or the existing item if it is a gauge too
+   */
+  std::shared_ptr<StatisticsItem> AddGauge(const std::string& name);
+
+  /**
+   * @brief Add histogram item as child, value is StatisticsHistogramSnapshot,
+   * record through GetHistogram()
+   * @param name Name of new item
+   * @return New item, or the existing item if it is a histogram too
+   */
+  std::shared_ptr<StatisticsItem> AddHistogram(const std::string& name);
+
+  /**
+   * @brief Get counter of this item
+   * @return Counter, nullptr if this item is not a counter
+   */
+  std::shared_ptr<StatisticsCounter> GetCounter();
+
+  /**
+   * @brief Get gauge of this item
+   * @return Gauge, nullptr if this item is not a gauge
+   */
+  std::shared_ptr<StatisticsGauge> GetGauge();
+
+  /**
+   * @brief Get histogram of this item
+   * @return Histogram, nullptr if this item is not a histogram
+   */
+  std::shared_ptr<StatisticsHistogram> GetHistogram();
+
   /**
    * @brief Get item with name
    * @param child_path Target item name
@@ -494,8 +564,32 @@ class StatisticsItem : public std::enable_shared_from_this<StatisticsItem> {
   modelbox::Status ForEachInner(const StatisticsForEachFunc& func,
                                 bool recursive, const std::string& base_path);
 
-  std::shared_ptr<StatisticsItem> AddItemInner(const std::string& name,
-                                               std::shared_ptr<Any> value);
+  std::shared_ptr<StatisticsItem> AddItemInner(
+      const std::string& name, std::shared_ptr<Any> value,
+      std::shared_ptr<StatisticsMetric> metric = nullptr);
+
+  std::shared_ptr<StatisticsItem> AddMetricItem(const std::string& name,
+                                                StatisticsMetricType type);
+
+  template <typename T>
+  using IsMetricValue =
+      std::integral_constant<bool, std::is_integral<T>::value &&
+                                       !std::is_same<T, bool>::value>;
+
+  modelbox::Status UpdateMetric(int64_t value, bool increase);
+
+  template <typename T>
+  modelbox::Status UpdateMetric(const T& value, bool increase,
+                                std::true_type) {
+    return UpdateMetric((int64_t)value, increase);
+  }
+
+  template <typename T>
+  modelbox::Status UpdateMetric(const T& value, bool increase,
+                                std::false_type) {
+    return {modelbox::STATUS_NOTSUPPORT,
+            "Metric item only accepts integer value."};
+  }
 
  private:
   std::string parent_path_;
@@ -504,6 +598,7 @@ class StatisticsItem : public std::enable_shared_from_this<StatisticsItem> {
   std::string path_;  // full path : parent_path_ + "." + name_
   std::mutex value_lock_;
   std::shared_ptr<Any> value_;
+  std::shared_ptr<StatisticsMetric> metric_;  // set once when created
   std::mutex children_lock_;
   std::map<std::string, std::shared_ptr<StatisticsItem>> children_;
   std::set<std::string> children_name_set_;
@@ -516,11 +611,12 @@ class StatisticsItem : public std::enable_shared_from_this<StatisticsItem> {
   StatisticsNotifyConsumers consumers_;
   std::shared_ptr<ThreadPool> thread_pool_;
   std::shared_ptr<Timer> notify_timer_;
-  std::chrono::steady_clock::time_point last_change_notify_time_;
-  std::mutex last_change_notify_time_lock_;
+  // steady clock time in nanoseconds
+  std::atomic<int64_t> last_change_notify_time_{0};
 
   std::atomic_bool is_alive_{true};
   std::atomic_bool is_leaf_{false};
+  std::atomic_bool is_session_{false};
 };
 
 template <typename T, typename>
@@ -530,6 +626,10 @@ modelbox::Status StatisticsItem::SetValue(const T& value) {
             "This is not a leaf node, set value failed."};
   }
 
+  if (metric_ != nullptr) {
+    return UpdateMetric(value, false, IsMetricValue<T>());
+  }
+
   std::lock_guard<std::mutex> lck(value_lock_);
   auto old_val = value_;
   value_ = std::make_shared<Any>(value);
@@ -548,6 +648,10 @@ modelbox::Status StatisticsItem::IncreaseValue(const T& value) {
             "This is not a leaf node, increase value failed."};
   }
 
+  if (metric_ != nullptr) {
+    return UpdateMetric(value, true, IsMetricValue<T>());
+  }
+
   std::lock_guard<std::mutex> lck(value_lock_);
   if (value_ == nullptr) {
     return modelbox::STATUS_INVALID;
@@ -592,16 +696,23 @@ modelbox::Status StatisticsItem::GetValue(T& value) {
             "This is not a leaf node, get value failed."};
   }
 
-  std::lock_guard<std::mutex> lck(value_lock_);
-  if (value_ == nullptr) {
+  std::shared_ptr<Any> val;
+  if (metric_ != nullptr) {
+    val = metric_->GetValue();
+  } else {
+    std::lock_guard<std::mutex> lck(value_lock_);
+    val = value_;
+  }
+
+  if (val == nullptr) {
     return modelbox::STATUS_NODATA;
   }
 
-  if (value_->type() != typeid(value)) {
+  if (val->type() != typeid(value)) {
     return modelbox::STATUS_INVALID;
   }
 
-  value = any_cast<T>(*value_);
+  value = any_cast<T>(*val);
   return modelbox::STATUS_OK;
 }
 
@@ -636,6 +747,29 @@ std::shared_ptr<StatisticsItem> StatisticsItem::AddItem(const std::string& name,
   return AddItemInner(name, value_ptr);
 }
 
+/**
+ * @brief Memory account which exports mem_live_bytes and mem_peak_bytes
+ * gauges under the statistics item
+ */
+class StatisticsMemoryAccount : public DeviceMemoryAccount {
+ public:
+  /**
+   * @param name Account name, node name or session id
+   * @param parent Item to add gauges to, nullptr for no statistics
+   */
+  StatisticsMemoryAccount(const std::string& name,
+                          const std::shared_ptr<StatisticsItem>& parent);
+
+  ~StatisticsMemoryAccount() override;
+
+ protected:
+  void OnUpdate(int64_t live_delta, size_t peak_bytes) override;
+
+ private:
+  std::shared_ptr<StatisticsGauge> live_bytes_;
+  std::shared_ptr<StatisticsGauge> peak_bytes_;
+};
+
 class Statistics {
  public:
   /**
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MODELBOX_STATISTICS_METRIC_H_
+#define MODELBOX_STATISTICS_METRIC_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "modelbox/base/any.h"
+
+namespace modelbox {
+
+/**
+ * @brief Shard number of counter and histogram, each thread is bound to one
+ * shard, so updates from different threads do not contend on one cache line
+ */
+constexpr size_t STATISTICS_METRIC_SHARD_NUM = 16;
+
+enum class StatisticsMetricType : uint32_t { COUNTER, GAUGE, HISTOGRAM };
+
+/**
+ * @brief Native statistics value, updated without lock and allocation, shards
+ * are merged only when read
+ */
+class StatisticsMetric {
+ public:
+  virtual ~StatisticsMetric() = default;
+
+  virtual StatisticsMetricType GetMetricType() const = 0;
+
+  /**
+   * @brief Merge all shards into a plain value
+   * counter: uint64_t, gauge: int64_t, histogram: StatisticsHistogramSnapshot
+   * @return merged value
+   */
+  virtual std::shared_ptr<Any> GetValue() const = 0;
+
+  /**
+   * @brief Reset value to initial state
+   */
+  virtual void Reset() = 0;
+
+ protected:
+  /**
+   * @brief Shard index of current thread, assigned round robin on first use
+   */
+  static size_t GetShardIndex();
+};
+
+/**
+ * @brief Monotonic counter
+ */
+class StatisticsCounter : public StatisticsMetric {
+ public:
+  StatisticsCounter();
+
+  ~StatisticsCounter() override;
+
+  StatisticsMetricType GetMetricType() const override {
+    return StatisticsMetricType::COUNTER;
+  }
+
+  inline void Increase(uint64_t value = 1) {
+    shards_[GetShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  uint64_t Get() const;
+
+  std::shared_ptr<Any> GetValue() const override;
+
+  void Reset() override;
+
+ private:
+  // padded to cache line, values of two shards never share a line
+  struct Shard {
+    std::atomic<uint64_t> value{0};
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+  };
+
+  Shard shards_[STATISTICS_METRIC_SHARD_NUM];
+};
+
+/**
+ * @brief Value can go up and down, such as queue size
+ */
+class StatisticsGauge : public StatisticsMetric {
+ public:
+  StatisticsGauge();
+
+  ~StatisticsGauge() override;
+
+  StatisticsMetricType GetMetricType() const override {
+    return StatisticsMetricType::GAUGE;
+  }
+
+  inline void Set(int64_t value) {
+    value_.store(value, std::memory_order_relaxed);
+  }
+
+  inline void Add(int64_t value) {
+    value_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  inline int64_t Get() const { return value_.load(std::memory_order_relaxed); }
+
+  std::shared_ptr<Any> GetValue() const override;
+
+  void Reset() override;
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+/**
+ * @brief Merged view of a histogram
+ */
+class StatisticsHistogramSnapshot {
+ public:
+  StatisticsHistogramSnapshot();
+
+  virtual ~StatisticsHistogramSnapshot();
+
+  inline uint64_t GetCount() const { return count_; }
+
+  inline uint64_t GetSum() const { return sum_; }
+
+  inline uint64_t GetMin() const { return count_ == 0 ? 0 : min_; }
+
+  inline uint64_t GetMax() const { return max_; }
+
+  double GetMean() const;
+
+  /**
+   * @brief Get value at percentile
+   * @param percentile in [0, 100], e.g. 99.9
+   * @return value, relative error is less than 1 / 32
+   */
+  uint64_t GetPercentile(double percentile) const;
+
+  /**
+   * @brief count=, min=, max=, mean=, p50=, p99=, p999=
+   */
+  std::string ToString() const;
+
+ private:
+  friend class StatisticsHistogram;
+
+  uint64_t count_{0};
+  uint64_t sum_{0};
+  uint64_t min_{UINT64_MAX};
+  uint64_t max_{0};
+  std::vector<uint64_t> buckets_;
+};
+
+/**
+ * @brief Log-linear (HDR style) histogram for latency
+ * values below 32 are exact, above that each power of two is split into 32
+ * buckets, values not less than 2^41 are counted in the last bucket
+ */
+class StatisticsHistogram : public StatisticsMetric {
+ public:
+  StatisticsHistogram();
+
+  ~StatisticsHistogram() override;
+
+  StatisticsMetricType GetMetricType() const override {
+    return StatisticsMetricType::HISTOGRAM;
+  }
+
+  /**
+   * @brief Record one value, lock free
+   * @param value value to record, e.g. latency in microseconds
+   */
+  void Record(uint64_t value);
+
+  StatisticsHistogramSnapshot GetSnapshot() const;
+
+  std::shared_ptr<Any> GetValue() const override;
+
+  void Reset() override;
+
+  static size_t GetBucketIndex(uint64_t value);
+
+  static uint64_t GetBucketLowerBound(size_t index);
+
+  static uint64_t GetBucketUpperBound(size_t index);
+
+  static constexpr size_t SUB_BUCKET_BITS = 5;
+  static constexpr size_t SUB_BUCKET_NUM = 1 << SUB_BUCKET_BITS;
+  static constexpr size_t MAX_VALUE_BITS = 40;
+  static constexpr size_t BUCKET_NUM =
+      (MAX_VALUE_BITS - SUB_BUCKET_BITS + 2) * SUB_BUCKET_NUM;
+
+ private:
+  struct Shard {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> min{UINT64_MAX};
+    std::atomic<uint64_t> max{0};
+    std::atomic<uint64_t> buckets[BUCKET_NUM];
+
+    Shard();
+  };
+
+  Shard* GetShard();
+
+  // allocated on first record of the shard, most histograms are only touched
+  // by a few threads
+  std::atomic<Shard*> shards_[STATISTICS_METRIC_SHARD_NUM];
+};
+
+}  // namespace modelbox
+
+#endif  // MODELBOX_STATISTICS_METRIC_H_
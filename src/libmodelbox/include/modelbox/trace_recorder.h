@@ -0,0 +1,262 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MODELBOX_TRACE_RECORDER_H_
+#define MODELBOX_TRACE_RECORDER_H_
+
+#include <modelbox/base/status.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace modelbox {
+
+enum class TraceSliceType {
+  OPEN,
+  CLOSE,
+  PROCESS,
+  STREAM_OPEN,
+  STREAM_CLOSE,
+  QUEUE_WAIT,
+  CUSTOM
+};
+
+/**
+ * @brief Record number of each thread ring, must be power of 2
+ */
+constexpr size_t DEFAULT_TRACE_RING_CAPACITY = 8192;
+
+/**
+ * @brief Fixed size binary trace record, names are interned ids
+ */
+struct TraceRecord {
+  uint64_t begin_ns;
+  uint64_t end_ns;
+  uint32_t name_id;
+  uint32_t session_id;
+  uint32_t batch_size;
+  TraceSliceType slice_type;
+};
+
+/**
+ * @brief Single producer single consumer ring of one thread
+ * producer never blocks, records are dropped when the ring is full
+ */
+class TraceRing {
+ public:
+  TraceRing(size_t capacity, uint32_t index);
+
+  virtual ~TraceRing();
+
+  inline bool Push(const TraceRecord &record) {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= capacity_) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    records_[head & (capacity_ - 1)] = record;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Consume all records, only one consumer at a time
+   * @param func called for each record
+   * @return record number consumed
+   */
+  size_t Drain(const std::function<void(const TraceRecord &)> &func);
+
+  inline uint32_t GetIndex() const { return index_; }
+
+  inline uint64_t GetDroppedCount() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  inline void Close() { closed_.store(true, std::memory_order_relaxed); }
+
+  inline bool IsClosed() const {
+    return closed_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // producer and consumer index on different cache lines
+  std::atomic<uint64_t> head_{0};
+  char head_padding_[64 - sizeof(std::atomic<uint64_t>)];
+  std::atomic<uint64_t> tail_{0};
+  char tail_padding_[64 - sizeof(std::atomic<uint64_t>)];
+
+  size_t capacity_;
+  uint32_t index_;
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic_bool closed_{false};
+  std::vector<TraceRecord> records_;
+};
+
+/**
+ * @brief Streaming writer of chrome trace event format, viewable in
+ * chrome://tracing and perfetto, file is created on first event
+ */
+class ChromeTraceWriter {
+ public:
+  explicit ChromeTraceWriter(const std::string &file_path);
+
+  virtual ~ChromeTraceWriter();
+
+  void WriteProcessName(uint32_t pid, const std::string &name);
+
+  void WriteThreadName(uint32_t pid, uint32_t tid, const std::string &name);
+
+  inline bool IsProcessNamed(uint32_t pid) const {
+    return named_.find((uint64_t)pid << 32 | UINT32_MAX) != named_.end();
+  }
+
+  inline bool IsThreadNamed(uint32_t pid, uint32_t tid) const {
+    return named_.find((uint64_t)pid << 32 | tid) != named_.end();
+  }
+
+  /**
+   * @brief Write complete event
+   * @param ts_ns begin time since epoch in nanoseconds
+   * @param dur_ns duration in nanoseconds
+   */
+  void WriteSlice(uint32_t pid, uint32_t tid, const std::string &name,
+                  uint64_t ts_ns, uint64_t dur_ns, uint32_t batch_size);
+
+  Status Close();
+
+  inline uint64_t GetEventCount() const { return event_count_; }
+
+  inline const std::string &GetFilePath() const { return file_path_; }
+
+ private:
+  void BeginEvent();
+
+  void AppendString(const std::string &str);
+
+  void Flush();
+
+  std::string file_path_;
+  FILE *file_{nullptr};
+  bool failed_{false};
+  uint64_t event_count_{0};
+  std::string buffer_;
+  // pid << 32 | tid of named thread, tid UINT32_MAX for process
+  std::set<uint64_t> named_;
+};
+
+/**
+ * @brief Low overhead tracer, each thread appends fixed size records to its
+ * own ring without lock or allocation, a background thread drains the rings
+ * into a ChromeTraceWriter
+ */
+class TraceRecorder {
+ public:
+  explicit TraceRecorder(size_t ring_capacity = DEFAULT_TRACE_RING_CAPACITY);
+
+  virtual ~TraceRecorder();
+
+  /**
+   * @brief Get id of name, call once when setup, not per record
+   * @param name node or session name
+   * @return id of name, 0 is reserved for empty name
+   */
+  uint32_t Intern(const std::string &name);
+
+  inline void SetEnable(bool enable) {
+    enable_.store(enable, std::memory_order_relaxed);
+  }
+
+  inline bool IsEnable() const {
+    return enable_.load(std::memory_order_relaxed);
+  }
+
+  inline void Record(uint32_t name_id, TraceSliceType slice_type,
+                     const std::chrono::steady_clock::time_point &begin,
+                     const std::chrono::steady_clock::time_point &end,
+                     uint32_t batch_size, uint32_t session_id = 0) {
+    if (!IsEnable()) {
+      return;
+    }
+
+    TraceRecord record;
+    record.begin_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          begin.time_since_epoch())
+                          .count();
+    record.end_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        end.time_since_epoch())
+                        .count();
+    record.name_id = name_id;
+    record.session_id = session_id;
+    record.batch_size = batch_size;
+    record.slice_type = slice_type;
+    GetThreadRing()->Push(record);
+  }
+
+  /**
+   * @brief Drain all thread rings, only one drainer at a time
+   * @param func called for each record with names of current interned table
+   * @return record number drained
+   */
+  size_t Drain(const std::function<void(const TraceRecord &record,
+                                        const std::vector<std::string> &names)>
+                   &func);
+
+  /**
+   * @brief Convert steady clock nanoseconds of record to wall clock
+   */
+  inline uint64_t ToWallTime(uint64_t steady_ns) const {
+    return wall_base_ns_ + (int64_t)(steady_ns - steady_base_ns_);
+  }
+
+  uint64_t GetDroppedCount();
+
+ private:
+  TraceRing *GetThreadRing();
+
+  std::shared_ptr<TraceRing> AddThreadRing();
+
+  uint64_t id_;
+  size_t ring_capacity_;
+  std::atomic_bool enable_{false};
+  uint64_t wall_base_ns_{0};
+  uint64_t steady_base_ns_{0};
+
+  std::mutex rings_mutex_;
+  std::list<std::shared_ptr<TraceRing>> rings_;
+  uint32_t next_ring_index_{0};
+  uint64_t dropped_count_{0};
+
+  std::mutex names_mutex_;
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, uint32_t> name_ids_;
+  std::vector<std::string> drain_names_;
+};
+
+}  // namespace modelbox
+
+#endif  // MODELBOX_TRACE_RECORDER_H_
@@ -0,0 +1,318 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include <cstring>
+#include <fstream>
+
+#include "modelbox/base/utils.h"
+#include "modelbox/profiler.h"
+
+namespace modelbox {
+
+// must be power of 2
+constexpr size_t CPU_SAMPLE_RING_CAPACITY = 4096;
+// session ids are not reused, stop interning when too many
+constexpr size_t CPU_SAMPLE_MAX_NAMES = 65536;
+
+struct CpuSample {
+  std::atomic<uint64_t> seq{0};
+  uint64_t tag{0};
+};
+
+/**
+ * Multi producer ring filled in signal handler, never freed because a
+ * signal may still be delivered after the sampler stops
+ */
+struct CpuSampleRing {
+  std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> tail{0};
+  std::atomic<uint64_t> dropped{0};
+  CpuSample samples[CPU_SAMPLE_RING_CAPACITY];
+};
+
+static std::atomic<CpuSampleRing *> g_sample_ring{nullptr};
+static std::atomic<CpuSampler *> g_active_sampler{nullptr};
+static std::atomic_bool g_sampling{false};
+static struct sigaction g_old_action;
+
+// node id << 32 | session id, initial exec model keeps the access
+// async signal safe
+static thread_local uint64_t g_cpu_sample_tag
+    __attribute__((tls_model("initial-exec"))) = 0;
+
+static std::mutex g_names_mutex;
+static std::vector<std::string> g_names{""};
+static std::unordered_map<std::string, uint32_t> g_name_ids{{"", 0}};
+
+// only async signal safe work here, record the sample id of the interrupted
+// thread, names are resolved when samples are drained
+static void CpuSampleHandler(int sig, siginfo_t *info, void *ucontext) {
+  auto saved_errno = errno;
+  auto *ring = g_sample_ring.load(std::memory_order_acquire);
+  if (ring == nullptr || !g_sampling.load(std::memory_order_relaxed)) {
+    errno = saved_errno;
+    return;
+  }
+
+  auto head = ring->head.load(std::memory_order_relaxed);
+  do {
+    if (head - ring->tail.load(std::memory_order_acquire) >=
+        CPU_SAMPLE_RING_CAPACITY) {
+      ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      errno = saved_errno;
+      return;
+    }
+  } while (!ring->head.compare_exchange_weak(head, head + 1,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_relaxed));
+
+  auto &sample = ring->samples[head & (CPU_SAMPLE_RING_CAPACITY - 1)];
+  sample.tag = g_cpu_sample_tag;
+  sample.seq.store(head + 1, std::memory_order_release);
+  errno = saved_errno;
+}
+
+/**
+ * CpuSampleScope
+ */
+CpuSampleScope::CpuSampleScope(uint32_t node_id, uint32_t session_id)
+    : prev_tag_(g_cpu_sample_tag) {
+  g_cpu_sample_tag = (uint64_t)node_id << 32 | session_id;
+}
+
+CpuSampleScope::~CpuSampleScope() { g_cpu_sample_tag = prev_tag_; }
+
+/**
+ * CpuSampler
+ */
+CpuSampler::CpuSampler(const std::string &output_dir_path)
+    : ProfilerLifeCycle("CpuSampler"), output_dir_path_(output_dir_path) {}
+
+CpuSampler::~CpuSampler() {
+  if (IsRunning()) {
+    Stop();
+  }
+}
+
+uint32_t CpuSampler::Intern(const std::string &name) {
+  std::lock_guard<std::mutex> lock(g_names_mutex);
+  auto iter = g_name_ids.find(name);
+  if (iter != g_name_ids.end()) {
+    return iter->second;
+  }
+
+  if (g_names.size() >= CPU_SAMPLE_MAX_NAMES) {
+    return 0;
+  }
+
+  uint32_t id = g_names.size();
+  g_names.push_back(name);
+  g_name_ids[name] = id;
+  return id;
+}
+
+bool CpuSampler::IsSampling() {
+  return g_sampling.load(std::memory_order_relaxed);
+}
+
+Status CpuSampler::OnStart() {
+  if (frequency_ == 0 || frequency_ > 1000000) {
+    return {STATUS_INVALID,
+            "invalid cpu sample frequency " + std::to_string(frequency_)};
+  }
+
+  CpuSampler *expected = nullptr;
+  if (!g_active_sampler.compare_exchange_strong(expected, this)) {
+    return {STATUS_BUSY, "another cpu sampler is running"};
+  }
+
+  if (g_sample_ring.load() == nullptr) {
+    g_sample_ring.store(new CpuSampleRing());
+  }
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_sigaction = CpuSampleHandler;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, &g_old_action) != 0) {
+    g_active_sampler = nullptr;
+    return {STATUS_FAULT, "install SIGPROF handler failed, " +
+                              modelbox::StrError(errno)};
+  }
+
+  g_sampling = true;
+  struct itimerval timer;
+  uint64_t period_us = 1000000 / frequency_;
+  timer.it_interval.tv_sec = period_us / 1000000;
+  timer.it_interval.tv_usec = period_us % 1000000;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    auto err = errno;
+    g_sampling = false;
+    sigaction(SIGPROF, &g_old_action, nullptr);
+    g_active_sampler = nullptr;
+    return {STATUS_FAULT, "start cpu sample timer failed, " +
+                              modelbox::StrError(err)};
+  }
+
+  timer_run_ = true;
+  timer_ = std::make_shared<std::thread>(&CpuSampler::SampleWork, this);
+  MBLOG_INFO << "cpu sampler start, frequency " << frequency_ << "Hz";
+  return STATUS_SUCCESS;
+}
+
+Status CpuSampler::OnResume() { return OnStart(); }
+
+Status CpuSampler::OnPause() {
+  if (g_active_sampler.load() != this) {
+    return STATUS_SUCCESS;
+  }
+
+  struct itimerval timer;
+  memset(&timer, 0, sizeof(timer));
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  // keep handler installed, a pending SIGPROF with default action kills
+  // the process, handler ignores signals when not sampling
+  g_sampling = false;
+
+  if (timer_) {
+    timer_run_ = false;
+    timer_->join();
+    timer_ = nullptr;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(sample_mutex_);
+    DrainSamples();
+  }
+
+  g_active_sampler = nullptr;
+  MBLOG_INFO << "cpu sampler stop, samples " << sample_count_ << ", dropped "
+             << GetDroppedCount();
+  return STATUS_SUCCESS;
+}
+
+Status CpuSampler::OnStop() {
+  OnPause();
+  return WriteProfile();
+}
+
+void CpuSampler::SampleWork() {
+  uint32_t count = 0;
+  while (timer_run_) {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(DEFAULT_TIMER_SAMPLE_INTERVAL));
+    count++;
+    if (count > write_file_interval_) {
+      WriteProfile();
+      count = 0;
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock(sample_mutex_);
+    DrainSamples();
+  }
+}
+
+void CpuSampler::DrainSamples() {
+  auto *ring = g_sample_ring.load(std::memory_order_acquire);
+  if (ring == nullptr) {
+    return;
+  }
+
+  auto tail = ring->tail.load(std::memory_order_relaxed);
+  while (true) {
+    auto &sample = ring->samples[tail & (CPU_SAMPLE_RING_CAPACITY - 1)];
+    if (sample.seq.load(std::memory_order_acquire) != tail + 1) {
+      break;
+    }
+
+    tag_counts_[sample.tag]++;
+    sample_count_++;
+    tail++;
+    ring->tail.store(tail, std::memory_order_release);
+  }
+}
+
+Status CpuSampler::WriteProfile() {
+  std::lock_guard<std::mutex> lock(sample_mutex_);
+  DrainSamples();
+  if (tag_counts_.empty()) {
+    return STATUS_SUCCESS;
+  }
+
+  time_t current_time = time(0);
+  char buf[64] = {0};
+  auto local_tm = localtime(&current_time);
+  if (local_tm) {
+    strftime(buf, sizeof(buf), "%Y-%m-%d-%H-%M-%S", local_tm);
+  }
+
+  std::string file_path =
+      output_dir_path_ + "/" + "cpu_" + std::string(buf) + ".folded";
+  std::ofstream out(file_path, std::ios::out | std::ios::trunc);
+  if (!out.is_open()) {
+    MBLOG_ERROR << "write cpu sample failed, file path : " << file_path;
+    return STATUS_FAULT;
+  }
+
+  std::vector<std::string> names;
+  {
+    std::lock_guard<std::mutex> lock(g_names_mutex);
+    names = g_names;
+  }
+
+  // folded stack of node and session, ';' separates frames
+  std::unordered_map<std::string, uint64_t> folded_stacks;
+  for (const auto &tag_count : tag_counts_) {
+    uint32_t node_id = tag_count.first >> 32;
+    uint32_t session_id = tag_count.first & UINT32_MAX;
+    auto stack = node_id != 0 && node_id < names.size() ? names[node_id]
+                                                        : "[no_node]";
+    if (session_id != 0 && session_id < names.size()) {
+      stack += ";session:" + names[session_id];
+    }
+
+    folded_stacks[stack] += tag_count.second;
+  }
+
+  for (const auto &stack : folded_stacks) {
+    out << stack.first << " " << stack.second << "\n";
+  }
+
+  out.close();
+  tag_counts_.clear();
+  MBLOG_INFO << "write cpu sample to " << file_path;
+  return STATUS_SUCCESS;
+}
+
+uint64_t CpuSampler::GetSampleCount() {
+  std::lock_guard<std::mutex> lock(sample_mutex_);
+  return sample_count_;
+}
+
+uint64_t CpuSampler::GetDroppedCount() {
+  auto *ring = g_sample_ring.load(std::memory_order_acquire);
+  return ring == nullptr ? 0 : ring->dropped.load(std::memory_order_relaxed);
+}
+
+}  // namespace modelbox
@@ -111,7 +111,8 @@ Profiler::Profiler(std::shared_ptr<DeviceManager> device_mgr,
       config_(config),
       output_dir_path_(""),
       perf_(nullptr),
-      trace_(nullptr) {}
+      trace_(nullptr),
+      cpu_sampler_(nullptr) {}
 
 Profiler::~Profiler() {
   if (IsRunning()) {
@@ -121,13 +122,14 @@ Profiler::~Profiler() {
 
 Status Profiler::OnInit() {
   bool profile_enable = false, trace_enable = false;
-  bool session_enable = false;
+  bool session_enable = false, cpu_sample_enable = false;
 
   profile_enable = config_->GetBool("profile.profile");
   trace_enable = config_->GetBool("profile.trace");
   session_enable = config_->GetBool("profile.session");
+  cpu_sample_enable = config_->GetBool("profile.cpu_sample");
 
-  if (profile_enable || trace_enable) {
+  if (profile_enable || trace_enable || cpu_sample_enable) {
     auto ret = InitProfilerDir();
     if (ret != STATUS_OK) {
       return STATUS_FAULT;
@@ -143,6 +145,12 @@ Status Profiler::OnInit() {
     trace_ = std::make_shared<Trace>(output_dir_path_, perf_, session_enable);
   }
 
+  if (cpu_sample_enable) {
+    cpu_sampler_ = std::make_shared<CpuSampler>(output_dir_path_);
+    cpu_sampler_->SetFrequency(config_->GetUint32(
+        "profile.cpu_sample_frequency", DEFAULT_CPU_SAMPLE_FREQUENCY));
+  }
+
   return STATUS_SUCCESS;
 }
 
@@ -190,6 +198,10 @@ Status Profiler::OnStart() {
     trace_->Start();
   }
 
+  if (cpu_sampler_ != nullptr) {
+    cpu_sampler_->Start();
+  }
+
   return STATUS_SUCCESS;
 }
 
@@ -202,6 +214,10 @@ Status Profiler::OnStop() {
     trace_->Stop();
   }
 
+  if (cpu_sampler_ != nullptr) {
+    cpu_sampler_->Stop();
+  }
+
   return STATUS_SUCCESS;
 }
 
@@ -214,6 +230,10 @@ Status Profiler::OnResume() {
     trace_->Resume();
   }
 
+  if (cpu_sampler_ != nullptr) {
+    cpu_sampler_->Resume();
+  }
+
   return STATUS_SUCCESS;
 }
 
@@ -226,6 +246,10 @@ Status Profiler::OnPause() {
     trace_->Pause();
   }
 
+  if (cpu_sampler_ != nullptr) {
+    cpu_sampler_->Pause();
+  }
+
   return STATUS_SUCCESS;
 }
 
@@ -19,6 +19,14 @@
 
 namespace modelbox {
 
+constexpr int64_t CHANGE_NOTIFY_INTERVAL_NS = 1000 * 1000 * 1000;
+
+static int64_t SteadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 /**
  * StatisticsValue
  */
@@ -64,6 +72,14 @@ bool StatisticsValue::IsString() { return IsType(typeid(std::string)); }
 
 bool StatisticsValue::GetString(std::string& val) { return GetValue(val); }
 
+bool StatisticsValue::IsHistogram() {
+  return IsType(typeid(StatisticsHistogramSnapshot));
+}
+
+bool StatisticsValue::GetHistogram(StatisticsHistogramSnapshot& val) {
+  return GetValue(val);
+}
+
 std::string StatisticsValue::ToString() {
   if (IsInt32()) {
     return ToString<int32_t>();
@@ -83,6 +99,10 @@ std::string StatisticsValue::ToString() {
     std::string val;
     GetValue(val);
     return val;
+  } else if (IsHistogram()) {
+    StatisticsHistogramSnapshot val;
+    GetValue(val);
+    return val.ToString();
   }
 
   return "";
@@ -177,7 +197,7 @@ StatisticsItem::StatisticsItem() {
   notify_timer_ = std::make_shared<Timer>();
   notify_timer_->SetName("Stat-Timer");
   notify_timer_->Start();
-  last_change_notify_time_ = std::chrono::steady_clock::now();
+  last_change_notify_time_ = SteadyNowNs();
 }
 
 StatisticsItem::StatisticsItem(const std::string& parent_path,
@@ -190,7 +210,7 @@ StatisticsItem::StatisticsItem(const std::string& parent_path,
     path_ = name_;
   }
 
-  last_change_notify_time_ = std::chrono::steady_clock::now();
+  last_change_notify_time_ = SteadyNowNs();
 }
 
 StatisticsItem::~StatisticsItem() {
@@ -209,8 +229,121 @@ std::shared_ptr<StatisticsItem> StatisticsItem::AddItem(
   return AddItemInner(name, nullptr);
 }
 
+std::shared_ptr<StatisticsItem> StatisticsItem::AddCounter(
+    const std::string& name) {
+  return AddMetricItem(name, StatisticsMetricType::COUNTER);
+}
+
+std::shared_ptr<StatisticsItem> StatisticsItem::AddGauge(
+    const std::string& name) {
+  return AddMetricItem(name, StatisticsMetricType::GAUGE);
+}
+
+std::shared_ptr<StatisticsItem> StatisticsItem::AddHistogram(
+    const std::string& name) {
+  return AddMetricItem(name, StatisticsMetricType::HISTOGRAM);
+}
+
+std::shared_ptr<StatisticsCounter> StatisticsItem::GetCounter() {
+  if (metric_ == nullptr ||
+      metric_->GetMetricType() != StatisticsMetricType::COUNTER) {
+    return nullptr;
+  }
+
+  return std::static_pointer_cast<StatisticsCounter>(metric_);
+}
+
+std::shared_ptr<StatisticsGauge> StatisticsItem::GetGauge() {
+  if (metric_ == nullptr ||
+      metric_->GetMetricType() != StatisticsMetricType::GAUGE) {
+    return nullptr;
+  }
+
+  return std::static_pointer_cast<StatisticsGauge>(metric_);
+}
+
+std::shared_ptr<StatisticsHistogram> StatisticsItem::GetHistogram() {
+  if (metric_ == nullptr ||
+      metric_->GetMetricType() != StatisticsMetricType::HISTOGRAM) {
+    return nullptr;
+  }
+
+  return std::static_pointer_cast<StatisticsHistogram>(metric_);
+}
+
+std::shared_ptr<StatisticsItem> StatisticsItem::AddMetricItem(
+    const std::string& name, StatisticsMetricType type) {
+  if (!is_alive_) {
+    StatusError = {STATUS_FAULT, "This item is disposed"};
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lck(children_lock_);
+  auto item = children_.find(name);
+  if (item != children_.end()) {
+    auto& target = item->second;
+    if (target->metric_ == nullptr ||
+        target->metric_->GetMetricType() != type) {
+      StatusError = {STATUS_EXIST,
+                     "Item " + name + " exists with different value type"};
+      return nullptr;
+    }
+
+    StatusError = STATUS_EXIST;
+    return target;
+  }
+
+  std::shared_ptr<StatisticsMetric> metric;
+  switch (type) {
+    case StatisticsMetricType::COUNTER:
+      metric = std::make_shared<StatisticsCounter>();
+      break;
+    case StatisticsMetricType::GAUGE:
+      metric = std::make_shared<StatisticsGauge>();
+      break;
+    case StatisticsMetricType::HISTOGRAM:
+      metric = std::make_shared<StatisticsHistogram>();
+      break;
+    default:
+      StatusError = {STATUS_INVALID, "Unknown metric type"};
+      return nullptr;
+  }
+
+  return AddItemInner(name, nullptr, metric);
+}
+
+modelbox::Status StatisticsItem::UpdateMetric(int64_t value, bool increase) {
+  switch (metric_->GetMetricType()) {
+    case StatisticsMetricType::COUNTER:
+      if (!increase) {
+        return {STATUS_NOTSUPPORT, "Counter can only be increased."};
+      }
+
+      if (value < 0) {
+        return {STATUS_INVALID, "Counter can not be decreased."};
+      }
+
+      GetCounter()->Increase((uint64_t)value);
+      break;
+    case StatisticsMetricType::GAUGE:
+      if (increase) {
+        GetGauge()->Add(value);
+      } else {
+        GetGauge()->Set(value);
+      }
+      break;
+    default:
+      return {STATUS_NOTSUPPORT,
+              "Histogram can only be recorded by GetHistogram()->Record."};
+  }
+
+  Notify(StatisticsNotifyType::CHANGE);
+  return STATUS_OK;
+}
+
 std::shared_ptr<StatisticsItem> StatisticsItem::AddItemInner(
-    const std::string& name, std::shared_ptr<Any> value) {
+    const std::string& name, std::shared_ptr<Any> value,
+    std::shared_ptr<StatisticsMetric> metric) {
   if (IsLeaf()) {
     StatusError = {STATUS_NOTSUPPORT, "This is a leaf node, can not add item."};
     return nullptr;
@@ -231,7 +364,8 @@ std::shared_ptr<StatisticsItem> StatisticsItem::AddItemInner(
   child->thread_pool_ = thread_pool_;
   child->notify_timer_ = notify_timer_;
   child->value_ = value;
-  if (value != nullptr) {
+  child->metric_ = metric;
+  if (value != nullptr || metric != nullptr) {
     child->is_leaf_ = true;
   }
   // Delay register
@@ -404,26 +538,27 @@ void StatisticsItem::UnRegisterNotify(
 }
 
 modelbox::Status StatisticsItem::Notify(const StatisticsNotifyType& type) {
-  auto consumer_list = consumers_.GetConsumers(type);
-  if (consumer_list.empty()) {
-    return modelbox::STATUS_OK;
-  }
-
+  // Change notify is on the update path of every value, check the interval
+  // before copying consumers
+  int64_t now = 0;
+  int64_t last = 0;
   if (type == StatisticsNotifyType::CHANGE) {
-    // Avoid lock frequently
-    if ((std::chrono::steady_clock::now() - last_change_notify_time_) <
-        std::chrono::seconds(1)) {
+    now = SteadyNowNs();
+    last = last_change_notify_time_.load(std::memory_order_relaxed);
+    if (now - last < CHANGE_NOTIFY_INTERVAL_NS) {
       return modelbox::STATUS_BUSY;
     }
+  }
 
-    // Avoid data race
-    std::lock_guard<std::mutex> lck(last_change_notify_time_lock_);
-    auto now = std::chrono::steady_clock::now();
-    if ((now - last_change_notify_time_) < std::chrono::seconds(1)) {
-      return modelbox::STATUS_BUSY;
-    }
+  auto consumer_list = consumers_.GetConsumers(type);
+  if (consumer_list.empty()) {
+    return modelbox::STATUS_OK;
+  }
 
-    last_change_notify_time_ = now;
+  // Only one updater in the interval wins the notify
+  if (type == StatisticsNotifyType::CHANGE &&
+      !last_change_notify_time_.compare_exchange_strong(last, now)) {
+    return modelbox::STATUS_BUSY;
   }
 
   auto msg = std::make_shared<StatisticsNotifyMsg>(path_, GetValue(), type);
@@ -528,6 +663,37 @@ void StatisticsItem::DelChildrenNotify(
   }
 }
 
+StatisticsMemoryAccount::StatisticsMemoryAccount(
+    const std::string& name, const std::shared_ptr<StatisticsItem>& parent)
+    : DeviceMemoryAccount(name) {
+  if (parent == nullptr) {
+    return;
+  }
+
+  auto live_item = parent->AddGauge("mem_live_bytes");
+  if (live_item != nullptr) {
+    live_bytes_ = live_item->GetGauge();
+  }
+
+  auto peak_item = parent->AddGauge("mem_peak_bytes");
+  if (peak_item != nullptr) {
+    peak_bytes_ = peak_item->GetGauge();
+  }
+}
+
+StatisticsMemoryAccount::~StatisticsMemoryAccount() {}
+
+void StatisticsMemoryAccount::OnUpdate(int64_t live_delta,
+                                       size_t peak_bytes) {
+  if (live_bytes_ != nullptr) {
+    live_bytes_->Add(live_delta);
+  }
+
+  if (peak_bytes_ != nullptr) {
+    peak_bytes_->Set(peak_bytes);
+  }
+}
+
 std::once_flag Statistics::fix_item_init_flag_;
 
 std::shared_ptr<StatisticsItem> Statistics::GetGlobalItem() {
@@ -539,6 +705,11 @@ std::shared_ptr<StatisticsItem> Statistics::GetGlobalItem() {
         if (flow_item == nullptr) {
           MBLOG_ERROR << "Add item " << STATISTICS_ITEM_FLOW << "failed";
         }
+
+        auto node_item = stats->AddItem(STATISTICS_ITEM_NODE);
+        if (node_item == nullptr) {
+          MBLOG_ERROR << "Add item " << STATISTICS_ITEM_NODE << "failed";
+        }
       },
       stats);
 
@@ -0,0 +1,282 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "modelbox/statistics_metric.h"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace modelbox {
+
+constexpr size_t StatisticsHistogram::SUB_BUCKET_BITS;
+constexpr size_t StatisticsHistogram::SUB_BUCKET_NUM;
+constexpr size_t StatisticsHistogram::MAX_VALUE_BITS;
+constexpr size_t StatisticsHistogram::BUCKET_NUM;
+
+size_t StatisticsMetric::GetShardIndex() {
+  static std::atomic<size_t> next_index{0};
+  thread_local size_t index =
+      next_index.fetch_add(1, std::memory_order_relaxed) %
+      STATISTICS_METRIC_SHARD_NUM;
+  return index;
+}
+
+/**
+ * StatisticsCounter
+ */
+StatisticsCounter::StatisticsCounter() {}
+
+StatisticsCounter::~StatisticsCounter() {}
+
+uint64_t StatisticsCounter::Get() const {
+  uint64_t total = 0;
+  for (const auto& shard : shards_) {
+    total += shard.value.load(std::memory_order_relaxed);
+  }
+
+  return total;
+}
+
+std::shared_ptr<Any> StatisticsCounter::GetValue() const {
+  return std::make_shared<Any>(Get());
+}
+
+void StatisticsCounter::Reset() {
+  for (auto& shard : shards_) {
+    shard.value.store(0, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * StatisticsGauge
+ */
+StatisticsGauge::StatisticsGauge() {}
+
+StatisticsGauge::~StatisticsGauge() {}
+
+std::shared_ptr<Any> StatisticsGauge::GetValue() const {
+  return std::make_shared<Any>(Get());
+}
+
+void StatisticsGauge::Reset() { Set(0); }
+
+/**
+ * StatisticsHistogramSnapshot
+ */
+StatisticsHistogramSnapshot::StatisticsHistogramSnapshot()
+    : buckets_(StatisticsHistogram::BUCKET_NUM, 0) {}
+
+StatisticsHistogramSnapshot::~StatisticsHistogramSnapshot() {}
+
+double StatisticsHistogramSnapshot::GetMean() const {
+  if (count_ == 0) {
+    return 0;
+  }
+
+  return (double)sum_ / count_;
+}
+
+uint64_t StatisticsHistogramSnapshot::GetPercentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+
+  if (percentile <= 0) {
+    return GetMin();
+  }
+
+  if (percentile >= 100) {
+    return max_;
+  }
+
+  auto rank = (uint64_t)std::ceil(percentile / 100 * count_);
+  if (rank == 0) {
+    rank = 1;
+  }
+
+  uint64_t accumulated = 0;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    accumulated += buckets_[i];
+    if (accumulated < rank) {
+      continue;
+    }
+
+    auto value = StatisticsHistogram::GetBucketUpperBound(i);
+    if (value > max_) {
+      value = max_;
+    }
+
+    if (value < min_) {
+      value = min_;
+    }
+
+    return value;
+  }
+
+  return max_;
+}
+
+std::string StatisticsHistogramSnapshot::ToString() const {
+  std::stringstream ss;
+  ss << "count=" << count_ << " min=" << GetMin() << " max=" << max_
+     << " mean=" << std::fixed << std::setprecision(2) << GetMean()
+     << " p50=" << GetPercentile(50) << " p99=" << GetPercentile(99)
+     << " p999=" << GetPercentile(99.9);
+  return ss.str();
+}
+
+/**
+ * StatisticsHistogram
+ */
+StatisticsHistogram::Shard::Shard() {
+  for (auto& bucket : buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+StatisticsHistogram::StatisticsHistogram() {
+  for (auto& shard : shards_) {
+    shard.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+StatisticsHistogram::~StatisticsHistogram() {
+  for (auto& shard : shards_) {
+    delete shard.load(std::memory_order_relaxed);
+  }
+}
+
+size_t StatisticsHistogram::GetBucketIndex(uint64_t value) {
+  if (value < SUB_BUCKET_NUM) {
+    return value;
+  }
+
+  size_t msb = 63 - __builtin_clzll(value);
+  if (msb > MAX_VALUE_BITS) {
+    return BUCKET_NUM - 1;
+  }
+
+  auto shift = msb - SUB_BUCKET_BITS;
+  auto sub_index = (value >> shift) & (SUB_BUCKET_NUM - 1);
+  return (shift + 1) * SUB_BUCKET_NUM + sub_index;
+}
+
+uint64_t StatisticsHistogram::GetBucketLowerBound(size_t index) {
+  if (index < SUB_BUCKET_NUM) {
+    return index;
+  }
+
+  auto shift = index / SUB_BUCKET_NUM - 1;
+  auto sub_index = index % SUB_BUCKET_NUM;
+  return (uint64_t)(SUB_BUCKET_NUM + sub_index) << shift;
+}
+
+uint64_t StatisticsHistogram::GetBucketUpperBound(size_t index) {
+  if (index >= BUCKET_NUM - 1) {
+    return UINT64_MAX;
+  }
+
+  return GetBucketLowerBound(index + 1) - 1;
+}
+
+StatisticsHistogram::Shard* StatisticsHistogram::GetShard() {
+  auto& slot = shards_[GetShardIndex()];
+  auto* shard = slot.load(std::memory_order_acquire);
+  if (shard != nullptr) {
+    return shard;
+  }
+
+  auto* new_shard = new Shard();
+  if (slot.compare_exchange_strong(shard, new_shard,
+                                   std::memory_order_acq_rel)) {
+    return new_shard;
+  }
+
+  // other thread sharing the slot won
+  delete new_shard;
+  return shard;
+}
+
+void StatisticsHistogram::Record(uint64_t value) {
+  auto* shard = GetShard();
+  shard->buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  shard->count.fetch_add(1, std::memory_order_relaxed);
+  shard->sum.fetch_add(value, std::memory_order_relaxed);
+
+  auto min = shard->min.load(std::memory_order_relaxed);
+  while (value < min && !shard->min.compare_exchange_weak(
+                            min, value, std::memory_order_relaxed)) {
+  }
+
+  auto max = shard->max.load(std::memory_order_relaxed);
+  while (value > max && !shard->max.compare_exchange_weak(
+                            max, value, std::memory_order_relaxed)) {
+  }
+}
+
+StatisticsHistogramSnapshot StatisticsHistogram::GetSnapshot() const {
+  StatisticsHistogramSnapshot snapshot;
+  for (const auto& slot : shards_) {
+    const auto* shard = slot.load(std::memory_order_acquire);
+    if (shard == nullptr) {
+      continue;
+    }
+
+    for (size_t i = 0; i < BUCKET_NUM; ++i) {
+      snapshot.buckets_[i] += shard->buckets[i].load(std::memory_order_relaxed);
+    }
+
+    snapshot.count_ += shard->count.load(std::memory_order_relaxed);
+    snapshot.sum_ += shard->sum.load(std::memory_order_relaxed);
+    auto min = shard->min.load(std::memory_order_relaxed);
+    if (min < snapshot.min_) {
+      snapshot.min_ = min;
+    }
+
+    auto max = shard->max.load(std::memory_order_relaxed);
+    if (max > snapshot.max_) {
+      snapshot.max_ = max;
+    }
+  }
+
+  return snapshot;
+}
+
+std::shared_ptr<Any> StatisticsHistogram::GetValue() const {
+  return std::make_shared<Any>(GetSnapshot());
+}
+
+void StatisticsHistogram::Reset() {
+  for (auto& slot : shards_) {
+    auto* shard = slot.load(std::memory_order_acquire);
+    if (shard == nullptr) {
+      continue;
+    }
+
+    for (auto& bucket : shard->buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+
+    shard->count.store(0, std::memory_order_relaxed);
+    shard->sum.store(0, std::memory_order_relaxed);
+    shard->min.store(UINT64_MAX, std::memory_order_relaxed);
+    shard->max.store(0, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace modelbox
@@ -15,9 +15,6 @@
  */
 
 
-#include <fstream>
-#include <nlohmann/json.hpp>
-
 #include "modelbox/profiler.h"
 
 namespace modelbox {
@@ -26,7 +23,10 @@ const std::map<TraceSliceType, std::string> TRACE_SLICE_TYPE = {
     {TraceSliceType::CLOSE, "CLOSE"},
     {TraceSliceType::PROCESS, "PROCESS"},
     {TraceSliceType::STREAM_OPEN, "STREAM_OPEN"},
-    {TraceSliceType::STREAM_CLOSE, "STREAM_CLOSE"}};
+    {TraceSliceType::STREAM_CLOSE, "STREAM_CLOSE"},
+    {TraceSliceType::QUEUE_WAIT, "QUEUE_WAIT"}};
+
+constexpr uint32_t TRACE_GRAPH_PID = 1;
 
 Trace::Trace(std::string& output_dir_path, std::shared_ptr<Performance> perf,
              bool session_enable)
@@ -34,7 +34,8 @@ Trace::Trace(std::string& output_dir_path, std::shared_ptr<Performance> perf,
       output_dir_path_(output_dir_path),
       perf_(perf),
       write_file_interval_(DEFAULT_WRITE_TRACE_INTERVAL),
-      session_enable_(session_enable) {}
+      session_enable_(session_enable),
+      recorder_(std::make_shared<TraceRecorder>()) {}
 
 Trace::~Trace() {
   if (IsRunning()) {
@@ -43,6 +44,7 @@ Trace::~Trace() {
 }
 
 Status Trace::OnStart() {
+  recorder_->SetEnable(true);
   timer_run_ = true;
   timer_ = std::make_shared<std::thread>(&Trace::TraceWork, this);
   return STATUS_SUCCESS;
@@ -59,6 +61,7 @@ Status Trace::OnStop() {
 }
 
 Status Trace::OnPause() {
+  recorder_->SetEnable(false);
   if (timer_) {
     timer_run_ = false;
     timer_->join();
@@ -123,84 +126,126 @@ void Trace::TraceWork() {
     if (count > write_file_interval_) {
       WriteTrace();
       count = 0;
+      continue;
     }
+
+    // drain rings every tick, so a ring only holds records of one tick
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    DrainTrace();
   }
 
   MBLOG_INFO << "trace timer end";
 }
 
 Status Trace::WriteTrace() {
-  nlohmann::json traces_json = nlohmann::json::array();
-  std::unique_lock<std::mutex> lock(trace_mutex_);
-  if (traces_.empty()) {
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  DrainTrace();
+  if (writer_ == nullptr) {
     return STATUS_SUCCESS;
   }
 
-  uint64_t valid_trace_count = 0;
-  for (auto trace : traces_) {
-    std::string flow_unit_name = trace.second->GetFlowUnitName();
-    std::vector<std::shared_ptr<TraceSlice>> trace_slices;
-    trace.second->GetTraceSlices(trace_slices);
-    for (auto slice : trace_slices) {
-      if (slice->GetDuration() < 0) {
-        continue;
-      }
+  auto ret = writer_->Close();
+  writer_ = nullptr;
+  return ret;
+}
 
-      valid_trace_count++;
-      nlohmann::json trace_json;
-      // Global
-      nlohmann::json args;
-      args["batch_size"] = slice->GetBatchSize();
+void Trace::WriteSlice(uint32_t name_id, uint32_t session_id,
+                       TraceSliceType slice_type, uint64_t ts_ns,
+                       uint64_t dur_ns, uint32_t batch_size,
+                       const std::string& name, const std::string& session) {
+  const auto& slice_name = TraceSliceTypeToString(slice_type);
+  // Global, one lane for each flowunit
+  if (!writer_->IsThreadNamed(TRACE_GRAPH_PID, name_id)) {
+    if (!writer_->IsProcessNamed(TRACE_GRAPH_PID)) {
+      writer_->WriteProcessName(TRACE_GRAPH_PID, "Graph");
+    }
 
-      trace_json["name"] = TraceSliceTypeToString(slice->GetTraceSliceType());
-      trace_json["dur"] = slice->GetDuration();
-      trace_json["ts"] =
-          slice->GetBeginEvent()->GetEventTime().time_since_epoch().count();
-      trace_json["tid"] = flow_unit_name;
-      trace_json["ph"] = "X";
-      trace_json["pid"] = "Graph";
-      trace_json["args"] = args;
-      traces_json.push_back(trace_json);
-      // Session
-      if (session_enable_) {
-        trace_json["pid"] = "Session:" + slice->GetSession();
-        traces_json.push_back(trace_json);
-      }
+    writer_->WriteThreadName(TRACE_GRAPH_PID, name_id, name);
+  }
+
+  writer_->WriteSlice(TRACE_GRAPH_PID, name_id, slice_name, ts_ns, dur_ns,
+                      batch_size);
+  if (!session_enable_ || session_id == 0) {
+    return;
+  }
+
+  // Session
+  auto session_pid = TRACE_GRAPH_PID + session_id;
+  if (!writer_->IsThreadNamed(session_pid, name_id)) {
+    if (!writer_->IsProcessNamed(session_pid)) {
+      writer_->WriteProcessName(session_pid, "Session:" + session);
     }
+
+    writer_->WriteThreadName(session_pid, name_id, name);
   }
 
-  lock.unlock();
+  writer_->WriteSlice(session_pid, name_id, slice_name, ts_ns, dur_ns,
+                      batch_size);
+}
 
-  if (valid_trace_count == 0) {
-    return STATUS_SUCCESS;
+void Trace::DrainTrace() {
+  if (writer_ == nullptr) {
+    time_t current_time = time(0);
+    char buf[64] = {0};
+    auto local_tm = localtime(&current_time);
+    if (local_tm) {
+      strftime(buf, sizeof(buf), "%Y-%m-%d-%H-%M-%S", local_tm);
+    }
+
+    // TODO: graph_name + task_name + timestample
+    std::string file_path =
+        output_dir_path_ + "/" + "trace_" + std::string(buf) + ".json";
+    writer_ = std::make_shared<ChromeTraceWriter>(file_path);
   }
 
-  time_t current_time = time(0);
-  char buf[64] = {0};
-  auto local_tm = localtime(&current_time);
-  if (local_tm) {
-    strftime(buf, sizeof(buf), "%Y-%m-%d-%H-%M-%S", local_tm);
+  // slices of FlowUnitTrace api
+  std::vector<std::shared_ptr<FlowUnitTrace>> flowunit_traces;
+  {
+    std::lock_guard<std::mutex> lock(trace_mutex_);
+    for (auto& trace : traces_) {
+      flowunit_traces.push_back(trace.second);
+    }
   }
 
-  // TODO: graph_name + task_name + timestample
-  std::string file_path =
-      output_dir_path_ + "/" + "trace_" + std::string(buf) + ".json";
+  std::vector<std::shared_ptr<TraceSlice>> trace_slices;
+  for (auto& trace : flowunit_traces) {
+    trace_slices.clear();
+    trace->GetTraceSlices(trace_slices);
+    if (trace_slices.empty()) {
+      continue;
+    }
 
-  std::ofstream out(file_path);
-  if (out.is_open() == false) {
-    MBLOG_ERROR << "write trace failed, file path : " << file_path;
-    return STATUS_FAULT;
-  }
-  Defer { out.close(); };
+    auto name_id = recorder_->Intern(trace->GetFlowUnitName());
+    for (auto& slice : trace_slices) {
+      auto duration = slice->GetDuration();
+      if (duration < 0) {
+        continue;
+      }
 
-  std::string traces_json_str = traces_json.dump();
-  out.write(traces_json_str.c_str(), traces_json_str.size());
-  if (out.rdstate() & std::ios::failbit) {
-    MBLOG_ERROR << "Write file " << file_path << " failed";
-    return STATUS_FAULT;
+      auto session_id = recorder_->Intern(slice->GetSession());
+      uint64_t ts_us =
+          slice->GetBeginEvent()->GetEventTime().time_since_epoch().count();
+      WriteSlice(name_id, session_id, slice->GetTraceSliceType(), ts_us * 1000,
+                 (uint64_t)duration * 1000, slice->GetBatchSize(),
+                 trace->GetFlowUnitName(), slice->GetSession());
+    }
   }
 
-  return STATUS_SUCCESS;
+  // slices of TraceRecorder
+  recorder_->Drain([this](const TraceRecord& record,
+                          const std::vector<std::string>& names) {
+    WriteSlice(record.name_id, record.session_id, record.slice_type,
+               recorder_->ToWallTime(record.begin_ns),
+               record.end_ns - record.begin_ns, record.batch_size,
+               names[record.name_id], names[record.session_id]);
+  });
+
+  auto dropped_count = recorder_->GetDroppedCount();
+  if (dropped_count != dropped_count_) {
+    MBLOG_WARN << "trace ring full, " << dropped_count - dropped_count_
+               << " slices dropped";
+    dropped_count_ = dropped_count;
+  }
 }
 
 FlowUnitTrace::FlowUnitTrace(const std::string& flow_unit_name)
@@ -0,0 +1,307 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "modelbox/trace_recorder.h"
+
+#include <cinttypes>
+
+#include "modelbox/base/log.h"
+
+namespace modelbox {
+
+constexpr size_t TRACE_WRITER_FLUSH_SIZE = 64 * 1024;
+
+/**
+ * TraceRing
+ */
+TraceRing::TraceRing(size_t capacity, uint32_t index)
+    : capacity_(capacity), index_(index), records_(capacity) {}
+
+TraceRing::~TraceRing() {}
+
+size_t TraceRing::Drain(const std::function<void(const TraceRecord &)> &func) {
+  auto tail = tail_.load(std::memory_order_relaxed);
+  auto head = head_.load(std::memory_order_acquire);
+  for (auto i = tail; i < head; ++i) {
+    func(records_[i & (capacity_ - 1)]);
+  }
+
+  tail_.store(head, std::memory_order_release);
+  return head - tail;
+}
+
+/**
+ * ChromeTraceWriter
+ */
+ChromeTraceWriter::ChromeTraceWriter(const std::string &file_path)
+    : file_path_(file_path) {
+  buffer_.reserve(TRACE_WRITER_FLUSH_SIZE + 1024);
+}
+
+ChromeTraceWriter::~ChromeTraceWriter() { Close(); }
+
+void ChromeTraceWriter::BeginEvent() {
+  if (file_ == nullptr && !failed_) {
+    file_ = fopen(file_path_.c_str(), "w");
+    if (file_ == nullptr) {
+      MBLOG_ERROR << "write trace failed, file path : " << file_path_;
+      failed_ = true;
+    } else {
+      buffer_ = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    }
+  }
+
+  if (event_count_ > 0) {
+    buffer_ += ",\n";
+  }
+
+  ++event_count_;
+}
+
+void ChromeTraceWriter::AppendString(const std::string &str) {
+  buffer_ += '"';
+  for (auto c : str) {
+    if (c == '"' || c == '\\') {
+      buffer_ += '\\';
+      buffer_ += c;
+    } else if ((unsigned char)c < 0x20) {
+      char escape[8];
+      snprintf(escape, sizeof(escape), "\\u%04x", c);
+      buffer_ += escape;
+    } else {
+      buffer_ += c;
+    }
+  }
+
+  buffer_ += '"';
+}
+
+void ChromeTraceWriter::Flush() {
+  if (file_ != nullptr && !buffer_.empty()) {
+    if (fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+      MBLOG_ERROR << "Write file " << file_path_ << " failed";
+      failed_ = true;
+    }
+  }
+
+  buffer_.clear();
+}
+
+void ChromeTraceWriter::WriteProcessName(uint32_t pid,
+                                         const std::string &name) {
+  char buf[64];
+  BeginEvent();
+  snprintf(buf, sizeof(buf),
+           "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%" PRIu32
+           ",\"args\":{\"name\":",
+           pid);
+  buffer_ += buf;
+  AppendString(name);
+  buffer_ += "}}";
+  named_.insert((uint64_t)pid << 32 | UINT32_MAX);
+}
+
+void ChromeTraceWriter::WriteThreadName(uint32_t pid, uint32_t tid,
+                                        const std::string &name) {
+  char buf[96];
+  BeginEvent();
+  snprintf(buf, sizeof(buf),
+           "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%" PRIu32
+           ",\"tid\":%" PRIu32 ",\"args\":{\"name\":",
+           pid, tid);
+  buffer_ += buf;
+  AppendString(name);
+  buffer_ += "}}";
+  named_.insert((uint64_t)pid << 32 | tid);
+}
+
+void ChromeTraceWriter::WriteSlice(uint32_t pid, uint32_t tid,
+                                   const std::string &name, uint64_t ts_ns,
+                                   uint64_t dur_ns, uint32_t batch_size) {
+  char buf[160];
+  BeginEvent();
+  buffer_ += "{\"ph\":\"X\",\"name\":";
+  AppendString(name);
+  // chrome trace time unit is microsecond, keep nanosecond as fraction
+  snprintf(buf, sizeof(buf),
+           ",\"pid\":%" PRIu32 ",\"tid\":%" PRIu32 ",\"ts\":%" PRIu64
+           ".%03" PRIu64 ",\"dur\":%" PRIu64 ".%03" PRIu64
+           ",\"args\":{\"batch_size\":%" PRIu32 "}}",
+           pid, tid, ts_ns / 1000, ts_ns % 1000, dur_ns / 1000, dur_ns % 1000,
+           batch_size);
+  buffer_ += buf;
+  if (buffer_.size() >= TRACE_WRITER_FLUSH_SIZE) {
+    Flush();
+  }
+}
+
+Status ChromeTraceWriter::Close() {
+  if (file_ == nullptr) {
+    buffer_.clear();
+    return failed_ ? Status(STATUS_FAULT) : STATUS_OK;
+  }
+
+  buffer_ += "\n]}\n";
+  Flush();
+  fclose(file_);
+  file_ = nullptr;
+  named_.clear();
+  return failed_ ? Status(STATUS_FAULT) : STATUS_OK;
+}
+
+/**
+ * TraceRecorder
+ */
+struct ThreadTraceRing {
+  uint64_t recorder_id;
+  std::shared_ptr<TraceRing> ring;
+};
+
+// rings of current thread, one for each recorder it has recorded to
+static thread_local std::vector<ThreadTraceRing> thread_rings;
+
+static std::atomic<uint64_t> next_recorder_id{1};
+
+TraceRecorder::TraceRecorder(size_t ring_capacity)
+    : id_(next_recorder_id.fetch_add(1)), ring_capacity_(1) {
+  while (ring_capacity_ < ring_capacity) {
+    ring_capacity_ <<= 1;
+  }
+
+  auto wall_now = std::chrono::system_clock::now();
+  auto steady_now = std::chrono::steady_clock::now();
+  wall_base_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      wall_now.time_since_epoch())
+                      .count();
+  steady_base_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        steady_now.time_since_epoch())
+                        .count();
+  names_.push_back("");
+  name_ids_[""] = 0;
+}
+
+TraceRecorder::~TraceRecorder() {
+  std::lock_guard<std::mutex> lock(rings_mutex_);
+  for (auto &ring : rings_) {
+    ring->Close();
+  }
+}
+
+uint32_t TraceRecorder::Intern(const std::string &name) {
+  std::lock_guard<std::mutex> lock(names_mutex_);
+  auto iter = name_ids_.find(name);
+  if (iter != name_ids_.end()) {
+    return iter->second;
+  }
+
+  uint32_t id = names_.size();
+  names_.push_back(name);
+  name_ids_[name] = id;
+  return id;
+}
+
+TraceRing *TraceRecorder::GetThreadRing() {
+  for (const auto &thread_ring : thread_rings) {
+    if (thread_ring.recorder_id == id_) {
+      return thread_ring.ring.get();
+    }
+  }
+
+  // first record of this thread, drop rings of destroyed recorders
+  auto iter = thread_rings.begin();
+  while (iter != thread_rings.end()) {
+    if (iter->ring->IsClosed()) {
+      iter = thread_rings.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  auto ring = AddThreadRing();
+  thread_rings.push_back({id_, ring});
+  return ring.get();
+}
+
+std::shared_ptr<TraceRing> TraceRecorder::AddThreadRing() {
+  std::lock_guard<std::mutex> lock(rings_mutex_);
+  auto ring = std::make_shared<TraceRing>(ring_capacity_, next_ring_index_++);
+  rings_.push_back(ring);
+  return ring;
+}
+
+size_t TraceRecorder::Drain(
+    const std::function<void(const TraceRecord &record,
+                             const std::vector<std::string> &names)> &func) {
+  std::vector<std::shared_ptr<TraceRing>> rings;
+  {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    rings.assign(rings_.begin(), rings_.end());
+  }
+
+  auto refresh_names = [this]() {
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    if (drain_names_.size() != names_.size()) {
+      drain_names_ = names_;
+    }
+  };
+
+  // names may be interned and recorded after the copy is taken
+  auto emit = [&](const TraceRecord &record) {
+    if (record.name_id >= drain_names_.size() ||
+        record.session_id >= drain_names_.size()) {
+      refresh_names();
+      if (record.name_id >= drain_names_.size() ||
+          record.session_id >= drain_names_.size()) {
+        return;
+      }
+    }
+
+    func(record, drain_names_);
+  };
+
+  refresh_names();
+  size_t count = 0;
+  for (auto &ring : rings) {
+    count += ring->Drain(emit);
+  }
+
+  // ring of exited thread is only referenced here, release it once drained
+  std::lock_guard<std::mutex> lock(rings_mutex_);
+  rings.clear();
+  rings_.remove_if([&](const std::shared_ptr<TraceRing> &ring) {
+    if (ring.use_count() != 1) {
+      return false;
+    }
+
+    count += ring->Drain(emit);
+    dropped_count_ += ring->GetDroppedCount();
+    return true;
+  });
+  return count;
+}
+
+uint64_t TraceRecorder::GetDroppedCount() {
+  std::lock_guard<std::mutex> lock(rings_mutex_);
+  uint64_t dropped = dropped_count_;
+  for (auto &ring : rings_) {
+    dropped += ring->GetDroppedCount();
+  }
+
+  return dropped;
+}
+
+}  // namespace modelbox
@@ -21,6 +21,8 @@
 #include <modelbox/base/utils.h>
 #include <modelbox/common/log.h>
 
+#include <iomanip>
+
 #include "modelbox/statistics.h"
 
 namespace modelbox {
@@ -380,4 +382,147 @@ int ToolCommandStatistics::Run(int argc, char *argv[]) {
   return 0;
 }
 
-}  // namespace modelbox
\ No newline at end of file
+REG_MODELBOX_TOOL_COMMAND(ToolCommandScheduler)
+
+enum MODELBOX_SERVER_COMMAND_SCHEDULER {
+  MODELBOX_SERVER_COMMAND_SCHED_STATUS,
+  MODELBOX_SERVER_COMMAND_SCHED_STALLED,
+};
+
+static struct option server_scheduler_options[] = {
+    {"status", no_argument, NULL, MODELBOX_SERVER_COMMAND_SCHED_STATUS},
+    {"stalled", no_argument, NULL, MODELBOX_SERVER_COMMAND_SCHED_STALLED},
+    {0, 0, 0, 0},
+};
+
+static int64_t GetSchedGauge(std::shared_ptr<modelbox::StatisticsItem> &item,
+                             const std::string &name) {
+  auto gauge_item = item->GetItem(name);
+  if (gauge_item == nullptr || gauge_item->GetGauge() == nullptr) {
+    return 0;
+  }
+
+  return gauge_item->GetGauge()->Get();
+}
+
+ToolCommandScheduler::ToolCommandScheduler() {}
+ToolCommandScheduler::~ToolCommandScheduler() {}
+
+std::string ToolCommandScheduler::GetHelp() {
+  char help[] =
+      "option:\n"
+      "  --status            get scheduler status of all graphs\n"
+      "  --stalled           get nodes holding data but not run\n"
+      "\n";
+  return help;
+}
+
+void ToolCommandScheduler::DisplayGraph(
+    std::shared_ptr<modelbox::StatisticsItem> &graph_item,
+    bool only_stalled) {
+  TOOL_COUT << "graph: " << graph_item->GetName() << std::endl;
+  if (!only_stalled) {
+    auto stall_item = graph_item->GetItem("sched_stalls");
+    uint64_t stalls = 0;
+    if (stall_item != nullptr && stall_item->GetCounter() != nullptr) {
+      stalls = stall_item->GetCounter()->Get();
+    }
+
+    TOOL_COUT << "  ready ports: "
+              << GetSchedGauge(graph_item, "sched_ready_ports")
+              << "  running nodes: "
+              << GetSchedGauge(graph_item, "sched_running_nodes")
+              << "  busy threads: "
+              << GetSchedGauge(graph_item, "sched_busy_threads") << "/"
+              << GetSchedGauge(graph_item, "sched_threads")
+              << "  blocking threads: "
+              << GetSchedGauge(graph_item, "sched_blocking_threads")
+              << "  waiting works: "
+              << GetSchedGauge(graph_item, "sched_waiting_works")
+              << "  queue wait us: "
+              << GetSchedGauge(graph_item, "sched_queue_wait_us")
+              << "  stalled nodes: "
+              << GetSchedGauge(graph_item, "sched_stalled_nodes")
+              << "  stalls: " << stalls << std::endl;
+  }
+
+  TOOL_COUT << "  " << std::left << std::setw(32) << "node" << std::setw(12)
+            << "queue" << std::setw(12) << "idle(ms)" << std::setw(10)
+            << "running"
+            << "stalled" << std::endl;
+  for (const auto &name : graph_item->GetItemNames()) {
+    auto node_item = graph_item->GetItem(name);
+    if (node_item == nullptr || node_item->IsLeaf() ||
+        node_item->GetItem("sched_queue_depth") == nullptr) {
+      continue;
+    }
+
+    auto stalled = GetSchedGauge(node_item, "sched_stalled");
+    if (only_stalled && stalled == 0) {
+      continue;
+    }
+
+    TOOL_COUT << "  " << std::left << std::setw(32) << name << std::setw(12)
+              << GetSchedGauge(node_item, "sched_queue_depth") << std::setw(12)
+              << GetSchedGauge(node_item, "sched_idle_ms") << std::setw(10)
+              << GetSchedGauge(node_item, "sched_running") << stalled
+              << std::endl;
+  }
+}
+
+int ToolCommandScheduler::DisplayGraphs(bool only_stalled) {
+  auto root = modelbox::Statistics::GetGlobalItem();
+  auto node_root = root->GetItem(modelbox::STATISTICS_ITEM_NODE);
+  if (node_root == nullptr) {
+    TOOL_CERR << "Statistics of node have not been created" << std::endl;
+    return 1;
+  }
+
+  bool found = false;
+  for (const auto &graph_id : node_root->GetItemNames()) {
+    auto graph_item = node_root->GetItem(graph_id);
+    if (graph_item == nullptr ||
+        graph_item->GetItem("sched_ready_ports") == nullptr) {
+      continue;
+    }
+
+    if (only_stalled && GetSchedGauge(graph_item, "sched_stalled_nodes") == 0) {
+      continue;
+    }
+
+    DisplayGraph(graph_item, only_stalled);
+    found = true;
+  }
+
+  if (!found) {
+    TOOL_COUT << (only_stalled ? "No stalled node." : "No running graph.")
+              << std::endl;
+  }
+
+  return 0;
+}
+
+int ToolCommandScheduler::Run(int argc, char *argv[]) {
+  int cmdtype = 0;
+
+  if (argc <= 1) {
+    TOOL_COUT << GetHelp();
+    return 0;
+  }
+
+  MODELBOX_COMMAND_GETOPT_BEGIN(cmdtype, server_scheduler_options)
+  switch (cmdtype) {
+    case MODELBOX_SERVER_COMMAND_SCHED_STATUS:
+      return DisplayGraphs(false);
+    case MODELBOX_SERVER_COMMAND_SCHED_STALLED:
+      return DisplayGraphs(true);
+    default:
+      TOOL_COUT << GetHelp();
+      return 1;
+  }
+  MODELBOX_COMMAND_GETOPT_END()
+
+  return 0;
+}
+
+}  // namespace modelbox
@@ -19,12 +19,14 @@
 
 #include "modelbox/base/memory_pool.h"
 #include "modelbox/common/command.h"
+#include "modelbox/statistics.h"
 
 namespace modelbox {
 
 constexpr const char *LOG_CONTROL_DESC = "control server log";
 constexpr const char *SLAB_CONTROL_DESC = "control server slab";
 constexpr const char *STATISTICS_DESC = "control server statistics";
+constexpr const char *SCHEDULER_DESC = "control server scheduler status";
 
 class ToolCommandLog : public modelbox::ToolCommand {
  public:
@@ -72,6 +74,22 @@ class ToolCommandStatistics : public modelbox::ToolCommand {
   std::string GetCommandDesc() { return STATISTICS_DESC; };
 };
 
+class ToolCommandScheduler : public modelbox::ToolCommand {
+ public:
+  ToolCommandScheduler();
+  virtual ~ToolCommandScheduler();
+
+  int Run(int argc, char *argv[]);
+  std::string GetHelp();
+  std::string GetCommandName() { return "sched"; };
+  std::string GetCommandDesc() { return SCHEDULER_DESC; };
+
+ private:
+  int DisplayGraphs(bool only_stalled);
+  void DisplayGraph(std::shared_ptr<modelbox::StatisticsItem> &graph_item,
+                    bool only_stalled);
+};
+
 }  // namespace modelbox
 
 #endif  // MODELBOX_CONTROL_COMMAND_H_
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <modelbox/base/log.h>
+#include <modelbox/server/flow_pool.h>
+
+#include <algorithm>
+
+namespace modelbox {
+
+constexpr uint32_t FLOW_POOL_RETRY_MIN_MS = 1000;
+constexpr uint32_t FLOW_POOL_RETRY_MAX_MS = 60 * 1000;
+
+FlowPool::FlowPool() {}
+
+FlowPool::~FlowPool() { Stop(); }
+
+Status FlowPool::BuildFlow(const std::string &graph_path,
+                           std::shared_ptr<Flow> *flow) {
+  auto new_flow = std::make_shared<Flow>();
+  auto ret = new_flow->Init(graph_path);
+  if (!ret) {
+    return {ret, "init flow " + graph_path + " failed"};
+  }
+
+  ret = new_flow->Build();
+  if (!ret) {
+    return {ret, "build flow " + graph_path + " failed"};
+  }
+
+  *flow = new_flow;
+  return STATUS_OK;
+}
+
+Status FlowPool::Register(const std::string &name,
+                          const std::string &graph_path, uint32_t size) {
+  if (name.empty() || graph_path.empty()) {
+    return {STATUS_INVALID, "graph name or path is empty"};
+  }
+
+  std::lock_guard<std::mutex> lock(lock_);
+  if (graphs_.find(name) != graphs_.end()) {
+    return {STATUS_ALREADY, "graph " + name + " is registered"};
+  }
+
+  auto entry = std::make_shared<FlowPoolEntry>();
+  entry->graph_path = graph_path;
+  entry->size = size;
+  entry->retry_time = std::chrono::steady_clock::now();
+  graphs_[name] = entry;
+  cond_.notify_all();
+  MBLOG_INFO << "register warm graph " << name << ", path " << graph_path
+             << ", size " << size;
+  return STATUS_OK;
+}
+
+void FlowPool::Unregister(const std::string &name) {
+  std::list<std::shared_ptr<Flow>> idle;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto iter = graphs_.find(name);
+    if (iter == graphs_.end()) {
+      return;
+    }
+
+    idle.swap(iter->second->idle);
+    graphs_.erase(iter);
+  }
+
+  for (auto &flow : idle) {
+    flow->Stop();
+  }
+}
+
+void FlowPool::Start() {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (run_) {
+    return;
+  }
+
+  run_ = true;
+  fill_thread_ = std::thread(&FlowPool::FillWork, this);
+}
+
+void FlowPool::Stop() {
+  std::list<std::shared_ptr<Flow>> idle;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    run_ = false;
+    for (auto &graph : graphs_) {
+      idle.splice(idle.end(), graph.second->idle);
+    }
+    cond_.notify_all();
+  }
+
+  if (fill_thread_.joinable()) {
+    fill_thread_.join();
+  }
+
+  for (auto &flow : idle) {
+    flow->Stop();
+  }
+}
+
+std::shared_ptr<Flow> FlowPool::Acquire(const std::string &name) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto iter = graphs_.find(name);
+  if (iter == graphs_.end() || iter->second->idle.empty()) {
+    return nullptr;
+  }
+
+  auto flow = iter->second->idle.front();
+  iter->second->idle.pop_front();
+  cond_.notify_all();
+  return flow;
+}
+
+bool FlowPool::GetGraphPath(const std::string &name,
+                            std::string *graph_path) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto iter = graphs_.find(name);
+  if (iter == graphs_.end()) {
+    return false;
+  }
+
+  *graph_path = iter->second->graph_path;
+  return true;
+}
+
+size_t FlowPool::GetIdleCount(const std::string &name) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto iter = graphs_.find(name);
+  if (iter == graphs_.end()) {
+    return 0;
+  }
+
+  return iter->second->idle.size();
+}
+
+bool FlowPool::IsReady() {
+  for (auto &graph : graphs_) {
+    auto &entry = graph.second;
+    if (entry->fail_count == 0 && entry->idle.size() < entry->size) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool FlowPool::WaitReady(int64_t timeout) {
+  std::unique_lock<std::mutex> lock(lock_);
+  if (timeout < 0) {
+    cond_.wait(lock, [this]() { return IsReady() || !run_; });
+    return IsReady();
+  }
+
+  return cond_.wait_for(lock, std::chrono::milliseconds(timeout),
+                        [this]() { return IsReady() || !run_; }) &&
+         IsReady();
+}
+
+std::shared_ptr<FlowPoolEntry> FlowPool::NextToFill(std::string *name) {
+  auto now = std::chrono::steady_clock::now();
+  for (auto &graph : graphs_) {
+    auto &entry = graph.second;
+    if (entry->idle.size() + entry->building < entry->size &&
+        entry->retry_time <= now) {
+      *name = graph.first;
+      return entry;
+    }
+  }
+
+  return nullptr;
+}
+
+void FlowPool::FillWork() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (run_) {
+    std::string name;
+    auto entry = NextToFill(&name);
+    if (entry == nullptr) {
+      // wake up for failed graphs to retry
+      cond_.wait_for(lock, std::chrono::milliseconds(FLOW_POOL_RETRY_MIN_MS));
+      continue;
+    }
+
+    // build out of lock, may take seconds
+    entry->building++;
+    lock.unlock();
+    std::shared_ptr<Flow> flow;
+    auto begin = std::chrono::steady_clock::now();
+    auto ret = BuildFlow(entry->graph_path, &flow);
+    auto cost_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count();
+    lock.lock();
+    entry->building--;
+
+    if (!ret) {
+      // graph may hold exclusive resource or be broken, retry slowly
+      auto shift = std::min(entry->fail_count, 6U);
+      auto delay = std::min(FLOW_POOL_RETRY_MIN_MS << shift,
+                            FLOW_POOL_RETRY_MAX_MS);
+      entry->fail_count++;
+      entry->retry_time =
+          std::chrono::steady_clock::now() + std::chrono::milliseconds(delay);
+      MBLOG_WARN << "build warm flow " << name << " failed, retry in "
+                 << delay << "ms, " << ret.WrapErrormsgs();
+      cond_.notify_all();
+      continue;
+    }
+
+    entry->fail_count = 0;
+    if (!run_ || graphs_.find(name) == graphs_.end() ||
+        graphs_[name] != entry) {
+      lock.unlock();
+      flow->Stop();
+      lock.lock();
+      continue;
+    }
+
+    entry->idle.push_back(flow);
+    MBLOG_INFO << "warm flow " << name << " built in " << cost_ms
+               << "ms, idle " << entry->idle.size();
+    cond_.notify_all();
+  }
+}
+
+}  // namespace modelbox
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODELBOX_FLOW_POOL_H_
+#define MODELBOX_FLOW_POOL_H_
+
+#include <modelbox/flow.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace modelbox {
+
+/**
+ * @brief Warm flows of one registered graph
+ */
+struct FlowPoolEntry {
+  std::string graph_path;
+  uint32_t size{0};
+  std::list<std::shared_ptr<Flow>> idle;
+  uint32_t building{0};
+  uint32_t fail_count{0};
+  std::chrono::steady_clock::time_point retry_time;
+};
+
+/**
+ * @brief Flows built and opened ahead of time for registered graphs.
+ *
+ * Build of a flow scans drivers, parses graph and opens flowunits, a job
+ * taking a warm flow only needs to run it. Taken flows are refilled in
+ * background. Flowunits holding exclusive resources in Open, like listen
+ * port, can not have more than one flow built, use size 1 for them.
+ */
+class FlowPool {
+ public:
+  FlowPool();
+  virtual ~FlowPool();
+
+  /**
+   * @brief Register graph to keep warm flows
+   * @param name graph name
+   * @param graph_path graph file path
+   * @param size number of warm flows, 0 only registers graph
+   * @return register result
+   */
+  Status Register(const std::string &name, const std::string &graph_path,
+                  uint32_t size);
+
+  /**
+   * @brief Unregister graph, warm flows are stopped
+   * @param name graph name
+   */
+  void Unregister(const std::string &name);
+
+  /**
+   * @brief Start building warm flows in background
+   */
+  void Start();
+
+  /**
+   * @brief Stop building and release warm flows
+   */
+  void Stop();
+
+  /**
+   * @brief Take a warm flow of graph
+   * @param name graph name
+   * @return built flow not run, nullptr when no warm flow
+   */
+  std::shared_ptr<Flow> Acquire(const std::string &name);
+
+  /**
+   * @brief Get graph file of registered graph
+   * @param name graph name
+   * @param graph_path graph file path
+   * @return false when graph is not registered
+   */
+  bool GetGraphPath(const std::string &name, std::string *graph_path);
+
+  /**
+   * @brief Get warm flow number of graph
+   * @param name graph name
+   * @return warm flow number
+   */
+  size_t GetIdleCount(const std::string &name);
+
+  /**
+   * @brief Wait until warm flows of all graphs are built or failed
+   * @param timeout wait time in ms, < 0 wait forever
+   * @return false when timeout
+   */
+  bool WaitReady(int64_t timeout);
+
+  /**
+   * @brief Init and build flow from graph file
+   * @param graph_path graph file path
+   * @param flow built flow
+   * @return build result
+   */
+  static Status BuildFlow(const std::string &graph_path,
+                          std::shared_ptr<Flow> *flow);
+
+ private:
+  void FillWork();
+
+  std::shared_ptr<FlowPoolEntry> NextToFill(std::string *name);
+
+  bool IsReady();
+
+  std::mutex lock_;
+  std::condition_variable cond_;
+  std::map<std::string, std::shared_ptr<FlowPoolEntry>> graphs_;
+  std::thread fill_thread_;
+  bool run_{false};
+};
+
+}  // namespace modelbox
+
+#endif  // MODELBOX_FLOW_POOL_H_
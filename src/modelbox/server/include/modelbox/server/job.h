@@ -20,9 +20,12 @@
 #include <modelbox/flow.h>
 #include <modelbox/server/task_manager.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace modelbox {
@@ -63,6 +66,43 @@ struct ErrorInfo {
   std::string error_msg_;
 };
 
+/**
+ * @brief Job graph reload state
+ */
+enum JobReloadState {
+  /// @brief Job is never reloaded
+  JOB_RELOAD_NONE,
+  /// @brief New graph is building
+  JOB_RELOAD_BUILDING,
+  /// @brief New graph is running, old graph is draining sessions
+  JOB_RELOAD_DRAINING,
+  /// @brief Old graph is drained
+  JOB_RELOAD_SUCCEEDED,
+  /// @brief New graph failed, old graph keeps running
+  JOB_RELOAD_FAILED
+};
+
+constexpr const char* job_str_reload_state[] = {
+    "NONE", "BUILDING", "DRAINING", "SUCCEEDED", "FAILED"};
+
+/**
+ * @brief Job graph reload result
+ */
+struct JobReloadInfo {
+  /// @brief Reload state
+  JobReloadState state_{JOB_RELOAD_NONE};
+  /// @brief Time to build and run new graph in ms
+  uint64_t build_ms_{0};
+  /// @brief Time new sessions are held while switching graph in us
+  uint64_t switch_us_{0};
+  /// @brief Time old graph drains its sessions in ms
+  uint64_t drain_ms_{0};
+  /// @brief Sessions of old graph stopped at drain timeout
+  uint64_t dropped_sessions_{0};
+  /// @brief Reload error message
+  std::string error_msg_;
+};
+
 class Job {
  public:
   /**
@@ -89,6 +129,19 @@ class Job {
    */
   Status Init();
 
+  /**
+   * @brief Init job with a flow already built, build is skipped
+   * @param flow built flow, from FlowPool
+   * @return init result
+   */
+  Status Init(std::shared_ptr<modelbox::Flow> flow);
+
+  /**
+   * @brief Is job started with a warm flow, build was skipped
+   * @return is warm start
+   */
+  bool IsWarmStart();
+
   /**
    * @brief Build graph
    * @return build result
@@ -116,6 +169,12 @@ class Job {
    */
   JobStatus GetJobStatus();
 
+  /**
+   * @brief Set job status, e.g. creating before job is started asynchronously
+   * @param status job status
+   */
+  void SetJobStatus(JobStatus status);
+
   /**
    * @brief Get job status in string
    * @return job status in string
@@ -129,6 +188,13 @@ class Job {
    */
   static std::string JobStatusToString(JobStatus status);
 
+  /**
+   * @brief Convert job reload state to string
+   * @param state reload state
+   * @return reload state in string
+   */
+  static std::string JobReloadStateToString(JobReloadState state);
+
   /**
    * @brief Get job error info
    * @return job error info
@@ -184,20 +250,75 @@ class Job {
   std::shared_ptr<modelbox::Flow> GetFlow();
 
   /**
-   * @brief Create task manager
+   * @brief Create task manager, receive threads and admission limits are
+   * read from task.* keys of graph config, see TaskManager::SetConfig
    * @param limit_task_count task threshold
    * @return task manager
    */
   std::shared_ptr<TaskManager> CreateTaskManger(int limit_task_count);
 
+  /**
+   * @brief Reload graph of running job without dropping sessions. New graph
+   * is built and run first, then new sessions go to it. Returns after the
+   * switch, old graph is drained in background and stopped after its
+   * sessions finish or drain timeout, see GetReloadInfo. Old graph keeps
+   * running when new graph fails.
+   * @param graph_path new graph file
+   * @param drain_timeout_ms max time to wait sessions of old graph
+   * @param warm_flow built flow of new graph, build is skipped, nullable
+   * @return reload result
+   */
+  Status Reload(const std::string& graph_path, uint64_t drain_timeout_ms,
+                std::shared_ptr<modelbox::Flow> warm_flow = nullptr);
+
+  /**
+   * @brief Reload graph of running job without dropping sessions
+   * @param graph_name new graph name
+   * @param graph new graph in string
+   * @param drain_timeout_ms max time to wait sessions of old graph
+   * @return reload result
+   */
+  Status Reload(const std::string& graph_name, const std::string& graph,
+                uint64_t drain_timeout_ms);
+
+  /**
+   * @brief Get result of last reload
+   * @return reload info
+   */
+  JobReloadInfo GetReloadInfo();
+
  private:
+  Status InitFlow(std::shared_ptr<modelbox::Flow> flow,
+                  const std::string& graph_path, const std::string& graph_name,
+                  const std::string& graph);
+  Status ReloadFlow(std::shared_ptr<modelbox::Flow> flow, bool built,
+                    uint64_t drain_timeout_ms);
+  void DrainFlow(std::shared_ptr<modelbox::Flow> old_flow, JobReloadInfo info,
+                 uint64_t drain_timeout_ms);
+  Status JoinDrain(bool stop);
+  void SetReloadInfo(const JobReloadInfo& info);
+
   std::string job_name_;
   std::string graph_path_;
   std::string graph_name_;
   std::string graph_;
-  JobStatus status_{JOB_STATUS_UNKNOWN};
+  std::atomic<JobStatus> status_{JOB_STATUS_UNKNOWN};
+  bool built_{false};
+  std::atomic<bool> warm_start_{false};
+  std::mutex error_lock_;
   ErrorInfo error_info_;
+  std::mutex flow_lock_;
   std::shared_ptr<modelbox::Flow> flow_;
+  // one reload at a time
+  std::mutex reload_lock_;
+  std::mutex reload_info_lock_;
+  JobReloadInfo reload_info_;
+  // old graph of last reload is drained here
+  std::mutex drain_lock_;
+  std::thread drain_thread_;
+  std::atomic<bool> drain_running_{false};
+  std::atomic<bool> drain_stop_{false};
+  std::vector<std::weak_ptr<TaskManager>> task_managers_;
 };
 
 }  // namespace modelbox
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODELBOX_SERVER_STREAM_PROTOCOL_H_
+#define MODELBOX_SERVER_STREAM_PROTOCOL_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "modelbox/base/status.h"
+
+namespace modelbox {
+
+/**
+ * Binary stream protocol, one session per connection.
+ *
+ * frame: StreamFrameHeader | name | meta | data
+ *   name: graph name of OPEN, port name of DATA and RESULT
+ *   meta: json object, buffer meta of DATA and RESULT, status of CLOSE
+ *   data: raw buffer bytes
+ *
+ * client                          server
+ *   OPEN(graph)            ->
+ *                          <-     OPEN or ERROR
+ *   DATA(input port) ...   ->
+ *                          <-     RESULT(output port) ...
+ *   END                    ->
+ *                          <-     RESULT(output port) ...
+ *                          <-     CLOSE
+ *
+ * Header fields are in host byte order, the transport is a local unix
+ * socket or a tcp connection between hosts of the same byte order.
+ */
+constexpr uint32_t STREAM_FRAME_MAGIC = 0x4642534d;
+constexpr uint16_t STREAM_FRAME_MAX_NAME = 1024;
+constexpr uint32_t STREAM_FRAME_MAX_META = 1024 * 1024;
+constexpr uint64_t STREAM_FRAME_MAX_DATA = 1ULL << 32;
+// default limit of received frame data, peer is not authenticated
+constexpr uint64_t STREAM_FRAME_DEFAULT_MAX_DATA = 16ULL * 1024 * 1024;
+
+enum StreamFrameType : uint16_t {
+  STREAM_FRAME_OPEN = 1,
+  STREAM_FRAME_DATA = 2,
+  STREAM_FRAME_END = 3,
+  STREAM_FRAME_RESULT = 4,
+  STREAM_FRAME_CLOSE = 5,
+  STREAM_FRAME_ERROR = 6,
+};
+
+#pragma pack(push, 1)
+struct StreamFrameHeader {
+  uint32_t magic;
+  uint16_t type;
+  uint16_t name_len;
+  uint32_t meta_len;
+  uint32_t reserved;
+  uint64_t data_len;
+};
+#pragma pack(pop)
+
+struct StreamFrame {
+  uint16_t type{0};
+  std::string name;
+  std::string meta;
+  // data is allocated once and can be adopted by buffer without copy
+  std::shared_ptr<uint8_t> data;
+  size_t data_len{0};
+};
+
+/**
+ * @brief Listen on stream address
+ * @param address unix socket path, or tcp://ip:port
+ * @param fd listen socket fd
+ * @param allow_remote allow tcp address other than loopback, stream has no
+ * authentication or encryption
+ * @return listen result
+ */
+Status StreamListen(const std::string &address, int *fd,
+                    bool allow_remote = false);
+
+/**
+ * @brief Connect to stream address
+ * @param address unix socket path, or tcp://ip:port
+ * @param fd connected socket fd
+ * @return connect result
+ */
+Status StreamConnect(const std::string &address, int *fd);
+
+/**
+ * @brief Framed connection, write is thread safe, read from one thread
+ */
+class StreamConnection {
+ public:
+  explicit StreamConnection(int fd);
+
+  virtual ~StreamConnection();
+
+  /**
+   * @brief Write one frame, data is sent from caller memory directly
+   */
+  Status WriteFrame(uint16_t type, const std::string &name,
+                    const std::string &meta = "", const void *data = nullptr,
+                    size_t data_len = 0);
+
+  /**
+   * @brief Read one frame
+   * @return STATUS_EOF when peer closed, STATUS_INVALID when frame data is
+   * larger than max data length
+   */
+  Status ReadFrame(StreamFrame *frame);
+
+  /**
+   * @brief Set max data length of received frame, checked before allocation
+   */
+  void SetMaxDataLen(uint64_t max_data_len);
+
+  /**
+   * @brief Wake up blocked read and write, fd is closed on destroy
+   */
+  void Shutdown();
+
+  /**
+   * @brief Close write side only, peer reads EOF and may still write
+   */
+  void ShutdownWrite();
+
+ private:
+  Status ReadFull(void *buf, size_t len);
+
+  int fd_;
+  uint64_t max_data_len_{STREAM_FRAME_DEFAULT_MAX_DATA};
+  std::mutex write_lock_;
+};
+
+/**
+ * @brief Client of one stream session
+ */
+class StreamClient {
+ public:
+  StreamClient();
+
+  virtual ~StreamClient();
+
+  /**
+   * @brief Connect and open session of graph
+   * @param address unix socket path, or tcp://ip:port
+   * @param graph graph name, empty for default graph of server
+   * @return open result
+   */
+  Status Open(const std::string &address, const std::string &graph = "");
+
+  /**
+   * @brief Send one buffer to input port
+   * @param meta json object of buffer meta
+   */
+  Status Send(const std::string &port, const void *data, size_t data_len,
+              const std::string &meta = "");
+
+  /**
+   * @brief Notify no more input, results are still received
+   * @param shutdown_write close write side of connection after end
+   */
+  Status End(bool shutdown_write = false);
+
+  /**
+   * @brief Receive one result
+   * @param frame result frame, name is output port
+   * @return STATUS_EOF when session finished, or error of session
+   */
+  Status Recv(StreamFrame *frame);
+
+  void Close();
+
+ private:
+  std::shared_ptr<StreamConnection> connection_;
+};
+
+}  // namespace modelbox
+
+#endif  // MODELBOX_SERVER_STREAM_PROTOCOL_H_
@@ -19,6 +19,7 @@
 #define MODELBOX_SERVER_TASK_H_
 #include <modelbox/base/status.h>
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -30,6 +31,22 @@
 namespace modelbox {
 
 enum TaskStatus { UNKNOWN, WAITING, WORKING, STOPPED, ABNORMAL, FINISHED };
+/**
+ * @brief Waiting tasks of higher priority start first, lower priority tasks
+ * are rejected first under overload
+ */
+enum TaskPriority {
+  TASK_PRIORITY_HIGH,
+  TASK_PRIORITY_NORMAL,
+  TASK_PRIORITY_LOW,
+  TASK_PRIORITY_NUM
+};
+
+/**
+ * @brief Session config key of task priority, value is high, normal or low
+ */
+constexpr const char* TASK_CONFIG_PRIORITY = "task.priority";
+
 class TaskManager;
 class OneShotTask;
 
@@ -107,6 +124,19 @@ class Task : public std::enable_shared_from_this<Task> {
    */
   std::string GetUUID();
 
+  /**
+   * @brief Set task priority before start, overrides task.priority in session
+   * config
+   * @param priority task priority
+   */
+  void SetPriority(TaskPriority priority);
+
+  /**
+   * @brief Get task priority
+   * @return task priority
+   */
+  TaskPriority GetPriority();
+
  protected:
   /**
    * @brief Feed data to task
@@ -121,6 +151,12 @@ class Task : public std::enable_shared_from_this<Task> {
    */
   virtual void FetchData(Status fetch_status, OutputBufferList& output_buf) = 0;
 
+  /**
+   * @brief Get number of buffers task feeds to flow
+   * @return buffer number, 0 when unknown
+   */
+  virtual size_t GetBufferNum() { return 0; }
+
   /**
    * @brief Pointer to external data
    */
@@ -133,6 +169,7 @@ class Task : public std::enable_shared_from_this<Task> {
   Status SendData();
   std::shared_ptr<ExternalDataMap> GetExternalData();
   bool IsRready();
+  TaskPriority ParsePriority();
 
   std::atomic<TaskStatus> status_{UNKNOWN};
   std::shared_ptr<Flow> flow_;
@@ -141,6 +178,15 @@ class Task : public std::enable_shared_from_this<Task> {
   std::string task_uuid_;
   std::mutex lock_;
   std::condition_variable cv_;
+  // serialize receive of one task among receive threads
+  std::mutex fetch_lock_;
+  TaskPriority priority_{TASK_PRIORITY_NORMAL};
+  bool priority_set_{false};
+  // members below are guarded by new_del_lock_ of task manager
+  bool hold_slot_{false};
+  size_t buffer_num_{0};
+  int64_t submit_time_us_{0};
+  int64_t start_time_us_{0};
 };
 
 class OneShotTask : public Task {
@@ -187,6 +233,8 @@ class OneShotTask : public Task {
    */
   virtual void FetchData(Status fetch_status, OutputBufferList& output_buf);
 
+  virtual size_t GetBufferNum();
+
  private:
   TaskDataCallback GetDataCallback();
   TaskStatusCallback GetStatusCallback();
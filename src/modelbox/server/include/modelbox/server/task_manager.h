@@ -19,8 +19,11 @@
 #define MODELBOX_SERVER_TASK_MANAGER_H_
 
 #include <modelbox/server/task.h>
+#include <modelbox/statistics.h>
 #include <modelbox/virtual_node.h>
 
+#include <deque>
+
 namespace modelbox {
 enum TaskType { TASK_ONESHOT };
 class TaskManager : public std::enable_shared_from_this<TaskManager> {
@@ -82,23 +85,101 @@ class TaskManager : public std::enable_shared_from_this<TaskManager> {
    */
   void SetTaskNumLimit(int task_limits);
 
+  /**
+   * @brief Set number of threads receiving task output, call before Start
+   * @param thread_num receive thread number, at least 1
+   */
+  void SetReceiveThreadNum(uint32_t thread_num);
+
+  /**
+   * @brief Switch flow of new tasks, tasks created before stay on old flow
+   * @param flow new flow
+   */
+  void SetFlow(std::shared_ptr<Flow> flow);
+
+  /**
+   * @brief Move task statistics to graph of current flow, call after tasks
+   * of old flow finish
+   */
+  void RebindStatistics();
+
   /**
    * @brief Register new task
    * @param task task pointer
    */
   void RegisterTask(std::shared_ptr<Task> task);
 
+  /**
+   * @brief Set admission limits of a priority class, task over limits is
+   * rejected by Start with STATUS_BUSY
+   * @param priority priority class
+   * @param max_waiting_tasks waiting tasks of this class, 0 is unlimited
+   * @param max_queue_time_ms limit of estimated queue time, which is measured
+   * task latency multiplied by rounds of waiting tasks ahead, 0 is unlimited
+   */
+  void SetAdmissionLimit(TaskPriority priority, uint32_t max_waiting_tasks,
+                         uint32_t max_queue_time_ms);
+
+  /**
+   * @brief Limit buffers fed by running tasks, waiting task starts when its
+   * buffers fit in the limit
+   * @param buffer_limit buffer number, 0 is unlimited
+   */
+  void SetInflightBufferLimit(uint64_t buffer_limit);
+
+  /**
+   * @brief Apply task settings from configuration, call before Start. Keys
+   * are task.receive-thread-num, threads receiving task output, default 1,
+   * and admission limits task.inflight-buffer-limit,
+   * task.<high|normal|low>.max-waiting-tasks and
+   * task.<high|normal|low>.max-queue-time-ms, absent limits are unlimited
+   * @param config flow configuration
+   */
+  void SetConfig(const std::shared_ptr<Configuration> &config);
+
+  /**
+   * @brief Replace clock of task latency and queue time, call before Start
+   * @param clock returns steady time in us, nullptr for steady clock
+   */
+  void SetClock(const std::function<int64_t()> &clock);
+
+  /**
+   * @brief Get moving average of task latency, from task running to end,
+   * which is the run time of whole tasks rather than sampled graph latency
+   * @return latency in microseconds, 0 when no task finished
+   */
+  uint64_t GetTaskLatency();
+
  private:
+  struct PriorityClass {
+    std::deque<std::weak_ptr<Task>> waiting_tasks;
+    uint32_t max_waiting_tasks{0};
+    uint32_t max_queue_time_ms{0};
+    std::shared_ptr<StatisticsGauge> waiting_gauge;
+    std::shared_ptr<StatisticsHistogram> queue_time;
+    std::shared_ptr<StatisticsCounter> rejected;
+  };
+
   friend class Task;
   void ReceiveWork();
+  bool ReceiveTaskData(const std::shared_ptr<ExternalDataMap> &external);
   Status Submit(std::shared_ptr<Task> task);
+  Status Admit(const std::shared_ptr<Task> &task);
+  bool CanRunTask(const std::shared_ptr<Task> &task);
+  std::shared_ptr<Task> PopWaitingTask();
+  void RunTask(const std::shared_ptr<Task> &task);
+  void ReleaseTask(const std::shared_ptr<Task> &task);
   void StartWaittingTask();
+  void InitStatisticsLocked();
+  void ClearStatisticsLocked();
+  int64_t Now() const;
   std::shared_ptr<Flow> GetFlow();
   std::shared_ptr<ExternalDataSelect> GetSelector();
 
   std::shared_ptr<ThreadPool> thread_pool_;
   std::mutex new_del_lock_;
   std::mutex map_lock_;
+  std::mutex flow_lock_;
   std::shared_ptr<Flow> flow_;
   std::atomic<uint32_t> task_num_limits_;
   std::atomic<uint32_t> avaiable_task_counts_;
@@ -106,8 +187,19 @@ class TaskManager : public std::enable_shared_from_this<TaskManager> {
   std::unordered_map<std::string, std::shared_ptr<Task>> task_maps_;
   std::map<std::shared_ptr<ExternalDataMap>, std::shared_ptr<Task>>
       external_task_maps_;
-  std::shared_ptr<std::thread> receive_thread_;
+  uint32_t receive_thread_num_{1};
+  std::vector<std::shared_ptr<std::thread>> receive_threads_;
   std::atomic<bool> thread_run_;
+  // guarded by new_del_lock_
+  PriorityClass priority_classes_[TASK_PRIORITY_NUM];
+  uint64_t inflight_buffer_limit_{0};
+  uint64_t inflight_buffers_{0};
+  std::atomic<uint64_t> task_latency_us_{0};
+  std::function<int64_t()> clock_;
+  // statistics, guarded by new_del_lock_ too
+  std::shared_ptr<StatisticsItem> graph_stats_;
+  std::shared_ptr<StatisticsGauge> running_gauge_;
+  std::shared_ptr<StatisticsGauge> inflight_gauge_;
 };
 }  // namespace modelbox
 #endif
\ No newline at end of file
@@ -19,7 +19,11 @@
 #include <modelbox/server/job.h>
 #include <modelbox/server/timer.h>
 
+#include <chrono>
+#include <thread>
+
 constexpr uint64_t HEART_BEAT_PERIOD_MS = 60 * 1000;
+constexpr uint64_t JOB_RELOAD_DRAIN_CHECK_MS = 10;
 
 namespace modelbox {
 
@@ -31,6 +35,7 @@ Job::Job(const std::string& job_name, const std::string& graph_name,
     : job_name_(job_name), graph_name_(graph_name), graph_(graph) {}
 
 Job::~Job() {
+  JoinDrain(true);
   if (flow_ != nullptr) {
     flow_->Stop();
     flow_ = nullptr;
@@ -45,19 +50,39 @@ std::string Job::JobStatusToString(JobStatus status) {
   return job_str_status[status];
 }
 
+std::string Job::JobReloadStateToString(JobReloadState state) {
+  if ((int)state >= (int)(JOB_RELOAD_FAILED + 1)) {
+    return "";
+  }
+
+  return job_str_reload_state[state];
+}
+
 std::string Job::JobStatusString() { return JobStatusToString(GetJobStatus()); }
 
-Status Job::Init() {
-  flow_ = std::make_shared<modelbox::Flow>();
+Status Job::InitFlow(std::shared_ptr<modelbox::Flow> flow,
+                     const std::string& graph_path,
+                     const std::string& graph_name, const std::string& graph) {
   Status status;
-  status_ = JOB_STATUS_CREATING;
-  if (graph_path_.length() > 0) {
-    status = flow_->Init(graph_path_);
+  if (graph_path.length() > 0) {
+    status = flow->Init(graph_path);
   }
-  if (graph_.length() > 0) {
-    status = flow_->Init(graph_name_, graph_);
+  if (graph.length() > 0) {
+    status = flow->Init(graph_name, graph);
   }
 
+  return status;
+}
+
+Status Job::Init() {
+  auto flow = std::make_shared<modelbox::Flow>();
+  status_ = JOB_STATUS_CREATING;
+  {
+    std::lock_guard<std::mutex> lock(flow_lock_);
+    flow_ = flow;
+  }
+
+  auto status = InitFlow(flow, graph_path_, graph_name_, graph_);
   if (!status) {
     MBLOG_ERROR << "flow init failed: " << status;
     SetError(status);
@@ -66,27 +91,53 @@ Status Job::Init() {
   return status;
 }
 
+Status Job::Init(std::shared_ptr<modelbox::Flow> flow) {
+  if (flow == nullptr) {
+    return Init();
+  }
+
+  status_ = JOB_STATUS_CREATING;
+  {
+    std::lock_guard<std::mutex> lock(flow_lock_);
+    flow_ = flow;
+  }
+
+  built_ = true;
+  warm_start_ = true;
+  return STATUS_OK;
+}
+
+bool Job::IsWarmStart() { return warm_start_; }
+
 Status Job::Build() {
-  if (flow_ == nullptr) {
+  auto flow = GetFlow();
+  if (flow == nullptr) {
     Status status = {STATUS_SHUTDOWN, "Job is shutdown"};
     SetError(status);
     return status;
   }
 
-  auto retval = flow_->Build();
+  if (built_) {
+    return STATUS_OK;
+  }
+
+  auto retval = flow->Build();
   if (!retval) {
     SetError(retval);
+    return retval;
   }
 
+  built_ = true;
   return retval;
 }
 
 void Job::Run() {
-  if (flow_ == nullptr) {
+  auto flow = GetFlow();
+  if (flow == nullptr) {
     return;
   }
 
-  flow_->RunAsync();
+  flow->RunAsync();
   status_ = JOB_STATUS_RUNNING;
 
   auto heart_beat_task = std::make_shared<modelbox::TimerTask>([this]() {
@@ -102,32 +153,37 @@ void Job::Run() {
 }
 
 void Job::Stop() {
-  if (flow_ == nullptr) {
+  JoinDrain(true);
+  auto flow = GetFlow();
+  if (flow == nullptr) {
     return;
   }
 
-  flow_->Stop();
+  flow->Stop();
 }
 
 void Job::Join() {
-  if (flow_ == nullptr) {
+  auto flow = GetFlow();
+  if (flow == nullptr) {
     return;
   }
 
-  flow_->Wait();
+  flow->Wait();
 }
 
 JobStatus Job::GetJobStatus() {
   modelbox::Status retval;
-  if (status_ != JOB_STATUS_RUNNING) {
-    return status_;
+  auto job_status = status_.load();
+  if (job_status != JOB_STATUS_RUNNING) {
+    return job_status;
   }
 
-  if (flow_ == nullptr) {
+  auto flow = GetFlow();
+  if (flow == nullptr) {
     return JOB_STATUS_PENDING;
   }
 
-  auto status = flow_->Wait(-1, &retval);
+  auto status = flow->Wait(-1, &retval);
   switch (status.Code()) {
     case modelbox::STATUS_SUCCESS:
       if (retval == modelbox::STATUS_OK || retval == modelbox::STATUS_STOP ||
@@ -141,7 +197,7 @@ JobStatus Job::GetJobStatus() {
       break;
     default:
       SetError(status);
-      flow_->Stop();
+      flow->Stop();
       return JOB_STATUS_FAILED;
       break;
   }
@@ -149,9 +205,15 @@ JobStatus Job::GetJobStatus() {
   return JOB_STATUS_UNKNOWN;
 }
 
-ErrorInfo Job::GetErrorInfo() { return error_info_; }
+void Job::SetJobStatus(JobStatus status) { status_ = status; }
+
+ErrorInfo Job::GetErrorInfo() {
+  std::lock_guard<std::mutex> lock(error_lock_);
+  return error_info_;
+}
 
 std::string Job::GetErrorMsg() {
+  std::lock_guard<std::mutex> lock(error_lock_);
   std::string msg;
 
   if (error_info_.error_code_.length() > 0) {
@@ -169,20 +231,29 @@ std::string Job::GetErrorMsg() {
   return msg;
 }
 
-void Job::SetErrorInfo(ErrorInfo& errorInfo) { error_info_ = errorInfo; }
+void Job::SetErrorInfo(ErrorInfo& errorInfo) {
+  std::lock_guard<std::mutex> lock(error_lock_);
+  error_info_ = errorInfo;
+}
 
 void Job::ClearErrorInfo() {
+  std::lock_guard<std::mutex> lock(error_lock_);
   error_info_.error_code_ = "";
   error_info_.error_msg_ = "";
 }
 
 void Job::SetErrorInfo(const std::string& code, const std::string& msg) {
+  std::lock_guard<std::mutex> lock(error_lock_);
   error_info_.error_code_ = code;
   error_info_.error_msg_ = msg;
 }
 
 void Job::SetError(const modelbox::Status& status) {
-  error_info_.error_msg_ = status.WrapErrormsgs();
+  {
+    std::lock_guard<std::mutex> lock(error_lock_);
+    error_info_.error_msg_ = status.WrapErrormsgs();
+  }
+
   status_ = JOB_STATUS_FAILED;
 }
 
@@ -190,11 +261,216 @@ void Job::SetJobName(const std::string& job_name) { job_name_ = job_name; }
 
 std::string Job::GetJobName() { return job_name_; }
 
-std::shared_ptr<modelbox::Flow> Job::GetFlow() { return flow_; }
+std::shared_ptr<modelbox::Flow> Job::GetFlow() {
+  std::lock_guard<std::mutex> lock(flow_lock_);
+  return flow_;
+}
 
 std::shared_ptr<TaskManager> Job::CreateTaskManger(int limit_task_count) {
+  std::lock_guard<std::mutex> lock(flow_lock_);
   auto task_manager = std::make_shared<TaskManager>(flow_, limit_task_count);
+  if (flow_ != nullptr) {
+    task_manager->SetConfig(flow_->GetConfig());
+  }
+
+  task_managers_.push_back(task_manager);
   return task_manager;
 }
 
+Status Job::Reload(const std::string& graph_path, uint64_t drain_timeout_ms,
+                   std::shared_ptr<modelbox::Flow> warm_flow) {
+  std::lock_guard<std::mutex> reload_lock(reload_lock_);
+  auto status = JoinDrain(false);
+  if (!status) {
+    return status;
+  }
+
+  auto flow = warm_flow;
+  if (flow == nullptr) {
+    flow = std::make_shared<modelbox::Flow>();
+    status = InitFlow(flow, graph_path, "", "");
+    if (!status) {
+      JobReloadInfo info;
+      info.state_ = JOB_RELOAD_FAILED;
+      info.error_msg_ = status.WrapErrormsgs();
+      SetReloadInfo(info);
+      return {status, "init new graph failed"};
+    }
+  }
+
+  status = ReloadFlow(flow, warm_flow != nullptr, drain_timeout_ms);
+  if (!status) {
+    return status;
+  }
+
+  graph_path_ = graph_path;
+  graph_name_.clear();
+  graph_.clear();
+  return STATUS_OK;
+}
+
+Status Job::Reload(const std::string& graph_name, const std::string& graph,
+                   uint64_t drain_timeout_ms) {
+  std::lock_guard<std::mutex> reload_lock(reload_lock_);
+  auto status = JoinDrain(false);
+  if (!status) {
+    return status;
+  }
+
+  auto flow = std::make_shared<modelbox::Flow>();
+  status = InitFlow(flow, "", graph_name, graph);
+  if (!status) {
+    JobReloadInfo info;
+    info.state_ = JOB_RELOAD_FAILED;
+    info.error_msg_ = status.WrapErrormsgs();
+    SetReloadInfo(info);
+    return {status, "init new graph failed"};
+  }
+
+  status = ReloadFlow(flow, false, drain_timeout_ms);
+  if (!status) {
+    return status;
+  }
+
+  graph_path_.clear();
+  graph_name_ = graph_name;
+  graph_ = graph;
+  return STATUS_OK;
+}
+
+Status Job::ReloadFlow(std::shared_ptr<modelbox::Flow> flow, bool built,
+                       uint64_t drain_timeout_ms) {
+  JobReloadInfo info;
+  auto begin = std::chrono::steady_clock::now();
+  if (GetJobStatus() != JOB_STATUS_RUNNING) {
+    return {STATUS_INVALID, "job " + job_name_ + " is not running"};
+  }
+
+  info.state_ = JOB_RELOAD_BUILDING;
+  SetReloadInfo(info);
+  // old graph serves sessions until new graph runs
+  Status status = STATUS_OK;
+  if (!built) {
+    status = flow->Build();
+  }
+
+  if (status) {
+    status = flow->RunAsync();
+  }
+
+  if (!status) {
+    flow->Stop();
+    info.state_ = JOB_RELOAD_FAILED;
+    info.error_msg_ = status.WrapErrormsgs();
+    SetReloadInfo(info);
+    MBLOG_ERROR << "reload job " << job_name_ << " failed, " << status;
+    return {status, "run new graph failed"};
+  }
+
+  auto switch_begin = std::chrono::steady_clock::now();
+  info.build_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       switch_begin - begin)
+                       .count();
+  std::shared_ptr<modelbox::Flow> old_flow;
+  {
+    std::lock_guard<std::mutex> lock(flow_lock_);
+    old_flow = flow_;
+    flow_ = flow;
+    for (auto iter = task_managers_.begin(); iter != task_managers_.end();) {
+      auto task_manager = iter->lock();
+      if (task_manager == nullptr) {
+        iter = task_managers_.erase(iter);
+        continue;
+      }
+
+      task_manager->SetFlow(flow);
+      iter++;
+    }
+  }
+
+  auto switch_end = std::chrono::steady_clock::now();
+  info.switch_us_ = std::chrono::duration_cast<std::chrono::microseconds>(
+                        switch_end - switch_begin)
+                        .count();
+  info.state_ = JOB_RELOAD_DRAINING;
+  SetReloadInfo(info);
+  MBLOG_INFO << "reload job " << job_name_ << " switched, build "
+             << info.build_ms_ << "ms, switch " << info.switch_us_
+             << "us, draining old graph";
+
+  // sessions created before switch finish on old graph, caller is not held
+  std::lock_guard<std::mutex> lock(drain_lock_);
+  drain_stop_ = false;
+  drain_running_ = true;
+  drain_thread_ = std::thread(&Job::DrainFlow, this, old_flow, info,
+                              drain_timeout_ms);
+  return STATUS_OK;
+}
+
+void Job::DrainFlow(std::shared_ptr<modelbox::Flow> old_flow,
+                    JobReloadInfo info, uint64_t drain_timeout_ms) {
+  auto drain_begin = std::chrono::steady_clock::now();
+  auto deadline = drain_begin + std::chrono::milliseconds(drain_timeout_ms);
+  while (old_flow != nullptr && !drain_stop_ &&
+         old_flow->GetSessionCount() > 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    if (old_flow->Wait(-1) != STATUS_BUSY) {
+      break;
+    }
+
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(JOB_RELOAD_DRAIN_CHECK_MS));
+  }
+
+  if (old_flow != nullptr) {
+    info.dropped_sessions_ = old_flow->GetSessionCount();
+    old_flow->Stop();
+  }
+
+  // statistics of tasks move to new graph after old tasks are gone
+  {
+    std::lock_guard<std::mutex> lock(flow_lock_);
+    for (auto &weak_task_manager : task_managers_) {
+      auto task_manager = weak_task_manager.lock();
+      if (task_manager != nullptr) {
+        task_manager->RebindStatistics();
+      }
+    }
+  }
+
+  info.drain_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - drain_begin)
+                       .count();
+  info.state_ = JOB_RELOAD_SUCCEEDED;
+  SetReloadInfo(info);
+  drain_running_ = false;
+  MBLOG_INFO << "reload job " << job_name_ << " drained, drain "
+             << info.drain_ms_ << "ms, dropped sessions "
+             << info.dropped_sessions_;
+}
+
+Status Job::JoinDrain(bool stop) {
+  std::lock_guard<std::mutex> lock(drain_lock_);
+  if (drain_running_ && !stop) {
+    return {STATUS_BUSY, "job " + job_name_ + " is draining last reload"};
+  }
+
+  drain_stop_ = stop;
+  if (drain_thread_.joinable()) {
+    drain_thread_.join();
+  }
+
+  return STATUS_OK;
+}
+
+JobReloadInfo Job::GetReloadInfo() {
+  std::lock_guard<std::mutex> lock(reload_info_lock_);
+  return reload_info_;
+}
+
+void Job::SetReloadInfo(const JobReloadInfo& info) {
+  std::lock_guard<std::mutex> lock(reload_info_lock_);
+  reload_info_ = info;
+}
+
 }  // namespace modelbox
@@ -0,0 +1,599 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics_plugin.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "modelbox/base/log.h"
+
+using namespace modelbox;
+
+const std::string DEFAULT_METRICS_PATH = "/metrics";
+constexpr const char *METRICS_CONTENT_TYPE =
+    "text/plain; version=0.0.4; charset=utf-8";
+constexpr const char *METRICS_PREFIX = "modelbox_";
+constexpr const char *METRICS_TYPE_COUNTER = "counter";
+constexpr const char *METRICS_TYPE_GAUGE = "gauge";
+constexpr const char *METRICS_TYPE_SUMMARY = "summary";
+
+const std::vector<std::pair<double, const char *>> SUMMARY_QUANTILES = {
+    {50, "0.5"}, {90, "0.9"}, {99, "0.99"}, {99.9, "0.999"}};
+
+static void AppendMetricName(std::string &out, const std::string &name) {
+  for (auto c : name) {
+    if (isalnum(c) || c == '_' || c == ':') {
+      out += c;
+    } else {
+      out += '_';
+    }
+  }
+}
+
+static void AppendLabelValue(std::string &out, const std::string &value) {
+  for (auto c : value) {
+    switch (c) {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '"':
+        out += "\\\"";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        out += c;
+        break;
+    }
+  }
+}
+
+static bool FormatValue(StatisticsValue &value, char *buf, size_t len) {
+  int32_t i32 = 0;
+  uint32_t u32 = 0;
+  int64_t i64 = 0;
+  uint64_t u64 = 0;
+  float f = 0;
+  double d = 0;
+  bool b = false;
+  if (value.GetInt32(i32)) {
+    snprintf(buf, len, "%" PRId32, i32);
+  } else if (value.GetUint32(u32)) {
+    snprintf(buf, len, "%" PRIu32, u32);
+  } else if (value.GetInt64(i64)) {
+    snprintf(buf, len, "%" PRId64, i64);
+  } else if (value.GetUint64(u64)) {
+    snprintf(buf, len, "%" PRIu64, u64);
+  } else if (value.GetFloat(f)) {
+    snprintf(buf, len, "%.6g", f);
+  } else if (value.GetDouble(d)) {
+    snprintf(buf, len, "%.6g", d);
+  } else if (value.GetBool(b)) {
+    snprintf(buf, len, "%d", b ? 1 : 0);
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+bool ModelboxMetricsPlugin::Init(
+    std::shared_ptr<modelbox::Configuration> config) {
+  MBLOG_INFO << "modelbox metrics plugin init";
+
+  bool ret = ParseConfig(config);
+  if (!ret) {
+    MBLOG_ERROR << "parse config file failed";
+    return false;
+  }
+
+  if (enable_ == false) {
+    MBLOG_INFO << "metrics is disabled.";
+    return true;
+  }
+
+  auto endpoint = "http://" + server_ip_ + ":" + server_port_;
+  listener_ = std::make_shared<modelbox::HttpListener>(endpoint);
+  MBLOG_INFO << "run metrics on " << endpoint << path_;
+  RegistHandlers();
+
+  return true;
+}
+
+std::shared_ptr<Plugin> CreatePlugin() {
+  MBLOG_INFO << "create modelbox metrics plugin";
+  return std::make_shared<ModelboxMetricsPlugin>();
+}
+
+void ModelboxMetricsPlugin::RegistHandlers() {
+  listener_->Register(path_, HttpMethods::GET,
+                      std::bind(&ModelboxMetricsPlugin::HandlerMetricsGet,
+                                this, std::placeholders::_1,
+                                std::placeholders::_2));
+}
+
+bool ModelboxMetricsPlugin::Start() {
+  if (enable_ == false) {
+    return true;
+  }
+
+  listener_->SetAclWhiteList(acl_white_list_);
+  listener_->Start();
+
+  auto ret = listener_->GetStatus();
+  if (!ret) {
+    MBLOG_ERROR << "Start metrics failed, err " << ret;
+    return false;
+  }
+
+  return true;
+}
+
+bool ModelboxMetricsPlugin::Stop() {
+  if (enable_ == false) {
+    return true;
+  }
+
+  listener_->Stop();
+
+  return true;
+}
+
+bool ModelboxMetricsPlugin::ParseConfig(
+    std::shared_ptr<modelbox::Configuration> config) {
+  enable_ = config->GetBool("metrics.enable", false);
+  server_ip_ = config->GetString("metrics.ip",
+                                 config->GetString("server.ip", "127.0.0.1"));
+  server_port_ = config->GetString(
+      "metrics.port", config->GetString("server.port", "1104"));
+  path_ = config->GetString("metrics.path", DEFAULT_METRICS_PATH);
+  acl_white_list_ = config->GetStrings("acl.allow");
+  return true;
+}
+
+void ModelboxMetricsPlugin::HandlerMetricsGet(const httplib::Request &request,
+                                              httplib::Response &response) {
+  std::lock_guard<std::mutex> lock(collect_lock_);
+  Collect();
+  AddSafeHeader(response);
+  response.status = HttpStatusCodes::OK;
+  response.set_content(output_, METRICS_CONTENT_TYPE);
+}
+
+void ModelboxMetricsPlugin::Collect() {
+  for (auto &family : families_) {
+    family.second.samples.clear();
+  }
+
+  session_id_.clear();
+  live_graphs_.clear();
+
+  auto root = Statistics::GetGlobalItem();
+  root->ForEach(
+      [this](const std::shared_ptr<StatisticsItem> &item,
+             const std::string &relative_path) {
+        CollectItem(item);
+        return STATUS_OK;
+      },
+      true);
+  CollectAggregates();
+  CollectProcess();
+
+  output_.clear();
+  for (auto &family : families_) {
+    if (family.second.samples.empty()) {
+      continue;
+    }
+
+    output_ += "# TYPE ";
+    output_ += family.first;
+    output_ += ' ';
+    output_ += family.second.type;
+    output_ += '\n';
+    output_ += family.second.samples;
+  }
+}
+
+void ModelboxMetricsPlugin::ParsePath(const std::string &path) {
+  segment_num_ = 0;
+  size_t begin = 0;
+  while (begin <= path.size()) {
+    auto end = path.find('.', begin);
+    if (end == std::string::npos) {
+      end = path.size();
+    }
+
+    if (segment_num_ >= segments_.size()) {
+      segments_.emplace_back();
+    }
+
+    segments_[segment_num_].assign(path, begin, end - begin);
+    ++segment_num_;
+    begin = end + 1;
+  }
+}
+
+bool ModelboxMetricsPlugin::IsSessionPath() {
+  // items are visited parent first, session_id_ is the last session item
+  // visited, so the leaves under it follow directly
+  return segment_num_ >= 4 && !session_id_.empty() &&
+         segments_[0] == STATISTICS_ITEM_FLOW &&
+         segments_[1] == session_graph_ && segments_[2] == session_id_;
+}
+
+void ModelboxMetricsPlugin::AppendLabel(const char *name, size_t begin,
+                                        size_t end) {
+  if (begin >= end) {
+    return;
+  }
+
+  if (!labels_.empty()) {
+    labels_ += ',';
+  }
+
+  labels_ += name;
+  labels_ += "=\"";
+  for (auto i = begin; i < end; ++i) {
+    if (i != begin) {
+      labels_ += '.';
+    }
+
+    AppendLabelValue(labels_, segments_[i]);
+  }
+
+  labels_ += '"';
+}
+
+void ModelboxMetricsPlugin::BuildSeries() {
+  auto last = segment_num_ - 1;
+  family_name_ = METRICS_PREFIX;
+  AppendMetricName(family_name_, segments_[0]);
+  family_name_ += '_';
+  labels_.clear();
+  aggregate_ = false;
+  if (segments_[0] == STATISTICS_ITEM_FLOW && last >= 2) {
+    AppendLabel("graph", 1, 2);
+    // session is not a label, values are summed over sessions to keep the
+    // series count bounded
+    aggregate_ = IsSessionPath();
+    if (aggregate_) {
+      AppendLabel("node", 3, last);
+    } else {
+      // graph level items, such as task.<priority>, are part of the name
+      for (size_t i = 2; i < last; ++i) {
+        AppendMetricName(family_name_, segments_[i]);
+        family_name_ += '_';
+      }
+    }
+  } else if (segments_[0] == STATISTICS_ITEM_NODE) {
+    AppendLabel("graph", 1, std::min<size_t>(2, last));
+    AppendLabel("node", 2, last);
+  } else {
+    AppendLabel("path", 1, last);
+  }
+
+  AppendMetricName(family_name_, segments_[last]);
+}
+
+ModelboxMetricsPlugin::MetricFamily &ModelboxMetricsPlugin::GetFamily(
+    const std::string &name, const char *type) {
+  auto iter = families_.find(name);
+  if (iter != families_.end()) {
+    return iter->second;
+  }
+
+  auto &family = families_[name];
+  family.type = type;
+  return family;
+}
+
+void ModelboxMetricsPlugin::AppendSample(MetricFamily &family,
+                                         const char *suffix,
+                                         const char *extra_label,
+                                         const char *extra_value,
+                                         const char *value) {
+  auto &samples = family.samples;
+  samples += family_name_;
+  samples += suffix;
+  if (!labels_.empty() || extra_label != nullptr) {
+    samples += '{';
+    samples += labels_;
+    if (extra_label != nullptr) {
+      if (!labels_.empty()) {
+        samples += ',';
+      }
+
+      samples += extra_label;
+      samples += "=\"";
+      samples += extra_value;
+      samples += '"';
+    }
+
+    samples += '}';
+  }
+
+  samples += ' ';
+  samples += value;
+  samples += '\n';
+}
+
+void ModelboxMetricsPlugin::CollectItem(
+    const std::shared_ptr<StatisticsItem> &item) {
+  ParsePath(item->GetPath());
+  if (item->IsLeaf()) {
+    CollectValue(item);
+    return;
+  }
+
+  if (segments_[0] != STATISTICS_ITEM_FLOW) {
+    return;
+  }
+
+  if (segment_num_ == 3) {
+    if (item->IsSession()) {
+      session_graph_ = segments_[1];
+      session_id_ = segments_[2];
+    } else {
+      session_id_.clear();
+    }
+
+    return;
+  }
+
+  if (segment_num_ != 2) {
+    return;
+  }
+
+  // flow.<graph> holds one item per session, and graph level items
+  live_graphs_.insert(segments_[1]);
+  size_t session_num = 0;
+  item->ForEach(
+      [&session_num](const std::shared_ptr<StatisticsItem> &child,
+                     const std::string &relative_path) {
+        if (child->IsSession()) {
+          ++session_num;
+        }
+
+        return STATUS_OK;
+      },
+      false);
+
+  char value[32];
+  snprintf(value, sizeof(value), "%zu", session_num);
+  family_name_ = METRICS_PREFIX;
+  family_name_ += "flow_sessions";
+  labels_ = "graph=\"";
+  AppendLabelValue(labels_, segments_[1]);
+  labels_ += '"';
+  AppendSample(GetFamily(family_name_, METRICS_TYPE_GAUGE), "", nullptr,
+               nullptr, value);
+}
+
+void ModelboxMetricsPlugin::CollectValue(
+    const std::shared_ptr<StatisticsItem> &item) {
+  if (segment_num_ < 2) {
+    return;
+  }
+
+  BuildSeries();
+
+  char value[32];
+  auto counter = item->GetCounter();
+  if (counter != nullptr) {
+    const std::string total_suffix = "_total";
+    if (family_name_.size() < total_suffix.size() ||
+        family_name_.compare(family_name_.size() - total_suffix.size(),
+                             total_suffix.size(), total_suffix) != 0) {
+      family_name_ += total_suffix;
+    }
+
+    if (aggregate_) {
+      AddAggregate(METRICS_TYPE_COUNTER, "", counter->Get());
+      return;
+    }
+
+    snprintf(value, sizeof(value), "%" PRIu64, counter->Get());
+    AppendSample(GetFamily(family_name_, METRICS_TYPE_COUNTER), "", nullptr,
+                 nullptr, value);
+    return;
+  }
+
+  auto histogram = item->GetHistogram();
+  if (histogram != nullptr) {
+    auto snapshot = histogram->GetSnapshot();
+    if (aggregate_) {
+      // quantiles can not be summed, per node quantiles are in node.*
+      AddAggregate(METRICS_TYPE_SUMMARY, "_sum", snapshot.GetSum());
+      AddAggregate(METRICS_TYPE_SUMMARY, "_count", snapshot.GetCount());
+      return;
+    }
+
+    auto &family = GetFamily(family_name_, METRICS_TYPE_SUMMARY);
+    for (const auto &quantile : SUMMARY_QUANTILES) {
+      snprintf(value, sizeof(value), "%" PRIu64,
+               snapshot.GetPercentile(quantile.first));
+      AppendSample(family, "", "quantile", quantile.second, value);
+    }
+
+    snprintf(value, sizeof(value), "%" PRIu64, snapshot.GetSum());
+    AppendSample(family, "_sum", nullptr, nullptr, value);
+    snprintf(value, sizeof(value), "%" PRIu64, snapshot.GetCount());
+    AppendSample(family, "_count", nullptr, nullptr, value);
+    return;
+  }
+
+  auto stats_value = item->GetValue();
+  if (stats_value == nullptr ||
+      !FormatValue(*stats_value, value, sizeof(value))) {
+    // string value is not a metric
+    return;
+  }
+
+  if (aggregate_) {
+    AddAggregate(METRICS_TYPE_GAUGE, "", strtod(value, nullptr));
+    return;
+  }
+
+  AppendSample(GetFamily(family_name_, METRICS_TYPE_GAUGE), "", nullptr,
+               nullptr, value);
+}
+
+void ModelboxMetricsPlugin::AddAggregate(const char *type, const char *suffix,
+                                         double value) {
+  aggregate_key_ = family_name_;
+  aggregate_key_ += suffix;
+  aggregate_key_ += '{';
+  aggregate_key_ += labels_;
+  auto &aggregate = aggregates_[aggregate_key_];
+  if (aggregate.type == nullptr) {
+    aggregate.family = family_name_;
+    aggregate.type = type;
+    aggregate.suffix = suffix;
+    aggregate.labels = labels_;
+    aggregate.graph = segments_[1];
+    aggregate.monotonic = (strcmp(type, METRICS_TYPE_GAUGE) != 0);
+  }
+
+  if (!aggregate.monotonic) {
+    if (!aggregate.touched) {
+      aggregate.value = 0;
+    }
+
+    aggregate.value += value;
+    aggregate.touched = true;
+    return;
+  }
+
+  auto iter = aggregate.sessions.find(segments_[2]);
+  if (iter == aggregate.sessions.end()) {
+    iter = aggregate.sessions.emplace(segments_[2], SessionValue()).first;
+  }
+
+  iter->second.value = value;
+  iter->second.touched = true;
+  aggregate.touched = true;
+}
+
+void ModelboxMetricsPlugin::CollectAggregates() {
+  char value[32];
+  for (auto iter = aggregates_.begin(); iter != aggregates_.end();) {
+    auto &aggregate = iter->second;
+    double sum = 0;
+    if (aggregate.monotonic) {
+      if (live_graphs_.find(aggregate.graph) == live_graphs_.end()) {
+        iter = aggregates_.erase(iter);
+        continue;
+      }
+
+      // finished sessions stay in the total, so the counter never goes down
+      for (auto session = aggregate.sessions.begin();
+           session != aggregate.sessions.end();) {
+        if (!session->second.touched) {
+          aggregate.value += session->second.value;
+          session = aggregate.sessions.erase(session);
+          continue;
+        }
+
+        sum += session->second.value;
+        session->second.touched = false;
+        ++session;
+      }
+
+      sum += aggregate.value;
+    } else {
+      if (!aggregate.touched) {
+        // all sessions of this series are gone
+        iter = aggregates_.erase(iter);
+        continue;
+      }
+
+      sum = aggregate.value;
+    }
+
+    family_name_ = aggregate.family;
+    labels_ = aggregate.labels;
+    snprintf(value, sizeof(value), "%.15g", sum);
+    AppendSample(GetFamily(family_name_, aggregate.type), aggregate.suffix,
+                 nullptr, nullptr, value);
+    aggregate.touched = false;
+    ++iter;
+  }
+}
+
+void ModelboxMetricsPlugin::CollectProcess() {
+  char buf[1024];
+  int fd = open("/proc/self/stat", O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+
+  auto len = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  if (len <= 0) {
+    return;
+  }
+
+  buf[len] = '\0';
+  // comm may contain space, fields start after the last ')'
+  auto *fields = strrchr(buf, ')');
+  if (fields == nullptr) {
+    return;
+  }
+
+  unsigned long utime = 0;
+  unsigned long stime = 0;
+  long threads = 0;
+  unsigned long vsize = 0;
+  long rss = 0;
+  auto ret = sscanf(fields + 1,
+                    " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu %*d "
+                    "%*d %*d %*d %ld %*d %*u %lu %ld",
+                    &utime, &stime, &threads, &vsize, &rss);
+  if (ret != 5) {
+    return;
+  }
+
+  char value[32];
+  labels_.clear();
+  snprintf(value, sizeof(value), "%.2f",
+           (double)(utime + stime) / sysconf(_SC_CLK_TCK));
+  family_name_ = "process_cpu_seconds_total";
+  AppendSample(GetFamily(family_name_, METRICS_TYPE_COUNTER), "", nullptr,
+               nullptr, value);
+
+  snprintf(value, sizeof(value), "%ld", rss * sysconf(_SC_PAGESIZE));
+  family_name_ = "process_resident_memory_bytes";
+  AppendSample(GetFamily(family_name_, METRICS_TYPE_GAUGE), "", nullptr,
+               nullptr, value);
+
+  snprintf(value, sizeof(value), "%lu", vsize);
+  family_name_ = "process_virtual_memory_bytes";
+  AppendSample(GetFamily(family_name_, METRICS_TYPE_GAUGE), "", nullptr,
+               nullptr, value);
+
+  snprintf(value, sizeof(value), "%ld", threads);
+  family_name_ = "process_threads";
+  AppendSample(GetFamily(family_name_, METRICS_TYPE_GAUGE), "", nullptr,
+               nullptr, value);
+}
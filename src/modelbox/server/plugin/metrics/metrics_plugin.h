@@ -0,0 +1,132 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODELBOX_MODELBOX_METRICS_PLUGIN_H_
+#define MODELBOX_MODELBOX_METRICS_PLUGIN_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "modelbox/server/http_helper.h"
+#include "modelbox/server/plugin.h"
+#include "modelbox/statistics.h"
+
+/**
+ * @brief Serve statistics tree in prometheus text format
+ * flow.<graph>.<session>.<node>.<name> -> modelbox_flow_<name>{graph,node},
+ * summed over sessions
+ * flow.<graph>.<session>.<name> -> modelbox_flow_<name>{graph}, summed over
+ * sessions
+ * flow.<graph>.<scope>.<name> -> modelbox_flow_<scope>_<name>{graph}
+ * node.<graph>.<node>.<name> -> modelbox_node_<name>{graph,node}
+ * other paths -> modelbox_<root>_<name>{path}
+ * session segment is the item marked by StatisticsItem::MarkSession
+ */
+class ModelboxMetricsPlugin : public modelbox::Plugin {
+ public:
+  ModelboxMetricsPlugin(){};
+  virtual ~ModelboxMetricsPlugin(){};
+
+  bool Init(std::shared_ptr<modelbox::Configuration> config) override;
+  bool Start() override;
+  bool Stop() override;
+
+  void RegistHandlers();
+  bool ParseConfig(std::shared_ptr<modelbox::Configuration> config);
+
+ private:
+  struct MetricFamily {
+    std::string type;
+    std::string samples;
+  };
+
+  struct SessionValue {
+    double value{0};
+    bool touched{false};
+  };
+
+  struct Aggregate {
+    std::string family;
+    const char *type{nullptr};
+    const char *suffix{nullptr};
+    std::string labels;
+    std::string graph;
+    bool monotonic{false};
+    // gauge: sum of this scrape, monotonic: total of finished sessions
+    double value{0};
+    // monotonic only, last value of each live session
+    std::map<std::string, SessionValue> sessions;
+    bool touched{false};
+  };
+
+  void HandlerMetricsGet(const httplib::Request &request,
+                         httplib::Response &response);
+
+  void Collect();
+
+  void CollectItem(const std::shared_ptr<modelbox::StatisticsItem> &item);
+
+  void CollectValue(const std::shared_ptr<modelbox::StatisticsItem> &item);
+
+  void CollectProcess();
+
+  void AddAggregate(const char *type, const char *suffix, double value);
+
+  void CollectAggregates();
+
+  void ParsePath(const std::string &path);
+
+  MetricFamily &GetFamily(const std::string &name, const char *type);
+
+  bool IsSessionPath();
+
+  void BuildSeries();
+
+  void AppendLabel(const char *name, size_t begin, size_t end);
+
+  void AppendSample(MetricFamily &family, const char *suffix,
+                    const char *extra_label, const char *extra_value,
+                    const char *value);
+
+  std::shared_ptr<modelbox::HttpListener> listener_;
+  std::string server_ip_;
+  std::string server_port_;
+  std::string path_;
+  std::vector<std::string> acl_white_list_;
+  bool enable_{false};
+
+  // buffers are kept between scrapes, so steady state scrape does not
+  // allocate for the text output
+  std::mutex collect_lock_;
+  std::map<std::string, MetricFamily> families_;
+  std::vector<std::string> segments_;
+  size_t segment_num_{0};
+  std::string family_name_;
+  std::string labels_;
+  bool aggregate_{false};
+  std::string session_graph_;
+  std::string session_id_;
+  std::set<std::string> live_graphs_;
+  std::map<std::string, Aggregate> aggregates_;
+  std::string aggregate_key_;
+  std::string output_;
+};
+
+#endif  // MODELBOX_MODELBOX_METRICS_PLUGIN_H_
@@ -0,0 +1,455 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stream_plugin.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include "modelbox/base/log.h"
+#include "modelbox/base/utils.h"
+
+using namespace modelbox;
+
+const std::string DEFAULT_STREAM_LISTEN = "/var/run/modelbox/stream.sock";
+constexpr uint32_t DEFAULT_STREAM_MAX_SESSIONS = 64;
+constexpr uint32_t DEFAULT_STREAM_MAX_FRAME_SIZE_MB = 16;
+constexpr int STREAM_ACCEPT_POLL_MS = 200;
+constexpr int STREAM_RECV_TIMEOUT_MS = 200;
+
+static Status SetBufferMeta(const std::shared_ptr<Buffer> &buffer,
+                            const std::string &meta) {
+  if (meta.empty()) {
+    return STATUS_OK;
+  }
+
+  try {
+    auto meta_json = nlohmann::json::parse(meta);
+    if (!meta_json.is_object()) {
+      return {STATUS_INVALID, "buffer meta is not json object"};
+    }
+
+    for (auto &item : meta_json.items()) {
+      auto &key = item.key();
+      auto &value = item.value();
+      if (key == "type" && value.is_number_integer()) {
+        buffer->Set(key, (ModelBoxDataType)value.get<int32_t>());
+      } else if (key == "shape" && value.is_array()) {
+        buffer->Set(key, value.get<std::vector<size_t>>());
+      } else if (value.is_string()) {
+        buffer->Set(key, value.get<std::string>());
+      } else if (value.is_boolean()) {
+        buffer->Set(key, value.get<bool>());
+      } else if (value.is_number_integer()) {
+        auto num = value.get<int64_t>();
+        if (num >= INT32_MIN && num <= INT32_MAX) {
+          buffer->Set(key, (int32_t)num);
+        } else {
+          buffer->Set(key, num);
+        }
+      } else if (value.is_number_float()) {
+        buffer->Set(key, value.get<double>());
+      } else {
+        return {STATUS_INVALID, "unsupported buffer meta " + key};
+      }
+    }
+  } catch (const std::exception &e) {
+    return {STATUS_INVALID, "parse buffer meta failed, " + std::string(e.what())};
+  }
+
+  return STATUS_OK;
+}
+
+static std::string GetBufferMeta(const std::shared_ptr<Buffer> &buffer) {
+  // tensor description only, other meta types are not known here
+  nlohmann::json meta_json = nlohmann::json::object();
+  std::vector<size_t> shape;
+  if (buffer->Get("shape", shape)) {
+    meta_json["shape"] = shape;
+  }
+
+  ModelBoxDataType type = MODELBOX_TYPE_INVALID;
+  if (buffer->Get("type", type)) {
+    meta_json["type"] = (int32_t)type;
+  }
+
+  return meta_json.dump();
+}
+
+static void WriteClose(const std::shared_ptr<StreamConnection> &connection,
+                       uint16_t type, const std::string &error) {
+  nlohmann::json meta_json = nlohmann::json::object();
+  if (!error.empty()) {
+    meta_json["error"] = error;
+  }
+
+  connection->WriteFrame(type, "", meta_json.dump());
+}
+
+bool ModelboxStreamPlugin::Init(
+    std::shared_ptr<modelbox::Configuration> config) {
+  MBLOG_INFO << "modelbox stream plugin init";
+
+  bool ret = ParseConfig(config);
+  if (!ret) {
+    MBLOG_ERROR << "parse config file failed";
+    return false;
+  }
+
+  if (enable_ == false) {
+    MBLOG_INFO << "stream is disabled.";
+    return true;
+  }
+
+  auto status = LoadGraphs();
+  if (!status) {
+    MBLOG_ERROR << "load stream graphs failed, " << status.WrapErrormsgs();
+    return false;
+  }
+
+  status = StreamListen(listen_, &listen_fd_, allow_remote_);
+  if (!status) {
+    MBLOG_ERROR << "stream listen failed, " << status;
+    return false;
+  }
+
+  MBLOG_INFO << "run stream on " << listen_;
+  return true;
+}
+
+std::shared_ptr<Plugin> CreatePlugin() {
+  MBLOG_INFO << "create modelbox stream plugin";
+  return std::make_shared<ModelboxStreamPlugin>();
+}
+
+bool ModelboxStreamPlugin::ParseConfig(
+    std::shared_ptr<modelbox::Configuration> config) {
+  enable_ = config->GetBool("stream.enable", false);
+  listen_ = config->GetString("stream.listen", DEFAULT_STREAM_LISTEN);
+  graph_files_ = config->GetStrings("stream.graphs");
+  max_sessions_ =
+      config->GetUint32("stream.max_sessions", DEFAULT_STREAM_MAX_SESSIONS);
+  // data of frame is allocated before read, limit it for unknown peers
+  auto max_frame_size_mb = config->GetUint32("stream.max_frame_size_mb",
+                                             DEFAULT_STREAM_MAX_FRAME_SIZE_MB);
+  max_frame_data_len_ = (uint64_t)max_frame_size_mb * 1024 * 1024;
+  if (max_frame_data_len_ == 0 ||
+      max_frame_data_len_ > STREAM_FRAME_MAX_DATA) {
+    MBLOG_ERROR << "invalid stream.max_frame_size_mb " << max_frame_size_mb;
+    return false;
+  }
+
+  allow_remote_ = config->GetBool("stream.allow_remote", false);
+  if (enable_ && graph_files_.empty()) {
+    MBLOG_ERROR << "stream.graphs is not set";
+    return false;
+  }
+
+  return true;
+}
+
+Status ModelboxStreamPlugin::LoadGraphs() {
+  for (const auto &graph_file : graph_files_) {
+    // graph name is file name without extension
+    auto name = GetBaseName(graph_file);
+    auto pos = name.find_last_of('.');
+    if (pos != std::string::npos) {
+      name = name.substr(0, pos);
+    }
+
+    auto flow = std::make_shared<Flow>();
+    auto ret = flow->Init(graph_file);
+    if (!ret) {
+      return {ret, "init graph " + graph_file + " failed"};
+    }
+
+    ret = flow->Build();
+    if (!ret) {
+      return {ret, "build graph " + graph_file + " failed"};
+    }
+
+    if (default_graph_.empty()) {
+      default_graph_ = name;
+    }
+
+    flows_[name] = flow;
+    MBLOG_INFO << "stream graph " << name << " loaded from " << graph_file;
+  }
+
+  return STATUS_OK;
+}
+
+bool ModelboxStreamPlugin::Start() {
+  if (enable_ == false) {
+    return true;
+  }
+
+  for (auto &flow : flows_) {
+    flow.second->RunAsync();
+  }
+
+  run_ = true;
+  accept_thread_ = std::thread(&ModelboxStreamPlugin::AcceptWork, this);
+  return true;
+}
+
+bool ModelboxStreamPlugin::Stop() {
+  if (enable_ == false || run_ == false) {
+    return true;
+  }
+
+  run_ = false;
+  if (accept_thread_.joinable()) {
+    accept_thread_.join();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(sessions_lock_);
+    for (auto &session : sessions_) {
+      session->connection->Shutdown();
+    }
+  }
+
+  ReapSessions(true);
+  for (auto &flow : flows_) {
+    flow.second->Stop();
+  }
+
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+    if (listen_.find("://") == std::string::npos) {
+      unlink(listen_.c_str());
+    }
+  }
+
+  return true;
+}
+
+void ModelboxStreamPlugin::AcceptWork() {
+  struct pollfd fds;
+  fds.fd = listen_fd_;
+  fds.events = POLLIN;
+  while (run_) {
+    ReapSessions(false);
+    fds.revents = 0;
+    auto ret = poll(&fds, 1, STREAM_ACCEPT_POLL_MS);
+    if (ret <= 0) {
+      continue;
+    }
+
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      MBLOG_WARN << "stream accept failed, " << StrError(errno);
+      continue;
+    }
+
+    auto session = std::make_shared<StreamSession>();
+    session->connection = std::make_shared<StreamConnection>(fd);
+    session->connection->SetMaxDataLen(max_frame_data_len_);
+    bool rejected = false;
+    {
+      std::lock_guard<std::mutex> lock(sessions_lock_);
+      rejected = sessions_.size() >= max_sessions_;
+      if (!rejected) {
+        sessions_.push_back(session);
+        session->reader =
+            std::thread(&ModelboxStreamPlugin::ReadWork, this, session);
+      }
+    }
+
+    // a slow peer must not block other sessions holding the lock
+    if (rejected) {
+      WriteClose(session->connection, STREAM_FRAME_ERROR,
+                 "too many stream sessions");
+    }
+  }
+}
+
+void ModelboxStreamPlugin::ReapSessions(bool wait_all) {
+  std::list<std::shared_ptr<StreamSession>> finished;
+  {
+    std::lock_guard<std::mutex> lock(sessions_lock_);
+    for (auto iter = sessions_.begin(); iter != sessions_.end();) {
+      if (wait_all || (*iter)->finished) {
+        finished.push_back(*iter);
+        iter = sessions_.erase(iter);
+        continue;
+      }
+
+      ++iter;
+    }
+  }
+
+  for (auto &session : finished) {
+    if (session->reader.joinable()) {
+      session->reader.join();
+    }
+  }
+}
+
+Status ModelboxStreamPlugin::OpenSession(
+    std::shared_ptr<StreamSession> session, const StreamFrame &frame) {
+  auto graph = frame.name.empty() ? default_graph_ : frame.name;
+  auto iter = flows_.find(graph);
+  if (iter == flows_.end()) {
+    return {STATUS_NOTFOUND, "graph " + graph + " not found"};
+  }
+
+  session->external = iter->second->CreateExternalDataMap();
+  if (session->external == nullptr) {
+    return {STATUS_FAULT, "create session of graph " + graph + " failed"};
+  }
+
+  session->writer =
+      std::thread(&ModelboxStreamPlugin::WriteWork, this, session);
+  nlohmann::json meta_json;
+  meta_json["graph"] = graph;
+  return session->connection->WriteFrame(STREAM_FRAME_OPEN, graph,
+                                         meta_json.dump());
+}
+
+Status ModelboxStreamPlugin::SendData(std::shared_ptr<StreamSession> session,
+                                      StreamFrame &frame) {
+  auto buffer_list = session->external->CreateBufferList();
+  Status ret = STATUS_OK;
+  if (frame.data_len == 0) {
+    // device memory can not adopt empty data
+    auto buffer = std::make_shared<Buffer>(buffer_list->GetDevice());
+    ret = buffer->Build(0);
+    buffer_list->PushBack(buffer);
+  } else {
+    // frame data is adopted, no copy for cpu device
+    ret = buffer_list->EmplaceBack(frame.data, frame.data_len);
+  }
+
+  if (!ret) {
+    return {ret, "build buffer of port " + frame.name + " failed"};
+  }
+
+  ret = SetBufferMeta(buffer_list->Back(), frame.meta);
+  if (!ret) {
+    return ret;
+  }
+
+  return session->external->Send(frame.name, buffer_list);
+}
+
+void ModelboxStreamPlugin::ReadWork(std::shared_ptr<StreamSession> session) {
+  auto &connection = session->connection;
+  bool input_end = false;
+  bool has_data = false;
+  StreamFrame frame;
+  Status ret = STATUS_OK;
+  while (ret) {
+    ret = connection->ReadFrame(&frame);
+    if (!ret) {
+      break;
+    }
+
+    if (frame.type == STREAM_FRAME_OPEN) {
+      ret = session->external == nullptr
+                ? OpenSession(session, frame)
+                : Status(STATUS_ALREADY, "stream session is already opened");
+    } else if (session->external == nullptr || input_end) {
+      ret = {STATUS_INVALID, "stream session is not opened or input ended"};
+    } else if (frame.type == STREAM_FRAME_DATA) {
+      ret = SendData(session, frame);
+      has_data = true;
+    } else if (frame.type == STREAM_FRAME_END) {
+      input_end = true;
+      if (has_data) {
+        ret = session->external->Close();
+      } else {
+        // session without data never ends, finish it directly
+        session->abort = true;
+        ret = session->external->Shutdown();
+      }
+    } else {
+      ret = {STATUS_INVALID,
+             "unexpected stream frame " + std::to_string(frame.type)};
+    }
+
+    if (!ret) {
+      MBLOG_WARN << "stream session failed, " << ret;
+      WriteClose(connection, STREAM_FRAME_ERROR, ret.WrapErrormsgs());
+    }
+  }
+
+  if (session->external != nullptr) {
+    // peer may close its write side after end and still read results
+    if (!input_end || ret != STATUS_EOF) {
+      // client left before input end, abort the session
+      session->abort = true;
+      session->external->Shutdown();
+    }
+
+    session->writer.join();
+  }
+
+  connection->Shutdown();
+  session->finished = true;
+}
+
+void ModelboxStreamPlugin::WriteWork(std::shared_ptr<StreamSession> session) {
+  auto &connection = session->connection;
+  auto &external = session->external;
+  Status ret = STATUS_OK;
+  Status write_ret = STATUS_OK;
+  while (ret && write_ret) {
+    OutputBufferList output;
+    ret = external->Recv(output, STREAM_RECV_TIMEOUT_MS);
+    if (ret && output.empty() && session->abort) {
+      break;
+    }
+
+    for (auto &port : output) {
+      for (auto &buffer : *port.second) {
+        // buffer memory is written to socket directly
+        write_ret = connection->WriteFrame(
+            STREAM_FRAME_RESULT, port.first, GetBufferMeta(buffer),
+            buffer->ConstData(), buffer->GetBytes());
+        if (!write_ret) {
+          break;
+        }
+      }
+
+      if (!write_ret) {
+        break;
+      }
+    }
+  }
+
+  if (!write_ret) {
+    // connection is dead, stop the session and wake up reader
+    MBLOG_WARN << "stream write result failed, " << write_ret;
+    session->abort = true;
+    external->Shutdown();
+    connection->Shutdown();
+    return;
+  }
+
+  std::string error;
+  if (ret != STATUS_EOF) {
+    auto last_error = external->GetLastError();
+    error = last_error != nullptr ? last_error->GetDesc() : ret.WrapErrormsgs();
+  }
+
+  WriteClose(connection, STREAM_FRAME_CLOSE, error);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODELBOX_MODELBOX_STREAM_PLUGIN_H_
+#define MODELBOX_MODELBOX_STREAM_PLUGIN_H_
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "modelbox/flow.h"
+#include "modelbox/server/plugin.h"
+#include "modelbox/server/stream_protocol.h"
+
+/**
+ * @brief One client connection, mapped to one external data map session
+ */
+struct StreamSession {
+  std::shared_ptr<modelbox::StreamConnection> connection;
+  std::shared_ptr<modelbox::ExternalDataMap> external;
+  std::thread reader;
+  std::thread writer;
+  // no more result will be received
+  std::atomic_bool abort{false};
+  std::atomic_bool finished{false};
+};
+
+/**
+ * @brief Binary streaming endpoint, buffers are sent and received as length
+ * prefixed frames over unix socket or tcp, see stream_protocol.h
+ */
+class ModelboxStreamPlugin : public modelbox::Plugin {
+ public:
+  ModelboxStreamPlugin(){};
+  virtual ~ModelboxStreamPlugin(){};
+
+  bool Init(std::shared_ptr<modelbox::Configuration> config) override;
+  bool Start() override;
+  bool Stop() override;
+
+  bool ParseConfig(std::shared_ptr<modelbox::Configuration> config);
+
+ private:
+  modelbox::Status LoadGraphs();
+
+  void AcceptWork();
+
+  void ReapSessions(bool wait_all);
+
+  void ReadWork(std::shared_ptr<StreamSession> session);
+
+  void WriteWork(std::shared_ptr<StreamSession> session);
+
+  modelbox::Status OpenSession(std::shared_ptr<StreamSession> session,
+                               const modelbox::StreamFrame &frame);
+
+  modelbox::Status SendData(std::shared_ptr<StreamSession> session,
+                            modelbox::StreamFrame &frame);
+
+  bool enable_{false};
+  std::string listen_;
+  std::vector<std::string> graph_files_;
+  uint32_t max_sessions_{0};
+  uint64_t max_frame_data_len_{modelbox::STREAM_FRAME_DEFAULT_MAX_DATA};
+  bool allow_remote_{false};
+
+  std::map<std::string, std::shared_ptr<modelbox::Flow>> flows_;
+  std::string default_graph_;
+
+  int listen_fd_{-1};
+  std::atomic_bool run_{false};
+  std::thread accept_thread_;
+
+  std::mutex sessions_lock_;
+  std::list<std::shared_ptr<StreamSession>> sessions_;
+};
+
+#endif  // MODELBOX_MODELBOX_STREAM_PLUGIN_H_
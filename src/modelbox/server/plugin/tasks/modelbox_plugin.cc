@@ -29,6 +29,8 @@ using namespace modelbox;
 const std::string SERVER_PATH = "/v1/modelbox/job";
 constexpr const char* GRAPH_DISABLED_FLAG = "DISABLED_";
 constexpr int MAX_FILES = 1 << 16;
+constexpr uint32_t MAX_PENDING_CREATE = 256;
+constexpr uint64_t DEFAULT_RELOAD_DRAIN_TIMEOUT_MS = 30 * 1000;
 
 std::map<std::string, std::string> ERROR_INFO = {
     {"MODELBOX_001", "server internal error"},
@@ -61,6 +63,7 @@ bool ModelboxPlugin::Init(std::shared_ptr<modelbox::Configuration> config) {
   listener_ = std::make_shared<modelbox::HttpListener>(endpoint);
   MBLOG_INFO << "run modelbox plugin on " << endpoint;
   RegistHandlers();
+  RegistWarmGraphs();
 
   return CreateLocalJobs();
 }
@@ -88,6 +91,7 @@ void ModelboxPlugin::RegistHandlers() {
 }
 
 bool ModelboxPlugin::Start() {
+  flow_pool_.Start();
   listener_->SetAclWhiteList(acl_white_list_);
   listener_->Start();
 
@@ -102,6 +106,10 @@ bool ModelboxPlugin::Start() {
 
 bool ModelboxPlugin::Stop() {
   listener_->Stop();
+  if (create_pool_ != nullptr) {
+    create_pool_->Shutdown();
+  }
+  flow_pool_.Stop();
 
   return true;
 }
@@ -138,9 +146,37 @@ bool ModelboxPlugin::ParseConfig(
   default_application_path_ = config->GetString("server.application_root");
   oneshot_flow_path_ = default_flow_path_ + "/oneshot";
 
+  warm_graphs_ = config->GetStrings("job.warm_graphs");
+  warm_pool_size_ = config->GetUint32("job.warm_pool_size", 1);
+  reload_drain_timeout_ms_ = config->GetUint64(
+      "job.reload_drain_timeout_ms", DEFAULT_RELOAD_DRAIN_TIMEOUT_MS);
+  auto create_threads = config->GetUint32("job.create_threads", 2);
+  if (create_threads == 0) {
+    create_threads = 1;
+  }
+
+  create_pool_ = std::make_shared<modelbox::ThreadPool>(
+      create_threads, create_threads, MAX_PENDING_CREATE);
+  create_pool_->SetName("Job-Create");
+
   return true;
 }
 
+void ModelboxPlugin::RegistWarmGraphs() {
+  for (const auto& graph_file : warm_graphs_) {
+    auto name = modelbox::GetBaseName(graph_file);
+    auto pos = name.find_last_of('.');
+    if (pos != std::string::npos && pos > 0) {
+      name = name.substr(0, pos);
+    }
+
+    auto ret = flow_pool_.Register(name, graph_file, warm_pool_size_);
+    if (!ret) {
+      MBLOG_WARN << "register warm graph " << graph_file << " failed, " << ret;
+    }
+  }
+}
+
 modelbox::Status ModelboxPlugin::CreateLocalJobs() {
   MBLOG_INFO << "create local job";
   std::vector<std::string> files;
@@ -245,8 +281,17 @@ modelbox::Status ModelboxPlugin::SaveGraphFile(const std::string& job_id,
   return modelbox::STATUS_OK;
 }
 
-modelbox::Status ModelboxPlugin::StartJob(std::shared_ptr<modelbox::Job> job) {
-  auto ret = job->Init();
+modelbox::Status ModelboxPlugin::BuildJob(std::shared_ptr<modelbox::Job> job,
+                                          const std::string& warm_graph) {
+  std::shared_ptr<modelbox::Flow> flow;
+  if (!warm_graph.empty()) {
+    flow = flow_pool_.Acquire(warm_graph);
+    MBLOG_INFO << "start job " << job->GetJobName() << " with "
+               << (flow != nullptr ? "warm" : "cold") << " graph "
+               << warm_graph;
+  }
+
+  auto ret = job->Init(flow);
   if (!ret) {
     MBLOG_ERROR << "start job init failed:" << ret;
     return ret;
@@ -258,11 +303,68 @@ modelbox::Status ModelboxPlugin::StartJob(std::shared_ptr<modelbox::Job> job) {
     return ret;
   }
 
+  return modelbox::STATUS_OK;
+}
+
+modelbox::Status ModelboxPlugin::StartJob(std::shared_ptr<modelbox::Job> job,
+                                          const std::string& warm_graph) {
+  auto ret = BuildJob(job, warm_graph);
+  if (!ret) {
+    return ret;
+  }
+
   job->Run();
 
   return modelbox::STATUS_OK;
 }
 
+modelbox::Status ModelboxPlugin::LaunchJob(std::shared_ptr<modelbox::Job> job,
+                                           const std::string& warm_graph,
+                                           bool async) {
+  job->SetJobStatus(modelbox::JOB_STATUS_CREATING);
+  if (!async) {
+    return StartJob(job, warm_graph);
+  }
+
+  if (pending_create_++ >= MAX_PENDING_CREATE) {
+    pending_create_--;
+    return {modelbox::STATUS_BUSY, "too many jobs creating"};
+  }
+
+  auto job_id = job->GetJobName();
+  // job is held here, it may be deleted while waiting in queue or building
+  auto create_func = [this, job, job_id, warm_graph]() {
+    Defer { pending_create_--; };
+    if (jobmanager_.GetJob(job_id) != job) {
+      return;
+    }
+
+    auto ret = BuildJob(job, warm_graph);
+    if (!ret) {
+      job->SetError(ret);
+      MBLOG_ERROR << "create job " << job_id << " async failed, " << ret;
+      return;
+    }
+
+    // deleted job is not run, its flow stops when the job is released
+    if (jobmanager_.GetJob(job_id) != job) {
+      MBLOG_INFO << "job " << job_id << " is deleted while creating";
+      job->Stop();
+      return;
+    }
+
+    job->Run();
+  };
+
+  auto result = create_pool_->Submit(job_id, create_func);
+  if (!result.valid()) {
+    pending_create_--;
+    return {modelbox::STATUS_BUSY, "submit job create task failed"};
+  }
+
+  return modelbox::STATUS_OK;
+}
+
 modelbox::Status ModelboxPlugin::CreateJobByFile(
     const std::string& job_id, const std::string& graph_file) {
   auto job = jobmanager_.CreateJob(job_id, graph_file);
@@ -281,9 +383,35 @@ modelbox::Status ModelboxPlugin::CreateJobByFile(
   return modelbox::STATUS_OK;
 }
 
+modelbox::Status ModelboxPlugin::CreateJobByName(const std::string& job_id,
+                                                 const std::string& graph_name,
+                                                 bool async) {
+  std::string graph_file;
+  if (!flow_pool_.GetGraphPath(graph_name, &graph_file)) {
+    return {modelbox::STATUS_NOTFOUND,
+            "graph " + graph_name + " is not registered"};
+  }
+
+  auto job = jobmanager_.CreateJob(job_id, graph_file);
+  if (job == nullptr) {
+    return modelbox::StatusError;
+  }
+
+  auto ret = LaunchJob(job, graph_name, async);
+  if (!ret) {
+    job->SetError(ret);
+    MBLOG_ERROR << "create job " << job_id << " from graph " << graph_name
+                << " failed";
+    return ret;
+  }
+
+  return modelbox::STATUS_OK;
+}
+
 modelbox::Status ModelboxPlugin::CreateJobByString(const std::string& job_id,
                                                    const std::string& graph,
-                                                   const std::string& format) {
+                                                   const std::string& format,
+                                                   bool async) {
   std::string toml_data;
   modelbox::Status ret;
   if (format == HTTP_GRAPH_FORMAT_TOML || format.length() == 0) {
@@ -311,7 +439,7 @@ modelbox::Status ModelboxPlugin::CreateJobByString(const std::string& job_id,
     return ret;
   }
 
-  ret = StartJob(job);
+  ret = LaunchJob(job, "", async);
   if (!ret) {
     MBLOG_ERROR << "create job " << job_id << " from string failed";
     return ret;
@@ -320,6 +448,88 @@ modelbox::Status ModelboxPlugin::CreateJobByString(const std::string& job_id,
   return modelbox::STATUS_OK;
 }
 
+modelbox::Status ModelboxPlugin::ReloadJob(const std::string& job_id,
+                                           const std::string& graph,
+                                           const std::string& format,
+                                           const std::string& graph_name,
+                                           uint64_t drain_timeout_ms,
+                                           bool async) {
+  auto job = jobmanager_.GetJob(job_id);
+  if (job == nullptr) {
+    return {modelbox::STATUS_NOTFOUND, "job " + job_id + " not exist"};
+  }
+
+  std::function<modelbox::Status()> reload_func;
+  if (!graph_name.empty()) {
+    std::string graph_file;
+    if (!flow_pool_.GetGraphPath(graph_name, &graph_file)) {
+      return {modelbox::STATUS_NOTFOUND,
+              "graph " + graph_name + " is not registered"};
+    }
+
+    reload_func = [this, job, graph_name, graph_file, drain_timeout_ms]() {
+      auto flow = flow_pool_.Acquire(graph_name);
+      return job->Reload(graph_file, drain_timeout_ms, flow);
+    };
+  } else {
+    std::string toml_data;
+    if (format == HTTP_GRAPH_FORMAT_TOML || format.length() == 0) {
+      toml_data = graph;
+    } else if (format == HTTP_GRAPH_FORMAT_JSON) {
+      if (modelbox::JsonToToml(graph, &toml_data) == false) {
+        return {modelbox::STATUS_INVALID, "graph data is invalid."};
+      }
+    } else {
+      return {modelbox::STATUS_INVALID,
+              "graph type:" + format + " is invalid."};
+    }
+
+    // graph file is kept for restart only when new graph runs
+    reload_func = [this, job, job_id, toml_data, drain_timeout_ms]() {
+      auto ret = job->Reload(job_id, toml_data, drain_timeout_ms);
+      if (!ret) {
+        return ret;
+      }
+
+      return SaveGraphFile(job_id, toml_data);
+    };
+  }
+
+  if (!async) {
+    return reload_func();
+  }
+
+  if (pending_create_++ >= MAX_PENDING_CREATE) {
+    pending_create_--;
+    return {modelbox::STATUS_BUSY, "too many jobs creating"};
+  }
+
+  auto result = create_pool_->Submit(job_id, [this, job_id, reload_func]() {
+    Defer { pending_create_--; };
+    auto ret = reload_func();
+    if (!ret) {
+      MBLOG_ERROR << "reload job " << job_id << " async failed, " << ret;
+    }
+  });
+  if (!result.valid()) {
+    pending_create_--;
+    return {modelbox::STATUS_BUSY, "submit job reload task failed"};
+  }
+
+  return modelbox::STATUS_OK;
+}
+
+nlohmann::json BuildReloadInfo(const modelbox::JobReloadInfo& info) {
+  nlohmann::json reload_json;
+  reload_json["state"] = modelbox::Job::JobReloadStateToString(info.state_);
+  reload_json["build_ms"] = info.build_ms_;
+  reload_json["switch_us"] = info.switch_us_;
+  reload_json["drain_ms"] = info.drain_ms_;
+  reload_json["dropped_sessions"] = info.dropped_sessions_;
+  reload_json["error_msg"] = info.error_msg_;
+  return reload_json;
+}
+
 std::string BuildErrorResponse(const std::string& error,
                                const std::string& msg = "") {
   nlohmann::json response;
@@ -339,6 +549,7 @@ void ModelboxPlugin::HandlerPut(const httplib::Request& request,
   std::string graph_format = HTTP_GRAPH_FORMAT_JSON;
   std::string error_code = "MODELBOX_001";
   std::string error_msg;
+  bool async = false;
   AddSafeHeader(response);
   bool is_failed = true;
   Defer {
@@ -371,7 +582,10 @@ void ModelboxPlugin::HandlerPut(const httplib::Request& request,
     }
 
     auto jobid = body["job_id"].get<std::string>();
-    if (body.find("job_graph") == body.end()) {
+    // job graph inline, or name of graph registered in job.warm_graphs
+    auto has_graph = body.find("job_graph") != body.end();
+    auto has_graph_name = body.find("job_graph_name") != body.end();
+    if (!has_graph && !has_graph_name) {
       error_code = "MODELBOX_004";
       error_msg = ERROR_INFO[error_code];
       return;
@@ -383,12 +597,30 @@ void ModelboxPlugin::HandlerPut(const httplib::Request& request,
       return;
     }
 
+    // return once job is accepted, query job for result
+    if (body.find("async") != body.end()) {
+      async = body["async"].get<bool>();
+    }
+
     if (body.find("job_graph_format") != body.end()) {
       graph_format = body["job_graph_format"].get<std::string>();
     }
 
+    // replace graph of existing job, sessions are drained
+    bool reload = false;
+    if (body.find("reload") != body.end()) {
+      reload = body["reload"].get<bool>();
+    }
+
+    auto drain_timeout_ms = reload_drain_timeout_ms_;
+    if (body.find("drain_timeout_ms") != body.end()) {
+      drain_timeout_ms = body["drain_timeout_ms"].get<uint64_t>();
+    }
+
     std::string graph_data;
-    if (graph_format == HTTP_GRAPH_FORMAT_JSON) {
+    if (!has_graph) {
+      // graph is loaded from registered file
+    } else if (graph_format == HTTP_GRAPH_FORMAT_JSON) {
       graph_data = body["job_graph"].dump();
     } else if (graph_format == HTTP_GRAPH_FORMAT_TOML) {
       graph_data = body["job_graph"].get<std::string>();
@@ -398,6 +630,39 @@ void ModelboxPlugin::HandlerPut(const httplib::Request& request,
       return;
     }
 
+    if (reload) {
+      if (modelbox::JobStatus::JOB_STATUS_NOTEXIST ==
+          jobmanager_.QueryJobStatus(jobid)) {
+        error_code = "MODELBOX_002";
+        error_msg = ERROR_INFO[error_code];
+        return;
+      }
+
+      std::string graph_name;
+      if (!has_graph) {
+        graph_name = body["job_graph_name"].get<std::string>();
+      }
+
+      auto status = ReloadJob(jobid, graph_data, graph_format, graph_name,
+                              drain_timeout_ms, async);
+      if (!status) {
+        error_code = "MODELBOX_008";
+        error_msg = status.WrapErrormsgs();
+        return;
+      }
+
+      is_failed = false;
+      nlohmann::json response_json;
+      response_json["job_id"] = jobid;
+      response_json["job_status"] = jobmanager_.QueryJobStatusString(jobid);
+      response_json["job_reload"] =
+          BuildReloadInfo(jobmanager_.GetJob(jobid)->GetReloadInfo());
+      response.status =
+          async ? HttpStatusCodes::ACCEPTED : HttpStatusCodes::OK;
+      response.set_content(response_json.dump(), JSON);
+      return;
+    }
+
     if (modelbox::JobStatus::JOB_STATUS_NOTEXIST !=
         jobmanager_.QueryJobStatus(jobid)) {
       error_code = "MODELBOX_005";
@@ -405,7 +670,14 @@ void ModelboxPlugin::HandlerPut(const httplib::Request& request,
       return;
     }
 
-    auto status = CreateJobByString(jobid, graph_data, graph_format);
+    modelbox::Status status;
+    if (has_graph) {
+      status = CreateJobByString(jobid, graph_data, graph_format, async);
+    } else {
+      auto graph_name = body["job_graph_name"].get<std::string>();
+      status = CreateJobByName(jobid, graph_name, async);
+    }
+
     if (!status) {
       error_code = "MODELBOX_008";
       error_msg = status.WrapErrormsgs();
@@ -413,6 +685,14 @@ void ModelboxPlugin::HandlerPut(const httplib::Request& request,
     }
 
     is_failed = false;
+    if (async) {
+      nlohmann::json response_json;
+      response_json["job_id"] = jobid;
+      response_json["job_status"] = jobmanager_.QueryJobStatusString(jobid);
+      response.status = HttpStatusCodes::ACCEPTED;
+      response.set_content(response_json.dump(), JSON);
+      return;
+    }
   } catch (const std::exception& e) {
     MBLOG_ERROR << "process request failed, " << e.what();
     error_msg = e.what();
@@ -446,6 +726,11 @@ void ModelboxPlugin::HandlerGet(const httplib::Request& request,
       response_json["job_id"] = job_id;
       response_json["job_status"] = job_status;
       response_json["job_error_msg"] = job_msg;
+      auto job = jobmanager_.GetJob(job_id);
+      if (job != nullptr) {
+        response_json["job_warm_start"] = job->IsWarmStart();
+        response_json["job_reload"] = BuildReloadInfo(job->GetReloadInfo());
+      }
       response.status = HttpStatusCodes::OK;
       response.set_content(response_json.dump(), JSON);
       return;
@@ -471,6 +756,25 @@ void ModelboxPlugin::HandlerGet(const httplib::Request& request,
       return;
     }
 
+    // warm flows of registered graph
+    if (pre_path == "/warm") {
+      std::string graph_file;
+      if (!flow_pool_.GetGraphPath(job_id, &graph_file)) {
+        const auto& response_content = BuildErrorResponse("MODELBOX_002");
+        response.status = HttpStatusCodes::NOT_FOUND;
+        response.set_content(response_content, JSON);
+        return;
+      }
+
+      nlohmann::json response_json;
+      response_json["graph_name"] = job_id;
+      response_json["idle"] = flow_pool_.GetIdleCount(job_id);
+      response_json["ready"] = flow_pool_.WaitReady(0);
+      response.status = HttpStatusCodes::OK;
+      response.set_content(response_json.dump(), JSON);
+      return;
+    }
+
     const auto& response_content = BuildErrorResponse("MODELBOX_006");
     response.status = HttpStatusCodes::INTERNAL_ERROR;
     response.set_content(response_content, JSON);
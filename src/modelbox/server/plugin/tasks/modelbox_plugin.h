@@ -17,7 +17,11 @@
 #ifndef MODELBOX_MODELBOX_PLUGIN_H_
 #define MODELBOX_MODELBOX_PLUGIN_H_
 
+#include <atomic>
+
 #include "memory"
+#include "modelbox/base/thread_pool.h"
+#include "modelbox/server/flow_pool.h"
 #include "modelbox/server/http_helper.h"
 #include "modelbox/server/job_manager.h"
 #include "modelbox/server/plugin.h"
@@ -47,9 +51,25 @@ class ModelboxPlugin : public modelbox::Plugin {
                                    const std::string& graph_file);
   modelbox::Status CreateJobByString(const std::string& job_id,
                                      const std::string& graph,
-                                     const std::string& format);
+                                     const std::string& format,
+                                     bool async = false);
+  modelbox::Status CreateJobByName(const std::string& job_id,
+                                   const std::string& graph_name,
+                                   bool async = false);
+
+  modelbox::Status ReloadJob(const std::string& job_id,
+                             const std::string& graph,
+                             const std::string& format,
+                             const std::string& graph_name,
+                             uint64_t drain_timeout_ms, bool async);
 
-  modelbox::Status StartJob(std::shared_ptr<modelbox::Job> job);
+  modelbox::Status BuildJob(std::shared_ptr<modelbox::Job> job,
+                            const std::string& warm_graph);
+  modelbox::Status StartJob(std::shared_ptr<modelbox::Job> job,
+                            const std::string& warm_graph = "");
+  modelbox::Status LaunchJob(std::shared_ptr<modelbox::Job> job,
+                             const std::string& warm_graph, bool async);
+  void RegistWarmGraphs();
 
   modelbox::Status SaveGraphFile(const std::string& job_id,
                                  const std::string& toml_graph);
@@ -65,6 +85,13 @@ class ModelboxPlugin : public modelbox::Plugin {
   std::vector<std::string> acl_white_list_;
   std::shared_ptr<modelbox::HttpListener> listener_;
   modelbox::JobManager jobmanager_;
+
+  std::vector<std::string> warm_graphs_;
+  uint32_t warm_pool_size_{1};
+  uint64_t reload_drain_timeout_ms_{0};
+  modelbox::FlowPool flow_pool_;
+  std::shared_ptr<modelbox::ThreadPool> create_pool_;
+  std::atomic<uint32_t> pending_create_{0};
 };
 
 #endif  // MODELBOX_MODELBOX_PLUGIN_H_
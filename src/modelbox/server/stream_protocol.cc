@@ -0,0 +1,427 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "modelbox/server/stream_protocol.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include "modelbox/base/log.h"
+#include "modelbox/base/utils.h"
+#include "securec.h"
+
+namespace modelbox {
+
+constexpr const char *STREAM_TCP_PREFIX = "tcp://";
+constexpr int STREAM_LISTEN_BACKLOG = 128;
+
+static bool IsLoopback(const struct sockaddr *addr) {
+  if (addr->sa_family == AF_INET) {
+    auto *addr4 = (const struct sockaddr_in *)addr;
+    return (ntohl(addr4->sin_addr.s_addr) >> 24) == IN_LOOPBACKNET;
+  }
+
+  if (addr->sa_family == AF_INET6) {
+    auto *addr6 = (const struct sockaddr_in6 *)addr;
+    return IN6_IS_ADDR_LOOPBACK(&addr6->sin6_addr);
+  }
+
+  return false;
+}
+
+static Status StreamSocket(const std::string &address, bool is_listen,
+                           bool allow_remote, int *fd) {
+  int sock = -1;
+  auto ret = STATUS_OK;
+  DeferCond { return sock >= 0 && ret != STATUS_OK; };
+  DeferCondAdd { close(sock); };
+
+  if (address.compare(0, strlen(STREAM_TCP_PREFIX), STREAM_TCP_PREFIX) != 0) {
+    struct sockaddr_un addr;
+    memset_s(&addr, sizeof(addr), 0, sizeof(addr));
+    if (address.empty() || address.length() >= sizeof(addr.sun_path)) {
+      ret = {STATUS_INVALID, "invalid unix socket path " + address};
+      return ret;
+    }
+
+    addr.sun_family = AF_UNIX;
+    strncpy_s(addr.sun_path, sizeof(addr.sun_path), address.c_str(),
+              address.length());
+    sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+      ret = {STATUS_FAULT, "create socket failed, " + StrError(errno)};
+      return ret;
+    }
+
+    if (is_listen) {
+      unlink(addr.sun_path);
+      if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        ret = {STATUS_FAULT,
+               "bind socket " + address + " failed, " + StrError(errno)};
+        return ret;
+      }
+
+      chmod(addr.sun_path, 0660);
+    } else if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+      ret = {STATUS_FAULT,
+             "connect socket " + address + " failed, " + StrError(errno)};
+      return ret;
+    }
+  } else {
+    auto host_port = address.substr(strlen(STREAM_TCP_PREFIX));
+    auto pos = host_port.rfind(':');
+    if (pos == std::string::npos) {
+      ret = {STATUS_INVALID, "invalid tcp address " + address};
+      return ret;
+    }
+
+    struct addrinfo hints;
+    struct addrinfo *result = nullptr;
+    memset_s(&hints, sizeof(hints), 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = is_listen ? AI_PASSIVE : 0;
+    auto host = host_port.substr(0, pos);
+    auto port = host_port.substr(pos + 1);
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0 ||
+        result == nullptr) {
+      ret = {STATUS_INVALID, "resolve address " + address + " failed"};
+      return ret;
+    }
+    Defer { freeaddrinfo(result); };
+
+    if (is_listen && !allow_remote && !IsLoopback(result->ai_addr)) {
+      ret = {STATUS_PERMIT,
+             "stream is not authenticated, listen " + address +
+                 " is refused, use loopback address or allow remote"};
+      return ret;
+    }
+
+    sock = socket(result->ai_family, result->ai_socktype | SOCK_CLOEXEC,
+                  result->ai_protocol);
+    if (sock < 0) {
+      ret = {STATUS_FAULT, "create socket failed, " + StrError(errno)};
+      return ret;
+    }
+
+    int on = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    if (is_listen) {
+      setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+      if (bind(sock, result->ai_addr, result->ai_addrlen) != 0) {
+        ret = {STATUS_FAULT,
+               "bind socket " + address + " failed, " + StrError(errno)};
+        return ret;
+      }
+    } else if (connect(sock, result->ai_addr, result->ai_addrlen) != 0) {
+      ret = {STATUS_FAULT,
+             "connect socket " + address + " failed, " + StrError(errno)};
+      return ret;
+    }
+  }
+
+  if (is_listen && listen(sock, STREAM_LISTEN_BACKLOG) != 0) {
+    ret = {STATUS_FAULT,
+           "listen socket " + address + " failed, " + StrError(errno)};
+    return ret;
+  }
+
+  *fd = sock;
+  return STATUS_OK;
+}
+
+Status StreamListen(const std::string &address, int *fd, bool allow_remote) {
+  return StreamSocket(address, true, allow_remote, fd);
+}
+
+Status StreamConnect(const std::string &address, int *fd) {
+  return StreamSocket(address, false, true, fd);
+}
+
+/**
+ * StreamConnection
+ */
+StreamConnection::StreamConnection(int fd) : fd_(fd) {}
+
+StreamConnection::~StreamConnection() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+Status StreamConnection::WriteFrame(uint16_t type, const std::string &name,
+                                    const std::string &meta, const void *data,
+                                    size_t data_len) {
+  if (name.length() > STREAM_FRAME_MAX_NAME ||
+      meta.length() > STREAM_FRAME_MAX_META ||
+      data_len > STREAM_FRAME_MAX_DATA) {
+    return {STATUS_RANGE, "stream frame is too large"};
+  }
+
+  StreamFrameHeader header;
+  header.magic = STREAM_FRAME_MAGIC;
+  header.type = type;
+  header.name_len = name.length();
+  header.meta_len = meta.length();
+  header.reserved = 0;
+  header.data_len = data_len;
+
+  struct iovec iov[4];
+  int iov_num = 0;
+  iov[iov_num].iov_base = &header;
+  iov[iov_num++].iov_len = sizeof(header);
+  if (!name.empty()) {
+    iov[iov_num].iov_base = (void *)name.data();
+    iov[iov_num++].iov_len = name.length();
+  }
+
+  if (!meta.empty()) {
+    iov[iov_num].iov_base = (void *)meta.data();
+    iov[iov_num++].iov_len = meta.length();
+  }
+
+  if (data_len > 0) {
+    iov[iov_num].iov_base = (void *)data;
+    iov[iov_num++].iov_len = data_len;
+  }
+
+  std::lock_guard<std::mutex> lock(write_lock_);
+  struct iovec *iov_pos = iov;
+  while (iov_num > 0) {
+    struct msghdr msg;
+    memset_s(&msg, sizeof(msg), 0, sizeof(msg));
+    msg.msg_iov = iov_pos;
+    msg.msg_iovlen = iov_num;
+    auto len = sendmsg(fd_, &msg, MSG_NOSIGNAL);
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      return {STATUS_FAULT, "write stream frame failed, " + StrError(errno)};
+    }
+
+    // skip sent part
+    while (iov_num > 0 && (size_t)len >= iov_pos->iov_len) {
+      len -= iov_pos->iov_len;
+      iov_pos++;
+      iov_num--;
+    }
+
+    if (iov_num > 0) {
+      iov_pos->iov_base = (char *)iov_pos->iov_base + len;
+      iov_pos->iov_len -= len;
+    }
+  }
+
+  return STATUS_OK;
+}
+
+Status StreamConnection::ReadFull(void *buf, size_t len) {
+  auto *pos = (char *)buf;
+  while (len > 0) {
+    auto ret = recv(fd_, pos, len, 0);
+    if (ret == 0) {
+      return STATUS_EOF;
+    }
+
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      return {STATUS_FAULT, "read stream frame failed, " + StrError(errno)};
+    }
+
+    pos += ret;
+    len -= ret;
+  }
+
+  return STATUS_OK;
+}
+
+Status StreamConnection::ReadFrame(StreamFrame *frame) {
+  StreamFrameHeader header;
+  auto ret = ReadFull(&header, sizeof(header));
+  if (!ret) {
+    return ret;
+  }
+
+  if (header.magic != STREAM_FRAME_MAGIC ||
+      header.name_len > STREAM_FRAME_MAX_NAME ||
+      header.meta_len > STREAM_FRAME_MAX_META ||
+      header.data_len > STREAM_FRAME_MAX_DATA) {
+    return {STATUS_INVALID, "invalid stream frame header"};
+  }
+
+  if (header.data_len > max_data_len_) {
+    return {STATUS_INVALID, "stream frame data " +
+                                std::to_string(header.data_len) +
+                                " exceeds limit " +
+                                std::to_string(max_data_len_)};
+  }
+
+  frame->type = header.type;
+  frame->name.resize(header.name_len);
+  frame->meta.resize(header.meta_len);
+  frame->data = nullptr;
+  frame->data_len = header.data_len;
+  if (header.name_len > 0) {
+    ret = ReadFull(&frame->name[0], header.name_len);
+    if (!ret) {
+      return ret;
+    }
+  }
+
+  if (header.meta_len > 0) {
+    ret = ReadFull(&frame->meta[0], header.meta_len);
+    if (!ret) {
+      return ret;
+    }
+  }
+
+  if (header.data_len > 0) {
+    frame->data.reset(new (std::nothrow) uint8_t[header.data_len],
+                      std::default_delete<uint8_t[]>());
+    if (frame->data == nullptr) {
+      return {STATUS_NOMEM, "alloc stream frame data failed"};
+    }
+
+    ret = ReadFull(frame->data.get(), header.data_len);
+    if (!ret) {
+      return ret;
+    }
+  }
+
+  return STATUS_OK;
+}
+
+void StreamConnection::SetMaxDataLen(uint64_t max_data_len) {
+  max_data_len_ = max_data_len;
+}
+
+void StreamConnection::Shutdown() { shutdown(fd_, SHUT_RDWR); }
+
+void StreamConnection::ShutdownWrite() { shutdown(fd_, SHUT_WR); }
+
+/**
+ * StreamClient
+ */
+StreamClient::StreamClient() {}
+
+StreamClient::~StreamClient() { Close(); }
+
+Status StreamClient::Open(const std::string &address,
+                          const std::string &graph) {
+  int fd = -1;
+  auto ret = StreamConnect(address, &fd);
+  if (!ret) {
+    return ret;
+  }
+
+  // results come from the server connected to, not limited by default
+  connection_ = std::make_shared<StreamConnection>(fd);
+  connection_->SetMaxDataLen(STREAM_FRAME_MAX_DATA);
+  ret = connection_->WriteFrame(STREAM_FRAME_OPEN, graph);
+  if (!ret) {
+    return ret;
+  }
+
+  StreamFrame frame;
+  ret = Recv(&frame);
+  if (!ret) {
+    return ret;
+  }
+
+  if (frame.type != STREAM_FRAME_OPEN) {
+    return {STATUS_FAULT, "unexpected stream frame " +
+                              std::to_string(frame.type) + " on open"};
+  }
+
+  return STATUS_OK;
+}
+
+Status StreamClient::Send(const std::string &port, const void *data,
+                          size_t data_len, const std::string &meta) {
+  if (connection_ == nullptr) {
+    return {STATUS_SHUTDOWN, "stream is not opened"};
+  }
+
+  return connection_->WriteFrame(STREAM_FRAME_DATA, port, meta, data,
+                                 data_len);
+}
+
+Status StreamClient::End(bool shutdown_write) {
+  if (connection_ == nullptr) {
+    return {STATUS_SHUTDOWN, "stream is not opened"};
+  }
+
+  auto ret = connection_->WriteFrame(STREAM_FRAME_END, "");
+  if (ret && shutdown_write) {
+    connection_->ShutdownWrite();
+  }
+
+  return ret;
+}
+
+Status StreamClient::Recv(StreamFrame *frame) {
+  if (connection_ == nullptr) {
+    return {STATUS_SHUTDOWN, "stream is not opened"};
+  }
+
+  auto ret = connection_->ReadFrame(frame);
+  if (!ret) {
+    return ret;
+  }
+
+  if (frame->type != STREAM_FRAME_CLOSE && frame->type != STREAM_FRAME_ERROR) {
+    return STATUS_OK;
+  }
+
+  std::string error;
+  try {
+    auto meta = nlohmann::json::parse(frame->meta);
+    error = meta.value("error", "");
+  } catch (const std::exception &e) {
+    error = "invalid stream close meta, " + std::string(e.what());
+  }
+
+  if (frame->type == STREAM_FRAME_CLOSE && error.empty()) {
+    return STATUS_EOF;
+  }
+
+  return {STATUS_FAULT, error};
+}
+
+void StreamClient::Close() {
+  if (connection_ == nullptr) {
+    return;
+  }
+
+  connection_->Shutdown();
+  connection_ = nullptr;
+}
+
+}  // namespace modelbox
@@ -144,15 +144,63 @@ Status Task::Start() {
     return {STATUS_PERMIT, "task is in the waitting queue"};
   }
   already_submit_ = true;
+  if (!priority_set_) {
+    priority_ = ParsePriority();
+  }
 
   auto status = task_manager->Submit(shared_from_this());
   if (status != STATUS_SUCCESS) {
+    // rejected task may start again later
+    already_submit_ = false;
     return status;
   }
 
   return STATUS_SUCCESS;
 }
 
+void Task::SetPriority(TaskPriority priority) {
+  std::lock_guard<std::mutex> guard(lock_);
+  if (priority >= TASK_PRIORITY_NUM) {
+    priority = TASK_PRIORITY_LOW;
+  }
+
+  priority_ = priority;
+  priority_set_ = true;
+}
+
+TaskPriority Task::GetPriority() {
+  std::lock_guard<std::mutex> guard(lock_);
+  return priority_;
+}
+
+TaskPriority Task::ParsePriority() {
+  auto external_data = external_data_.lock();
+  if (external_data == nullptr) {
+    return priority_;
+  }
+
+  auto config = external_data->GetSessionConfig();
+  if (config == nullptr) {
+    return priority_;
+  }
+
+  auto priority = config->GetString(TASK_CONFIG_PRIORITY, "normal");
+  if (priority == "high") {
+    return TASK_PRIORITY_HIGH;
+  }
+
+  if (priority == "low") {
+    return TASK_PRIORITY_LOW;
+  }
+
+  if (priority != "normal") {
+    MBLOG_WARN << "task " << task_uuid_ << " priority " << priority
+               << " is invalid, use normal";
+  }
+
+  return TASK_PRIORITY_NORMAL;
+}
+
 void Task::SetTaskManager(std::shared_ptr<TaskManager> task_manager) {
   task_manager_ = task_manager;
   flow_ = task_manager->GetFlow();
@@ -291,6 +339,15 @@ void OneShotTask::FetchData(Status fetch_status, OutputBufferList& output_buf) {
   }
 }
 
+size_t OneShotTask::GetBufferNum() {
+  size_t buffer_num = 0;
+  for (auto& data : data_) {
+    buffer_num += data.second->Size();
+  }
+
+  return buffer_num;
+}
+
 void OneShotTask::RegisterDataCallback(TaskDataCallback callback) {
   data_callback_ = callback;
 }
@@ -18,6 +18,19 @@
 #include <modelbox/server/task_manager.h>
 namespace modelbox {
 
+constexpr int TASK_RECEIVE_SELECT_TIMEOUT = 200;
+// ready outputs taken by one receive thread at a time
+constexpr size_t TASK_RECEIVE_SELECT_BATCH = 16;
+// statistics item name of priority classes
+static const char *kTaskPriorityNames[TASK_PRIORITY_NUM] = {"high", "normal",
+                                                             "low"};
+constexpr const char *TASK_CONFIG_RECEIVE_THREAD_NUM =
+    "task.receive-thread-num";
+constexpr const char *TASK_CONFIG_INFLIGHT_BUFFER_LIMIT =
+    "task.inflight-buffer-limit";
+constexpr const char *TASK_CONFIG_MAX_WAITING_TASKS = "max-waiting-tasks";
+constexpr const char *TASK_CONFIG_MAX_QUEUE_TIME_MS = "max-queue-time-ms";
+
 TaskManager::TaskManager(std::shared_ptr<Flow> task_flow,
                          uint32_t task_limits) {
   flow_ = task_flow;
@@ -31,94 +44,334 @@ TaskManager::~TaskManager() { Stop(); }
 
 Status TaskManager::Submit(std::shared_ptr<Task> task) {
   std::unique_lock<std::mutex> guard(new_del_lock_);
-  if (avaiable_task_counts_ >= task_num_limits_) {
-    MBLOG_INFO<<"Running Task exceed task_num_limits "<<avaiable_task_counts_;
-    return STATUS_SUCCESS;
-  }
   if (thread_pool_ == nullptr) {
     return {STATUS_NOTFOUND, "thread_pool not exist"};
   }
-  avaiable_task_counts_++;
-  guard.unlock();
 
-  thread_pool_->Submit(task->GetTaskId(), &Task::SendData, task.get());
+  task->buffer_num_ = task->GetBufferNum();
+  task->submit_time_us_ = Now();
+  auto &priority_class = priority_classes_[task->priority_];
+  bool waiting_before = false;
+  for (int i = 0; i <= task->priority_; ++i) {
+    waiting_before |= !priority_classes_[i].waiting_tasks.empty();
+  }
+
+  if (!waiting_before && CanRunTask(task)) {
+    RunTask(task);
+    guard.unlock();
+    thread_pool_->Submit(task->GetTaskId(), &Task::SendData, task.get());
+    return STATUS_SUCCESS;
+  }
+
+  auto ret = Admit(task);
+  if (!ret) {
+    if (priority_class.rejected) {
+      priority_class.rejected->Increase();
+    }
+
+    MBLOG_INFO << "reject task " << task->GetTaskId() << ", " << ret.Errormsg();
+    return ret;
+  }
+
+  MBLOG_INFO << "task " << task->GetTaskId() << " is waiting, running tasks "
+             << avaiable_task_counts_;
+  priority_class.waiting_tasks.push_back(task);
+  if (priority_class.waiting_gauge) {
+    priority_class.waiting_gauge->Add(1);
+  }
 
   return STATUS_SUCCESS;
 }
 
-void TaskManager::StartWaittingTask() {
-  std::unique_lock<std::mutex> guard(map_lock_);
-  auto task_iter = task_maps_.begin();
+Status TaskManager::Admit(const std::shared_ptr<Task> &task) {
+  auto &priority_class = priority_classes_[task->priority_];
+  auto priority_name = kTaskPriorityNames[task->priority_];
+  if (priority_class.max_waiting_tasks > 0 &&
+      priority_class.waiting_tasks.size() >= priority_class.max_waiting_tasks) {
+    return {STATUS_BUSY, std::string("too many waiting tasks of priority ") +
+                             priority_name};
+  }
+
+  uint64_t latency = task_latency_us_;
+  if (priority_class.max_queue_time_ms == 0 || latency == 0) {
+    return STATUS_OK;
+  }
+
+  size_t waiting_ahead = 0;
+  for (int i = 0; i <= task->priority_; ++i) {
+    waiting_ahead += priority_classes_[i].waiting_tasks.size();
+  }
+
+  // every running slot serves waiting tasks in turn
+  uint32_t slots = task_num_limits_ > 0 ? task_num_limits_.load() : 1;
+  auto queue_time_us = latency * (waiting_ahead / slots + 1);
+  if (queue_time_us > (uint64_t)priority_class.max_queue_time_ms * 1000) {
+    return {STATUS_BUSY, std::string("estimated queue time ") +
+                             std::to_string(queue_time_us / 1000) +
+                             "ms exceeds limit of priority " + priority_name};
+  }
+
+  return STATUS_OK;
+}
+
+bool TaskManager::CanRunTask(const std::shared_ptr<Task> &task) {
   if (avaiable_task_counts_ >= task_num_limits_) {
+    return false;
+  }
+
+  // a large task still runs alone
+  if (inflight_buffer_limit_ == 0 || inflight_buffers_ == 0) {
+    return true;
+  }
+
+  return inflight_buffers_ + task->buffer_num_ <= inflight_buffer_limit_;
+}
+
+std::shared_ptr<Task> TaskManager::PopWaitingTask() {
+  for (auto &priority_class : priority_classes_) {
+    auto &waiting_tasks = priority_class.waiting_tasks;
+    while (!waiting_tasks.empty()) {
+      auto task = waiting_tasks.front().lock();
+      // deleted or stopped when waiting
+      if (task == nullptr || !task->already_submit_ ||
+          task->status_ != WAITING) {
+        waiting_tasks.pop_front();
+        if (priority_class.waiting_gauge) {
+          priority_class.waiting_gauge->Add(-1);
+        }
+        continue;
+      }
+
+      // lower priority tasks never overtake
+      if (!CanRunTask(task)) {
+        return nullptr;
+      }
+
+      waiting_tasks.pop_front();
+      if (priority_class.waiting_gauge) {
+        priority_class.waiting_gauge->Add(-1);
+      }
+      return task;
+    }
+  }
+
+  return nullptr;
+}
+
+void TaskManager::RunTask(const std::shared_ptr<Task> &task) {
+  task->hold_slot_ = true;
+  task->start_time_us_ = Now();
+  avaiable_task_counts_++;
+  inflight_buffers_ += task->buffer_num_;
+
+  auto &priority_class = priority_classes_[task->priority_];
+  if (priority_class.queue_time) {
+    priority_class.queue_time->Record(task->start_time_us_ -
+                                      task->submit_time_us_);
+  }
+
+  if (running_gauge_) {
+    running_gauge_->Set(avaiable_task_counts_);
+    inflight_gauge_->Set(inflight_buffers_);
+  }
+}
+
+void TaskManager::ReleaseTask(const std::shared_ptr<Task> &task) {
+  // task stopped when waiting holds no slot
+  if (!task->hold_slot_) {
     return;
   }
 
-  while (task_iter != task_maps_.end()) {
-    auto task = task_iter->second;
-    if (task->IsRready()) {
-      Submit(task);
+  task->hold_slot_ = false;
+  avaiable_task_counts_--;
+  inflight_buffers_ -= task->buffer_num_;
+  auto run_time = Now() - task->start_time_us_;
+  uint64_t latency = run_time > 0 ? run_time : 0;
+  uint64_t old_latency = task_latency_us_;
+  task_latency_us_ =
+      old_latency == 0 ? latency : (old_latency * 7 + latency) / 8;
+
+  if (running_gauge_) {
+    running_gauge_->Set(avaiable_task_counts_);
+    inflight_gauge_->Set(inflight_buffers_);
+  }
+}
+
+void TaskManager::StartWaittingTask() {
+  std::vector<std::shared_ptr<Task>> start_tasks;
+  std::unique_lock<std::mutex> guard(new_del_lock_);
+  if (thread_pool_ == nullptr) {
+    return;
+  }
+
+  while (true) {
+    auto task = PopWaitingTask();
+    if (task == nullptr) {
+      break;
     }
-    task_iter++;
+
+    RunTask(task);
+    start_tasks.push_back(task);
+  }
+  guard.unlock();
+
+  for (auto &task : start_tasks) {
+    thread_pool_->Submit(task->GetTaskId(), &Task::SendData, task.get());
   }
 }
 
+bool TaskManager::ReceiveTaskData(
+    const std::shared_ptr<ExternalDataMap> &external) {
+  std::unique_lock<std::mutex> map_guard(map_lock_);
+  auto task_iter = external_task_maps_.find(external);
+  if (task_iter == external_task_maps_.end()) {
+    MBLOG_DEBUG << "task already deleted";
+    return false;
+  }
+  auto task = task_iter->second;
+  map_guard.unlock();
+
+  // keep output order of one task, recv never blocks a receive thread
+  std::lock_guard<std::mutex> fetch_guard(task->fetch_lock_);
+  modelbox::OutputBufferList map_buffer_list;
+  auto status = external->Recv(map_buffer_list, -1);
+  if (status == STATUS_SUCCESS && map_buffer_list.empty()) {
+    MBLOG_DEBUG << "output already received";
+    return false;
+  }
+
+  bool task_end = false;
+  std::unique_lock<std::mutex> guard(new_del_lock_);
+  if (status == STATUS_INVALID) {
+    MBLOG_WARN << "recv external failed";
+    auto error = external->GetLastError();
+    if (error->GetDesc() == "EOF") {
+      task->UpdateTaskStatus(STOPPED);
+    } else {
+      task->UpdateTaskStatus(ABNORMAL);
+    }
+    ReleaseTask(task);
+    task_end = true;
+  } else if (status == STATUS_EOF) {
+    MBLOG_DEBUG << "recv external finished";
+    task->UpdateTaskStatus(FINISHED);
+    ReleaseTask(task);
+    task_end = true;
+  }
+  guard.unlock();
+  task->FetchData(status, map_buffer_list);
+  return task_end;
+}
+
 void TaskManager::ReceiveWork() {
   while (thread_run_) {
     std::list<std::shared_ptr<ExternalDataMap>> external_list;
     auto select_status = selector_->SelectExternalData(
-        external_list, std::chrono::milliseconds(200));
+        external_list, std::chrono::milliseconds(TASK_RECEIVE_SELECT_TIMEOUT),
+        TASK_RECEIVE_SELECT_BATCH);
+    if (select_status != STATUS_SUCCESS &&
+        select_status != STATUS_TIMEDOUT) {
+      MBLOG_ERROR << "select task output failed, " << select_status;
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(TASK_RECEIVE_SELECT_TIMEOUT));
+    }
 
-    for (auto external : external_list) {
-      std::unique_lock<std::mutex> map_guard(map_lock_);
-      auto task_iter = external_task_maps_.find(external);
-      if (task_iter == external_task_maps_.end()) {
-        MBLOG_DEBUG << "task already deleted";
-        continue;
-      }
-      auto task = task_iter->second;
-      map_guard.unlock();
-
-      modelbox::OutputBufferList map_buffer_list;
-      auto status = external->Recv(map_buffer_list);
-
-      std::unique_lock<std::mutex> guard(new_del_lock_);
-      if (status == STATUS_INVALID) {
-        MBLOG_WARN << "recv external failed";
-        auto error = external->GetLastError();
-        if (error->GetDesc() == "EOF") {
-          task->UpdateTaskStatus(STOPPED);
-        } else {
-          task->UpdateTaskStatus(ABNORMAL);
-        }
-        avaiable_task_counts_--;
-      } else if (status == STATUS_EOF) {
-        MBLOG_DEBUG << "recv external finished";
-        task->UpdateTaskStatus(FINISHED);
-        avaiable_task_counts_--;
-      }
-      guard.unlock();
-      task->FetchData(status, map_buffer_list);
+    bool task_end = false;
+    for (const auto &external : external_list) {
+      task_end |= ReceiveTaskData(external);
+    }
+
+    // scan all tasks only when running slot may be released
+    if (task_end || select_status == STATUS_TIMEDOUT) {
+      StartWaittingTask();
     }
-    StartWaittingTask();
   }
 }
 
 Status TaskManager::Start() {
-  receive_thread_ =
-      std::make_shared<std::thread>(&TaskManager::ReceiveWork, this);
+  thread_run_ = true;
+  {
+    std::lock_guard<std::mutex> guard(new_del_lock_);
+    InitStatisticsLocked();
+  }
+  for (uint32_t i = 0; i < receive_thread_num_; ++i) {
+    receive_threads_.push_back(
+        std::make_shared<std::thread>(&TaskManager::ReceiveWork, this));
+  }
   return STATUS_SUCCESS;
 }
 
 void TaskManager::Stop() {
-  if (receive_thread_) {
-    thread_run_ = false;
-    receive_thread_->join();
-    receive_thread_ = nullptr;
+  thread_run_ = false;
+  for (auto &receive_thread : receive_threads_) {
+    receive_thread->join();
   }
+  receive_threads_.clear();
   if (thread_pool_) {
     thread_pool_->Shutdown();
   }
   selector_ = nullptr;
+  std::lock_guard<std::mutex> guard(new_del_lock_);
+  ClearStatisticsLocked();
+}
+
+void TaskManager::InitStatisticsLocked() {
+  auto flow = GetFlow();
+  if (flow == nullptr || graph_stats_ != nullptr) {
+    return;
+  }
+
+  graph_stats_ = Statistics::GetGlobalItem()->GetItem(
+      std::string(STATISTICS_ITEM_FLOW) + "." + flow->GetGraphId());
+  if (graph_stats_ == nullptr) {
+    return;
+  }
+
+  // flow.<graph_id>.task.<priority>.queue_time_us
+  auto task_stats = graph_stats_->AddItem("task");
+  if (task_stats == nullptr) {
+    return;
+  }
+
+  for (int i = 0; i < TASK_PRIORITY_NUM; ++i) {
+    auto &priority_class = priority_classes_[i];
+    auto class_stats = task_stats->AddItem(kTaskPriorityNames[i]);
+    if (class_stats == nullptr) {
+      continue;
+    }
+
+    auto item = class_stats->AddGauge("waiting");
+    priority_class.waiting_gauge = item ? item->GetGauge() : nullptr;
+    if (priority_class.waiting_gauge) {
+      priority_class.waiting_gauge->Set(priority_class.waiting_tasks.size());
+    }
+    item = class_stats->AddHistogram("queue_time_us");
+    priority_class.queue_time = item ? item->GetHistogram() : nullptr;
+    item = class_stats->AddCounter("rejected");
+    priority_class.rejected = item ? item->GetCounter() : nullptr;
+  }
+
+  auto running = task_stats->AddGauge("running");
+  auto inflight = task_stats->AddGauge("inflight_buffers");
+  if (running != nullptr && inflight != nullptr) {
+    running_gauge_ = running->GetGauge();
+    inflight_gauge_ = inflight->GetGauge();
+  }
+}
+
+void TaskManager::ClearStatisticsLocked() {
+  for (auto &priority_class : priority_classes_) {
+    priority_class.waiting_gauge = nullptr;
+    priority_class.queue_time = nullptr;
+    priority_class.rejected = nullptr;
+  }
+
+  running_gauge_ = nullptr;
+  inflight_gauge_ = nullptr;
+  if (graph_stats_ != nullptr) {
+    graph_stats_->DelItem("task");
+    graph_stats_ = nullptr;
+  }
 }
 
 std::shared_ptr<Task> TaskManager::CreateTask(TaskType task_type) {
@@ -138,7 +391,87 @@ void TaskManager::SetTaskNumLimit(int task_limits) {
   task_num_limits_ = task_limits;
 }
 
-std::shared_ptr<Flow> TaskManager::GetFlow() { return flow_; }
+void TaskManager::SetAdmissionLimit(TaskPriority priority,
+                                    uint32_t max_waiting_tasks,
+                                    uint32_t max_queue_time_ms) {
+  if (priority >= TASK_PRIORITY_NUM) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(new_del_lock_);
+  priority_classes_[priority].max_waiting_tasks = max_waiting_tasks;
+  priority_classes_[priority].max_queue_time_ms = max_queue_time_ms;
+}
+
+void TaskManager::SetInflightBufferLimit(uint64_t buffer_limit) {
+  std::lock_guard<std::mutex> guard(new_del_lock_);
+  inflight_buffer_limit_ = buffer_limit;
+}
+
+void TaskManager::SetConfig(const std::shared_ptr<Configuration> &config) {
+  if (config == nullptr) {
+    return;
+  }
+
+  SetReceiveThreadNum(config->GetUint32(TASK_CONFIG_RECEIVE_THREAD_NUM, 1));
+  SetInflightBufferLimit(
+      config->GetUint64(TASK_CONFIG_INFLIGHT_BUFFER_LIMIT, 0));
+  for (int i = 0; i < TASK_PRIORITY_NUM; ++i) {
+    auto prefix = std::string("task.") + kTaskPriorityNames[i] + ".";
+    auto max_waiting_tasks =
+        config->GetUint32(prefix + TASK_CONFIG_MAX_WAITING_TASKS, 0);
+    auto max_queue_time_ms =
+        config->GetUint32(prefix + TASK_CONFIG_MAX_QUEUE_TIME_MS, 0);
+    if (max_waiting_tasks > 0 || max_queue_time_ms > 0) {
+      MBLOG_INFO << "task priority " << kTaskPriorityNames[i]
+                 << " max waiting tasks " << max_waiting_tasks
+                 << ", max queue time " << max_queue_time_ms << "ms";
+    }
+
+    SetAdmissionLimit((TaskPriority)i, max_waiting_tasks, max_queue_time_ms);
+  }
+}
+
+void TaskManager::SetClock(const std::function<int64_t()> &clock) {
+  clock_ = clock;
+}
+
+int64_t TaskManager::Now() const {
+  if (clock_ != nullptr) {
+    return clock_();
+  }
+
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint64_t TaskManager::GetTaskLatency() { return task_latency_us_; }
+
+void TaskManager::SetReceiveThreadNum(uint32_t thread_num) {
+  receive_thread_num_ = thread_num > 0 ? thread_num : 1;
+}
+
+void TaskManager::SetFlow(std::shared_ptr<Flow> flow) {
+  std::lock_guard<std::mutex> guard(flow_lock_);
+  flow_ = flow;
+}
+
+void TaskManager::RebindStatistics() {
+  std::lock_guard<std::mutex> guard(new_del_lock_);
+  // not started or already stopped
+  if (graph_stats_ == nullptr) {
+    return;
+  }
+
+  ClearStatisticsLocked();
+  InitStatisticsLocked();
+}
+
+std::shared_ptr<Flow> TaskManager::GetFlow() {
+  std::lock_guard<std::mutex> guard(flow_lock_);
+  return flow_;
+}
 std::shared_ptr<ExternalDataSelect> TaskManager::GetSelector() {
   return selector_;
 }
@@ -156,6 +489,7 @@ Status TaskManager::DeleteTaskById(std::string taskid) {
   task->Stop();
 
   selector_->RemoveExternalData(external_data);
+  guard.lock();
   external_task_maps_.erase(external_data);
   return STATUS_SUCCESS;
 }
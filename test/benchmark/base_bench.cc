@@ -0,0 +1,140 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <future>
+#include <vector>
+
+#include "modelbox/base/blocking_queue.h"
+#include "modelbox/base/memory_pool.h"
+#include "modelbox/base/thread_pool.h"
+
+namespace modelbox {
+
+static void BM_BlockingQueuePushPop(benchmark::State &state) {
+  BlockingQueue<int> queue(1024);
+  int value = 0;
+  for (auto _ : state) {
+    queue.Push(1, 0);
+    queue.Pop(&value, 0);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BlockingQueuePushPop);
+
+static void BM_BlockingQueueBatch(benchmark::State &state) {
+  BlockingQueue<int> queue(SIZE_MAX);
+  std::vector<int> in(state.range(0), 1);
+  std::vector<int> out;
+  out.reserve(state.range(0));
+  for (auto _ : state) {
+    auto batch = in;
+    queue.Push(&batch, 0);
+    out.clear();
+    queue.PopBatch(&out, 0);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BlockingQueueBatch)->Arg(8)->Arg(64)->Arg(512);
+
+// even threads produce and odd threads consume, iterations of each thread
+// are equal, so producers and consumers are balanced
+static BlockingQueue<int> contended_queue(1024);
+
+static void BM_BlockingQueueContended(benchmark::State &state) {
+  bool producer = state.thread_index() % 2 == 0;
+  int value = 0;
+  for (auto _ : state) {
+    if (producer) {
+      contended_queue.Push(1, 0);
+    } else {
+      contended_queue.Pop(&value, 0);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BlockingQueueContended)->Threads(2)->Threads(8)->UseRealTime();
+
+static void BM_ThreadPoolSubmitWait(benchmark::State &state) {
+  ThreadPool pool(state.range(0));
+  for (auto _ : state) {
+    auto future = pool.Submit([]() { return 0; });
+    benchmark::DoNotOptimize(future.get());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ThreadPoolSubmitWait)->Arg(1)->Arg(8)->UseRealTime();
+
+static void BM_ThreadPoolSubmitBatch(benchmark::State &state) {
+  const size_t batch = 1000;
+  ThreadPool pool(state.range(0));
+  std::vector<std::future<int>> futures;
+  futures.reserve(batch);
+  for (auto _ : state) {
+    futures.clear();
+    for (size_t i = 0; i < batch; ++i) {
+      futures.push_back(pool.Submit([]() { return 0; }));
+    }
+
+    for (auto &future : futures) {
+      future.wait();
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_ThreadPoolSubmitBatch)->Arg(1)->Arg(8)->UseRealTime();
+
+static void BM_MemoryPoolAlloc(benchmark::State &state) {
+  MemoryPoolBase pool;
+  pool.InitSlabCache();
+  size_t size = state.range(0);
+  for (auto _ : state) {
+    auto ptr = pool.AllocSharedPtr(size);
+    benchmark::DoNotOptimize(ptr.get());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  pool.DestroySlabCache();
+}
+BENCHMARK(BM_MemoryPoolAlloc)->Arg(64)->Arg(4 * 1024)->Arg(1024 * 1024);
+
+static void BM_MemoryPoolAllocBurst(benchmark::State &state) {
+  const size_t burst = 256;
+  MemoryPoolBase pool;
+  pool.InitSlabCache();
+  size_t size = state.range(0);
+  std::vector<std::shared_ptr<void>> ptrs;
+  ptrs.reserve(burst);
+  for (auto _ : state) {
+    for (size_t i = 0; i < burst; ++i) {
+      ptrs.push_back(pool.AllocSharedPtr(size));
+    }
+
+    ptrs.clear();
+  }
+
+  state.SetItemsProcessed(state.iterations() * burst);
+  pool.DestroySlabCache();
+}
+BENCHMARK(BM_MemoryPoolAllocBurst)->Arg(64)->Arg(4 * 1024);
+
+}  // namespace modelbox
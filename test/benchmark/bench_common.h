@@ -0,0 +1,33 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODELBOX_BENCH_COMMON_H_
+#define MODELBOX_BENCH_COMMON_H_
+
+#include <memory>
+
+#include "modelbox/base/device.h"
+
+namespace modelbox {
+
+/**
+ * @brief Cpu device shared by all benchmarks, created in main
+ */
+std::shared_ptr<Device> GetBenchDevice();
+
+}  // namespace modelbox
+
+#endif  // MODELBOX_BENCH_COMMON_H_
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "bench_common.h"
+#include "modelbox/base/configuration.h"
+#include "modelbox/base/driver.h"
+#include "modelbox/base/log.h"
+#include "modelbox/base/utils.h"
+#include "test_config.h"
+
+namespace modelbox {
+
+static std::shared_ptr<Device> bench_device;
+
+std::shared_ptr<Device> GetBenchDevice() { return bench_device; }
+
+static Status InitBenchDevice() {
+  auto device_cpu_dest_path =
+      std::string(TEST_LIB_DIR) + "/libmodelbox-device-cpu.so";
+  CopyFile(DEVICE_CPU_SO_PATH, device_cpu_dest_path, 0, true);
+
+  auto drivers = Drivers::GetInstance();
+  if (!drivers->Scan(TEST_LIB_DIR, "libmodelbox-device-cpu.so")) {
+    return {STATUS_NOTFOUND, "scan cpu device driver failed"};
+  }
+
+  ConfigurationBuilder config_builder;
+  auto device_mgr = DeviceManager::GetInstance();
+  auto ret = device_mgr->Initialize(drivers, config_builder.Build());
+  if (!ret) {
+    return ret;
+  }
+
+  bench_device = device_mgr->CreateDevice("cpu", "0");
+  if (bench_device == nullptr) {
+    return {STATUS_FAULT, "create cpu device failed"};
+  }
+
+  return STATUS_OK;
+}
+
+static void ExitBenchDevice() {
+  bench_device = nullptr;
+  DeviceManager::GetInstance()->Clear();
+  Drivers::GetInstance()->Clear();
+}
+
+}  // namespace modelbox
+
+int main(int argc, char **argv) {
+  // log in hot path would be measured, keep it quiet
+  if (getenv("MODELBOX_CONSOLE_LOGLEVEL") == nullptr) {
+    ModelBoxLogger.GetLogger()->SetLogLevel(modelbox::LOG_WARN);
+  }
+
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  auto ret = modelbox::InitBenchDevice();
+  if (!ret) {
+    fprintf(stderr, "init bench device failed, %s\n",
+            ret.WrapErrormsgs().c_str());
+    return 1;
+  }
+
+  ::benchmark::RunSpecifiedBenchmarks();
+  modelbox::ExitBenchDevice();
+  return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_common.h"
+#include "modelbox/buffer.h"
+#include "modelbox/buffer_index_info.h"
+#include "modelbox/buffer_list.h"
+#include "modelbox/match_stream.h"
+
+namespace modelbox {
+
+static void BM_BufferBuild(benchmark::State &state) {
+  auto device = GetBenchDevice();
+  size_t size = state.range(0);
+  for (auto _ : state) {
+    auto buffer = std::make_shared<Buffer>(device);
+    buffer->Build(size);
+    benchmark::DoNotOptimize(buffer->ConstData());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BufferBuild)->Arg(64)->Arg(64 * 1024)->Arg(4 * 1024 * 1024);
+
+static void BM_BufferListBuild(benchmark::State &state) {
+  auto device = GetBenchDevice();
+  std::vector<size_t> sizes(state.range(0), 4096);
+  bool contiguous = state.range(1) != 0;
+  for (auto _ : state) {
+    BufferList buffer_list(device);
+    buffer_list.Build(sizes, contiguous);
+    benchmark::DoNotOptimize(buffer_list.Size());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BufferListBuild)
+    ->Args({8, 1})
+    ->Args({8, 0})
+    ->Args({128, 1})
+    ->Args({128, 0});
+
+static void BM_BufferMetaSet(benchmark::State &state) {
+  auto buffer = std::make_shared<Buffer>(GetBenchDevice());
+  int32_t width = 1920;
+  for (auto _ : state) {
+    buffer->Set("width", width);
+    buffer->Set("pix_fmt", std::string("nv12"));
+  }
+
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_BufferMetaSet);
+
+static void BM_BufferMetaGet(benchmark::State &state) {
+  auto buffer = std::make_shared<Buffer>(GetBenchDevice());
+  buffer->Set("width", (int32_t)1920);
+  buffer->Set("pix_fmt", std::string("nv12"));
+  int32_t width = 0;
+  std::string pix_fmt;
+  for (auto _ : state) {
+    buffer->Get("width", width);
+    buffer->Get("pix_fmt", pix_fmt);
+    benchmark::DoNotOptimize(width);
+  }
+
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_BufferMetaGet);
+
+static void BM_DeviceMemoryCombine(benchmark::State &state) {
+  auto device = GetBenchDevice();
+  const size_t block_size = 4096;
+  size_t block_num = state.range(0);
+  bool contiguous = state.range(1) != 0;
+  std::vector<std::shared_ptr<DeviceMemory>> mem_list;
+  if (contiguous) {
+    auto mem = device->MemAlloc(block_size * block_num);
+    for (size_t i = 0; i < block_num; ++i) {
+      mem_list.push_back(mem->Cut(i * block_size, block_size));
+    }
+  } else {
+    for (size_t i = 0; i < block_num; ++i) {
+      mem_list.push_back(device->MemAlloc(block_size));
+    }
+  }
+
+  for (auto _ : state) {
+    auto mem = DeviceMemory::Combine(mem_list);
+    benchmark::DoNotOptimize(mem.get());
+  }
+
+  state.SetBytesProcessed(state.iterations() * block_size * block_num);
+}
+BENCHMARK(BM_DeviceMemoryCombine)
+    ->Args({16, 1})
+    ->Args({16, 0})
+    ->Args({256, 1})
+    ->Args({256, 0});
+
+static void BM_MatchStreamCache(benchmark::State &state) {
+  const size_t batch = 64;
+  std::vector<std::string> ports;
+  std::unordered_map<std::string, size_t> stream_count_each_port;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    ports.push_back("in_" + std::to_string(i));
+    stream_count_each_port[ports.back()] = 1;
+  }
+
+  MatchStreamCache cache("bench", ports.size(), &stream_count_each_port);
+  size_t index = 0;
+  std::vector<std::shared_ptr<Buffer>> buffers;
+  for (auto _ : state) {
+    state.PauseTiming();
+    buffers.clear();
+    for (size_t i = 0; i < batch; ++i) {
+      for (size_t j = 0; j < ports.size(); ++j) {
+        auto buffer = std::make_shared<Buffer>();
+        auto index_info = std::make_shared<BufferIndexInfo>();
+        index_info->SetIndex(index + i);
+        BufferManageView::SetIndexInfo(buffer, index_info);
+        buffers.push_back(buffer);
+      }
+    }
+    state.ResumeTiming();
+
+    // ports receive the same buffer index in turn
+    for (size_t i = 0; i < buffers.size(); ++i) {
+      cache.CacheBuffer(ports[i % ports.size()], buffers[i]);
+    }
+
+    auto ready = cache.PopReadyMatchBuffers(true, false);
+    benchmark::DoNotOptimize(ready.get());
+    index += batch;
+  }
+
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_MatchStreamCache)->Arg(1)->Arg(4);
+
+}  // namespace modelbox
@@ -0,0 +1,126 @@
+#
+# Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+"""Compare google benchmark json result with a baseline result.
+
+Usage: compare_baseline.py BASELINE CURRENT [--threshold 0.1]
+                           [--metric real_time] [--update]
+
+Benchmarks slower than baseline by more than threshold are reported as
+regression and the script exits with 1. When baseline does not exist, or
+--update is given, current result is saved as the new baseline.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import sys
+
+
+def load_results(path, metric):
+    with open(path) as f:
+        data = json.load(f)
+
+    results = {}
+    for bench in data.get("benchmarks", []):
+        if bench.get("error_occurred"):
+            continue
+
+        # with repetitions, compare median only
+        run_type = bench.get("run_type", "iteration")
+        if run_type == "aggregate":
+            if bench.get("aggregate_name") != "median":
+                continue
+            name = bench["run_name"]
+        else:
+            name = bench["name"]
+            if name in results:
+                continue
+
+        results[name] = (bench[metric], bench.get("time_unit", "ns"))
+
+    return results
+
+
+def to_ns(value, unit):
+    scale = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}
+    return value * scale.get(unit, 1)
+
+
+def compare(baseline, current, threshold):
+    regressions = []
+    print("%-56s %14s %14s %9s" % ("Benchmark", "Baseline(ns)", "Current(ns)",
+                                   "Change"))
+    for name in sorted(current):
+        cur_ns = to_ns(*current[name])
+        if name not in baseline:
+            print("%-56s %14s %14.1f %9s" % (name, "-", cur_ns, "new"))
+            continue
+
+        base_ns = to_ns(*baseline[name])
+        change = (cur_ns - base_ns) / base_ns if base_ns > 0 else 0
+        mark = ""
+        if change > threshold:
+            mark = " <- regression"
+            regressions.append(name)
+
+        print("%-56s %14.1f %14.1f %+8.1f%%%s" % (name, base_ns, cur_ns,
+                                                 change * 100, mark))
+
+    for name in sorted(set(baseline) - set(current)):
+        print("%-56s %14.1f %14s %9s" % (name, to_ns(*baseline[name]), "-",
+                                         "removed"))
+
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="compare benchmark result with baseline")
+    parser.add_argument("baseline", help="baseline json file")
+    parser.add_argument("current", help="current json file")
+    parser.add_argument("--threshold", type=float, default=0.1,
+                        help="max allowed slowdown ratio, default 0.1")
+    parser.add_argument("--metric", default="real_time",
+                        choices=["real_time", "cpu_time"],
+                        help="time to compare, default real_time")
+    parser.add_argument("--update", action="store_true",
+                        help="save current result as baseline")
+    args = parser.parse_args()
+
+    if not os.path.exists(args.current):
+        print("result file %s not found" % args.current)
+        return 1
+
+    if args.update or not os.path.exists(args.baseline):
+        shutil.copyfile(args.current, args.baseline)
+        print("save baseline to %s" % args.baseline)
+        return 0
+
+    baseline = load_results(args.baseline, args.metric)
+    current = load_results(args.current, args.metric)
+    regressions = compare(baseline, current, args.threshold)
+    if regressions:
+        print("%d benchmark regressed more than %.0f%%" %
+              (len(regressions), args.threshold * 100))
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
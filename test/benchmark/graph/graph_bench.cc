@@ -0,0 +1,721 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <thread>
+
+#include "flowunit_mockflowunit/flowunit_mockflowunit.h"
+#include "gmock/gmock.h"
+#include "mockflow.h"
+#include "modelbox/base/log.h"
+#include "modelbox/buffer.h"
+#include "modelbox/data_context.h"
+#include "modelbox/flow.h"
+#include "test_config.h"
+
+namespace modelbox {
+
+// steady time when the buffer is sent into the graph
+constexpr const char *BENCH_SEND_TIME = "bench_send_ns";
+constexpr const char *BENCH_LOOP_COUNT = "bench_loop";
+constexpr int32_t BENCH_RECV_TIMEOUT = 1000;
+
+enum GRAPH_BENCH_OPTION {
+  GRAPH_BENCH_OPT_SHAPE,
+  GRAPH_BENCH_OPT_DEPTH,
+  GRAPH_BENCH_OPT_WIDTH,
+  GRAPH_BENCH_OPT_WORK,
+  GRAPH_BENCH_OPT_WORK_US,
+  GRAPH_BENCH_OPT_BATCH,
+  GRAPH_BENCH_OPT_RATE,
+  GRAPH_BENCH_OPT_COUNT,
+  GRAPH_BENCH_OPT_SESSIONS,
+  GRAPH_BENCH_OPT_JSON,
+  GRAPH_BENCH_OPT_HELP,
+};
+
+static struct option graph_bench_options[] = {
+    {"shape", 1, 0, GRAPH_BENCH_OPT_SHAPE},
+    {"depth", 1, 0, GRAPH_BENCH_OPT_DEPTH},
+    {"width", 1, 0, GRAPH_BENCH_OPT_WIDTH},
+    {"work", 1, 0, GRAPH_BENCH_OPT_WORK},
+    {"work-us", 1, 0, GRAPH_BENCH_OPT_WORK_US},
+    {"batch", 1, 0, GRAPH_BENCH_OPT_BATCH},
+    {"rate", 1, 0, GRAPH_BENCH_OPT_RATE},
+    {"count", 1, 0, GRAPH_BENCH_OPT_COUNT},
+    {"sessions", 1, 0, GRAPH_BENCH_OPT_SESSIONS},
+    {"json", 1, 0, GRAPH_BENCH_OPT_JSON},
+    {"help", 0, 0, GRAPH_BENCH_OPT_HELP},
+    {0, 0, 0, 0},
+};
+
+enum class BenchWork { PASS, SLEEP, BURN };
+
+struct GraphBenchConfig {
+  std::string shape{"chain"};
+  uint32_t depth{4};
+  uint32_t width{2};
+  std::string work{"pass"};
+  BenchWork work_type{BenchWork::PASS};
+  uint32_t work_us{0};
+  uint32_t batch_size{8};
+  // buffers per second of all sessions, 0 is unlimited
+  uint32_t rate{0};
+  uint32_t count{10000};
+  uint32_t sessions{1};
+  std::string json_path;
+};
+
+struct GraphBenchResult {
+  uint64_t sent{0};
+  uint64_t received{0};
+  uint32_t hops{0};
+  double elapsed_s{0};
+  std::vector<uint64_t> latency_ns;
+  Status status{STATUS_OK};
+};
+
+static void PrintHelp() {
+  char help[] =
+      "usage: graph-bench [option]\n"
+      " option:\n"
+      "   --shape [chain|fanout|condition|expand|loop]  graph shape\n"
+      "   --depth [num]         pass node number of chain or branch, loop "
+      "times\n"
+      "   --width [num]         branch number of fanout, children of expand\n"
+      "   --work [pass|sleep|burn]  work of each node per buffer\n"
+      "   --work-us [us]        sleep or cpu burn time per buffer\n"
+      "   --batch [num]         default batch size of flowunit\n"
+      "   --rate [num]          input buffers per second, 0 is unlimited\n"
+      "   --count [num]         input buffer number\n"
+      "   --sessions [num]      concurrent session number\n"
+      "   --json [file]         write result to json file\n"
+      "\n";
+  std::cerr << help;
+}
+
+static inline int64_t SteadyNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static void DoWork(BenchWork work_type, uint32_t work_us) {
+  if (work_us == 0) {
+    return;
+  }
+
+  if (work_type == BenchWork::SLEEP) {
+    std::this_thread::sleep_for(std::chrono::microseconds(work_us));
+    return;
+  }
+
+  if (work_type == BenchWork::BURN) {
+    auto end = std::chrono::steady_clock::now() +
+               std::chrono::microseconds(work_us);
+    while (std::chrono::steady_clock::now() < end) {
+    }
+  }
+}
+
+/**
+ * Synthetic flowunits, buffers are forwarded so that the send time meta
+ * survives every hop
+ */
+static void RegisterPassFlowUnit(MockFlow *mock_flow,
+                                 const GraphBenchConfig &config) {
+  auto mock_desc = GenerateFlowunitDesc("bench_pass", {"In_1"}, {"Out_1"});
+  mock_desc->SetDefaultBatchSize(config.batch_size);
+  auto mock_funcitons = std::make_shared<MockFunctionCollection>();
+  auto work_type = config.work_type;
+  auto work_us = config.work_us;
+  auto process_func =
+      [=](std::shared_ptr<DataContext> ctx,
+          std::shared_ptr<MockFlowUnit> mock_flowunit) -> Status {
+    auto input_bufs = ctx->Input("In_1");
+    auto output_bufs = ctx->Output("Out_1");
+    for (size_t i = 0; i < input_bufs->Size(); ++i) {
+      DoWork(work_type, work_us);
+      output_bufs->PushBack(input_bufs->At(i));
+    }
+
+    return STATUS_OK;
+  };
+  mock_funcitons->RegisterProcessFunc(process_func);
+  mock_flow->AddFlowUnitDesc(mock_desc, mock_funcitons->GenerateCreateFunc());
+}
+
+static void RegisterMergeFlowUnit(MockFlow *mock_flow,
+                                  const GraphBenchConfig &config) {
+  std::set<std::string> inputs;
+  for (uint32_t i = 0; i < config.width; ++i) {
+    inputs.insert("In_" + std::to_string(i + 1));
+  }
+
+  auto mock_desc = GenerateFlowunitDesc("bench_merge", inputs, {"Out_1"});
+  mock_desc->SetDefaultBatchSize(config.batch_size);
+  auto mock_funcitons = std::make_shared<MockFunctionCollection>();
+  auto process_func =
+      [=](std::shared_ptr<DataContext> ctx,
+          std::shared_ptr<MockFlowUnit> mock_flowunit) -> Status {
+    // inputs are matched, all branches carry the same buffer
+    auto input_bufs = ctx->Input("In_1");
+    auto output_bufs = ctx->Output("Out_1");
+    for (size_t i = 0; i < input_bufs->Size(); ++i) {
+      output_bufs->PushBack(input_bufs->At(i));
+    }
+
+    return STATUS_OK;
+  };
+  mock_funcitons->RegisterProcessFunc(process_func);
+  mock_flow->AddFlowUnitDesc(mock_desc, mock_funcitons->GenerateCreateFunc());
+}
+
+static void RegisterConditionFlowUnit(MockFlow *mock_flow,
+                                      const GraphBenchConfig &config) {
+  auto mock_desc =
+      GenerateFlowunitDesc("bench_condition", {"In_1"}, {"Out_1", "Out_2"});
+  mock_desc->SetConditionType(IF_ELSE);
+  auto mock_funcitons = std::make_shared<MockFunctionCollection>();
+  auto process_func =
+      [=](std::shared_ptr<DataContext> ctx,
+          std::shared_ptr<MockFlowUnit> mock_flowunit) -> Status {
+    auto input_bufs = ctx->Input("In_1");
+    auto output_bufs_1 = ctx->Output("Out_1");
+    auto output_bufs_2 = ctx->Output("Out_2");
+    for (size_t i = 0; i < input_bufs->Size(); ++i) {
+      auto buffer = input_bufs->At(i);
+      auto seq = *(const int *)buffer->ConstData();
+      if (seq % 2 == 0) {
+        output_bufs_1->PushBack(buffer);
+      } else {
+        output_bufs_2->PushBack(buffer);
+      }
+    }
+
+    return STATUS_OK;
+  };
+  mock_funcitons->RegisterProcessFunc(process_func);
+  mock_flow->AddFlowUnitDesc(mock_desc, mock_funcitons->GenerateCreateFunc());
+}
+
+static void RegisterExpandFlowUnit(MockFlow *mock_flow,
+                                   const GraphBenchConfig &config) {
+  auto mock_desc = GenerateFlowunitDesc("bench_expand", {"In_1"}, {"Out_1"});
+  mock_desc->SetOutputType(EXPAND);
+  auto mock_funcitons = std::make_shared<MockFunctionCollection>();
+  auto width = config.width;
+  auto process_func =
+      [=](std::shared_ptr<DataContext> ctx,
+          std::shared_ptr<MockFlowUnit> mock_flowunit) -> Status {
+    auto input_buf = ctx->Input("In_1")->At(0);
+    auto output_bufs = ctx->Output("Out_1");
+    output_bufs->Build(std::vector<size_t>(width, sizeof(int)));
+    for (size_t i = 0; i < output_bufs->Size(); ++i) {
+      auto buffer = output_bufs->At(i);
+      buffer->CopyMeta(input_buf);
+      *(int *)buffer->MutableData() = *(const int *)input_buf->ConstData();
+    }
+
+    return STATUS_OK;
+  };
+  mock_funcitons->RegisterProcessFunc(process_func);
+  mock_flow->AddFlowUnitDesc(mock_desc, mock_funcitons->GenerateCreateFunc());
+}
+
+static void RegisterCollapseFlowUnit(MockFlow *mock_flow,
+                                     const GraphBenchConfig &config) {
+  auto mock_desc =
+      GenerateFlowunitDesc("bench_collapse", {"In_1"}, {"Out_1"});
+  mock_desc->SetOutputType(COLLAPSE);
+  mock_desc->SetCollapseAll(true);
+  auto mock_funcitons = std::make_shared<MockFunctionCollection>();
+  auto process_func =
+      [=](std::shared_ptr<DataContext> ctx,
+          std::shared_ptr<MockFlowUnit> mock_flowunit) -> Status {
+    auto input_bufs = ctx->Input("In_1");
+    auto output_bufs = ctx->Output("Out_1");
+    output_bufs->Build({sizeof(int)});
+    auto buffer = output_bufs->At(0);
+    buffer->CopyMeta(input_bufs->At(0));
+    *(int *)buffer->MutableData() = *(const int *)input_bufs->ConstData();
+    return STATUS_OK;
+  };
+  mock_funcitons->RegisterProcessFunc(process_func);
+  mock_flow->AddFlowUnitDesc(mock_desc, mock_funcitons->GenerateCreateFunc());
+}
+
+static void RegisterLoopFlowUnit(MockFlow *mock_flow,
+                                 const GraphBenchConfig &config) {
+  auto mock_desc =
+      GenerateFlowunitDesc("bench_loop", {"In_1"}, {"Out_1", "Out_2"});
+  mock_desc->SetDefaultBatchSize(1);
+  mock_desc->SetLoopType(LOOP);
+  auto mock_funcitons = std::make_shared<MockFunctionCollection>();
+  auto work_type = config.work_type;
+  auto work_us = config.work_us;
+  int loop_times = config.depth;
+  auto process_func =
+      [=](std::shared_ptr<DataContext> ctx,
+          std::shared_ptr<MockFlowUnit> mock_flowunit) -> Status {
+    auto input_bufs = ctx->Input("In_1");
+    auto output_bufs_1 = ctx->Output("Out_1");
+    auto output_bufs_2 = ctx->Output("Out_2");
+    auto device = mock_flowunit->GetBindDevice();
+    for (size_t i = 0; i < input_bufs->Size(); ++i) {
+      DoWork(work_type, work_us);
+      auto input_buf = input_bufs->At(i);
+      int count = 0;
+      input_buf->Get(BENCH_LOOP_COUNT, count);
+      auto buffer = std::make_shared<Buffer>(device);
+      buffer->Build(sizeof(int));
+      buffer->CopyMeta(input_buf);
+      buffer->Set(BENCH_LOOP_COUNT, ++count);
+      *(int *)buffer->MutableData() = *(const int *)input_buf->ConstData();
+      if (count >= loop_times) {
+        output_bufs_2->PushBack(buffer);
+      } else {
+        output_bufs_1->PushBack(buffer);
+      }
+    }
+
+    return STATUS_OK;
+  };
+  mock_funcitons->RegisterProcessFunc(process_func);
+  mock_flow->AddFlowUnitDesc(mock_desc, mock_funcitons->GenerateCreateFunc());
+}
+
+static std::string BenchNode(const std::string &name,
+                             const std::string &flowunit) {
+  return "    " + name + "[type=flowunit, flowunit=" + flowunit +
+         ", device=cpu, deviceid=0]\n";
+}
+
+static std::string BenchLink(const std::string &from, const std::string &to) {
+  return "    " + from + " -> " + to + "\n";
+}
+
+/**
+ * Append a chain of pass nodes
+ * @return output port of the last node
+ */
+static std::string AppendChain(std::ostringstream &graph,
+                               const std::string &prefix, uint32_t depth,
+                               const std::string &from) {
+  auto last = from;
+  for (uint32_t i = 0; i < depth; ++i) {
+    auto name = prefix + std::to_string(i);
+    graph << BenchNode(name, "bench_pass");
+    graph << BenchLink(last, name + ":In_1");
+    last = name + ":Out_1";
+  }
+
+  return last;
+}
+
+/**
+ * Generate graph of shape, hops is node number on the path of one buffer
+ */
+static Status GenerateGraph(const GraphBenchConfig &config,
+                            std::string *graph_conf, uint32_t *hops) {
+  std::ostringstream graph;
+  graph << "digraph bench {\n";
+  graph << "    input[type=input]\n";
+  graph << "    output[type=output]\n";
+  if (config.shape == "chain") {
+    auto last = AppendChain(graph, "pass_", config.depth, "input");
+    graph << BenchLink(last, "output");
+    *hops = config.depth;
+  } else if (config.shape == "fanout") {
+    graph << BenchNode("split", "bench_pass");
+    graph << BenchNode("merge", "bench_merge");
+    graph << BenchLink("input", "split:In_1");
+    for (uint32_t i = 0; i < config.width; ++i) {
+      auto prefix = "branch_" + std::to_string(i) + "_";
+      auto last = AppendChain(graph, prefix, config.depth, "split:Out_1");
+      graph << BenchLink(last, "merge:In_" + std::to_string(i + 1));
+    }
+    graph << BenchLink("merge:Out_1", "output");
+    *hops = config.depth + 2;
+  } else if (config.shape == "condition") {
+    graph << BenchNode("condition", "bench_condition");
+    graph << BenchNode("join", "bench_pass");
+    graph << BenchLink("input", "condition:In_1");
+    auto last = AppendChain(graph, "true_", config.depth, "condition:Out_1");
+    graph << BenchLink(last, "join:In_1");
+    last = AppendChain(graph, "false_", config.depth, "condition:Out_2");
+    graph << BenchLink(last, "join:In_1");
+    graph << BenchLink("join:Out_1", "output");
+    *hops = config.depth + 2;
+  } else if (config.shape == "expand") {
+    graph << BenchNode("expand", "bench_expand");
+    graph << BenchNode("collapse", "bench_collapse");
+    graph << BenchLink("input", "expand:In_1");
+    auto last = AppendChain(graph, "pass_", config.depth, "expand:Out_1");
+    graph << BenchLink(last, "collapse:In_1");
+    graph << BenchLink("collapse:Out_1", "output");
+    *hops = config.depth + 2;
+  } else if (config.shape == "loop") {
+    graph << BenchNode("loop", "bench_loop");
+    graph << BenchLink("input", "loop:In_1");
+    graph << BenchLink("loop:Out_1", "loop:In_1");
+    graph << BenchLink("loop:Out_2", "output");
+    *hops = config.depth;
+  } else {
+    return {STATUS_INVALID, "unsupported graph shape " + config.shape};
+  }
+
+  graph << "}";
+  *graph_conf = graph.str();
+  return STATUS_OK;
+}
+
+static void RunSession(std::shared_ptr<Flow> flow,
+                       const GraphBenchConfig &config, uint32_t count,
+                       GraphBenchResult *result) {
+  auto external = flow->CreateExternalDataMap();
+  if (external == nullptr) {
+    result->status = {STATUS_FAULT, "create external data map failed"};
+    return;
+  }
+
+  Status send_status = STATUS_OK;
+  std::thread sender([&]() {
+    std::chrono::nanoseconds interval(0);
+    if (config.rate > 0) {
+      interval = std::chrono::nanoseconds((uint64_t)1000000000 *
+                                          config.sessions / config.rate);
+    }
+
+    auto next = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; ++i) {
+      if (interval.count() > 0) {
+        std::this_thread::sleep_until(next);
+        next += interval;
+      }
+
+      auto buffer_list = external->CreateBufferList();
+      buffer_list->Build({sizeof(int)});
+      auto buffer = buffer_list->At(0);
+      *(int *)buffer->MutableData() = i;
+      buffer->Set(BENCH_SEND_TIME, SteadyNs());
+      send_status = external->Send("input", buffer_list);
+      if (!send_status) {
+        break;
+      }
+
+      result->sent++;
+    }
+
+    external->Close();
+  });
+
+  while (true) {
+    OutputBufferList output;
+    auto ret = external->Recv(output, BENCH_RECV_TIMEOUT);
+    if (ret == STATUS_EOF) {
+      break;
+    }
+
+    if (!ret) {
+      result->status = ret;
+      external->Shutdown();
+      break;
+    }
+
+    auto iter = output.find("output");
+    if (iter == output.end()) {
+      continue;
+    }
+
+    auto now = SteadyNs();
+    for (auto &buffer : *iter->second) {
+      int64_t send_ns = 0;
+      if (buffer->Get(BENCH_SEND_TIME, send_ns)) {
+        result->latency_ns.push_back(now - send_ns);
+      }
+      result->received++;
+    }
+  }
+
+  sender.join();
+  if (!send_status) {
+    result->status = send_status;
+  }
+}
+
+static Status RunBench(const GraphBenchConfig &config,
+                       GraphBenchResult *result) {
+  std::string graph_conf;
+  auto ret = GenerateGraph(config, &graph_conf, &result->hops);
+  if (!ret) {
+    return ret;
+  }
+
+  auto mock_flow = std::make_shared<MockFlow>();
+  if (!mock_flow->Init(false)) {
+    return {STATUS_FAULT, "init mock flow failed"};
+  }
+
+  RegisterPassFlowUnit(mock_flow.get(), config);
+  RegisterMergeFlowUnit(mock_flow.get(), config);
+  RegisterConditionFlowUnit(mock_flow.get(), config);
+  RegisterExpandFlowUnit(mock_flow.get(), config);
+  RegisterCollapseFlowUnit(mock_flow.get(), config);
+  RegisterLoopFlowUnit(mock_flow.get(), config);
+
+  std::string toml_content = R"(
+    [driver]
+    skip-default=true
+    dir=[")" + std::string(TEST_LIB_DIR) +
+                             "\"]\n" + R"(
+    [graph]
+    graphconf = ''')" + graph_conf +
+                             R"('''
+    format = "graphviz"
+  )";
+
+  auto flow = std::make_shared<Flow>();
+  ret = flow->Init("graph_bench", toml_content);
+  if (!ret) {
+    return {ret, "init flow failed"};
+  }
+
+  ret = flow->Build();
+  if (!ret) {
+    return {ret, "build flow failed"};
+  }
+
+  flow->RunAsync();
+
+  std::vector<GraphBenchResult> session_results(config.sessions);
+  std::vector<std::thread> sessions;
+  auto begin = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < config.sessions; ++i) {
+    auto count = config.count / config.sessions +
+                 (i < config.count % config.sessions ? 1 : 0);
+    sessions.emplace_back(RunSession, flow, std::cref(config), count,
+                          &session_results[i]);
+  }
+
+  for (auto &session : sessions) {
+    session.join();
+  }
+
+  result->elapsed_s = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - begin)
+                          .count();
+  flow->Stop();
+
+  for (auto &session_result : session_results) {
+    result->sent += session_result.sent;
+    result->received += session_result.received;
+    result->latency_ns.insert(result->latency_ns.end(),
+                              session_result.latency_ns.begin(),
+                              session_result.latency_ns.end());
+    if (!session_result.status) {
+      result->status = session_result.status;
+    }
+  }
+
+  std::sort(result->latency_ns.begin(), result->latency_ns.end());
+  return result->status;
+}
+
+static double PercentileUs(const std::vector<uint64_t> &sorted_ns,
+                           double percentile) {
+  if (sorted_ns.empty()) {
+    return 0;
+  }
+
+  auto index = std::min(sorted_ns.size() - 1,
+                        (size_t)(percentile * sorted_ns.size()));
+  return sorted_ns[index] / 1000.0;
+}
+
+static void ReportResult(const GraphBenchConfig &config,
+                         const GraphBenchResult &result) {
+  double avg_us = 0;
+  for (auto latency : result.latency_ns) {
+    avg_us += latency / 1000.0;
+  }
+
+  if (!result.latency_ns.empty()) {
+    avg_us /= result.latency_ns.size();
+  }
+
+  auto throughput =
+      result.elapsed_s > 0 ? result.received / result.elapsed_s : 0;
+  // latency without node work, divided by node number on the path
+  double hop_overhead_us = 0;
+  if (result.hops > 0 && config.work_type != BenchWork::PASS) {
+    hop_overhead_us =
+        (avg_us - (double)config.work_us * result.hops) / result.hops;
+  } else if (result.hops > 0) {
+    hop_overhead_us = avg_us / result.hops;
+  }
+
+  nlohmann::json json;
+  json["shape"] = config.shape;
+  json["depth"] = config.depth;
+  json["width"] = config.width;
+  json["work"] = config.work;
+  json["work_us"] = config.work_us;
+  json["batch"] = config.batch_size;
+  json["rate"] = config.rate;
+  json["sessions"] = config.sessions;
+  json["hops"] = result.hops;
+  json["sent"] = result.sent;
+  json["received"] = result.received;
+  json["elapsed_s"] = result.elapsed_s;
+  json["buffers_per_second"] = throughput;
+  json["hop_overhead_us"] = hop_overhead_us;
+  json["latency_us"] = {{"avg", avg_us},
+                        {"p50", PercentileUs(result.latency_ns, 0.5)},
+                        {"p90", PercentileUs(result.latency_ns, 0.9)},
+                        {"p99", PercentileUs(result.latency_ns, 0.99)},
+                        {"p999", PercentileUs(result.latency_ns, 0.999)},
+                        {"max", PercentileUs(result.latency_ns, 1)}};
+
+  printf("shape %s, depth %u, width %u, hops %u, work %s %uus, batch %u\n",
+         config.shape.c_str(), config.depth, config.width, result.hops,
+         config.work.c_str(), config.work_us, config.batch_size);
+  auto rate = config.rate == 0 ? std::string("unlimited")
+                               : std::to_string(config.rate) + "/s";
+  printf("sessions %u, rate %s, sent %lu, received %lu, elapsed %.3fs\n",
+         config.sessions, rate.c_str(), (unsigned long)result.sent,
+         (unsigned long)result.received, result.elapsed_s);
+  printf("throughput %.1f buffers/s, per hop overhead %.2fus\n", throughput,
+         hop_overhead_us);
+  printf("latency us: avg %.1f, p50 %.1f, p90 %.1f, p99 %.1f, p999 %.1f, "
+         "max %.1f\n",
+         avg_us, PercentileUs(result.latency_ns, 0.5),
+         PercentileUs(result.latency_ns, 0.9),
+         PercentileUs(result.latency_ns, 0.99),
+         PercentileUs(result.latency_ns, 0.999),
+         PercentileUs(result.latency_ns, 1));
+
+  if (config.json_path.empty()) {
+    return;
+  }
+
+  std::ofstream out(config.json_path, std::ios::out | std::ios::trunc);
+  if (!out.is_open()) {
+    MBLOG_ERROR << "write result failed, file path : " << config.json_path;
+    return;
+  }
+
+  out << json.dump(2) << std::endl;
+}
+
+static Status ParseWork(GraphBenchConfig *config) {
+  if (config->work == "pass") {
+    config->work_type = BenchWork::PASS;
+  } else if (config->work == "sleep") {
+    config->work_type = BenchWork::SLEEP;
+  } else if (config->work == "burn") {
+    config->work_type = BenchWork::BURN;
+  } else {
+    return {STATUS_INVALID, "unsupported work " + config->work};
+  }
+
+  if (config->depth == 0 || config->width == 0 || config->batch_size == 0 ||
+      config->sessions == 0 || config->count < config->sessions) {
+    return {STATUS_INVALID,
+            "depth, width, batch must be positive, count must not be less "
+            "than sessions"};
+  }
+
+  return STATUS_OK;
+}
+
+}  // namespace modelbox
+
+int main(int argc, char **argv) {
+  // synthetic flowunits are gmock objects
+  testing::InitGoogleMock(&argc, argv);
+  if (getenv("MODELBOX_CONSOLE_LOGLEVEL") == nullptr) {
+    ModelBoxLogger.GetLogger()->SetLogLevel(modelbox::LOG_WARN);
+  }
+
+  modelbox::GraphBenchConfig config;
+  int cmdtype = 0;
+  while ((cmdtype = getopt_long_only(
+              argc, argv, "", modelbox::graph_bench_options, nullptr)) != -1) {
+    switch (cmdtype) {
+      case modelbox::GRAPH_BENCH_OPT_SHAPE:
+        config.shape = optarg;
+        break;
+      case modelbox::GRAPH_BENCH_OPT_DEPTH:
+        config.depth = atoi(optarg);
+        break;
+      case modelbox::GRAPH_BENCH_OPT_WIDTH:
+        config.width = atoi(optarg);
+        break;
+      case modelbox::GRAPH_BENCH_OPT_WORK:
+        config.work = optarg;
+        break;
+      case modelbox::GRAPH_BENCH_OPT_WORK_US:
+        config.work_us = atoi(optarg);
+        break;
+      case modelbox::GRAPH_BENCH_OPT_BATCH:
+        config.batch_size = atoi(optarg);
+        break;
+      case modelbox::GRAPH_BENCH_OPT_RATE:
+        config.rate = atoi(optarg);
+        break;
+      case modelbox::GRAPH_BENCH_OPT_COUNT:
+        config.count = atoi(optarg);
+        break;
+      case modelbox::GRAPH_BENCH_OPT_SESSIONS:
+        config.sessions = atoi(optarg);
+        break;
+      case modelbox::GRAPH_BENCH_OPT_JSON:
+        config.json_path = optarg;
+        break;
+      default:
+        modelbox::PrintHelp();
+        return 1;
+    }
+  }
+
+  auto ret = modelbox::ParseWork(&config);
+  if (!ret) {
+    fprintf(stderr, "%s\n", ret.WrapErrormsgs().c_str());
+    modelbox::PrintHelp();
+    return 1;
+  }
+
+  modelbox::GraphBenchResult result;
+  ret = modelbox::RunBench(config, &result);
+  if (!ret) {
+    fprintf(stderr, "run graph bench failed, %s\n",
+            ret.WrapErrormsgs().c_str());
+    return 1;
+  }
+
+  modelbox::ReportResult(config, result);
+  return 0;
+}
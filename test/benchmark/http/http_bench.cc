@@ -0,0 +1,545 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <getopt.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+#include "modelbox/base/log.h"
+#include "modelbox/flow.h"
+#include "test_config.h"
+
+namespace modelbox {
+
+constexpr const char *HTTP_BENCH_DEFAULT_URL = "http://127.0.0.1:54380/bench";
+constexpr size_t HTTP_BENCH_READ_SIZE = 64 * 1024;
+
+enum HTTP_BENCH_OPTION {
+  HTTP_BENCH_OPT_URL,
+  HTTP_BENCH_OPT_SERVER,
+  HTTP_BENCH_OPT_CONNECTIONS,
+  HTTP_BENCH_OPT_PIPELINE,
+  HTTP_BENCH_OPT_REQUESTS,
+  HTTP_BENCH_OPT_BODY_SIZE,
+  HTTP_BENCH_OPT_BATCH_WINDOW,
+  HTTP_BENCH_OPT_JSON,
+  HTTP_BENCH_OPT_HELP,
+};
+
+static struct option http_bench_options[] = {
+    {"url", 1, 0, HTTP_BENCH_OPT_URL},
+    {"server", 1, 0, HTTP_BENCH_OPT_SERVER},
+    {"connections", 1, 0, HTTP_BENCH_OPT_CONNECTIONS},
+    {"pipeline", 1, 0, HTTP_BENCH_OPT_PIPELINE},
+    {"requests", 1, 0, HTTP_BENCH_OPT_REQUESTS},
+    {"body-size", 1, 0, HTTP_BENCH_OPT_BODY_SIZE},
+    {"batch-window", 1, 0, HTTP_BENCH_OPT_BATCH_WINDOW},
+    {"json", 1, 0, HTTP_BENCH_OPT_JSON},
+    {"help", 0, 0, HTTP_BENCH_OPT_HELP},
+    {0, 0, 0, 0},
+};
+
+struct HttpBenchConfig {
+  std::string url{HTTP_BENCH_DEFAULT_URL};
+  // start echo graph of httpserver_sync in process
+  bool server{true};
+  // keep-alive connection pool size
+  uint32_t connections{16};
+  // requests sent on one connection before waiting responses
+  uint32_t pipeline{1};
+  uint32_t requests{100000};
+  uint32_t body_size{1024};
+  uint32_t batch_window_ms{0};
+  std::string json_path;
+
+  std::string host;
+  std::string port;
+  std::string path;
+};
+
+struct HttpBenchResult {
+  uint64_t sent{0};
+  uint64_t ok{0};
+  uint64_t errors{0};
+  uint64_t reconnects{0};
+  uint64_t bytes{0};
+  double elapsed_s{0};
+  std::vector<uint64_t> latency_ns;
+};
+
+static void PrintHelp() {
+  std::string help =
+      "usage: http-bench [option]\n"
+      " option:\n"
+      "   --url [url]           http url of server, default " +
+      std::string(HTTP_BENCH_DEFAULT_URL) +
+      "\n"
+      "   --server [on|off]     start echo graph in process, default on\n"
+      "   --connections [num]   keep-alive connection number\n"
+      "   --pipeline [num]      pipelined requests on one connection\n"
+      "   --requests [num]      total request number\n"
+      "   --body-size [bytes]   request body size\n"
+      "   --batch-window [ms]   batch window of in process server\n"
+      "   --json [file]         write result to json file\n"
+      "\n";
+  std::cerr << help;
+}
+
+static inline int64_t SteadyNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static Status ParseUrl(HttpBenchConfig *config) {
+  const std::string scheme = "http://";
+  if (config->url.compare(0, scheme.size(), scheme) != 0) {
+    return {STATUS_INVALID, "only http url is supported, " + config->url};
+  }
+
+  auto host_port = config->url.substr(scheme.size());
+  auto path_pos = host_port.find('/');
+  config->path = path_pos == std::string::npos ? "/" : host_port.substr(path_pos);
+  host_port = host_port.substr(0, path_pos);
+  auto port_pos = host_port.rfind(':');
+  config->host = host_port.substr(0, port_pos);
+  config->port =
+      port_pos == std::string::npos ? "80" : host_port.substr(port_pos + 1);
+  if (config->host.empty() || config->connections == 0 ||
+      config->pipeline == 0) {
+    return {STATUS_INVALID, "host, connections and pipeline must be set"};
+  }
+
+  return STATUS_OK;
+}
+
+/**
+ * One keep-alive connection of the pool, requests are pipelined up to depth
+ */
+class BenchConnection {
+ public:
+  BenchConnection(const HttpBenchConfig &config,
+                  std::atomic<int64_t> *remain, HttpBenchResult *result)
+      : config_(config), remain_(remain), result_(result) {
+    std::string body(config.body_size, 'x');
+    request_ = "POST " + config.path + " HTTP/1.1\r\nHost: " + config.host +
+               ":" + config.port +
+               "\r\nContent-Type: application/octet-stream\r\nContent-Length: " +
+               std::to_string(body.size()) + "\r\n\r\n" + body;
+    read_buffer_.resize(HTTP_BENCH_READ_SIZE);
+  }
+
+  virtual ~BenchConnection() { Disconnect(); }
+
+  void Run() {
+    while (true) {
+      if (fd_ < 0 && !Connect()) {
+        result_->errors += inflight_.size();
+        return;
+      }
+
+      // fill pipeline
+      while (inflight_.size() < config_.pipeline && remain_->fetch_sub(1) > 0) {
+        inflight_.push_back(SteadyNs());
+        if (!SendAll(request_)) {
+          break;
+        }
+
+        result_->sent++;
+      }
+
+      if (inflight_.empty()) {
+        return;
+      }
+
+      if (!ReadResponse()) {
+        // requests on the broken connection are lost
+        result_->errors += inflight_.size();
+        inflight_.clear();
+        Disconnect();
+        result_->reconnects++;
+      }
+    }
+  }
+
+ private:
+  bool Connect() {
+    struct addrinfo hints;
+    struct addrinfo *addrs = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(config_.host.c_str(), config_.port.c_str(), &hints,
+                    &addrs) != 0) {
+      MBLOG_ERROR << "resolve " << config_.host << " failed";
+      return false;
+    }
+
+    for (auto *addr = addrs; addr != nullptr; addr = addr->ai_next) {
+      fd_ = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+      if (fd_ < 0) {
+        continue;
+      }
+
+      if (connect(fd_, addr->ai_addr, addr->ai_addrlen) == 0) {
+        break;
+      }
+
+      close(fd_);
+      fd_ = -1;
+    }
+
+    freeaddrinfo(addrs);
+    if (fd_ < 0) {
+      MBLOG_ERROR << "connect " << config_.url << " failed, "
+                  << StrError(errno);
+      return false;
+    }
+
+    int nodelay = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    pending_.clear();
+    return true;
+  }
+
+  void Disconnect() {
+    if (fd_ >= 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  bool SendAll(const std::string &data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+      auto ret = send(fd_, data.data() + offset, data.size() - offset,
+                      MSG_NOSIGNAL);
+      if (ret < 0 && errno == EINTR) {
+        continue;
+      }
+
+      if (ret <= 0) {
+        return false;
+      }
+
+      offset += ret;
+    }
+
+    return true;
+  }
+
+  bool ReadMore() {
+    while (true) {
+      auto ret = recv(fd_, &read_buffer_[0], read_buffer_.size(), 0);
+      if (ret < 0 && errno == EINTR) {
+        continue;
+      }
+
+      if (ret <= 0) {
+        return false;
+      }
+
+      pending_.append(read_buffer_.data(), ret);
+      return true;
+    }
+  }
+
+  bool ReadResponse() {
+    size_t header_end = std::string::npos;
+    while ((header_end = pending_.find("\r\n\r\n")) == std::string::npos) {
+      if (!ReadMore()) {
+        return false;
+      }
+    }
+
+    auto header = pending_.substr(0, header_end);
+    std::transform(header.begin(), header.end(), header.begin(), ::tolower);
+    size_t content_length = 0;
+    auto length_pos = header.find("content-length:");
+    if (length_pos != std::string::npos) {
+      content_length = strtoul(header.c_str() + length_pos + 15, nullptr, 10);
+    }
+
+    auto total = header_end + 4 + content_length;
+    while (pending_.size() < total) {
+      if (!ReadMore()) {
+        return false;
+      }
+    }
+
+    auto status = atoi(header.c_str() + strlen("http/1.1 "));
+    result_->latency_ns.push_back(SteadyNs() - inflight_.front());
+    inflight_.pop_front();
+    result_->bytes += content_length;
+    if (status == 200) {
+      result_->ok++;
+    } else {
+      result_->errors++;
+    }
+
+    pending_.erase(0, total);
+    // server may still close after reply, reconnect to keep the pool size
+    if (header.find("connection: close") != std::string::npos) {
+      result_->errors += inflight_.size();
+      inflight_.clear();
+      Disconnect();
+      result_->reconnects++;
+    }
+
+    return true;
+  }
+
+  const HttpBenchConfig &config_;
+  std::atomic<int64_t> *remain_;
+  HttpBenchResult *result_;
+  std::string request_;
+  std::string pending_;
+  std::vector<char> read_buffer_;
+  std::deque<int64_t> inflight_;
+  int fd_{-1};
+};
+
+static Status StartEchoServer(const HttpBenchConfig &config,
+                              std::shared_ptr<Flow> *flow) {
+  // receive and reply directly, cost is the http path only
+  std::string toml_content = R"(
+    [driver]
+    skip-default=true
+    dir=[")" + std::string(TEST_LIB_DIR) +
+                             "\", \"" + std::string(TEST_DRIVER_DIR) +
+                             "\"]\n" + R"(
+    [graph]
+    graphconf = '''digraph http_bench {
+          httpserver_sync_receive[type=flowunit, flowunit=httpserver_sync_receive, device=cpu, deviceid=0, endpoint="http://)" +
+                             config.host + ":" + config.port + R"(", max_requests=100000, time_out_ms=60000, batch_window_ms=)" +
+                             std::to_string(config.batch_window_ms) + R"(]
+          httpserver_sync_reply[type=flowunit, flowunit=httpserver_sync_reply, device=cpu, deviceid=0]
+          httpserver_sync_receive:out_request_info -> httpserver_sync_reply:in_reply_info
+        }'''
+    format = "graphviz"
+  )";
+
+  *flow = std::make_shared<Flow>();
+  auto ret = (*flow)->Init("http_bench", toml_content);
+  if (!ret) {
+    return {ret, "init flow failed"};
+  }
+
+  ret = (*flow)->Build();
+  if (!ret) {
+    return {ret, "build flow failed"};
+  }
+
+  (*flow)->RunAsync();
+  return STATUS_OK;
+}
+
+static Status RunBench(const HttpBenchConfig &config,
+                       HttpBenchResult *result) {
+  std::shared_ptr<Flow> flow;
+  if (config.server) {
+    auto ret = StartEchoServer(config, &flow);
+    if (!ret) {
+      return ret;
+    }
+  }
+
+  std::atomic<int64_t> remain{config.requests};
+  std::vector<HttpBenchResult> results(config.connections);
+  std::vector<std::thread> threads;
+  auto begin = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < config.connections; ++i) {
+    threads.emplace_back([&config, &remain, &results, i]() {
+      BenchConnection connection(config, &remain, &results[i]);
+      connection.Run();
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  result->elapsed_s = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - begin)
+                          .count();
+  if (flow != nullptr) {
+    flow->Stop();
+  }
+
+  for (auto &conn_result : results) {
+    result->sent += conn_result.sent;
+    result->ok += conn_result.ok;
+    result->errors += conn_result.errors;
+    result->reconnects += conn_result.reconnects;
+    result->bytes += conn_result.bytes;
+    result->latency_ns.insert(result->latency_ns.end(),
+                              conn_result.latency_ns.begin(),
+                              conn_result.latency_ns.end());
+  }
+
+  std::sort(result->latency_ns.begin(), result->latency_ns.end());
+  if (result->ok == 0) {
+    return {STATUS_FAULT, "no request succeeded"};
+  }
+
+  return STATUS_OK;
+}
+
+static double PercentileUs(const std::vector<uint64_t> &sorted_ns,
+                           double percentile) {
+  if (sorted_ns.empty()) {
+    return 0;
+  }
+
+  auto index = std::min(sorted_ns.size() - 1,
+                        (size_t)(percentile * sorted_ns.size()));
+  return sorted_ns[index] / 1000.0;
+}
+
+static void ReportResult(const HttpBenchConfig &config,
+                         const HttpBenchResult &result) {
+  double avg_us = 0;
+  for (auto latency : result.latency_ns) {
+    avg_us += latency / 1000.0;
+  }
+
+  if (!result.latency_ns.empty()) {
+    avg_us /= result.latency_ns.size();
+  }
+
+  auto throughput = result.elapsed_s > 0 ? result.ok / result.elapsed_s : 0;
+  nlohmann::json json;
+  json["url"] = config.url;
+  json["connections"] = config.connections;
+  json["pipeline"] = config.pipeline;
+  json["body_size"] = config.body_size;
+  json["batch_window_ms"] = config.batch_window_ms;
+  json["sent"] = result.sent;
+  json["ok"] = result.ok;
+  json["errors"] = result.errors;
+  json["reconnects"] = result.reconnects;
+  json["elapsed_s"] = result.elapsed_s;
+  json["requests_per_second"] = throughput;
+  json["latency_us"] = {{"avg", avg_us},
+                        {"p50", PercentileUs(result.latency_ns, 0.5)},
+                        {"p90", PercentileUs(result.latency_ns, 0.9)},
+                        {"p99", PercentileUs(result.latency_ns, 0.99)},
+                        {"p999", PercentileUs(result.latency_ns, 0.999)},
+                        {"max", PercentileUs(result.latency_ns, 1)}};
+
+  printf("url %s, connections %u, pipeline %u, body %u bytes\n",
+         config.url.c_str(), config.connections, config.pipeline,
+         config.body_size);
+  printf("sent %lu, ok %lu, errors %lu, reconnects %lu, elapsed %.3fs\n",
+         (unsigned long)result.sent, (unsigned long)result.ok,
+         (unsigned long)result.errors, (unsigned long)result.reconnects,
+         result.elapsed_s);
+  printf("throughput %.1f requests/s\n", throughput);
+  printf("latency us: avg %.1f, p50 %.1f, p90 %.1f, p99 %.1f, p999 %.1f, "
+         "max %.1f\n",
+         avg_us, PercentileUs(result.latency_ns, 0.5),
+         PercentileUs(result.latency_ns, 0.9),
+         PercentileUs(result.latency_ns, 0.99),
+         PercentileUs(result.latency_ns, 0.999),
+         PercentileUs(result.latency_ns, 1));
+
+  if (config.json_path.empty()) {
+    return;
+  }
+
+  std::ofstream out(config.json_path, std::ios::out | std::ios::trunc);
+  if (!out.is_open()) {
+    MBLOG_ERROR << "write result failed, file path : " << config.json_path;
+    return;
+  }
+
+  out << json.dump(2) << std::endl;
+}
+
+}  // namespace modelbox
+
+int main(int argc, char **argv) {
+  if (getenv("MODELBOX_CONSOLE_LOGLEVEL") == nullptr) {
+    ModelBoxLogger.GetLogger()->SetLogLevel(modelbox::LOG_WARN);
+  }
+
+  modelbox::HttpBenchConfig config;
+  int cmdtype = 0;
+  while ((cmdtype = getopt_long_only(
+              argc, argv, "", modelbox::http_bench_options, nullptr)) != -1) {
+    switch (cmdtype) {
+      case modelbox::HTTP_BENCH_OPT_URL:
+        config.url = optarg;
+        break;
+      case modelbox::HTTP_BENCH_OPT_SERVER:
+        config.server = std::string(optarg) != "off";
+        break;
+      case modelbox::HTTP_BENCH_OPT_CONNECTIONS:
+        config.connections = atoi(optarg);
+        break;
+      case modelbox::HTTP_BENCH_OPT_PIPELINE:
+        config.pipeline = atoi(optarg);
+        break;
+      case modelbox::HTTP_BENCH_OPT_REQUESTS:
+        config.requests = atoi(optarg);
+        break;
+      case modelbox::HTTP_BENCH_OPT_BODY_SIZE:
+        config.body_size = atoi(optarg);
+        break;
+      case modelbox::HTTP_BENCH_OPT_BATCH_WINDOW:
+        config.batch_window_ms = atoi(optarg);
+        break;
+      case modelbox::HTTP_BENCH_OPT_JSON:
+        config.json_path = optarg;
+        break;
+      default:
+        modelbox::PrintHelp();
+        return 1;
+    }
+  }
+
+  auto ret = modelbox::ParseUrl(&config);
+  if (!ret) {
+    fprintf(stderr, "%s\n", ret.WrapErrormsgs().c_str());
+    modelbox::PrintHelp();
+    return 1;
+  }
+
+  modelbox::HttpBenchResult result;
+  ret = modelbox::RunBench(config, &result);
+  if (!ret) {
+    fprintf(stderr, "run http bench failed, %s\n",
+            ret.WrapErrormsgs().c_str());
+    return 1;
+  }
+
+  modelbox::ReportResult(config, result);
+  return 0;
+}
@@ -0,0 +1,375 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <thread>
+
+#include "flowunit_mockflowunit/flowunit_mockflowunit.h"
+#include "gmock/gmock.h"
+#include "mockflow.h"
+#include "modelbox/base/log.h"
+#include "modelbox/base/utils.h"
+#include "modelbox/buffer.h"
+#include "modelbox/data_context.h"
+#include "modelbox/flow.h"
+#include "modelbox/server/flow_pool.h"
+#include "test_config.h"
+
+namespace modelbox {
+
+constexpr const char *JOB_BENCH_GRAPH_NAME = "job_bench";
+constexpr int32_t BENCH_RECV_TIMEOUT = 10000;
+
+enum JOB_BENCH_OPTION {
+  JOB_BENCH_OPT_OPEN_MS,
+  JOB_BENCH_OPT_NODES,
+  JOB_BENCH_OPT_COUNT,
+  JOB_BENCH_OPT_JSON,
+  JOB_BENCH_OPT_HELP,
+};
+
+static struct option job_bench_options[] = {
+    {"open-ms", 1, 0, JOB_BENCH_OPT_OPEN_MS},
+    {"nodes", 1, 0, JOB_BENCH_OPT_NODES},
+    {"count", 1, 0, JOB_BENCH_OPT_COUNT},
+    {"json", 1, 0, JOB_BENCH_OPT_JSON},
+    {"help", 0, 0, JOB_BENCH_OPT_HELP},
+    {0, 0, 0, 0},
+};
+
+struct JobBenchConfig {
+  // open time of each node, like model loading
+  uint32_t open_ms{0};
+  uint32_t nodes{4};
+  uint32_t count{10};
+  std::string json_path;
+};
+
+struct JobBenchResult {
+  // time from job creation to first result
+  std::vector<uint64_t> cold_us;
+  std::vector<uint64_t> warm_us;
+  // warm flows not ready when taken
+  uint32_t warm_miss{0};
+};
+
+static void PrintHelp() {
+  char help[] =
+      "usage: job-bench [option]\n"
+      " option:\n"
+      "   --open-ms [ms]        open time of each node\n"
+      "   --nodes [num]         node number of graph chain\n"
+      "   --count [num]         jobs started of cold and warm each\n"
+      "   --json [file]         write result to json file\n"
+      "\n";
+  std::cerr << help;
+}
+
+static void RegisterOpenFlowUnit(MockFlow *mock_flow,
+                                 const JobBenchConfig &config) {
+  auto mock_desc = GenerateFlowunitDesc("bench_open", {"In_1"}, {"Out_1"});
+  auto mock_funcitons = std::make_shared<MockFunctionCollection>();
+  auto open_ms = config.open_ms;
+  auto open_func = [=](const std::shared_ptr<Configuration> &opts,
+                       std::shared_ptr<MockFlowUnit> mock_flowunit) -> Status {
+    std::this_thread::sleep_for(std::chrono::milliseconds(open_ms));
+    return STATUS_OK;
+  };
+  auto process_func =
+      [=](std::shared_ptr<DataContext> ctx,
+          std::shared_ptr<MockFlowUnit> mock_flowunit) -> Status {
+    auto input_bufs = ctx->Input("In_1");
+    auto output_bufs = ctx->Output("Out_1");
+    for (size_t i = 0; i < input_bufs->Size(); ++i) {
+      output_bufs->PushBack(input_bufs->At(i));
+    }
+
+    return STATUS_OK;
+  };
+  mock_funcitons->RegisterOpenFunc(open_func);
+  mock_funcitons->RegisterProcessFunc(process_func);
+  mock_flow->AddFlowUnitDesc(mock_desc, mock_funcitons->GenerateCreateFunc());
+}
+
+static Status WriteGraph(const JobBenchConfig &config,
+                         const std::string &graph_path) {
+  std::ostringstream graph;
+  graph << "digraph job_bench {\n";
+  graph << "    input[type=input]\n";
+  graph << "    output[type=output]\n";
+  std::string last = "input";
+  for (uint32_t i = 0; i < config.nodes; ++i) {
+    auto name = "open_" + std::to_string(i);
+    graph << "    " << name
+          << "[type=flowunit, flowunit=bench_open, device=cpu, deviceid=0]\n";
+    graph << "    " << last << " -> " << name << ":In_1\n";
+    last = name + ":Out_1";
+  }
+  graph << "    " << last << " -> output\n";
+  graph << "}";
+
+  std::ofstream out(graph_path, std::ios::out | std::ios::trunc);
+  if (!out.is_open()) {
+    return {STATUS_FAULT, "write graph failed, file path : " + graph_path};
+  }
+
+  out << "[driver]\n";
+  out << "skip-default=true\n";
+  out << "dir=[\"" << TEST_LIB_DIR << "\"]\n";
+  out << "[graph]\n";
+  out << "graphconf = '''" << graph.str() << "'''\n";
+  out << "format = \"graphviz\"\n";
+  return STATUS_OK;
+}
+
+/**
+ * Run flow and wait for the first buffer to pass through
+ */
+static Status RunFirstBuffer(std::shared_ptr<Flow> flow) {
+  auto ret = flow->RunAsync();
+  if (!ret) {
+    return {ret, "run flow failed"};
+  }
+
+  auto external = flow->CreateExternalDataMap();
+  if (external == nullptr) {
+    return {STATUS_FAULT, "create external data map failed"};
+  }
+
+  auto buffer_list = external->CreateBufferList();
+  buffer_list->Build({sizeof(int)});
+  ret = external->Send("input", buffer_list);
+  if (!ret) {
+    return {ret, "send buffer failed"};
+  }
+
+  external->Close();
+  while (true) {
+    OutputBufferList output;
+    ret = external->Recv(output, BENCH_RECV_TIMEOUT);
+    if (!ret) {
+      return {ret, "receive first buffer failed"};
+    }
+
+    auto iter = output.find("output");
+    if (iter != output.end() && iter->second->Size() > 0) {
+      return STATUS_OK;
+    }
+  }
+}
+
+static inline uint64_t ElapsedUs(std::chrono::steady_clock::time_point begin) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - begin)
+      .count();
+}
+
+static Status RunCold(const JobBenchConfig &config,
+                      const std::string &graph_path, JobBenchResult *result) {
+  for (uint32_t i = 0; i < config.count; ++i) {
+    auto begin = std::chrono::steady_clock::now();
+    std::shared_ptr<Flow> flow;
+    auto ret = FlowPool::BuildFlow(graph_path, &flow);
+    if (!ret) {
+      return ret;
+    }
+
+    ret = RunFirstBuffer(flow);
+    result->cold_us.push_back(ElapsedUs(begin));
+    flow->Stop();
+    if (!ret) {
+      return ret;
+    }
+  }
+
+  return STATUS_OK;
+}
+
+static Status RunWarm(const JobBenchConfig &config,
+                      const std::string &graph_path, JobBenchResult *result) {
+  FlowPool pool;
+  auto ret = pool.Register(JOB_BENCH_GRAPH_NAME, graph_path, 1);
+  if (!ret) {
+    return ret;
+  }
+
+  pool.Start();
+  for (uint32_t i = 0; i < config.count; ++i) {
+    // jobs arrive slower than refill, measure start from a warm flow
+    if (!pool.WaitReady(-1)) {
+      return {STATUS_FAULT, "warm flow build failed"};
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    auto flow = pool.Acquire(JOB_BENCH_GRAPH_NAME);
+    if (flow == nullptr) {
+      result->warm_miss++;
+      ret = FlowPool::BuildFlow(graph_path, &flow);
+      if (!ret) {
+        return ret;
+      }
+    }
+
+    ret = RunFirstBuffer(flow);
+    result->warm_us.push_back(ElapsedUs(begin));
+    flow->Stop();
+    if (!ret) {
+      return ret;
+    }
+  }
+
+  pool.Stop();
+  return STATUS_OK;
+}
+
+static Status RunBench(const JobBenchConfig &config, JobBenchResult *result) {
+  auto mock_flow = std::make_shared<MockFlow>();
+  if (!mock_flow->Init(false)) {
+    return {STATUS_FAULT, "init mock flow failed"};
+  }
+
+  RegisterOpenFlowUnit(mock_flow.get(), config);
+
+  std::string graph_path = std::string(TEST_DATA_DIR) + "/job_bench.toml";
+  auto ret = WriteGraph(config, graph_path);
+  if (!ret) {
+    return ret;
+  }
+  Defer { remove(graph_path.c_str()); };
+
+  ret = RunCold(config, graph_path, result);
+  if (!ret) {
+    return ret;
+  }
+
+  ret = RunWarm(config, graph_path, result);
+  if (!ret) {
+    return ret;
+  }
+
+  std::sort(result->cold_us.begin(), result->cold_us.end());
+  std::sort(result->warm_us.begin(), result->warm_us.end());
+  return STATUS_OK;
+}
+
+static nlohmann::json LatencyJson(const std::vector<uint64_t> &sorted_us) {
+  double avg_ms = 0;
+  for (auto latency : sorted_us) {
+    avg_ms += latency / 1000.0;
+  }
+
+  if (sorted_us.empty()) {
+    return {{"avg", 0}, {"p50", 0}, {"max", 0}};
+  }
+
+  avg_ms /= sorted_us.size();
+  return {{"avg", avg_ms},
+          {"p50", sorted_us[sorted_us.size() / 2] / 1000.0},
+          {"max", sorted_us.back() / 1000.0}};
+}
+
+static void ReportResult(const JobBenchConfig &config,
+                         const JobBenchResult &result) {
+  nlohmann::json json;
+  json["open_ms"] = config.open_ms;
+  json["nodes"] = config.nodes;
+  json["count"] = config.count;
+  json["warm_miss"] = result.warm_miss;
+  json["cold_ms"] = LatencyJson(result.cold_us);
+  json["warm_ms"] = LatencyJson(result.warm_us);
+  double cold_avg = json["cold_ms"]["avg"];
+  double warm_avg = json["warm_ms"]["avg"];
+  json["speedup"] = warm_avg > 0 ? cold_avg / warm_avg : 0;
+
+  printf("nodes %u, open %ums, jobs %u\n", config.nodes, config.open_ms,
+         config.count);
+  printf("cold start ms: avg %.2f, p50 %.2f, max %.2f\n", cold_avg,
+         (double)json["cold_ms"]["p50"], (double)json["cold_ms"]["max"]);
+  printf("warm start ms: avg %.2f, p50 %.2f, max %.2f, miss %u\n", warm_avg,
+         (double)json["warm_ms"]["p50"], (double)json["warm_ms"]["max"],
+         result.warm_miss);
+  printf("speedup %.1fx\n", (double)json["speedup"]);
+
+  if (config.json_path.empty()) {
+    return;
+  }
+
+  std::ofstream out(config.json_path, std::ios::out | std::ios::trunc);
+  if (!out.is_open()) {
+    MBLOG_ERROR << "write result failed, file path : " << config.json_path;
+    return;
+  }
+
+  out << json.dump(2) << std::endl;
+}
+
+}  // namespace modelbox
+
+int main(int argc, char **argv) {
+  // synthetic flowunits are gmock objects
+  testing::InitGoogleMock(&argc, argv);
+  if (getenv("MODELBOX_CONSOLE_LOGLEVEL") == nullptr) {
+    ModelBoxLogger.GetLogger()->SetLogLevel(modelbox::LOG_WARN);
+  }
+
+  modelbox::JobBenchConfig config;
+  int cmdtype = 0;
+  while ((cmdtype = getopt_long_only(
+              argc, argv, "", modelbox::job_bench_options, nullptr)) != -1) {
+    switch (cmdtype) {
+      case modelbox::JOB_BENCH_OPT_OPEN_MS:
+        config.open_ms = atoi(optarg);
+        break;
+      case modelbox::JOB_BENCH_OPT_NODES:
+        config.nodes = atoi(optarg);
+        break;
+      case modelbox::JOB_BENCH_OPT_COUNT:
+        config.count = atoi(optarg);
+        break;
+      case modelbox::JOB_BENCH_OPT_JSON:
+        config.json_path = optarg;
+        break;
+      default:
+        modelbox::PrintHelp();
+        return 1;
+    }
+  }
+
+  if (config.nodes == 0 || config.count == 0) {
+    fprintf(stderr, "nodes and count must be positive\n");
+    modelbox::PrintHelp();
+    return 1;
+  }
+
+  modelbox::JobBenchResult result;
+  auto ret = modelbox::RunBench(config, &result);
+  if (!ret) {
+    fprintf(stderr, "run job bench failed, %s\n", ret.WrapErrormsgs().c_str());
+    return 1;
+  }
+
+  modelbox::ReportResult(config, result);
+  return 0;
+}
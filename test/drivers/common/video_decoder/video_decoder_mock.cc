@@ -94,7 +94,8 @@ static void AddStartFlowUnit(std::shared_ptr<MockFlow>& flow) {
 }
 
 static void CheckVideoFrame(std::shared_ptr<modelbox::Buffer> frame_buffer,
-                            std::shared_ptr<int64_t> index_counter) {
+                            std::shared_ptr<int64_t> index_counter,
+                            int32_t expect_width, int32_t expect_height) {
   int64_t index = 0;
   int32_t width = 0;
   int32_t height = 0;
@@ -114,8 +115,8 @@ static void CheckVideoFrame(std::shared_ptr<modelbox::Buffer> frame_buffer,
 
   EXPECT_EQ(index, *index_counter);
   *index_counter = *index_counter + 1;
-  EXPECT_EQ(width, 480);
-  EXPECT_EQ(height, 320);
+  EXPECT_EQ(width, expect_width);
+  EXPECT_EQ(height, expect_height);
   EXPECT_EQ(rate_num, 24);
   EXPECT_EQ(rate_den, 1);
   if (index < 119) {
@@ -133,7 +134,8 @@ static void CheckVideoFrame(std::shared_ptr<modelbox::Buffer> frame_buffer,
 }
 
 static void AddReadFrameFlowUnit(std::shared_ptr<MockFlow>& flow,
-                                 bool is_stream) {
+                                 bool is_stream, int32_t expect_width,
+                                 int32_t expect_height) {
   auto mock_desc = GenerateFlowunitDesc("read_frame", {"frame_info"}, {});
   mock_desc->SetFlowType(STREAM);
   auto data_pre_func = [&](std::shared_ptr<DataContext> data_ctx,
@@ -159,7 +161,8 @@ static void AddReadFrameFlowUnit(std::shared_ptr<MockFlow>& flow,
         continue;
       }
 
-      CheckVideoFrame(frame_buffer, index_counter);
+      CheckVideoFrame(frame_buffer, index_counter, expect_width,
+                      expect_height);
     }
 
     return modelbox::STATUS_OK;
@@ -173,14 +176,16 @@ static void AddReadFrameFlowUnit(std::shared_ptr<MockFlow>& flow,
 }
 
 modelbox::Status AddMockFlowUnit(std::shared_ptr<MockFlow>& flow,
-                                 bool is_stream) {
+                                 bool is_stream, int32_t expect_width,
+                                 int32_t expect_height) {
   AddStartFlowUnit(flow);
-  AddReadFrameFlowUnit(flow, is_stream);
+  AddReadFrameFlowUnit(flow, is_stream, expect_width, expect_height);
   return STATUS_SUCCESS;
 }
 
 std::string GetTomlConfig(const std::string& device,
-                          const std::string& pix_fmt) {
+                          const std::string& pix_fmt,
+                          const std::string& decoder_options) {
   const std::string test_lib_dir = TEST_DRIVER_DIR;
   const std::string test_data_dir = TEST_DATA_DIR;
   std::string toml_content =
@@ -196,7 +201,7 @@ std::string GetTomlConfig(const std::string& device,
             videodecoder[type=flowunit, flowunit=video_decoder, device=)" +
       device +
       R"(, deviceid=0, label="<in_video_packet> | <out_video_frame>", pix_fmt=)" +
-      pix_fmt + R"(]
+      pix_fmt + decoder_options + R"(]
             read_frame[type=flowunit, flowunit=read_frame, device=cpu, deviceid=0, label="<frame_info>"]
             start_unit:stream_meta -> videodemuxer:in_video_url
             videodemuxer:out_video_packet -> videodecoder:in_video_packet
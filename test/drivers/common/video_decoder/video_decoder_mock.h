@@ -26,10 +26,13 @@
 
 namespace videodecoder {
 modelbox::Status AddMockFlowUnit(std::shared_ptr<modelbox::MockFlow>& flow,
-                               bool is_stream = false);
+                               bool is_stream = false,
+                               int32_t expect_width = 480,
+                               int32_t expect_height = 320);
 
 std::string GetTomlConfig(const std::string& device,
-                          const std::string& pix_fmt);
+                          const std::string& pix_fmt,
+                          const std::string& decoder_options = "");
 };  // namespace videodecoder
 
 #endif  // MODELBOX_DRIVER_TEST_VIDEO_DECODER_MOCK_H_
\ No newline at end of file
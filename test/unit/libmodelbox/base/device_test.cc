@@ -311,6 +311,79 @@ TEST_F(DeviceMemoryTest, MemAlloc) {
   EXPECT_EQ(device_->GetAllocatedMemSize(), 1024);
 }
 
+TEST_F(DeviceMemoryTest, MemAccount) {
+  device_->SetMemQuota(4096);
+  auto node_account = DeviceMemoryAccount::Create("node1");
+  auto session_account = DeviceMemoryAccount::Create("session1");
+
+  auto mem0 = device_->MemAlloc(100);
+  std::shared_ptr<DeviceMemory> mem1;
+  std::shared_ptr<DeviceMemory> mem2;
+  {
+    DeviceMemoryAccountScope scope(node_account, session_account);
+    mem1 = device_->MemAlloc(1024);
+    {
+      DeviceMemoryAccountScope inner_scope(node_account, nullptr);
+      mem2 = device_->MemAlloc(512);
+    }
+
+    auto mem3 = device_->MemAlloc(256);
+    EXPECT_EQ(device_->GetMemoryTrace()
+                  ->GetMemoryLog(mem3->GetMemoryID())
+                  ->user_id_,
+              "node1");
+  }
+
+  auto mem4 = device_->MemAlloc(100);
+  EXPECT_EQ(DeviceMemoryAccountScope::GetNodeAccount(), nullptr);
+  EXPECT_EQ(node_account->GetLiveBytes(), 1536);
+  EXPECT_EQ(node_account->GetLiveBlocks(), 2);
+  EXPECT_EQ(node_account->GetPeakBytes(), 1792);
+  EXPECT_EQ(session_account->GetLiveBytes(), 1024);
+  EXPECT_EQ(session_account->GetPeakBytes(), 1280);
+  auto owners = session_account->GetOwnerLiveBytes();
+  ASSERT_EQ(owners.size(), 1);
+  EXPECT_EQ(owners["node1"], 1024);
+
+  mem1 = nullptr;
+  EXPECT_EQ(node_account->GetLiveBytes(), 512);
+  EXPECT_EQ(session_account->GetLiveBytes(), 0);
+  EXPECT_TRUE(session_account->GetOwnerLiveBytes().empty());
+
+  // account is kept by memory after it is released by owner
+  node_account = nullptr;
+  mem2 = nullptr;
+  EXPECT_EQ(device_->GetAllocatedMemSize(), 200);
+}
+
+class TestMemoryAccount : public DeviceMemoryAccount {
+ public:
+  TestMemoryAccount(const std::string &name, bool *deleted)
+      : DeviceMemoryAccount(name), deleted_(deleted) {}
+
+  ~TestMemoryAccount() override { *deleted_ = true; }
+
+ private:
+  bool *deleted_;
+};
+
+TEST_F(DeviceMemoryTest, MemAccountLifetime) {
+  device_->SetMemQuota(4096);
+  bool deleted = false;
+  auto account = DeviceMemoryAccount::Create<TestMemoryAccount>("node1",
+                                                                &deleted);
+  std::shared_ptr<DeviceMemory> mem;
+  {
+    DeviceMemoryAccountScope scope(account, nullptr);
+    mem = device_->MemAlloc(1024);
+  }
+
+  account = nullptr;
+  EXPECT_FALSE(deleted);
+  mem = nullptr;
+  EXPECT_TRUE(deleted);
+}
+
 TEST_F(DeviceMemoryTest, MemWrite) {
   device_->SetMemQuota(1024);
 
@@ -17,12 +17,14 @@
 #include "modelbox/base/driver.h"
 
 #include <dlfcn.h>
+#include <fcntl.h>
 #include <poll.h>
 #include <sys/time.h>
 
 #include <algorithm>
 #include <chrono>
 #include <fstream>
+#include <functional>
 #include <nlohmann/json.hpp>
 #include <string>
 #include <thread>
@@ -54,41 +56,18 @@ class DriverTest : public testing::Test {
     drivers->Clear();
   };
 };
-static std::string CalCode(const std::vector<std::string> &dirs);
-
-std::string CalCode(const std::vector<std::string> &dirs) {
-  int64_t check_sum = 0;
-  for (const auto &dir : dirs) {
-    std::vector<std::string> drivers_list;
-    std::string filter = "libmodelbox-*.so*";
-    struct stat s;
-    lstat(dir.c_str(), &s);
-
-    if (!S_ISDIR(s.st_mode)) {
-      check_sum += s.st_mtim.tv_sec;
-      continue;
-    }
-
-    Status status = ListFiles(dir, filter, &drivers_list);
-    if (drivers_list.size() == 0) {
-      continue;
-    }
 
-    for (auto &driver_file : drivers_list) {
-      struct stat buf;
-      auto ret = lstat(driver_file.c_str(), &buf);
-      if (ret) {
-        continue;
-      }
-
-      if (S_ISLNK(buf.st_mode)) {
-        continue;
-      }
-      check_sum += buf.st_mtim.tv_sec;
+static nlohmann::json FindScanInfo(const std::string &file) {
+  std::ifstream ifs(DEFAULT_SCAN_INFO);
+  nlohmann::json dump_json;
+  ifs >> dump_json;
+  for (auto &driver_info : dump_json["scan_drivers"]) {
+    if (driver_info["file_path"] == file) {
+      return driver_info;
     }
   }
 
-  return GenerateKey(check_sum);
+  return nullptr;
 }
 
 TEST_F(DriverTest, Factory) {
@@ -596,21 +575,156 @@ TEST_F(DriverTest, DoubleScan) {
   drivers->Clear();
   drivers->Initialize(config);
 
-  std::ifstream ifs(DEFAULT_SCAN_INFO);
-  nlohmann::json dump_json;
-  ifs >> dump_json;
-  std::string read_check_node = dump_json["check_code"];
+  for (auto &driver : drivers->GetAllDriverList()) {
+    auto driver_info = FindScanInfo(driver->GetDriverFile());
+    EXPECT_FALSE(driver_info.is_null());
+  }
 
-  std::vector<std::string> dirs{MODELBOX_DEFAULT_DRIVER_PATH};
-  auto check_code = CalCode(dirs);
-  MBLOG_INFO << "check_code: " << check_code << ", read_check_node: " << read_check_node;
-  EXPECT_EQ(check_code, read_check_node);
   status = drivers->Scan();
   auto second_driver_nums = drivers->GetAllDriverList().size();
   EXPECT_EQ(driver_nums, second_driver_nums);
   EXPECT_EQ(status, STATUS_OK);
 }
 
+TEST_F(DriverTest, ScanCacheIncremental) {
+  auto scan_dir = std::string(TEST_DATA_DIR) + "/driver-scan";
+  auto driver_file = scan_dir + "/libmodelbox-unit-cpu-python.so";
+  CreateDirectory(scan_dir);
+  CopyFile(PYTHON_PATH, driver_file, 0, true);
+  Defer {
+    remove(driver_file.c_str());
+    rmdir(scan_dir.c_str());
+  };
+
+  ConfigurationBuilder builder;
+  builder.AddProperty(DRIVER_DIR, scan_dir);
+  builder.AddProperty(DRIVER_SKIP_DEFAULT, "true");
+  std::shared_ptr<Configuration> config = builder.Build();
+  auto drivers = std::make_shared<Drivers>();
+  drivers->Initialize(config);
+  EXPECT_EQ(drivers->Scan(), STATUS_OK);
+  EXPECT_EQ(drivers->GetAllDriverList().size(), 1);
+  auto driver_info = FindScanInfo(driver_file);
+  ASSERT_FALSE(driver_info.is_null());
+  EXPECT_TRUE(driver_info["load_success"]);
+  std::string hash = driver_info["hash"];
+  int64_t mtime = driver_info["mtime"];
+
+  // touched only, scan result is reused with new modify time
+  struct timespec times[2];
+  clock_gettime(CLOCK_REALTIME, &times[0]);
+  times[0].tv_sec += 10;
+  times[1] = times[0];
+  ASSERT_EQ(utimensat(AT_FDCWD, driver_file.c_str(), times, 0), 0);
+  drivers->Clear();
+  drivers->Initialize(config);
+  EXPECT_EQ(drivers->Scan(), STATUS_OK);
+  EXPECT_EQ(drivers->GetAllDriverList().size(), 1);
+  driver_info = FindScanInfo(driver_file);
+  EXPECT_EQ(driver_info["hash"], hash);
+  EXPECT_NE(driver_info["mtime"], mtime);
+
+  // content changed, rescan
+  std::ofstream out(driver_file, std::ios::app | std::ios::binary);
+  out << '\0';
+  out.close();
+  drivers->Clear();
+  drivers->Initialize(config);
+  EXPECT_EQ(drivers->Scan(), STATUS_OK);
+  EXPECT_EQ(drivers->GetAllDriverList().size(), 1);
+  driver_info = FindScanInfo(driver_file);
+  EXPECT_NE(driver_info["hash"], hash);
+}
+
+static void UpdateScanInfo(
+    const std::function<void(nlohmann::json &dump_json)> &update) {
+  nlohmann::json dump_json;
+  {
+    std::ifstream ifs(DEFAULT_SCAN_INFO);
+    ifs >> dump_json;
+  }
+
+  update(dump_json);
+  std::ofstream ofs(DEFAULT_SCAN_INFO, std::ios::trunc);
+  ofs << dump_json;
+}
+
+TEST_F(DriverTest, ScanCacheStale) {
+  auto scan_dir = std::string(TEST_DATA_DIR) + "/driver-scan-stale";
+  auto driver_file = scan_dir + "/libmodelbox-unit-cpu-python.so";
+  auto removed_file = scan_dir + "/libmodelbox-unit-cpu-removed.so";
+  CreateDirectory(scan_dir);
+  CopyFile(PYTHON_PATH, driver_file, 0, true);
+  Defer {
+    remove(driver_file.c_str());
+    rmdir(scan_dir.c_str());
+  };
+
+  ConfigurationBuilder builder;
+  builder.AddProperty(DRIVER_DIR, scan_dir);
+  builder.AddProperty(DRIVER_SKIP_DEFAULT, "true");
+  std::shared_ptr<Configuration> config = builder.Build();
+  auto drivers = std::make_shared<Drivers>();
+  drivers->Initialize(config);
+  EXPECT_EQ(drivers->Scan(), STATUS_OK);
+  ASSERT_EQ(drivers->GetAllDriverList().size(), 1);
+  auto name = drivers->GetAllDriverList()[0]->GetDriverDesc()->GetName();
+  auto driver_info = FindScanInfo(driver_file);
+  ASSERT_FALSE(driver_info.is_null());
+  int64_t size = driver_info["size"];
+
+  auto rescan = [&]() {
+    drivers->Clear();
+    drivers->Initialize(config);
+    EXPECT_EQ(drivers->Scan(), STATUS_OK);
+    EXPECT_EQ(drivers->GetAllDriverList().size(), 1);
+  };
+
+  // size differs from file, stale result is not used
+  UpdateScanInfo([&](nlohmann::json &dump_json) {
+    for (auto &info : dump_json["scan_drivers"]) {
+      if (info["file_path"] == driver_file) {
+        info["name"] = "stale_name";
+        info["size"] = size + 1;
+      }
+    }
+  });
+  rescan();
+  EXPECT_EQ(drivers->GetAllDriverList()[0]->GetDriverDesc()->GetName(), name);
+  driver_info = FindScanInfo(driver_file);
+  EXPECT_EQ(driver_info["name"], name);
+  EXPECT_EQ(driver_info["size"], size);
+
+  // file removed after scan, its entry is dropped
+  UpdateScanInfo([&](nlohmann::json &dump_json) {
+    auto info = FindScanInfo(driver_file);
+    info["file_path"] = removed_file;
+    dump_json["scan_drivers"].push_back(info);
+  });
+  rescan();
+  EXPECT_TRUE(FindScanInfo(removed_file).is_null());
+  EXPECT_FALSE(FindScanInfo(driver_file).is_null());
+
+  // old version of scan info, rescan all
+  UpdateScanInfo([&](nlohmann::json &dump_json) {
+    dump_json["version"] = 0;
+    for (auto &info : dump_json["scan_drivers"]) {
+      info["name"] = "stale_name";
+    }
+  });
+  rescan();
+  EXPECT_EQ(drivers->GetAllDriverList()[0]->GetDriverDesc()->GetName(), name);
+
+  // broken scan info, rescan all
+  {
+    std::ofstream ofs(DEFAULT_SCAN_INFO, std::ios::trunc);
+    ofs << "{broken";
+  }
+  rescan();
+  EXPECT_EQ(drivers->GetAllDriverList()[0]->GetDriverDesc()->GetName(), name);
+  EXPECT_FALSE(FindScanInfo(driver_file).is_null());
+}
+
 class VirtualDriverTest : public testing::Test {
  public:
   VirtualDriverTest() {}
@@ -0,0 +1,272 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "modelbox/base/shm_ring.h"
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "modelbox/base/status.h"
+
+namespace modelbox {
+
+class ShmRingTest : public testing::Test {
+ public:
+  ShmRingTest() {}
+
+ protected:
+  virtual void SetUp() {
+    path_ = "/tmp/modelbox-shm-ring-test-" + std::to_string(getpid());
+    auto ret = ShmRing::Listen(path_, &listen_fd_);
+    ASSERT_TRUE(ret);
+  };
+
+  virtual void TearDown() {
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+    }
+
+    unlink(path_.c_str());
+  };
+
+  pid_t Produce(uint32_t slot_num, size_t slot_size, int count,
+                bool close_ring = true) {
+    auto pid = fork();
+    if (pid != 0) {
+      return pid;
+    }
+
+    std::shared_ptr<ShmRing> ring;
+    if (!ShmRing::Connect(path_, slot_num, slot_size, &ring)) {
+      _exit(1);
+    }
+
+    for (int i = 0; i < count; i++) {
+      std::vector<int> data(i + 1, i);
+      auto ret = ring->Write(data.data(), data.size() * sizeof(int),
+                             std::to_string(i), 5000);
+      if (!ret) {
+        _exit(2);
+      }
+    }
+
+    if (close_ring) {
+      ring->Close();
+    }
+
+    _exit(0);
+  }
+
+  int ConnectRaw() {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+      close(fd);
+      return -1;
+    }
+
+    return fd;
+  }
+
+  int Join(pid_t pid) {
+    int status = -1;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  }
+
+  std::string path_;
+  int listen_fd_{-1};
+};
+
+TEST_F(ShmRingTest, ReadWrite) {
+  auto pid = Produce(4, 1024, 100);
+  std::shared_ptr<ShmRing> ring;
+  ASSERT_TRUE(ShmRing::Accept(listen_fd_, &ring));
+  EXPECT_EQ(ring->GetSlotNum(), 4);
+  EXPECT_EQ(ring->GetSlotSize(), 1024);
+
+  int count = 0;
+  while (true) {
+    ShmRingFrame frame;
+    auto ret = ring->Read(&frame, 5000);
+    if (ret == STATUS_EOF) {
+      break;
+    }
+
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(frame.size, (count + 1) * sizeof(int));
+    EXPECT_EQ(frame.meta, std::to_string(count));
+    auto *data = (int *)frame.data;
+    EXPECT_EQ(data[0], count);
+    EXPECT_EQ(data[count], count);
+    ring->Release(frame.slot);
+    count++;
+  }
+
+  EXPECT_EQ(count, 100);
+  EXPECT_EQ(ring->GetInUseCount(), 0);
+  EXPECT_EQ(Join(pid), 0);
+}
+
+TEST_F(ShmRingTest, AdoptReleaseOutOfOrder) {
+  auto pid = Produce(4, 1024, 8);
+  std::shared_ptr<ShmRing> ring;
+  ASSERT_TRUE(ShmRing::Accept(listen_fd_, &ring));
+
+  std::vector<std::shared_ptr<void>> held;
+  for (int i = 0; i < 4; i++) {
+    ShmRingFrame frame;
+    ASSERT_TRUE(ring->Read(&frame, 5000));
+    held.push_back(ring->Adopt(frame));
+  }
+
+  // all slots held, producer is blocked
+  ShmRingFrame frame;
+  EXPECT_EQ(ring->Read(&frame, 100), STATUS_TIMEDOUT);
+  EXPECT_EQ(ring->GetInUseCount(), 4);
+
+  // next slot in order is still held, nothing can be written
+  held[3] = nullptr;
+  EXPECT_EQ(ring->Read(&frame, 100), STATUS_TIMEDOUT);
+
+  held[0] = nullptr;
+  ASSERT_TRUE(ring->Read(&frame, 5000));
+  EXPECT_EQ(frame.meta, "4");
+  EXPECT_EQ(*(int *)frame.data, 4);
+  ring->Release(frame.slot);
+
+  held.clear();
+  int count = 5;
+  while (ring->Read(&frame, 5000) == STATUS_OK) {
+    EXPECT_EQ(*(int *)frame.data, count);
+    ring->Release(frame.slot);
+    count++;
+  }
+
+  EXPECT_EQ(count, 8);
+  EXPECT_EQ(Join(pid), 0);
+}
+
+TEST_F(ShmRingTest, ProducerExit) {
+  auto pid = Produce(4, 1024, 2, false);
+  std::shared_ptr<ShmRing> ring;
+  ASSERT_TRUE(ShmRing::Accept(listen_fd_, &ring));
+  EXPECT_EQ(Join(pid), 0);
+
+  // written frames are still readable after producer exits
+  ShmRingFrame frame;
+  EXPECT_TRUE(ring->Read(&frame, 1000));
+  ring->Release(frame.slot);
+  EXPECT_TRUE(ring->Read(&frame, 1000));
+  ring->Release(frame.slot);
+  EXPECT_EQ(ring->Read(&frame, 1000), STATUS_EOF);
+}
+
+TEST_F(ShmRingTest, ReserveCommit) {
+  std::shared_ptr<ShmRing> consumer;
+  std::thread accept_thread(
+      [&]() { EXPECT_TRUE(ShmRing::Accept(listen_fd_, &consumer)); });
+  std::shared_ptr<ShmRing> producer;
+  ASSERT_TRUE(ShmRing::Connect(path_, 3, 100, &producer));
+  accept_thread.join();
+  ASSERT_NE(consumer, nullptr);
+  EXPECT_EQ(producer->GetSlotNum(), 4);
+  EXPECT_EQ(producer->GetSlotSize(), 128);
+
+  void *data = nullptr;
+  EXPECT_EQ(producer->Reserve(256, &data), STATUS_RANGE);
+  ASSERT_TRUE(producer->Reserve(64, &data, -1, "{\"id\":1}"));
+  EXPECT_EQ(producer->Reserve(64, &data), STATUS_BUSY);
+  memset(data, 0x5a, 32);
+  ASSERT_TRUE(producer->Commit(32));
+
+  ShmRingFrame frame;
+  ASSERT_TRUE(consumer->Read(&frame, 1000));
+  EXPECT_EQ(frame.size, 32);
+  EXPECT_EQ(frame.meta, "{\"id\":1}");
+  EXPECT_EQ(((uint8_t *)frame.data)[31], 0x5a);
+  consumer->Release(frame.slot);
+
+  EXPECT_EQ(consumer->Read(&frame, 10), STATUS_TIMEDOUT);
+  producer->Close();
+  EXPECT_EQ(consumer->Read(&frame, 1000), STATUS_EOF);
+  EXPECT_EQ(producer->Write("a", 1), STATUS_SHUTDOWN);
+}
+
+TEST_F(ShmRingTest, HandshakeTimeout) {
+  int fd = ConnectRaw();
+  ASSERT_GE(fd, 0);
+
+  // peer connects but sends nothing
+  std::shared_ptr<ShmRing> ring;
+  EXPECT_EQ(ShmRing::Accept(listen_fd_, &ring, 100), STATUS_TIMEDOUT);
+  EXPECT_EQ(ring, nullptr);
+  close(fd);
+}
+
+TEST_F(ShmRingTest, RejectUnsealedMemory) {
+  int fd = ConnectRaw();
+  ASSERT_GE(fd, 0);
+
+  // memfd which producer can still resize
+  int fds[3];
+  fds[0] = syscall(SYS_memfd_create, "shm-ring-test", 0);
+  fds[1] = eventfd(0, 0);
+  fds[2] = eventfd(0, 0);
+  uint64_t map_size = 1024 * 1024;
+  ASSERT_EQ(ftruncate(fds[0], map_size), 0);
+
+  struct iovec iov;
+  iov.iov_base = &map_size;
+  iov.iov_len = sizeof(map_size);
+  char control[CMSG_SPACE(sizeof(fds))];
+  memset(control, 0, sizeof(control));
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  auto *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+  ASSERT_EQ(sendmsg(fd, &msg, 0), sizeof(map_size));
+
+  std::shared_ptr<ShmRing> ring;
+  EXPECT_EQ(ShmRing::Accept(listen_fd_, &ring, 1000), STATUS_INVALID);
+  for (auto send_fd : fds) {
+    close(send_fd);
+  }
+  close(fd);
+}
+
+}  // namespace modelbox
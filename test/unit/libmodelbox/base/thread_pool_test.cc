@@ -16,6 +16,8 @@
 
 #include "modelbox/base/thread_pool.h"
 
+#include <algorithm>
+
 #include "gtest/gtest.h"
 class ThreadPoolTest : public testing::Test {
  public:
@@ -176,6 +178,82 @@ TEST_F(ThreadPoolTest, KeepAlive) {
   EXPECT_EQ(pool.GetThreadsNum(), thread_size);
 }
 
+TEST_F(ThreadPoolTest, AdaptiveQueueWait) {
+  // queue wait grows pool up to cpu number
+  int cpu_num = std::max(1U, std::thread::hardware_concurrency());
+  int grow_limit = std::min(cpu_num, 8);
+  modelbox::ThreadPool pool(1, 8, 100);
+  pool.SetAdaptive(true, 1000);
+  EXPECT_TRUE(pool.IsAdaptive());
+  std::vector<std::future<void>> future_queue;
+  for (size_t i = 0; i < 50; i++) {
+    future_queue.push_back(pool.Submit(long_task, 5));
+  }
+
+  // queue is never full, only queue wait adds threads
+  int max_threads = 0;
+  for (auto &fut : future_queue) {
+    fut.get();
+    max_threads = std::max(max_threads, pool.GetThreadsNum());
+  }
+
+  if (grow_limit > 1) {
+    EXPECT_GT(max_threads, 1);
+  }
+  // thread number is raised by one while grow is being checked
+  EXPECT_LE(max_threads, grow_limit + 1);
+  EXPECT_GT(pool.GetQueueWaitTime(), 0);
+}
+
+TEST_F(ThreadPoolTest, AdaptiveBlockingSection) {
+  int thread_size = 2;
+  modelbox::ThreadPool pool(thread_size, thread_size, 10, 100);
+  pool.SetAdaptive(true);
+
+  std::atomic<bool> release{false};
+  std::atomic<int> blocked{0};
+  auto blocking_task = [&]() {
+    modelbox::BlockingSection blocking;
+    modelbox::BlockingSection nested;
+    blocked++;
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  };
+
+  std::vector<std::future<void>> blocking_futures;
+  for (int i = 0; i < thread_size; i++) {
+    blocking_futures.push_back(pool.Submit(blocking_task));
+  }
+
+  while (blocked < thread_size) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  EXPECT_EQ(pool.GetBlockingThreadsNum(), thread_size);
+  // all core threads are blocked, compensating thread runs this
+  auto fut = pool.Submit(compute, 1, 2);
+  EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  EXPECT_EQ(fut.get(), 3);
+  EXPECT_GT(pool.GetThreadsNum(), thread_size);
+  EXPECT_LE(pool.GetThreadsNum(), thread_size * 2);
+
+  release = true;
+  for (auto &blocking_fut : blocking_futures) {
+    blocking_fut.get();
+  }
+
+  EXPECT_EQ(pool.GetBlockingThreadsNum(), 0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  EXPECT_EQ(pool.GetThreadsNum(), thread_size);
+
+  // not a pool thread, nothing counted
+  {
+    modelbox::BlockingSection blocking;
+    EXPECT_EQ(pool.GetBlockingThreadsNum(), 0);
+  }
+}
+
 TEST_F(ThreadPoolTest, Performance) {
   modelbox::ThreadPool pool(std::thread::hardware_concurrency());
   std::atomic<bool> is_stop_{false};
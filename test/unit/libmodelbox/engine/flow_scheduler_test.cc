@@ -16,6 +16,8 @@
 
 #include "engine/scheduler/flow_scheduler.h"
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <future>
 #include <thread>
@@ -132,4 +134,75 @@ TEST_F(FlowSchedulerTest, ShowScheduleStatus) {
   scheduler->Shutdown();
 }
 
-}  // namespace modelbox
\ No newline at end of file
+TEST_F(FlowSchedulerTest, StallDetect) {
+  auto graph = std::make_shared<Graph>();
+  auto flowunit_mgr = FlowUnitManager::GetInstance();
+  auto device_mgr = DeviceManager::GetInstance();
+  ConfigurationBuilder configbuilder;
+  auto config = configbuilder.Build();
+  config->SetProperty("graph.stall-timeout-ms", 200);
+  graph->Initialize(flowunit_mgr, device_mgr, nullptr, config);
+
+  auto node = std::make_shared<Node>();
+  node->SetFlowUnitInfo("tensorlist_test_1", "cpu", "0", flowunit_mgr);
+  node->SetName("stall_node");
+  node->Init({"IN1"}, {"OUT1"}, config);
+  node->SetSessionManager(&g_test_session_manager);
+  EXPECT_TRUE(graph->AddNode(node));
+
+  // data is queued but port is deactivated, node will never run
+  auto in_port = node->GetInputPort("IN1");
+  in_port->SetActiveState(false);
+  in_port->GetQueue()->Push(std::make_shared<Buffer>());
+
+  // schedule stats follow the fake clock, stall does not depend on sleeps
+  std::atomic<int64_t> now_ms{0};
+  auto scheduler = std::make_shared<FlowScheduler>();
+  scheduler->SetClock([&now_ms]() { return now_ms.load(); });
+  EXPECT_EQ(scheduler->Init(config), STATUS_OK);
+  EXPECT_EQ(scheduler->Build(*graph), STATUS_OK);
+  scheduler->SetCheckTimeout(10);
+
+  auto graph_item = Statistics::GetGlobalItem()->GetItem(
+      std::string(STATISTICS_ITEM_NODE) + "." + graph->GetId());
+  ASSERT_NE(graph_item, nullptr);
+  auto node_item = graph_item->GetItem("stall_node");
+  ASSERT_NE(node_item, nullptr);
+  auto idle_ms = node_item->GetItem("sched_idle_ms")->GetGauge();
+  auto wait_until = [](const std::function<bool()>& cond) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!cond()) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+
+      std::this_thread::yield();
+    }
+
+    return true;
+  };
+
+  scheduler->RunAsync();
+  // stats update once clock moves by check timeout
+  now_ms = 190;
+  ASSERT_TRUE(wait_until([&idle_ms]() { return idle_ms->Get() == 190; }));
+  EXPECT_EQ(scheduler->GetStallCount(), 0);
+  EXPECT_EQ(node_item->GetItem("sched_stalled")->GetGauge()->Get(), 0);
+
+  now_ms = 200;
+  auto stalled_nodes = graph_item->GetItem("sched_stalled_nodes")->GetGauge();
+  ASSERT_TRUE(
+      wait_until([&stalled_nodes]() { return stalled_nodes->Get() == 1; }));
+  EXPECT_EQ(scheduler->GetStallCount(), 1);
+  EXPECT_EQ(node_item->GetItem("sched_queue_depth")->GetGauge()->Get(), 1);
+  EXPECT_EQ(idle_ms->Get(), 200);
+  EXPECT_EQ(node_item->GetItem("sched_stalled")->GetGauge()->Get(), 1);
+
+  // still stalled, reported once
+  now_ms = 400;
+  ASSERT_TRUE(wait_until([&idle_ms]() { return idle_ms->Get() == 400; }));
+  EXPECT_EQ(scheduler->GetStallCount(), 1);
+  scheduler->Shutdown();
+}
+
+}  // namespace modelbox
@@ -122,6 +122,28 @@ class FlowUnitTest : public testing::Test {
     EXPECT_EQ(status_drivers_add, STATUS_OK);
   };
 
+  void AddMockFlowUnitDriver(const std::string& unit_name) {
+    MockFlowUnitDriverDesc desc_flowunit;
+    desc_flowunit.SetClass("DRIVER-FLOWUNIT");
+    desc_flowunit.SetType("cpu");
+    desc_flowunit.SetName(unit_name);
+    desc_flowunit.SetDescription("the cpu " + unit_name);
+    desc_flowunit.SetVersion("1.0.0");
+    std::string file_path_flowunit = std::string(TEST_LIB_DIR) +
+                                     "/libmodelbox-unit-cpu-" + unit_name +
+                                     ".so";
+    desc_flowunit.SetFilePath(file_path_flowunit);
+    auto mock_flowunit = std::make_shared<MockFlowUnit>();
+    auto mock_flowunit_desc = std::make_shared<FlowUnitDesc>();
+    mock_flowunit_desc->SetFlowUnitName(unit_name);
+    mock_flowunit_desc->AddFlowUnitInput(modelbox::FlowUnitInput("input"));
+    mock_flowunit_desc->AddFlowUnitOutput(modelbox::FlowUnitOutput("output"));
+    mock_flowunit->SetFlowUnitDesc(mock_flowunit_desc);
+    desc_flowunit.SetMockFlowUnit(mock_flowunit);
+    ctl.AddMockDriverFlowUnit(unit_name, "cpu", desc_flowunit);
+    EXPECT_EQ(Drivers::GetInstance()->Add(file_path_flowunit), STATUS_OK);
+  }
+
   virtual void TearDown() {
     std::shared_ptr<Drivers> drivers = Drivers::GetInstance();
     std::shared_ptr<DeviceManager> device_mgr = DeviceManager::GetInstance();
@@ -249,6 +271,88 @@ TEST_F(FlowUnitTest, CreateFlowUnit) {
   EXPECT_EQ(flowunit[0]->GetBindDevice()->GetDeviceID(), "0");
 }
 
+TEST_F(FlowUnitTest, CreateSharedFlowUnit) {
+  std::shared_ptr<Drivers> drivers = Drivers::GetInstance();
+  ConfigurationBuilder configbuilder;
+  auto device_mgr = DeviceManager::GetInstance();
+  device_mgr->Initialize(drivers, configbuilder.Build());
+  auto flowunit_mgr = FlowUnitManager::GetInstance();
+  flowunit_mgr->Initialize(drivers, device_mgr, configbuilder.Build());
+
+  ConfigurationBuilder builder_a;
+  builder_a.AddProperty("ip", "127.0.0.1");
+  builder_a.AddProperty("label", "node_a");
+  auto config_a = builder_a.Build();
+  ConfigurationBuilder builder_b;
+  builder_b.AddProperty("ip", "127.0.0.1");
+  builder_b.AddProperty("label", "node_b");
+  auto config_b = builder_b.Build();
+  ConfigurationBuilder builder_c;
+  builder_c.AddProperty("ip", "0.0.0.0");
+  auto config_c = builder_c.Build();
+
+  auto shared_a =
+      flowunit_mgr->CreateSharedFlowUnit("httpserver", "cpu", "0", config_a);
+  ASSERT_EQ(shared_a.size(), 1);
+  EXPECT_EQ(shared_a[0]->Open(config_a), STATUS_OK);
+
+  // label differs only, flowunit is shared
+  auto shared_b =
+      flowunit_mgr->CreateSharedFlowUnit("httpserver", "cpu", "0", config_b);
+  ASSERT_EQ(shared_b.size(), 1);
+  EXPECT_EQ(shared_a[0], shared_b[0]);
+  EXPECT_EQ(shared_b[0]->Open(config_b), STATUS_OK);
+
+  auto shared_c =
+      flowunit_mgr->CreateSharedFlowUnit("httpserver", "cpu", "0", config_c);
+  ASSERT_EQ(shared_c.size(), 1);
+  EXPECT_NE(shared_a[0], shared_c[0]);
+
+  // closed after released by all nodes
+  std::weak_ptr<SharedFlowUnit> shared_wp = shared_a[0];
+  shared_a.clear();
+  shared_b.clear();
+  EXPECT_TRUE(shared_wp.expired());
+}
+
+TEST_F(FlowUnitTest, LazyLoadDrivers) {
+  AddMockFlowUnitDriver("lazyunit");
+  std::shared_ptr<Drivers> drivers = Drivers::GetInstance();
+  ConfigurationBuilder configbuilder;
+  auto device_mgr = DeviceManager::GetInstance();
+  device_mgr->Initialize(drivers, configbuilder.Build());
+  auto flowunit_mgr = FlowUnitManager::GetInstance();
+  flowunit_mgr->SetFlowUnitFilter({"httpserver"});
+  flowunit_mgr->Initialize(drivers, device_mgr, configbuilder.Build());
+  EXPECT_EQ(flowunit_mgr->GetLazyDriverCount(), 1);
+
+  // flowunit in filter is found without loading others
+  EXPECT_EQ(flowunit_mgr->GetFlowUnitTypes("httpserver").size(), 1);
+  EXPECT_EQ(flowunit_mgr->GetLazyDriverCount(), 1);
+
+  // lookup miss loads the others
+  auto desc = flowunit_mgr->GetFlowUnitDesc("cpu", "lazyunit");
+  ASSERT_NE(desc, nullptr);
+  EXPECT_EQ(desc->GetFlowUnitName(), "lazyunit");
+  EXPECT_EQ(flowunit_mgr->GetLazyDriverCount(), 0);
+  EXPECT_EQ(flowunit_mgr->CreateFlowUnit("lazyunit", "cpu", "0").size(), 1);
+}
+
+TEST_F(FlowUnitTest, LazyLoadDriversNameMismatch) {
+  AddMockFlowUnitDriver("lazyunit");
+  std::shared_ptr<Drivers> drivers = Drivers::GetInstance();
+  ConfigurationBuilder configbuilder;
+  auto device_mgr = DeviceManager::GetInstance();
+  device_mgr->Initialize(drivers, configbuilder.Build());
+  auto flowunit_mgr = FlowUnitManager::GetInstance();
+
+  // no driver is named as flowunit, all drivers are loaded in Initialize
+  flowunit_mgr->SetFlowUnitFilter({"httpserver", "unit_in_other_driver"});
+  flowunit_mgr->Initialize(drivers, device_mgr, configbuilder.Build());
+  EXPECT_EQ(flowunit_mgr->GetLazyDriverCount(), 0);
+  EXPECT_EQ(flowunit_mgr->GetFlowUnitTypes("lazyunit").size(), 1);
+}
+
 TEST_F(FlowUnitTest, CreateFlowUnitFail) {
   std::shared_ptr<Drivers> drivers = Drivers::GetInstance();
   auto device_mgr = DeviceManager::GetInstance();
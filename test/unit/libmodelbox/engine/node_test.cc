@@ -977,6 +977,27 @@ TEST_F(NodeTest, SendEvent) {
   EXPECT_EQ(events->at(0), event);
 }
 
+TEST_F(NodeTest, SampleLatency) {
+  auto node = std::make_shared<Node>();
+  auto index_info = std::make_shared<BufferIndexInfo>();
+  EXPECT_FALSE(node->SampleLatency(index_info));
+  EXPECT_EQ(index_info->GetOriginTime(), 0);
+
+  node->SetLatencySampleInterval(3);
+  size_t sampled = 0;
+  for (size_t i = 0; i < 9; ++i) {
+    auto info = std::make_shared<BufferIndexInfo>();
+    if (node->SampleLatency(info)) {
+      ++sampled;
+      EXPECT_NE(info->GetOriginTime(), 0);
+    } else {
+      EXPECT_EQ(info->GetOriginTime(), 0);
+    }
+  }
+
+  EXPECT_EQ(sampled, 3);
+}
+
 TEST_F(NodeRecvTest, RecvEmpty) {
   std::list<std::shared_ptr<MatchStreamData>> match_stream_data_list;
   EXPECT_EQ(
@@ -75,6 +75,30 @@ TEST_F(InPortTest, GetDataCount) {
   EXPECT_EQ(port->GetDataCount(), 1);
 }
 
+TEST_F(InPortTest, SendTimeEvictOldest) {
+  auto port = std::make_shared<InPort>("In_1", nullptr);
+  std::vector<std::shared_ptr<BufferIndexInfo>> index_infos;
+  for (size_t i = 0; i < 1024 + 10; ++i) {
+    auto index_info = std::make_shared<BufferIndexInfo>();
+    port->SetSendTime(index_info, i + 1);
+    index_infos.push_back(index_info);
+  }
+
+  // oldest records are evicted, newest are kept
+  EXPECT_EQ(port->TakeSendTime(index_infos[0]), 0);
+  EXPECT_EQ(port->TakeSendTime(index_infos[9]), 0);
+  EXPECT_EQ(port->TakeSendTime(index_infos[10]), 11);
+  EXPECT_EQ(port->TakeSendTime(index_infos.back()), index_infos.size());
+  EXPECT_EQ(port->TakeSendTime(index_infos.back()), 0);
+
+  // record set again is not evicted by its older entry in order queue
+  port->SetSendTime(index_infos[11], 100);
+  for (size_t i = 0; i < 10; ++i) {
+    port->SetSendTime(std::make_shared<BufferIndexInfo>(), 0);
+  }
+  EXPECT_EQ(port->TakeSendTime(index_infos[11]), 100);
+}
+
 class EventPortTest : public testing::Test {
  public:
   EventPortTest() {}
@@ -17,7 +17,9 @@
 #include "modelbox/virtual_node.h"
 
 #include <fstream>
+#include <map>
 #include <string>
+#include <thread>
 
 #include "flowunit_mockflowunit/flowunit_mockflowunit.h"
 #include "gmock/gmock.h"
@@ -776,6 +778,100 @@ TEST_F(VirtualNodeTest, VirtualNode_Select_Timeout) {
   flow->Wait(5 * 1000);
 }
 
+TEST_F(VirtualNodeTest, VirtualNode_Select_MultiThread) {
+  std::string toml_content = R"(
+    [driver]
+    skip-default=true
+    dir=[")" + std::string(TEST_LIB_DIR) +
+                             "\"]\n    " +
+                             R"(
+    [graph]
+    graphconf = '''digraph demo {
+          input1[type=input, device=cpu,deviceid=0] 
+          output1[type=output, device=cpu, deviceid=0]
+          stream_start[type=flowunit, flowunit=virtual_stream_start, device=cpu, deviceid=0, label="<In_1> | <Out_1>"]
+          stream_mid[type=flowunit, flowunit=virtual_stream_mid, device=cpu, deviceid=0, label="<In_1> | <Out_1>", batch_size=5]
+          
+          input1 ->stream_start:In_1
+          stream_start:Out_1 ->stream_mid:In_1
+          stream_mid:Out_1->output1
+
+        }'''
+    format = "graphviz"
+  )";
+  auto ret = mock_flow_->BuildAndRun("VirtualNode_Select_MultiThread",
+                                     toml_content, -1);
+  auto flow = mock_flow_->GetFlow();
+
+  {
+    const size_t map_num = 4;
+    const size_t thread_num = 4;
+    auto selector = std::make_shared<ExternalDataSelect>();
+    EXPECT_GE(selector->GetSelectFd(), 0);
+    EXPECT_FALSE(selector->IsExternalDataReady());
+
+    std::vector<std::shared_ptr<ExternalDataMap>> ext_datas;
+    for (size_t i = 0; i < map_num; ++i) {
+      auto ext_data = flow->CreateExternalDataMap();
+      auto output_buf = ext_data->CreateBufferList();
+      output_buf->Build({3 * sizeof(int)});
+      auto data = (int*)output_buf->MutableData();
+      data[0] = 0;
+      data[1] = 25000;
+      data[2] = 3;
+      EXPECT_EQ(ext_data->Send("input1", output_buf), STATUS_SUCCESS);
+      EXPECT_EQ(ext_data->Close(), STATUS_SUCCESS);
+      selector->RegisterExternalData(ext_data);
+      ext_datas.push_back(ext_data);
+    }
+
+    std::mutex recv_lock;
+    std::map<std::shared_ptr<ExternalDataMap>, int> sizes;
+    std::atomic<size_t> eof_count{0};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_num; ++i) {
+      threads.emplace_back([&]() {
+        while (eof_count < map_num) {
+          std::list<std::shared_ptr<ExternalDataMap>> external_list;
+          auto select_status = selector->SelectExternalData(
+              external_list, std::chrono::milliseconds(100), 1);
+          if (select_status == STATUS_TIMEDOUT) {
+            continue;
+          }
+
+          EXPECT_EQ(external_list.size(), 1);
+          std::lock_guard<std::mutex> lock(recv_lock);
+          for (auto external : external_list) {
+            OutputBufferList map_buffer_list;
+            auto status = external->Recv(map_buffer_list, -1);
+            if (status == STATUS_EOF) {
+              eof_count++;
+            } else if (status == STATUS_SUCCESS && !map_buffer_list.empty()) {
+              sizes[external] += map_buffer_list["output1"]->Size();
+            }
+          }
+        }
+      });
+    }
+
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    EXPECT_EQ(eof_count, map_num);
+    for (auto& ext_data : ext_datas) {
+      EXPECT_EQ(sizes[ext_data], 8334);
+    }
+
+    std::list<std::shared_ptr<ExternalDataMap>> external_list;
+    EXPECT_EQ(selector->SelectExternalData(external_list,
+                                           std::chrono::milliseconds(100)),
+              STATUS_TIMEDOUT);
+  }
+
+  flow->Wait(5 * 1000);
+}
+
 TEST_F(VirtualNodeTest, VirtualNode_Muliti_Output) {
   std::string toml_content = R"(
     [driver]
@@ -20,6 +20,8 @@
 #include <fstream>
 #include <functional>
 #include <future>
+#include <mutex>
+#include <set>
 #include <thread>
 
 #include "engine/scheduler/flow_scheduler.h"
@@ -590,6 +592,67 @@ TEST_F(FlowTest, Statistics) {
   statistics->UnRegisterNotify(timer_notify_cfg);
 }
 
+TEST_F(FlowTest, LatencySample) {
+  const std::string test_lib_dir = TEST_LIB_DIR;
+  std::string toml_content = R"(
+    [driver]
+    skip-default=true
+    dir=[")" + test_lib_dir + "\"]\n    " +
+                             R"([graph]
+    latency-sample-interval = 1
+    graphconf = '''digraph demo {
+          input[type=input]
+          add_1[type=flowunit, flowunit=add_1, device=cpu, deviceid=0, label="<In_1> | <Out_1>"]
+          output[type=output]
+
+          input -> add_1:In_1
+          add_1:Out_1 -> output
+        }'''
+    format = "graphviz"
+  )";
+
+  auto flow = std::make_shared<Flow>();
+  auto ret = flow->Init("graph", toml_content);
+  EXPECT_EQ(ret, STATUS_OK);
+
+  ret = flow->Build();
+  EXPECT_EQ(ret, STATUS_OK);
+
+  flow->RunAsync();
+
+  const size_t buffer_num = 3;
+  auto external = flow->CreateExternalDataMap();
+  auto input_buffer = external->CreateBufferList();
+  input_buffer->Build(std::vector<size_t>(buffer_num, sizeof(int)));
+  external->Send("input", input_buffer);
+  size_t recv_num = 0;
+  while (recv_num < buffer_num) {
+    OutputBufferList output_buffer;
+    ASSERT_EQ(external->Recv(output_buffer), STATUS_SUCCESS);
+    recv_num += output_buffer["output"]->Size();
+  }
+  external->Close();
+
+  auto graph_id = flow->GetGraphId();
+  auto statistics = Statistics::GetGlobalItem();
+  auto queue_wait =
+      statistics->GetItem("node." + graph_id + ".add_1.queue_wait_us");
+  auto graph_latency =
+      statistics->GetItem("node." + graph_id + ".graph_latency_us");
+  ASSERT_NE(queue_wait, nullptr);
+  ASSERT_NE(graph_latency, nullptr);
+
+  // every buffer is sampled, each one waits on the edge from input once
+  auto queue_wait_snapshot = queue_wait->GetHistogram()->GetSnapshot();
+  EXPECT_EQ(queue_wait_snapshot.GetCount(), buffer_num);
+
+  auto graph_latency_snapshot = graph_latency->GetHistogram()->GetSnapshot();
+  EXPECT_EQ(graph_latency_snapshot.GetCount(), buffer_num);
+  EXPECT_GE(graph_latency_snapshot.GetMin(), queue_wait_snapshot.GetMin());
+
+  flow->Stop();
+}
+
 TEST_F(FlowTest, LoopGraph_All) {
   const std::string test_lib_dir = TEST_LIB_DIR;
   std::string toml_content = R"(
@@ -655,4 +718,104 @@ TEST_F(FlowTest, NormalError) {
   flow->Stop();
 }
 
+TEST_F(FlowTest, ShareInstance) {
+  SharedFlowUnitRegistry::GetInstance().Clear();
+  flow_->Destroy();
+  flow_ = std::make_shared<MockFlow>();
+  std::atomic<int> open_count{0};
+  std::mutex instances_lock;
+  std::set<MockFlowUnit*> instances;
+  auto mock_desc = GenerateFlowunitDesc("share_pass", {"In_1"}, {"Out_1"});
+  auto mock_functions = std::make_shared<MockFunctionCollection>();
+  mock_functions->RegisterOpenFunc(
+      [&](const std::shared_ptr<Configuration>& opts,
+          std::shared_ptr<MockFlowUnit> mock_flowunit) {
+        ++open_count;
+        return STATUS_OK;
+      });
+  mock_functions->RegisterProcessFunc(
+      [&](std::shared_ptr<DataContext> data_ctx,
+          std::shared_ptr<MockFlowUnit> mock_flowunit) {
+        {
+          std::lock_guard<std::mutex> lock(instances_lock);
+          instances.insert(mock_flowunit.get());
+        }
+
+        auto input = data_ctx->Input("In_1");
+        auto output = data_ctx->Output("Out_1");
+        for (auto& buffer : *input) {
+          output->PushBack(buffer);
+        }
+        return STATUS_OK;
+      });
+  flow_->AddFlowUnitDesc(mock_desc, mock_functions->GenerateCreateFunc());
+  flow_->Init(false);
+
+  const std::string test_lib_dir = TEST_LIB_DIR;
+  std::string toml_content = R"(
+    [driver]
+    skip-default=true
+    dir=[")" + test_lib_dir + "\"]\n    " +
+                             R"([graph]
+    graphconf = '''digraph demo {
+          input[type=input]
+          share_pass[type=flowunit, flowunit=share_pass, device=cpu, deviceid=0, share_instance=true]
+          output[type=output]
+
+          input -> share_pass:In_1
+          share_pass:Out_1 -> output
+        }'''
+    format = "graphviz"
+  )";
+
+  std::vector<std::shared_ptr<Flow>> flows;
+  for (int i = 0; i < 2; ++i) {
+    auto flow = std::make_shared<Flow>();
+    ASSERT_EQ(flow->Init("graph_" + std::to_string(i), toml_content),
+              STATUS_OK);
+    ASSERT_EQ(flow->Build(), STATUS_OK);
+    flow->RunAsync();
+    flows.push_back(flow);
+  }
+
+  // flows share one opened instance
+  EXPECT_EQ(open_count, 1);
+  EXPECT_EQ(SharedFlowUnitRegistry::GetInstance().Size(), 1);
+
+  // sessions of both flows run together, each receives its own data
+  std::vector<std::shared_ptr<ExternalDataMap>> externals;
+  for (size_t i = 0; i < flows.size(); ++i) {
+    auto external = flows[i]->CreateExternalDataMap();
+    auto buffer_list = external->CreateBufferList();
+    buffer_list->Build({sizeof(int)});
+    *(int*)buffer_list->MutableData() = (int)i + 100;
+    EXPECT_EQ(external->Send("input", buffer_list), STATUS_OK);
+    EXPECT_EQ(external->Close(), STATUS_OK);
+    externals.push_back(external);
+  }
+
+  for (size_t i = 0; i < externals.size(); ++i) {
+    OutputBufferList output;
+    EXPECT_EQ(externals[i]->Recv(output, 5 * 1000), STATUS_OK);
+    ASSERT_EQ(output.count("output"), 1);
+    auto buffer_list = output["output"];
+    ASSERT_EQ(buffer_list->Size(), 1);
+    EXPECT_EQ(*(const int*)buffer_list->ConstBufferData(0), (int)i + 100);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(instances_lock);
+    EXPECT_EQ(instances.size(), 1);
+  }
+
+  for (auto& flow : flows) {
+    flow->Stop();
+  }
+
+  // released with the last flow
+  externals.clear();
+  flows.clear();
+  EXPECT_EQ(SharedFlowUnitRegistry::GetInstance().Size(), 0);
+}
+
 }  // namespace modelbox
@@ -19,10 +19,13 @@
 
 #include <modelbox/base/any.h>
 #include <dirent.h>
+#include <signal.h>
 #include <sys/stat.h>
 
 #include <atomic>
+#include <fstream>
 
+#include "modelbox/base/utils.h"
 #include "modelbox/statistics.h"
 #include "gtest/gtest.h"
 #include "test_config.h"
@@ -557,3 +560,69 @@ TEST_F(ProfilerTest, Statistics) {
   EXPECT_EQ(delete_notify_count, 1);
   EXPECT_EQ(timer_notify_count, 1);
 }
+
+TEST_F(ProfilerTest, CpuSampler) {
+  std::string dir_path = std::string(TEST_DATA_DIR) + "/cpu_sample";
+  modelbox::CreateDirectory(dir_path);
+  modelbox::CpuSampler sampler(dir_path);
+  sampler.SetFrequency(1000);
+  auto node_id = modelbox::CpuSampler::Intern("busy_node");
+  auto session_id = modelbox::CpuSampler::Intern("busy_session");
+  EXPECT_EQ(modelbox::CpuSampler::Intern("busy_node"), node_id);
+  EXPECT_FALSE(modelbox::CpuSampler::IsSampling());
+
+  EXPECT_EQ(sampler.Start(), modelbox::STATUS_SUCCESS);
+  EXPECT_TRUE(modelbox::CpuSampler::IsSampling());
+  modelbox::CpuSampler other(dir_path);
+  EXPECT_EQ(other.Start(), modelbox::STATUS_BUSY);
+
+  {
+    modelbox::CpuSampleScope scope(node_id, session_id);
+    volatile uint64_t sum = 0;
+    auto begin = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - begin <
+           std::chrono::milliseconds(300)) {
+      sum += 1;
+    }
+  }
+
+  EXPECT_EQ(sampler.Stop(), modelbox::STATUS_SUCCESS);
+  EXPECT_FALSE(modelbox::CpuSampler::IsSampling());
+  EXPECT_GT(sampler.GetSampleCount(), 0);
+
+  std::vector<std::string> files;
+  modelbox::ListFiles(dir_path, "cpu_*.folded", &files);
+  ASSERT_FALSE(files.empty());
+  std::ifstream in(files[0]);
+  std::string content((std::istreambuf_iterator<char>(in)),
+                      std::istreambuf_iterator<char>());
+  EXPECT_NE(content.find("busy_node;session:busy_session "),
+            std::string::npos);
+  for (const auto &file : files) {
+    remove(file.c_str());
+  }
+  rmdir(dir_path.c_str());
+}
+
+TEST_F(ProfilerTest, CpuSamplerLowFrequency) {
+  std::string dir_path = std::string(TEST_DATA_DIR) + "/cpu_sample_low";
+  modelbox::CreateDirectory(dir_path);
+  Defer {
+    std::vector<std::string> files;
+    modelbox::ListFiles(dir_path, "cpu_*.folded", &files);
+    for (const auto &file : files) {
+      remove(file.c_str());
+    }
+    rmdir(dir_path.c_str());
+  };
+
+  // period of one second must be split into seconds and microseconds
+  modelbox::CpuSampler sampler(dir_path);
+  sampler.SetFrequency(1);
+  EXPECT_EQ(sampler.Start(), modelbox::STATUS_SUCCESS);
+  EXPECT_EQ(sampler.Stop(), modelbox::STATUS_SUCCESS);
+
+  // signal still pending after stop must not kill the process
+  raise(SIGPROF);
+  EXPECT_FALSE(modelbox::CpuSampler::IsSampling());
+}
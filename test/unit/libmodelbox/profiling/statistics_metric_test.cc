@@ -0,0 +1,230 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "modelbox/statistics_metric.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "modelbox/base/log.h"
+#include "modelbox/statistics.h"
+
+namespace modelbox {
+
+class StatisticsMetricTest : public testing::Test {
+ public:
+  StatisticsMetricTest() {}
+  virtual ~StatisticsMetricTest() {}
+
+ protected:
+  virtual void SetUp(){};
+  virtual void TearDown(){};
+};
+
+TEST_F(StatisticsMetricTest, Counter) {
+  StatisticsCounter counter;
+  const size_t thread_num = 8;
+  const size_t loop = 100000;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_num; ++i) {
+    threads.emplace_back([&counter]() {
+      for (size_t j = 0; j < loop; ++j) {
+        counter.Increase();
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter.Get(), thread_num * loop);
+  uint64_t val = 0;
+  EXPECT_TRUE(StatisticsValue(counter.GetValue()).GetUint64(val));
+  EXPECT_EQ(val, thread_num * loop);
+  counter.Reset();
+  EXPECT_EQ(counter.Get(), 0);
+}
+
+TEST_F(StatisticsMetricTest, Gauge) {
+  StatisticsGauge gauge;
+  gauge.Set(10);
+  gauge.Add(-15);
+  EXPECT_EQ(gauge.Get(), -5);
+  int64_t val = 0;
+  EXPECT_TRUE(StatisticsValue(gauge.GetValue()).GetInt64(val));
+  EXPECT_EQ(val, -5);
+}
+
+TEST_F(StatisticsMetricTest, HistogramBucket) {
+  size_t last_index = 0;
+  for (uint64_t v = 1; v < (1 << 20); ++v) {
+    auto index = StatisticsHistogram::GetBucketIndex(v);
+    EXPECT_TRUE(index == last_index || index == last_index + 1) << v;
+    EXPECT_LE(StatisticsHistogram::GetBucketLowerBound(index), v);
+    EXPECT_GE(StatisticsHistogram::GetBucketUpperBound(index), v);
+    last_index = index;
+  }
+
+  EXPECT_EQ(StatisticsHistogram::GetBucketIndex(UINT64_MAX),
+            StatisticsHistogram::BUCKET_NUM - 1);
+  EXPECT_EQ(StatisticsHistogram::GetBucketIndex(1ULL << 41),
+            StatisticsHistogram::BUCKET_NUM - 1);
+  EXPECT_EQ(StatisticsHistogram::GetBucketIndex(1ULL << 40),
+            StatisticsHistogram::BUCKET_NUM -
+                StatisticsHistogram::SUB_BUCKET_NUM);
+}
+
+TEST_F(StatisticsMetricTest, HistogramPercentile) {
+  StatisticsHistogram histogram;
+  auto snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.GetCount(), 0);
+  EXPECT_EQ(snapshot.GetPercentile(99), 0);
+
+  std::vector<uint64_t> values;
+  std::mt19937_64 rand(0);
+  std::lognormal_distribution<double> dist(8, 1.5);
+  for (size_t i = 0; i < 100000; ++i) {
+    values.push_back((uint64_t)dist(rand));
+  }
+
+  const size_t thread_num = 4;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_num; ++i) {
+    threads.emplace_back([&histogram, &values, i]() {
+      for (size_t j = i; j < values.size(); j += thread_num) {
+        histogram.Record(values[j]);
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  std::sort(values.begin(), values.end());
+  snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.GetCount(), values.size());
+  EXPECT_EQ(snapshot.GetMin(), values.front());
+  EXPECT_EQ(snapshot.GetMax(), values.back());
+  EXPECT_EQ(snapshot.GetPercentile(100), values.back());
+  for (auto p : {50.0, 90.0, 99.0, 99.9}) {
+    auto expect = values[(size_t)std::ceil(p / 100 * values.size()) - 1];
+    auto actual = snapshot.GetPercentile(p);
+    EXPECT_GE(actual, expect) << "p" << p;
+    EXPECT_LE(actual, expect + expect / 32 + 1) << "p" << p;
+  }
+
+  MBLOG_INFO << snapshot.ToString();
+  histogram.Reset();
+  EXPECT_EQ(histogram.GetSnapshot().GetCount(), 0);
+}
+
+TEST_F(StatisticsMetricTest, StatisticsItem) {
+  auto root = std::make_shared<StatisticsItem>();
+  auto counter_item = root->AddCounter("count");
+  ASSERT_NE(counter_item, nullptr);
+  EXPECT_TRUE(counter_item->IsLeaf());
+  EXPECT_TRUE(counter_item->IsMetric());
+  EXPECT_EQ(root->AddCounter("count"), counter_item);
+  EXPECT_EQ(root->AddGauge("count"), nullptr);
+  EXPECT_EQ(counter_item->AddItem("child"), nullptr);
+
+  EXPECT_EQ(counter_item->IncreaseValue((uint64_t)2), STATUS_OK);
+  EXPECT_EQ(root->IncreaseValue("count", (int32_t)3), STATUS_OK);
+  EXPECT_EQ(counter_item->IncreaseValue((int32_t)-1), STATUS_INVALID);
+  EXPECT_EQ(counter_item->IncreaseValue(1.0), STATUS_NOTSUPPORT);
+  EXPECT_EQ(counter_item->SetValue((uint64_t)1), STATUS_NOTSUPPORT);
+  counter_item->GetCounter()->Increase(5);
+  uint64_t count = 0;
+  EXPECT_EQ(counter_item->GetValue(count), STATUS_OK);
+  EXPECT_EQ(count, 10);
+  EXPECT_EQ(counter_item->GetValue()->ToString(), "10");
+
+  auto gauge_item = root->AddGauge("queue_size");
+  ASSERT_NE(gauge_item, nullptr);
+  EXPECT_EQ(gauge_item->GetCounter(), nullptr);
+  EXPECT_EQ(gauge_item->SetValue((int64_t)7), STATUS_OK);
+  EXPECT_EQ(gauge_item->IncreaseValue((int64_t)-2), STATUS_OK);
+  EXPECT_EQ(gauge_item->SetValue(std::string("7")), STATUS_NOTSUPPORT);
+  int64_t size = 0;
+  EXPECT_EQ(gauge_item->GetValue(size), STATUS_OK);
+  EXPECT_EQ(size, 5);
+
+  auto histogram_item = root->AddHistogram("latency");
+  ASSERT_NE(histogram_item, nullptr);
+  EXPECT_EQ(histogram_item->IncreaseValue((uint64_t)1), STATUS_NOTSUPPORT);
+  auto histogram = histogram_item->GetHistogram();
+  ASSERT_NE(histogram, nullptr);
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    histogram->Record(i);
+  }
+
+  auto value = histogram_item->GetValue();
+  ASSERT_NE(value, nullptr);
+  EXPECT_TRUE(value->IsHistogram());
+  StatisticsHistogramSnapshot snapshot;
+  EXPECT_TRUE(value->GetHistogram(snapshot));
+  EXPECT_EQ(snapshot.GetCount(), 1000);
+  EXPECT_EQ(snapshot.GetSum(), 500500);
+  EXPECT_NE(value->ToString().find("p999="), std::string::npos);
+}
+
+TEST_F(StatisticsMetricTest, Perf) {
+  const size_t thread_num = 4;
+  const size_t loop = 1000000;
+  auto root = std::make_shared<StatisticsItem>();
+  auto counter = root->AddCounter("count")->GetCounter();
+  auto histogram = root->AddHistogram("latency")->GetHistogram();
+  auto any_item = root->AddItem("any_count", (uint64_t)0);
+
+  auto run = [&](const std::function<void(size_t)>& func) {
+    std::vector<std::thread> threads;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < thread_num; ++i) {
+      threads.emplace_back([&func]() {
+        for (size_t j = 0; j < loop; ++j) {
+          func(j);
+        }
+      });
+    }
+
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    auto cost = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin)
+                    .count();
+    return (double)cost / (thread_num * loop);
+  };
+
+  auto counter_cost = run([&](size_t i) { counter->Increase(); });
+  auto histogram_cost = run([&](size_t i) { histogram->Record(i & 0xffff); });
+  auto any_cost = run([&](size_t i) { any_item->IncreaseValue((uint64_t)1); });
+  MBLOG_INFO << "ns per update, counter: " << counter_cost
+             << ", histogram: " << histogram_cost
+             << ", any value: " << any_cost;
+  EXPECT_EQ(counter->Get(), thread_num * loop);
+  EXPECT_EQ(histogram->GetSnapshot().GetCount(), thread_num * loop);
+}
+
+}  // namespace modelbox
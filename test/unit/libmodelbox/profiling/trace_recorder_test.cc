@@ -0,0 +1,193 @@
+/*
+ * Copyright 2021 The Modelbox Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "modelbox/trace_recorder.h"
+
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "modelbox/base/log.h"
+#include "test_config.h"
+
+namespace modelbox {
+
+class TraceRecorderTest : public testing::Test {
+ public:
+  TraceRecorderTest() {}
+  virtual ~TraceRecorderTest() {}
+
+ protected:
+  virtual void SetUp(){};
+  virtual void TearDown(){};
+};
+
+TEST_F(TraceRecorderTest, RingFull) {
+  TraceRing ring(4, 0);
+  TraceRecord record;
+  record.batch_size = 0;
+  for (uint32_t i = 0; i < 6; ++i) {
+    record.batch_size = i;
+    EXPECT_EQ(ring.Push(record), i < 4);
+  }
+
+  EXPECT_EQ(ring.GetDroppedCount(), 2);
+  std::vector<uint32_t> values;
+  EXPECT_EQ(ring.Drain([&](const TraceRecord& r) {
+    values.push_back(r.batch_size);
+  }), 4);
+  EXPECT_EQ(values, std::vector<uint32_t>({0, 1, 2, 3}));
+  EXPECT_TRUE(ring.Push(record));
+  EXPECT_EQ(ring.Drain([](const TraceRecord& r) {}), 1);
+}
+
+TEST_F(TraceRecorderTest, Record) {
+  TraceRecorder recorder(1024);
+  auto name_id = recorder.Intern("resize");
+  EXPECT_EQ(recorder.Intern("resize"), name_id);
+  EXPECT_EQ(recorder.Intern(""), 0);
+
+  auto now = std::chrono::steady_clock::now();
+  recorder.Record(name_id, TraceSliceType::PROCESS, now, now, 1);
+  EXPECT_EQ(recorder.Drain([](const TraceRecord& r,
+                              const std::vector<std::string>& names) {}),
+            0);
+
+  recorder.SetEnable(true);
+  const size_t thread_num = 4;
+  const size_t loop = 1000;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_num; ++i) {
+    threads.emplace_back([&recorder, name_id]() {
+      for (size_t j = 0; j < loop; ++j) {
+        auto begin = std::chrono::steady_clock::now();
+        recorder.Record(name_id, TraceSliceType::PROCESS, begin,
+                        std::chrono::steady_clock::now(), j);
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  size_t count = 0;
+  auto drained = recorder.Drain(
+      [&](const TraceRecord& r, const std::vector<std::string>& names) {
+        EXPECT_EQ(names[r.name_id], "resize");
+        EXPECT_LE(r.begin_ns, r.end_ns);
+        ++count;
+      });
+  EXPECT_EQ(drained, thread_num * loop);
+  EXPECT_EQ(count, thread_num * loop);
+  EXPECT_EQ(recorder.GetDroppedCount(), 0);
+}
+
+TEST_F(TraceRecorderTest, DrainNewName) {
+  TraceRecorder recorder(1024);
+  recorder.SetEnable(true);
+  auto name_id = recorder.Intern("resize");
+  auto now = std::chrono::steady_clock::now();
+  recorder.Record(name_id, TraceSliceType::PROCESS, now, now, 1);
+  EXPECT_EQ(recorder.Drain([](const TraceRecord& r,
+                              const std::vector<std::string>& names) {}),
+            1);
+
+  // interned after the last drain, unknown id is skipped
+  auto new_id = recorder.Intern("crop");
+  recorder.Record(new_id, TraceSliceType::PROCESS, now, now, 1);
+  recorder.Record(new_id + 100, TraceSliceType::PROCESS, now, now, 1);
+  std::vector<std::string> drained_names;
+  recorder.Drain(
+      [&](const TraceRecord& r, const std::vector<std::string>& names) {
+        ASSERT_LT(r.name_id, names.size());
+        drained_names.push_back(names[r.name_id]);
+      });
+  EXPECT_EQ(drained_names, std::vector<std::string>({"crop"}));
+}
+
+TEST_F(TraceRecorderTest, ChromeTraceWriter) {
+  std::string file_path = std::string(TEST_DATA_DIR) + "/trace_writer.json";
+  remove(file_path.c_str());
+  {
+    ChromeTraceWriter writer(file_path);
+    EXPECT_EQ(writer.Close(), STATUS_OK);
+    EXPECT_NE(access(file_path.c_str(), F_OK), 0);
+  }
+
+  ChromeTraceWriter writer(file_path);
+  EXPECT_FALSE(writer.IsProcessNamed(1));
+  writer.WriteProcessName(1, "Graph");
+  writer.WriteThreadName(1, 2, "re\"size");
+  EXPECT_TRUE(writer.IsProcessNamed(1));
+  EXPECT_TRUE(writer.IsThreadNamed(1, 2));
+  EXPECT_FALSE(writer.IsThreadNamed(1, 3));
+  for (uint64_t i = 0; i < 10000; ++i) {
+    writer.WriteSlice(1, 2, "PROCESS", 1000000000 + i * 1500, 1234, 8);
+  }
+
+  EXPECT_EQ(writer.GetEventCount(), 10002);
+  EXPECT_EQ(writer.Close(), STATUS_OK);
+
+  std::ifstream in(file_path);
+  auto trace = nlohmann::json::parse(in);
+  auto& events = trace["traceEvents"];
+  ASSERT_EQ(events.size(), 10002);
+  EXPECT_EQ(events[1]["args"]["name"], "re\"size");
+  EXPECT_EQ(events[2]["ph"], "X");
+  EXPECT_EQ(events[2]["tid"], 2);
+  EXPECT_DOUBLE_EQ(events[2]["ts"].get<double>(), 1000000);
+  EXPECT_DOUBLE_EQ(events[3]["ts"].get<double>(), 1000001.5);
+  EXPECT_DOUBLE_EQ(events[3]["dur"].get<double>(), 1.234);
+  EXPECT_EQ(events[3]["args"]["batch_size"], 8);
+  remove(file_path.c_str());
+}
+
+TEST_F(TraceRecorderTest, Perf) {
+  const size_t thread_num = 4;
+  const size_t loop = 10000;
+  TraceRecorder recorder(loop);
+  auto name_id = recorder.Intern("infer");
+  recorder.SetEnable(true);
+
+  std::vector<std::thread> threads;
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < thread_num; ++i) {
+    threads.emplace_back([&recorder, name_id]() {
+      auto now = std::chrono::steady_clock::now();
+      for (size_t j = 0; j < loop; ++j) {
+        recorder.Record(name_id, TraceSliceType::PROCESS, now, now, 1);
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  auto cost = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - begin)
+                  .count();
+  MBLOG_INFO << "ns per record: " << (double)cost / (thread_num * loop);
+  EXPECT_EQ(recorder.Drain([](const TraceRecord& r,
+                              const std::vector<std::string>& names) {}),
+            thread_num * loop);
+}
+
+}  // namespace modelbox
@@ -22,8 +22,11 @@
 #include <ftw.h>
 #include <modelbox/base/popen.h>
 #include <stdio.h>
+#include <sys/socket.h>
 
+#include <chrono>
 #include <fstream>
+#include <functional>
 #include <future>
 #include <nlohmann/json.hpp>
 
@@ -33,6 +36,7 @@
 #include "mock_tool.h"
 #include "mockflow.h"
 #include "modelbox/server/job_manager.h"
+#include "modelbox/server/stream_protocol.h"
 #include "src/modelbox/server/config.h"
 #include "test_config.h"
 #include "thread"
@@ -51,6 +55,7 @@ class ModelboxServerTest : public testing::Test {
     flow_->Init(false);
     flow_->Register_Test_0_2_Flowunit();
     flow_->Register_Test_OK_2_0_Flowunit();
+    flow_->Register_Add_Flowunit();
   };
   virtual void TearDown() { flow_->Destroy(); };
 
@@ -164,6 +169,37 @@ httplib::Response QueryJob(MockServer &server, const std::string &name) {
   return server.DoRequest(request);
 }
 
+httplib::Response QueryWarmGraph(MockServer &server, const std::string &name) {
+  HttpRequest request(HttpMethods::GET,
+                      server.GetServerURL() + "/v1/modelbox/job/warm/" + name);
+  return server.DoRequest(request);
+}
+
+// poll query until result matches or deadline
+nlohmann::json PollQuery(
+    const std::function<httplib::Response()> &query,
+    const std::function<bool(const nlohmann::json &)> &done,
+    int timeout_ms = 10000) {
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(timeout_ms);
+  nlohmann::json result;
+  while (true) {
+    auto response = query();
+    if (response.status == HttpStatusCodes::OK) {
+      result = nlohmann::json::parse(response.body);
+      if (done(result)) {
+        return result;
+      }
+    }
+
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return result;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+}
+
 httplib::Response DeleteJob(MockServer &server, const std::string &name) {
   HttpRequest request(HttpMethods::DELETE,
                       server.GetServerURL() + "/v1/modelbox/job/" + name);
@@ -364,6 +400,217 @@ TEST_F(ModelboxServerTest, DeleteJob) {
   EXPECT_EQ(response.status, HttpStatusCodes::NOT_FOUND);
 }
 
+TEST_F(ModelboxServerTest, CreateJobAsync) {
+  MockServer server;
+  auto ret = server.Init(nullptr);
+  if (ret == STATUS_NOTSUPPORT) {
+    GTEST_SKIP();
+  }
+  server.Start();
+  auto body = GetCreateJobMsg("example");
+  body["async"] = true;
+  auto response = CreateJob(server, body);
+  MBLOG_INFO << response.body;
+  EXPECT_EQ(response.status, HttpStatusCodes::ACCEPTED);
+  auto result = nlohmann::json::parse(response.body);
+  EXPECT_EQ(result["job_id"], "example");
+
+  const std::string creating = Job::JobStatusToString(JOB_STATUS_CREATING);
+  result = PollQuery([&]() { return QueryJob(server, "example"); },
+                     [&](const nlohmann::json &job) {
+                       return job["job_status"] != creating;
+                     });
+  EXPECT_EQ(result["job_status"], "RUNNING");
+  EXPECT_FALSE(result["job_warm_start"].get<bool>());
+}
+
+TEST_F(ModelboxServerTest, CreateJobWarmGraph) {
+  const std::string test_lib_dir = TEST_LIB_DIR;
+  std::string graph_path = MockServer::GetTestGraphDir() + "/warm_demo.toml";
+  std::string toml_content = R"(
+    [driver]
+    skip-default=true
+    dir=[")" + test_lib_dir + "\"]\n    " +
+                             R"(
+    [graph]
+    graphconf = '''digraph warm_demo {
+          IN[flowunit=test_0_2]
+          OUT[flowunit=test_ok_2_0]
+          IN:Out_1->OUT:In_1
+          IN:Out_2->OUT:In_2
+        }'''
+    format = "graphviz"
+  )";
+
+  MockServer server;
+  CreateDirectory(MockServer::GetTestGraphDir());
+  std::ofstream out(graph_path, std::ios::trunc);
+  out << toml_content;
+  out.close();
+  Defer { remove(graph_path.c_str()); };
+
+  auto conf = std::make_shared<Configuration>();
+  std::vector<std::string> plugin_path;
+  plugin_path.push_back(MODELBOX_PLUGIN_SO_PATH);
+  conf->SetProperty("plugin.files", plugin_path);
+  conf->SetProperty("job.warm_graphs", std::vector<std::string>{graph_path});
+  auto ret = server.Init(conf);
+  if (ret == STATUS_NOTSUPPORT) {
+    GTEST_SKIP();
+  }
+  server.Start();
+
+  auto query_warm = [&]() { return QueryWarmGraph(server, "warm_demo"); };
+  auto warm = PollQuery(query_warm, [](const nlohmann::json &result) {
+    return result["ready"].get<bool>();
+  });
+  ASSERT_TRUE(warm["ready"].get<bool>());
+  EXPECT_EQ(warm["idle"], 1);
+
+  nlohmann::json body;
+  body["job_id"] = "example";
+  body["job_graph_name"] = "warm_demo";
+  auto response = CreateJob(server, body);
+  MBLOG_INFO << response.body;
+  EXPECT_EQ(response.status, HttpStatusCodes::CREATED);
+  response = QueryJob(server, "example");
+  auto result = nlohmann::json::parse(response.body);
+  EXPECT_EQ(result["job_status"], "RUNNING");
+  // warm flow is taken, job skipped build
+  EXPECT_TRUE(result["job_warm_start"].get<bool>());
+
+  // taken flow is refilled in background
+  warm = PollQuery(query_warm, [](const nlohmann::json &result) {
+    return result["ready"].get<bool>() && result["idle"] == 1;
+  });
+  EXPECT_EQ(warm["idle"], 1);
+  EXPECT_EQ(QueryWarmGraph(server, "not_exist").status,
+            HttpStatusCodes::NOT_FOUND);
+
+  body["job_id"] = "not_exist";
+  body["job_graph_name"] = "not_exist";
+  response = CreateJob(server, body);
+  EXPECT_EQ(response.status, HttpStatusCodes::BAD_REQUEST);
+}
+
+TEST_F(ModelboxServerTest, ReloadJob) {
+  MockServer server;
+  auto ret = server.Init(nullptr);
+  if (ret == STATUS_NOTSUPPORT) {
+    GTEST_SKIP();
+  }
+  server.Start();
+
+  auto body = GetCreateJobMsg("example");
+  auto response = CreateJob(server, body);
+  EXPECT_EQ(response.status, HttpStatusCodes::CREATED);
+
+  body["reload"] = true;
+  body["drain_timeout_ms"] = 1000;
+  response = CreateJob(server, body);
+  MBLOG_INFO << response.body;
+  EXPECT_EQ(response.status, HttpStatusCodes::OK);
+  auto result = nlohmann::json::parse(response.body);
+  // request returns after switch, old graph drains in background
+  auto state = result["job_reload"]["state"].get<std::string>();
+  EXPECT_TRUE(state == "DRAINING" || state == "SUCCEEDED");
+
+  result = PollQuery([&]() { return QueryJob(server, "example"); },
+                     [](const nlohmann::json &job) {
+                       return job["job_reload"]["state"] == "SUCCEEDED";
+                     });
+  EXPECT_EQ(result["job_status"], "RUNNING");
+  EXPECT_EQ(result["job_reload"]["state"], "SUCCEEDED");
+  EXPECT_EQ(result["job_reload"]["dropped_sessions"], 0);
+
+  body["job_id"] = "not_exist";
+  response = CreateJob(server, body);
+  EXPECT_EQ(response.status, HttpStatusCodes::BAD_REQUEST);
+}
+
+TEST_F(ModelboxServerTest, ReloadJobKeepSession) {
+  const std::string test_lib_dir = TEST_LIB_DIR;
+  std::string toml_content = R"(
+    [driver]
+    skip-default=true
+    dir=[")" + test_lib_dir + "\"]\n    " +
+                             R"(
+    [graph]
+    graphconf = '''digraph reload_demo {
+          input1[type=input]
+          input2[type=input]
+          add[type=flowunit, flowunit=add, device=cpu, deviceid=0, label="<In_1> | <In_2> | <Out_1>"]
+          output1[type=output]
+          input1 -> add:In_1
+          input2 -> add:In_2
+          add:Out_1 -> output1
+        }'''
+    format = "graphviz"
+  )";
+
+  auto send_add = [](const std::shared_ptr<ExternalDataMap> &external,
+                     int value) {
+    for (const auto &port : {"input1", "input2"}) {
+      auto buffer_list = external->CreateBufferList();
+      buffer_list->Build({sizeof(int)});
+      *(int *)buffer_list->MutableData() = value;
+      EXPECT_EQ(external->Send(port, buffer_list), STATUS_SUCCESS);
+    }
+  };
+
+  auto recv_add = [](const std::shared_ptr<ExternalDataMap> &external) {
+    OutputBufferList output;
+    EXPECT_EQ(external->Recv(output, 10000), STATUS_SUCCESS);
+    auto result = output["output1"];
+    if (result == nullptr || result->Size() != 1) {
+      return -1;
+    }
+
+    return *(const int *)result->ConstData();
+  };
+
+  auto job = std::make_shared<Job>("reload_session", "reload_demo",
+                                   toml_content);
+  ASSERT_EQ(job->Init(), STATUS_OK);
+  ASSERT_EQ(job->Build(), STATUS_OK);
+  job->Run();
+  Defer { job->Stop(); };
+
+  auto old_flow = job->GetFlow();
+  auto external = old_flow->CreateExternalDataMap();
+  send_add(external, 1);
+  EXPECT_EQ(recv_add(external), 2);
+
+  // session stays open across reload and finishes on old graph
+  ASSERT_EQ(job->Reload("reload_demo", toml_content, 10000), STATUS_OK);
+  EXPECT_NE(job->GetFlow(), old_flow);
+  EXPECT_EQ(job->GetReloadInfo().state_, JOB_RELOAD_DRAINING);
+
+  send_add(external, 2);
+  EXPECT_EQ(recv_add(external), 4);
+  external->Close();
+  OutputBufferList output;
+  EXPECT_EQ(external->Recv(output, 10000), STATUS_EOF);
+  external = nullptr;
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (job->GetReloadInfo().state_ == JOB_RELOAD_DRAINING &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  auto info = job->GetReloadInfo();
+  EXPECT_EQ(info.state_, JOB_RELOAD_SUCCEEDED);
+  EXPECT_EQ(info.dropped_sessions_, 0U);
+  EXPECT_EQ(Job::JobReloadStateToString(info.state_), "SUCCEEDED");
+
+  // new sessions run on new graph
+  external = job->GetFlow()->CreateExternalDataMap();
+  send_add(external, 3);
+  EXPECT_EQ(recv_add(external), 6);
+  external->Close();
+}
+
 TEST_F(ModelboxServerTest, QueryDemo) {
   MockServer server;
   std::string demo_root_dir = std::string(TEST_DATA_DIR) + "/demo";
@@ -678,6 +925,236 @@ TEST_F(ModelboxServerTest, Stat) {
   server.Stop();
 }
 
+TEST_F(ModelboxServerTest, Metrics) {
+  if (access(MODELBOX_PLUGIN_METRICS_SO_PATH, F_OK) != 0) {
+    GTEST_SKIP();
+  }
+
+  MockServer server;
+  auto conf = std::make_shared<Configuration>();
+  std::vector<std::string> plugin_path;
+  plugin_path.push_back(MODELBOX_PLUGIN_SO_PATH);
+  plugin_path.push_back(MODELBOX_PLUGIN_EDITOR_SO_PATH);
+  plugin_path.push_back(MODELBOX_PLUGIN_METRICS_SO_PATH);
+  conf->SetProperty("plugin.files", plugin_path);
+  conf->SetProperty("metrics.enable", "true");
+  auto retval = server.Init(conf);
+  if (retval == STATUS_NOTSUPPORT) {
+    GTEST_SKIP();
+  }
+  server.Start();
+
+  auto root = modelbox::Statistics::GetGlobalItem();
+  auto graph_item = root->GetItem(modelbox::STATISTICS_ITEM_FLOW)
+                        ->AddItem("metrics_graph");
+  auto session_item = graph_item->AddItem("session");
+  session_item->MarkSession();
+  auto node_item = session_item->AddItem("decoder");
+  node_item->AddCounter("frame_count")->IncreaseValue((uint64_t)5);
+  node_item->AddItem("codec", std::string("h264"));
+  session_item->AddGauge("mem_live_bytes")->GetGauge()->Set(100);
+  auto other_session_item = graph_item->AddItem("other_session");
+  other_session_item->MarkSession();
+  auto other_node_item = other_session_item->AddItem("decoder");
+  other_node_item->AddCounter("frame_count")->IncreaseValue((uint64_t)3);
+  other_session_item->AddGauge("mem_live_bytes")->GetGauge()->Set(28);
+  auto task_item = graph_item->AddItem("task");
+  task_item->AddItem("high")
+      ->AddHistogram("queue_time_us")
+      ->GetHistogram()
+      ->Record(10);
+  task_item->AddGauge("running")->GetGauge()->Set(2);
+  auto latency = root->GetItem(modelbox::STATISTICS_ITEM_NODE)
+                     ->AddItem("metrics_graph")
+                     ->AddItem("decoder")
+                     ->AddHistogram("process_latency_us");
+  latency->GetHistogram()->Record(100);
+  Defer {
+    root->GetItem(modelbox::STATISTICS_ITEM_FLOW)->DelItem("metrics_graph");
+    root->GetItem(modelbox::STATISTICS_ITEM_NODE)->DelItem("metrics_graph");
+  };
+
+  HttpRequest request(HttpMethods::GET, server.GetServerURL() + "/metrics");
+  auto response = server.DoRequest(request);
+  EXPECT_EQ(response.status, HttpStatusCodes::OK);
+  MBLOG_INFO << response.body;
+  EXPECT_NE(response.body.find("# TYPE modelbox_flow_frame_count_total counter"),
+            std::string::npos);
+  // sessions are summed into one series
+  EXPECT_NE(
+      response.body.find("modelbox_flow_frame_count_total{graph=\"metrics_"
+                         "graph\",node=\"decoder\"} 8\n"),
+      std::string::npos);
+  EXPECT_EQ(response.body.find("session=\""), std::string::npos);
+  EXPECT_EQ(response.body.find("other_session"), std::string::npos);
+  EXPECT_NE(response.body.find("modelbox_flow_sessions{graph=\"metrics_"
+                               "graph\"} 2\n"),
+            std::string::npos);
+  // flow.<graph>.<session>.<name> has no node label
+  EXPECT_NE(response.body.find("modelbox_flow_mem_live_bytes{graph=\"metrics_"
+                               "graph\"} 128\n"),
+            std::string::npos);
+  // graph level items keep their path in the name and keep quantiles
+  EXPECT_NE(response.body.find("modelbox_flow_task_high_queue_time_us{graph="
+                               "\"metrics_graph\",quantile=\"0.5\"} 10\n"),
+            std::string::npos);
+  EXPECT_NE(response.body.find("modelbox_flow_task_running{graph=\"metrics_"
+                               "graph\"} 2\n"),
+            std::string::npos);
+  EXPECT_EQ(response.body.find("node=\"high\""), std::string::npos);
+  EXPECT_EQ(response.body.find("node=\"task\""), std::string::npos);
+  EXPECT_NE(response.body.find("modelbox_node_process_latency_us_count{graph="
+                               "\"metrics_graph\",node=\"decoder\"} 1"),
+            std::string::npos);
+  EXPECT_EQ(response.body.find("codec"), std::string::npos);
+  EXPECT_NE(response.body.find("process_resident_memory_bytes"),
+            std::string::npos);
+
+  // counter keeps the share of finished session, gauge drops it
+  graph_item->DelItem("other_session");
+  response = server.DoRequest(request);
+  EXPECT_EQ(response.status, HttpStatusCodes::OK);
+  EXPECT_NE(
+      response.body.find("modelbox_flow_frame_count_total{graph=\"metrics_"
+                         "graph\",node=\"decoder\"} 8\n"),
+      std::string::npos);
+  EXPECT_NE(response.body.find("modelbox_flow_mem_live_bytes{graph=\"metrics_"
+                               "graph\"} 100\n"),
+            std::string::npos);
+  server.Stop();
+}
+
+TEST_F(ModelboxServerTest, Stream) {
+  if (access(MODELBOX_PLUGIN_STREAM_SO_PATH, F_OK) != 0) {
+    GTEST_SKIP();
+  }
+
+  const std::string test_lib_dir = TEST_LIB_DIR;
+  std::string graph_path = MockServer::GetTestGraphDir() + "/stream_add.toml";
+  std::string socket_path = std::string(TEST_DATA_DIR) + "/stream.sock";
+  std::string toml_content = R"(
+    [driver]
+    skip-default=true
+    dir=[")" + test_lib_dir + "\"]\n    " +
+                             R"(
+    [graph]
+    graphconf = '''digraph stream_add {
+          input1[type=input]
+          input2[type=input]
+          output1[type=output]
+          add[type=flowunit, flowunit=add, device=cpu, deviceid=0]
+          input1 -> add:In_1
+          input2 -> add:In_2
+          add:Out_1 -> output1
+        }'''
+    format = "graphviz"
+  )";
+
+  MockServer server;
+  CreateDirectory(MockServer::GetTestGraphDir());
+  std::ofstream out(graph_path, std::ios::trunc);
+  out << toml_content;
+  out.close();
+  Defer { remove(graph_path.c_str()); };
+
+  auto conf = std::make_shared<Configuration>();
+  std::vector<std::string> plugin_path;
+  plugin_path.push_back(MODELBOX_PLUGIN_SO_PATH);
+  plugin_path.push_back(MODELBOX_PLUGIN_STREAM_SO_PATH);
+  conf->SetProperty("plugin.files", plugin_path);
+  conf->SetProperty("stream.enable", "true");
+  conf->SetProperty("stream.listen", socket_path);
+  conf->SetProperty("stream.graphs", std::vector<std::string>{graph_path});
+  auto retval = server.Init(conf);
+  if (retval == STATUS_NOTSUPPORT) {
+    GTEST_SKIP();
+  }
+  server.Start();
+
+  {
+    StreamClient client;
+    EXPECT_FALSE(client.Open(socket_path, "not_exist"));
+  }
+
+  {
+    // session without data
+    StreamClient client;
+    ASSERT_EQ(client.Open(socket_path), STATUS_OK);
+    EXPECT_EQ(client.End(), STATUS_OK);
+    StreamFrame frame;
+    EXPECT_EQ(client.Recv(&frame), STATUS_EOF);
+  }
+
+  StreamClient client;
+  ASSERT_EQ(client.Open(socket_path, "stream_add"), STATUS_OK);
+  const int frame_num = 5;
+  const int data_len = 100;
+  std::vector<int> data(data_len);
+  for (int i = 0; i < frame_num; ++i) {
+    for (int j = 0; j < data_len; ++j) {
+      data[j] = i * data_len + j;
+    }
+
+    EXPECT_EQ(client.Send("input1", data.data(), data_len * sizeof(int),
+                          R"({"index": 1})"),
+              STATUS_OK);
+    EXPECT_EQ(client.Send("input2", data.data(), data_len * sizeof(int)),
+              STATUS_OK);
+  }
+  // half closed client still receives all results
+  EXPECT_EQ(client.End(true), STATUS_OK);
+
+  StreamFrame frame;
+  int result_num = 0;
+  Status ret;
+  while ((ret = client.Recv(&frame)) == STATUS_OK) {
+    EXPECT_EQ(frame.type, STREAM_FRAME_RESULT);
+    EXPECT_EQ(frame.name, "output1");
+    ASSERT_EQ(frame.data_len, data_len * sizeof(int));
+    auto result = (int *)frame.data.get();
+    for (int j = 0; j < data_len; ++j) {
+      EXPECT_EQ(result[j], 2 * (result_num * data_len + j));
+    }
+    result_num++;
+  }
+
+  EXPECT_EQ(ret, STATUS_EOF);
+  EXPECT_EQ(result_num, frame_num);
+  client.Close();
+  server.Stop();
+  EXPECT_NE(access(socket_path.c_str(), F_OK), 0);
+}
+
+TEST_F(ModelboxServerTest, StreamLimit) {
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+  StreamConnection writer(fds[0]);
+  StreamConnection reader(fds[1]);
+  reader.SetMaxDataLen(64);
+
+  std::vector<uint8_t> data(128, 1);
+  EXPECT_EQ(writer.WriteFrame(STREAM_FRAME_DATA, "input1", "", data.data(),
+                              64),
+            STATUS_OK);
+  StreamFrame frame;
+  EXPECT_EQ(reader.ReadFrame(&frame), STATUS_OK);
+  EXPECT_EQ(frame.data_len, 64);
+
+  // rejected from header, before data is allocated
+  EXPECT_EQ(writer.WriteFrame(STREAM_FRAME_DATA, "input1", "", data.data(),
+                              data.size()),
+            STATUS_OK);
+  EXPECT_EQ(reader.ReadFrame(&frame), STATUS_INVALID);
+
+  // no authentication, tcp listens on loopback only by default
+  int fd = -1;
+  EXPECT_EQ(StreamListen("tcp://0.0.0.0:0", &fd), STATUS_PERMIT);
+  ASSERT_EQ(StreamListen("tcp://127.0.0.1:0", &fd), STATUS_OK);
+  close(fd);
+  ASSERT_EQ(StreamListen("tcp://0.0.0.0:0", &fd, true), STATUS_OK);
+  close(fd);
+}
+
 TEST_F(ModelboxServerTest, JSPlugin) {
   const std::string test_etc_dir = TEST_DATA_DIR;
   const std::string test_js_path = test_etc_dir + "/modelbox-plugin-billing.js";
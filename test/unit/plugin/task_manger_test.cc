@@ -259,4 +259,357 @@ TEST_F(TaskManagerTest, TaskInQueue) {
   EXPECT_EQ(finish_tasks, 3);
 }
 
-}  // namespace modelbox
\ No newline at end of file
+static std::shared_ptr<OneShotTask> CreateTestTask(
+    std::shared_ptr<TaskManager> tm, TaskPriority priority) {
+  auto task =
+      std::dynamic_pointer_cast<OneShotTask>(tm->CreateTask(TASK_ONESHOT));
+  auto output_buf = task->CreateBufferList();
+  output_buf->Build({3 * sizeof(int)});
+  auto data = (int*)output_buf->MutableData();
+  data[0] = 0;
+  data[1] = 40000;
+  data[2] = 3;
+  std::unordered_map<std::string, std::shared_ptr<BufferList>> datas;
+  datas.emplace("input1", output_buf);
+  task->FillData(datas);
+  task->SetPriority(priority);
+  return task;
+}
+
+TEST_F(TaskManagerTest, MultiReceiveThread) {
+  const uint32_t task_limit = 2;
+  const int task_num = 8;
+  auto tm = std::make_shared<TaskManager>(mockflow_->GetFlow(), task_limit);
+  ConfigurationBuilder builder;
+  builder.AddProperty("task.receive-thread-num", "4");
+  tm->SetConfig(builder.Build());
+  EXPECT_EQ(tm->Start(), STATUS_SUCCESS);
+
+  std::vector<std::shared_ptr<OneShotTask>> tasks;
+  for (int i = 0; i < task_num; i++) {
+    auto task = CreateTestTask(tm, TASK_PRIORITY_NORMAL);
+    EXPECT_EQ(task->Start(), STATUS_SUCCESS);
+    tasks.push_back(task);
+  }
+
+  // waiting task is started once, running tasks never exceed limit
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  int finished = 0;
+  while (finished < task_num && std::chrono::steady_clock::now() < deadline) {
+    uint32_t working = 0;
+    finished = 0;
+    for (auto &task : tasks) {
+      auto task_status = task->GetTaskStatus();
+      working += task_status == WORKING ? 1 : 0;
+      finished += task_status == FINISHED ? 1 : 0;
+    }
+
+    EXPECT_LE(working, task_limit);
+    usleep(10 * 1000);
+  }
+
+  EXPECT_EQ(finished, task_num);
+
+  // running slots are all released
+  std::vector<std::shared_ptr<OneShotTask>> next_tasks;
+  for (uint32_t i = 0; i < task_limit; i++) {
+    auto task = CreateTestTask(tm, TASK_PRIORITY_NORMAL);
+    EXPECT_EQ(task->Start(), STATUS_SUCCESS);
+    next_tasks.push_back(task);
+  }
+
+  for (auto &task : next_tasks) {
+    for (int i = 0; i < 100 && task->GetTaskStatus() == WAITING; i++) {
+      usleep(100 * 1000);
+    }
+    EXPECT_NE(WAITING, task->GetTaskStatus());
+    task->Stop();
+  }
+  tm->Stop();
+}
+
+// task blocks in feeding until released, so it holds a running slot
+class BlockingTask : public OneShotTask {
+ public:
+  void Release() {
+    std::lock_guard<std::mutex> guard(block_lock_);
+    released_ = true;
+    block_cv_.notify_all();
+  }
+
+  bool WaitRunning() {
+    std::unique_lock<std::mutex> guard(block_lock_);
+    return block_cv_.wait_for(guard, std::chrono::seconds(10),
+                              [this]() { return running_; });
+  }
+
+  bool WaitEnd() {
+    std::unique_lock<std::mutex> guard(block_lock_);
+    return block_cv_.wait_for(guard, std::chrono::seconds(10),
+                              [this]() { return ended_; });
+  }
+
+ protected:
+  Status FeedData() override {
+    {
+      std::unique_lock<std::mutex> guard(block_lock_);
+      running_ = true;
+      block_cv_.notify_all();
+      block_cv_.wait(guard, [this]() { return released_; });
+    }
+
+    return OneShotTask::FeedData();
+  }
+
+  void FetchData(Status fetch_status, OutputBufferList& output_buf) override {
+    OneShotTask::FetchData(fetch_status, output_buf);
+    if (fetch_status == STATUS_SUCCESS) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(block_lock_);
+    ended_ = true;
+    block_cv_.notify_all();
+  }
+
+ private:
+  std::mutex block_lock_;
+  std::condition_variable block_cv_;
+  bool running_{false};
+  bool released_{false};
+  bool ended_{false};
+};
+
+static std::shared_ptr<BlockingTask> CreateBlockingTask(
+    std::shared_ptr<TaskManager> tm, TaskPriority priority,
+    size_t buffer_num = 1) {
+  auto task = std::make_shared<BlockingTask>();
+  tm->RegisterTask(task);
+  auto output_buf = task->CreateBufferList();
+  output_buf->Build(std::vector<size_t>(buffer_num, 3 * sizeof(int)));
+  for (size_t i = 0; i < buffer_num; i++) {
+    auto data = (int*)output_buf->At(i)->MutableData();
+    data[0] = 0;
+    data[1] = 3;
+    data[2] = 3;
+  }
+  std::unordered_map<std::string, std::shared_ptr<BufferList>> datas;
+  datas.emplace("input1", output_buf);
+  task->FillData(datas);
+  task->SetPriority(priority);
+  return task;
+}
+
+static void FinishBlockingTask(const std::shared_ptr<BlockingTask>& task) {
+  task->Release();
+  EXPECT_TRUE(task->WaitEnd());
+  EXPECT_EQ(FINISHED, task->GetTaskStatus());
+}
+
+static std::shared_ptr<StatisticsItem> GetTaskStats(
+    const std::shared_ptr<Flow>& flow, const std::string& path) {
+  return Statistics::GetGlobalItem()->GetItem(
+      std::string(STATISTICS_ITEM_FLOW) + "." + flow->GetGraphId() +
+      ".task." + path);
+}
+
+TEST_F(TaskManagerTest, TaskPriority) {
+  auto flow = mockflow_->GetFlow();
+  auto tm = std::make_shared<TaskManager>(flow, 1);
+  auto status = tm->Start();
+  EXPECT_EQ(status, STATUS_SUCCESS);
+
+  auto running_task = CreateBlockingTask(tm, TASK_PRIORITY_NORMAL);
+  auto low_task = CreateBlockingTask(tm, TASK_PRIORITY_LOW);
+  auto high_task = CreateBlockingTask(tm, TASK_PRIORITY_HIGH);
+  EXPECT_EQ(running_task->Start(), STATUS_SUCCESS);
+  ASSERT_TRUE(running_task->WaitRunning());
+  EXPECT_EQ(low_task->Start(), STATUS_SUCCESS);
+  EXPECT_EQ(high_task->Start(), STATUS_SUCCESS);
+  EXPECT_EQ(WORKING, running_task->GetTaskStatus());
+  EXPECT_EQ(WAITING, low_task->GetTaskStatus());
+  EXPECT_EQ(WAITING, high_task->GetTaskStatus());
+
+  // high priority task started after running task, though started later
+  FinishBlockingTask(running_task);
+  ASSERT_TRUE(high_task->WaitRunning());
+  EXPECT_EQ(WORKING, high_task->GetTaskStatus());
+  EXPECT_EQ(WAITING, low_task->GetTaskStatus());
+
+  FinishBlockingTask(high_task);
+  ASSERT_TRUE(low_task->WaitRunning());
+  FinishBlockingTask(low_task);
+  tm->Stop();
+}
+
+TEST_F(TaskManagerTest, TaskAdmission) {
+  auto flow = mockflow_->GetFlow();
+  auto tm = std::make_shared<TaskManager>(flow, 1);
+  ConfigurationBuilder builder;
+  builder.AddProperty("task.low.max-waiting-tasks", "1");
+  tm->SetConfig(builder.Build());
+  auto status = tm->Start();
+  EXPECT_EQ(status, STATUS_SUCCESS);
+
+  auto running_task = CreateBlockingTask(tm, TASK_PRIORITY_LOW);
+  auto waiting_task = CreateBlockingTask(tm, TASK_PRIORITY_LOW);
+  auto rejected_task = CreateBlockingTask(tm, TASK_PRIORITY_LOW);
+  auto normal_task = CreateBlockingTask(tm, TASK_PRIORITY_NORMAL);
+  EXPECT_EQ(running_task->Start(), STATUS_SUCCESS);
+  ASSERT_TRUE(running_task->WaitRunning());
+  EXPECT_EQ(waiting_task->Start(), STATUS_SUCCESS);
+  EXPECT_EQ(rejected_task->Start(), STATUS_BUSY);
+  EXPECT_EQ(normal_task->Start(), STATUS_SUCCESS);
+  EXPECT_EQ(WAITING, waiting_task->GetTaskStatus());
+  EXPECT_EQ(WAITING, rejected_task->GetTaskStatus());
+  EXPECT_EQ(WAITING, normal_task->GetTaskStatus());
+
+  FinishBlockingTask(running_task);
+  ASSERT_TRUE(normal_task->WaitRunning());
+  FinishBlockingTask(normal_task);
+  ASSERT_TRUE(waiting_task->WaitRunning());
+  FinishBlockingTask(waiting_task);
+
+  // rejected task may start again when the class has room
+  EXPECT_EQ(rejected_task->Start(), STATUS_SUCCESS);
+  ASSERT_TRUE(rejected_task->WaitRunning());
+  FinishBlockingTask(rejected_task);
+  tm->Stop();
+}
+
+TEST_F(TaskManagerTest, TaskQueueTimeLimit) {
+  auto flow = mockflow_->GetFlow();
+  auto tm = std::make_shared<TaskManager>(flow, 1);
+  std::atomic<int64_t> now_us{1000};
+  tm->SetClock([&now_us]() { return now_us.load(); });
+  tm->SetAdmissionLimit(TASK_PRIORITY_NORMAL, 0, 150);
+  EXPECT_EQ(tm->Start(), STATUS_SUCCESS);
+
+  // no latency measured yet, queue time is not limited
+  auto first_task = CreateBlockingTask(tm, TASK_PRIORITY_NORMAL);
+  EXPECT_EQ(first_task->Start(), STATUS_SUCCESS);
+  ASSERT_TRUE(first_task->WaitRunning());
+  now_us += 100 * 1000;
+  FinishBlockingTask(first_task);
+  EXPECT_EQ(tm->GetTaskLatency(), 100 * 1000U);
+
+  auto running_task = CreateBlockingTask(tm, TASK_PRIORITY_NORMAL);
+  auto waiting_task = CreateBlockingTask(tm, TASK_PRIORITY_NORMAL);
+  auto rejected_task = CreateBlockingTask(tm, TASK_PRIORITY_NORMAL);
+  auto high_task = CreateBlockingTask(tm, TASK_PRIORITY_HIGH);
+  EXPECT_EQ(running_task->Start(), STATUS_SUCCESS);
+  ASSERT_TRUE(running_task->WaitRunning());
+  // estimated 100ms, after running task
+  EXPECT_EQ(waiting_task->Start(), STATUS_SUCCESS);
+  // estimated 200ms, after running and waiting task
+  EXPECT_EQ(rejected_task->Start(), STATUS_BUSY);
+  // high priority class has no limit
+  EXPECT_EQ(high_task->Start(), STATUS_SUCCESS);
+
+  now_us += 20 * 1000;
+  FinishBlockingTask(running_task);
+  ASSERT_TRUE(high_task->WaitRunning());
+  FinishBlockingTask(high_task);
+  ASSERT_TRUE(waiting_task->WaitRunning());
+  FinishBlockingTask(waiting_task);
+
+  auto high_queue_time = GetTaskStats(flow, "high.queue_time_us");
+  ASSERT_NE(high_queue_time, nullptr);
+  auto snapshot = high_queue_time->GetHistogram()->GetSnapshot();
+  EXPECT_EQ(snapshot.GetCount(), 1U);
+  EXPECT_EQ(snapshot.GetSum(), 20 * 1000U);
+  tm->Stop();
+}
+
+TEST_F(TaskManagerTest, TaskInflightBufferLimit) {
+  auto flow = mockflow_->GetFlow();
+  auto tm = std::make_shared<TaskManager>(flow, 10);
+  ConfigurationBuilder builder;
+  builder.AddProperty("task.inflight-buffer-limit", "4");
+  tm->SetConfig(builder.Build());
+  EXPECT_EQ(tm->Start(), STATUS_SUCCESS);
+
+  auto first_task = CreateBlockingTask(tm, TASK_PRIORITY_NORMAL, 3);
+  auto second_task = CreateBlockingTask(tm, TASK_PRIORITY_NORMAL, 2);
+  auto low_task = CreateBlockingTask(tm, TASK_PRIORITY_LOW, 1);
+  EXPECT_EQ(first_task->Start(), STATUS_SUCCESS);
+  ASSERT_TRUE(first_task->WaitRunning());
+  // 3 + 2 buffers exceed limit, smaller low task never overtakes
+  EXPECT_EQ(second_task->Start(), STATUS_SUCCESS);
+  EXPECT_EQ(low_task->Start(), STATUS_SUCCESS);
+  EXPECT_EQ(WAITING, second_task->GetTaskStatus());
+  EXPECT_EQ(WAITING, low_task->GetTaskStatus());
+
+  auto inflight = GetTaskStats(flow, "inflight_buffers");
+  ASSERT_NE(inflight, nullptr);
+  EXPECT_EQ(inflight->GetGauge()->Get(), 3);
+
+  FinishBlockingTask(first_task);
+  ASSERT_TRUE(second_task->WaitRunning());
+  ASSERT_TRUE(low_task->WaitRunning());
+  EXPECT_EQ(inflight->GetGauge()->Get(), 3);
+
+  FinishBlockingTask(second_task);
+  FinishBlockingTask(low_task);
+  EXPECT_EQ(inflight->GetGauge()->Get(), 0);
+
+  // a large task still runs alone
+  auto large_task = CreateBlockingTask(tm, TASK_PRIORITY_NORMAL, 6);
+  EXPECT_EQ(large_task->Start(), STATUS_SUCCESS);
+  ASSERT_TRUE(large_task->WaitRunning());
+  EXPECT_EQ(inflight->GetGauge()->Get(), 6);
+  FinishBlockingTask(large_task);
+  tm->Stop();
+}
+
+TEST_F(TaskManagerTest, TaskStatistics) {
+  auto flow = mockflow_->GetFlow();
+  auto tm = std::make_shared<TaskManager>(flow, 1);
+  tm->SetAdmissionLimit(TASK_PRIORITY_LOW, 1, 0);
+  EXPECT_EQ(tm->Start(), STATUS_SUCCESS);
+
+  auto running = GetTaskStats(flow, "running");
+  auto normal_waiting = GetTaskStats(flow, "normal.waiting");
+  auto low_waiting = GetTaskStats(flow, "low.waiting");
+  auto low_rejected = GetTaskStats(flow, "low.rejected");
+  auto normal_queue_time = GetTaskStats(flow, "normal.queue_time_us");
+  ASSERT_NE(running, nullptr);
+  ASSERT_NE(normal_waiting, nullptr);
+  ASSERT_NE(low_waiting, nullptr);
+  ASSERT_NE(low_rejected, nullptr);
+  ASSERT_NE(normal_queue_time, nullptr);
+
+  auto running_task = CreateBlockingTask(tm, TASK_PRIORITY_NORMAL);
+  auto normal_task = CreateBlockingTask(tm, TASK_PRIORITY_NORMAL);
+  auto low_task = CreateBlockingTask(tm, TASK_PRIORITY_LOW);
+  auto rejected_task = CreateBlockingTask(tm, TASK_PRIORITY_LOW);
+  EXPECT_EQ(running_task->Start(), STATUS_SUCCESS);
+  ASSERT_TRUE(running_task->WaitRunning());
+  EXPECT_EQ(normal_task->Start(), STATUS_SUCCESS);
+  EXPECT_EQ(low_task->Start(), STATUS_SUCCESS);
+  EXPECT_EQ(rejected_task->Start(), STATUS_BUSY);
+
+  EXPECT_EQ(running->GetGauge()->Get(), 1);
+  EXPECT_EQ(normal_waiting->GetGauge()->Get(), 1);
+  EXPECT_EQ(low_waiting->GetGauge()->Get(), 1);
+  EXPECT_EQ(low_rejected->GetCounter()->Get(), 1U);
+  EXPECT_EQ(normal_queue_time->GetHistogram()->GetSnapshot().GetCount(), 1U);
+
+  FinishBlockingTask(running_task);
+  ASSERT_TRUE(normal_task->WaitRunning());
+  EXPECT_EQ(normal_waiting->GetGauge()->Get(), 0);
+  EXPECT_EQ(low_waiting->GetGauge()->Get(), 1);
+  EXPECT_EQ(normal_queue_time->GetHistogram()->GetSnapshot().GetCount(), 2U);
+
+  FinishBlockingTask(normal_task);
+  ASSERT_TRUE(low_task->WaitRunning());
+  EXPECT_EQ(low_waiting->GetGauge()->Get(), 0);
+  FinishBlockingTask(low_task);
+  EXPECT_EQ(running->GetGauge()->Get(), 0);
+
+  // task statistics are removed with task manager
+  tm->Stop();
+  EXPECT_EQ(GetTaskStats(flow, "running"), nullptr);
+}
+
+}  // namespace modelbox